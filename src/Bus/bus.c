@@ -53,6 +53,7 @@
  */
 
 #include <string.h>
+#include <strings.h>
 #include <malloc.h>
 #include "Processor/simio.h"
 #include "Processor/tlb.h"
@@ -64,6 +65,7 @@
 #include "IO/io_generic.h"
 #include "Bus/bus.h"
 #include "Memory/mmc.h"
+#include "Memory/directory.h"
 
 
 BUS *AllBusses;
@@ -77,6 +79,7 @@ int  BUS_CPU_REQUESTS   = 4;
 int  BUS_IO_REQUESTS    = 4;
 int  BUS_TRACE_ENABLE   = 0;
 int  BUS_CRITICAL_WORD  = 1;
+int  BUS_DATA_BUSES     = 0;
 
 
 
@@ -109,6 +112,10 @@ void Bus_init(void)
   NUM_MODULES = ARCH_cpus + ARCH_ios;  /* does not include memory controller */
   MEM_CNTL = ARCH_cpus + ARCH_ios;
 
+  if (MEM_CNTL >= MODMASK_BITS)
+    YS__errmsg(0, "Too many bus modules: %d, only %d supported",
+	       MEM_CNTL + 1, MODMASK_BITS);
+
   /*
    * Bus configuration.
    * Default arbitration delay: two delay cycles + 1 dead cycle when 
@@ -121,6 +128,15 @@ void Bus_init(void)
   get_parameter("BUS_turnaround",     &BUS_TURNAROUND,     PARAM_INT);
   get_parameter("BUS_mindelay",       &BUS_MINDELAY,       PARAM_INT);
   get_parameter("BUS_critical",       &BUS_CRITICAL_WORD,  PARAM_INT);
+  get_parameter("BUS_data_buses",     &BUS_DATA_BUSES,     PARAM_INT);
+
+  if ((BUS_DATA_BUSES < 0) || (BUS_DATA_BUSES >= MAX_BUS_LANES))
+    YS__errmsg(0, "BUS_data_buses must be between 0 and %d: %d",
+	       MAX_BUS_LANES - 1, BUS_DATA_BUSES);
+
+  if (NUM_MODULES + 1 > sizeof(unsigned) * 8)
+    YS__errmsg(0, "Bus arbitration supports at most %d bus modules",
+	       (int)(sizeof(unsigned) * 8));
 
 
   AllBusses = RSIM_CALLOC(BUS, ARCH_numnodes);
@@ -140,7 +156,6 @@ void Bus_init(void)
       if (!(pbus->arbwaiters))
 	YS__errmsg(nid, "malloc failed at %s:%i", __FILE__, __LINE__);
 
-      pbus->cur_req    = NULL;
       pbus->state      = BUS_IDLE;
       pbus->busy_until = 0;
       pbus->req_count  = 0;
@@ -163,6 +178,9 @@ void Bus_init(void)
 	}
 
       pbus->arbwaiter_count = 0;
+      pbus->arb_mask        = 0;
+      pbus->arb_req_mask    = 0;
+      pbus->arb_write_mask  = 0;
       pbus->cur_winner      = 0; 
       pbus->pstates[0]      = MASTER_STATE;
       pbus->rr_index        = MIN(1, NUM_MODULES - 1);
@@ -175,16 +193,34 @@ void Bus_init(void)
 
       /*
        * Create the arbitrator to call BusMain at the appropriate time.
-       * "issuer" is used to perform actual transferring on the bus.
+       * Each lane has an "issuer" and a "performer" to perform actual
+       * transferring on the bus.
        */
       pbus->arbitrator = NewEvent("bus_arbitrator", Bus_main, NODELETE, 0);
       pbus->arbitrator->uptr1 = (void *) pbus;
 
-      pbus->issuer = NewEvent("bus_issuer", Bus_issuer, NODELETE, 0);
-      pbus->issuer->uptr1 = (void *) pbus;
+      pbus->num_lanes = BUS_DATA_BUSES + 1;
+      pbus->next_lane = 0;
+      pbus->lanes     = RSIM_CALLOC(BUSLANE, pbus->num_lanes);
+      if (!(pbus->lanes))
+	YS__errmsg(nid, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+      for (i = 0; i < pbus->num_lanes; i++)
+	{
+	  BUSLANE *plane = &(pbus->lanes[i]);
+
+	  plane->busy_until = 0;
+	  plane->cur_req    = NULL;
+	  plane->last_owner = 0;
 
-      pbus->performer = NewEvent("bus_perform", Bus_perform, NODELETE, 0);
-      pbus->performer->uptr1 = (void *) pbus;
+	  plane->issuer = NewEvent("bus_issuer", Bus_issuer, NODELETE, 0);
+	  plane->issuer->uptr1 = (void *) pbus;
+	  plane->issuer->uptr2 = (void *) plane;
+
+	  plane->performer = NewEvent("bus_perform", Bus_perform, NODELETE, 0);
+	  plane->performer->uptr1 = (void *) pbus;
+	  plane->performer->uptr2 = (void *) plane;
+	}
 
       pbus->num_trans    = RSIM_CALLOC(trans_count_t, NUM_MODULES+1);
       if (!(pbus->num_trans))
@@ -238,6 +274,86 @@ void Bus_main(void)
 }
 
 
+/*=============================================================================
+ * Update the arbitration masks for module "pid", which is now waiting with
+ * "req", or has no waiter if "req" is NULL.
+ */
+
+static void Bus_arb_mark(BUS *pbus, int pid, REQ *req)
+{
+  modmask_t bit = MODMASK_BIT(pid);
+
+  pbus->arb_mask       &= ~bit;
+  pbus->arb_req_mask   &= ~bit;
+  pbus->arb_write_mask &= ~bit;
+
+  if (req == NULL)
+    return;
+
+  pbus->arb_mask |= bit;
+
+  if ((req->type == REQUEST) && (req->req_type != WRITE_UC))
+    pbus->arb_req_mask |= bit;
+
+  if ((req->type == COHE_REPLY) ||
+      (req->type == WRITEBACK) ||
+      (req->type == WRITEPURGE))
+    pbus->arb_write_mask |= bit;
+}
+
+
+
+/*=============================================================================
+ * Time for which a transaction keeps the next one from starting: all of it
+ * on a multiplexed bus, one address cycle on a split bus.
+ */
+
+static double Bus_slot(REQ *req)
+{
+  if (BUS_DATA_BUSES)
+    return (double)BUS_FREQUENCY;
+
+  return (double)(req->bus_cycles * BUS_FREQUENCY);
+}
+
+
+
+/*=============================================================================
+ * Select the lane of a split bus for a transaction of module "pid":
+ * the address bus for requests without data, otherwise the data bus that
+ * can start it first.
+ */
+
+static int Bus_pick_lane(BUS *pbus, REQ *req, int pid)
+{
+  BUSLANE *plane;
+  double   free_at, best_free = 1.0e20;
+  int      n, best = 1;
+
+  if ((req->type == REQUEST) &&
+      (req->req_type != WRITE_UC) &&
+      (req->req_type != SWAP_UC))
+    return 0;
+
+  for (n = 1; n < pbus->num_lanes; n++)
+    {
+      plane = &(pbus->lanes[n]);
+      free_at = plane->busy_until;
+      if (plane->last_owner != pid)
+	free_at += BUS_TURNAROUND * BUS_FREQUENCY;
+
+      if (free_at < best_free)
+	{
+	  best_free = free_at;
+	  best = n;
+	}
+    }
+
+  return best;
+}
+
+
+
 /*=============================================================================
  * Called by a processor which has something to send out through the bus
  * and which is not in master state. Bus receives only one arbitration request
@@ -262,6 +378,7 @@ void Bus_recv_arb_req(int nid, int pid, REQ *req, double start_time)
   pbus->arbwaiters[pid].req = req;
   pbus->arbwaiters[pid].time = (double)start;
   pbus->arbwaiter_count++;
+  Bus_arb_mark(pbus, pid, req);
 
   req->arb_start_time = YS__Simtime;
   
@@ -274,6 +391,21 @@ void Bus_recv_arb_req(int nid, int pid, REQ *req, double start_time)
 
 
 
+/*=============================================================================
+ * Replace the pending arbitration request of module "pid". Used to let
+ * cache-to-cache copies bypass a stalled arbitration request.
+ */
+
+void Bus_replace_arb_req(int nid, int pid, REQ *req)
+{
+  BUS *pbus = PID2BUS(nid);
+
+  pbus->arbwaiters[pid].req = req;
+  Bus_arb_mark(pbus, pid, req);
+}
+
+
+
 /*=============================================================================
  * Determine which module will drive the bus after current bus owner (i.e. the
  * one in master state.)
@@ -281,12 +413,11 @@ void Bus_recv_arb_req(int nid, int pid, REQ *req, double start_time)
 
 void Bus_arbitrator(BUS *pbus)
 {
-  int        i, idx;
-  ARBWAITER *parb;
+  BUSLANE   *plane;
   REQ       *next_req;
-  int        next_winner = -1;
-  double     start_time = 1e20;
-  double     end_time  = 1.0e20; /* big enough? */
+  modmask_t  eligible, pending, oldest, upper;
+  int        i, next_winner = -1;
+  double     start_time = 1.0e20;
   long long  next_cycle;
   
 
@@ -299,55 +430,43 @@ void Bus_arbitrator(BUS *pbus)
   
   /* find next winner, determine request start time -------------------------*/
 
-  for (i = pbus->rr_index; i < NUM_MODULES; i++)
-    {
-      parb = &(pbus->arbwaiters[i]);
-      if (parb->req && parb->time < start_time)
-	{
-	  if ((pbus->req_count == BUS_TOTAL_REQUESTS) &&
-	      (parb->req->type == REQUEST) &&
-	      (parb->req->req_type != WRITE_UC))
-	    continue;
-
-	  if ((pbus->write_flowcontrol) &&
-	      ((parb->req->type == COHE_REPLY) ||
-	       (parb->req->type == WRITEBACK) ||
-	       (parb->req->type == WRITEPURGE)))
-	    continue;
-	  
-	  next_winner = i;
-	  start_time = parb->time;
-	}
-    }
-
-  for (i = 0; i < pbus->rr_index; i++)
+  /*
+   * The oldest eligible waiter wins; among equally old ones the first at
+   * or after the round-robin index, otherwise the first one before it.
+   * Requests that need a request number wait while all are in use; data
+   * for the memory controller waits while it asserts write flow control.
+   */
+  eligible = pbus->arb_mask;
+  if (pbus->req_count == BUS_TOTAL_REQUESTS)
+    eligible &= ~pbus->arb_req_mask;
+  if (pbus->write_flowcontrol)
+    eligible &= ~pbus->arb_write_mask;
+
+  oldest = 0;
+  for (pending = eligible; pending; pending &= pending - 1)
     {
-      parb = &(pbus->arbwaiters[i]);
-      if (parb->req && parb->time < start_time)
+      i = ffsll(pending) - 1;
+      if (pbus->arbwaiters[i].time < start_time)
 	{
-	  if ((pbus->req_count == BUS_TOTAL_REQUESTS) &&
-	      (parb->req->type == REQUEST) &&
-	      (parb->req->req_type != WRITE_UC))
-	    continue;
-
-	  if ((pbus->write_flowcontrol) &&
-	      ((parb->req->type == COHE_REPLY) ||
-	       (parb->req->type == WRITEBACK) ||
-	       (parb->req->type == WRITEPURGE)))
-	    continue;
-	  
-	  next_winner = i;
-	  start_time = parb->time;
+	  start_time = pbus->arbwaiters[i].time;
+	  oldest = MODMASK_BIT(i);
 	}
+      else if (pbus->arbwaiters[i].time == start_time)
+	oldest |= MODMASK_BIT(i);
     }
 
-
+  upper = oldest & ~(MODMASK_BIT(pbus->rr_index) - 1);
+  if (upper)
+    next_winner = ffsll(upper) - 1;
+  else if (oldest)
+    next_winner = ffsll(oldest) - 1;
 
   /*
-   * If the MMC wants to use the bus, it has highest priority.
+   * If the MMC wants to use the bus, it has highest priority, unless it
+   * started waiting after the winner.
    */
-  if (pbus->arbwaiters[MEM_CNTL].req && 
-      pbus->arbwaiters[MEM_CNTL].time <= start_time)
+  if ((pbus->arb_mask & MODMASK_BIT(MEM_CNTL)) &&
+      (pbus->arbwaiters[MEM_CNTL].time <= start_time))
     {
       next_winner = MEM_CNTL;
       start_time  = pbus->arbwaiters[MEM_CNTL].time;
@@ -372,30 +491,64 @@ void Bus_arbitrator(BUS *pbus)
   next_req = pbus->arbwaiters[next_winner].req;
   pbus->arbwaiters[next_winner].req = NULL;
   pbus->next_req = next_req;
+  Bus_arb_mark(pbus, next_winner, NULL);
 
   
-  /*
-   * 1. Driver does not change:
-   *    start driving at end of current transaction
-   *    at least BUS_MINDELAY cycles after last transaction start
-   *    synchronize to bus cycle
-   * 2. Driver changes:
-   *    start driving BUS_TURNAROUND cycles after end of transaction
-   *    at least BUS_ARBDELAY cycles after arbitration request
-   *    at least BUS_MINDELAY cycles after last transaction start
-   *    synchronize to bus cycle
-   */
-  if (pbus->next_winner == pbus->cur_winner)
-    pbus->next_start_time =
-      MAX(MAX(pbus->last_start_time + BUS_MINDELAY * BUS_FREQUENCY,
-	      pbus->last_end_time),
-	  (double)next_cycle);
+  if (BUS_DATA_BUSES == 0)
+    {
+      /*
+       * 1. Driver does not change:
+       *    start driving at end of current transaction
+       *    at least BUS_MINDELAY cycles after last transaction start
+       *    synchronize to bus cycle
+       * 2. Driver changes:
+       *    start driving BUS_TURNAROUND cycles after end of transaction
+       *    at least BUS_ARBDELAY cycles after arbitration request
+       *    at least BUS_MINDELAY cycles after last transaction start
+       *    synchronize to bus cycle
+       */
+      if (pbus->next_winner == pbus->cur_winner)
+	pbus->next_start_time =
+	  MAX(MAX(pbus->last_start_time + BUS_MINDELAY * BUS_FREQUENCY,
+		  pbus->last_end_time),
+	      (double)next_cycle);
+      else
+	pbus->next_start_time =
+	  MAX(MAX(pbus->last_start_time + BUS_MINDELAY * BUS_FREQUENCY,
+		  pbus->last_end_time + BUS_TURNAROUND * BUS_FREQUENCY),
+	      MAX(start_time + BUS_ARBDELAY * BUS_FREQUENCY,
+		  (double)next_cycle));
+    }
   else
-    pbus->next_start_time =
-      MAX(MAX(pbus->last_start_time + BUS_MINDELAY * BUS_FREQUENCY,
-	      pbus->last_end_time + BUS_TURNAROUND * BUS_FREQUENCY),
-	  MAX(start_time + BUS_ARBDELAY * BUS_FREQUENCY,
-	      (double)next_cycle));
+    {
+      /*
+       * Split bus: the address bus takes one transaction per bus cycle
+       * (plus turnaround when the driver changes). Address-only requests
+       * stay on it, everything else needs a data bus for its whole
+       * duration; take the one that becomes free first.
+       */
+      pbus->next_lane = Bus_pick_lane(pbus, next_req, next_winner);
+      plane = &(pbus->lanes[pbus->next_lane]);
+
+      pbus->next_start_time =
+	MAX(pbus->last_start_time + MAX(BUS_MINDELAY, 1) * BUS_FREQUENCY,
+	    (double)next_cycle);
+
+      if (pbus->next_winner != pbus->cur_winner)
+	pbus->next_start_time =
+	  MAX(pbus->next_start_time,
+	      MAX(pbus->last_start_time +
+		  (1 + BUS_TURNAROUND) * BUS_FREQUENCY,
+		  start_time + BUS_ARBDELAY * BUS_FREQUENCY));
+
+      if (plane->last_owner == next_winner)
+	pbus->next_start_time = MAX(pbus->next_start_time, plane->busy_until);
+      else
+	pbus->next_start_time =
+	  MAX(pbus->next_start_time,
+	      plane->busy_until + BUS_TURNAROUND * BUS_FREQUENCY);
+      plane->last_owner = next_winner;
+    }
 
   
   if (pbus->next_start_time < pbus->busy_until)
@@ -429,8 +582,7 @@ void Bus_wakeup_winner(BUS *pbus)
   pbus->pstates[pbus->next_winner] = MASTER_STATE;
   pbus->cur_winner = pbus->next_winner;
   pbus->next_winner = -1;
-  pbus->busy_until = YS__Simtime +
-    (pbus->next_req->bus_cycles * BUS_FREQUENCY);
+  pbus->busy_until = YS__Simtime + Bus_slot(pbus->next_req);
 
   if (pbus->cur_winner == MEM_CNTL)
     MMC_in_master_state(pbus->next_req);
@@ -459,20 +611,26 @@ void Bus_wakeup_winner(BUS *pbus)
 
 
 
-/*===========================================================================*/
+/*=============================================================================
+ * Start a transaction on the lane picked by the arbitrator (the bus itself
+ * if it is not split).
+ */
 
 void Bus_start(REQ *req, int owner)
 {
-  BUS *pbus = PID2BUS(req->node);
+  BUS     *pbus  = PID2BUS(req->node);
+  BUSLANE *plane = &(pbus->lanes[pbus->next_lane]);
 
 
-  if (IsScheduled(pbus->issuer))
+  if (IsScheduled(plane->issuer))
     YS__errmsg(pbus->nodeid,
 	       "IOGetMasterState: scheduling scheduled bus issuer");
 
-  pbus->cur_req       = req;
-  pbus->cur_req_owner = owner;
-  pbus->busy_until = YS__Simtime + (req->bus_cycles * BUS_FREQUENCY);
+  plane->cur_req       = req;
+  plane->cur_req_owner = owner;
+  plane->busy_until    = YS__Simtime + (req->bus_cycles * BUS_FREQUENCY);
+  plane->busy_cycles  += req->bus_cycles;
+  pbus->busy_until     = YS__Simtime + Bus_slot(req);
   
   if ((req->type == REQUEST) &&
       (req->req_type != WRITE_UC))
@@ -487,14 +645,14 @@ void Bus_start(REQ *req, int owner)
   if ((BUS_CRITICAL_WORD) &&
       ((req->type == REPLY) || (req->type == COHE_REPLY)))
     {
-      schedule_event(pbus->performer, YS__Simtime + BUS_FREQUENCY);
+      schedule_event(plane->performer, YS__Simtime + BUS_FREQUENCY);
     }
   else
     {
-      schedule_event(pbus->performer, pbus->busy_until - 0.1);
+      schedule_event(plane->performer, plane->busy_until - 0.1);
     }
     
-  schedule_event(pbus->issuer, pbus->busy_until);
+  schedule_event(plane->issuer, plane->busy_until);
 
   if ((req->type == REQUEST) || (req->type == COHE_REPLY))
     pbus->num_subtrans[req->src_proc][req->req_type]++;
@@ -520,8 +678,9 @@ void Bus_start(REQ *req, int owner)
 
 void Bus_issuer(void)
 {
-  BUS *pbus = (BUS *) YS__ActEvnt->uptr1;
-  REQ *req = pbus->cur_req;
+  BUS     *pbus  = (BUS *) YS__ActEvnt->uptr1;
+  BUSLANE *plane = (BUSLANE *) YS__ActEvnt->uptr2;
+  REQ     *req   = plane->cur_req;
 
   if (req == NULL)
     YS__errmsg(pbus->nodeid,
@@ -534,9 +693,9 @@ void Bus_issuer(void)
   
   /*-------------------------------------------------------------------------*/
 
-  Bus_finish_trans(pbus, pbus->cur_req);
+  Bus_finish_trans(pbus, plane->cur_req);
 
-  pbus->cur_req = NULL;
+  plane->cur_req = NULL;
 }
 
 
@@ -548,20 +707,21 @@ void Bus_issuer(void)
 
 void Bus_perform(void)
 {
-  BUS *pbus = (BUS *) YS__ActEvnt->uptr1;
+  BUS     *pbus  = (BUS *) YS__ActEvnt->uptr1;
+  BUSLANE *plane = (BUSLANE *) YS__ActEvnt->uptr2;
 
-  if (pbus->cur_req == NULL)
+  if (plane->cur_req == NULL)
     YS__errmsg(pbus->nodeid,
 	       "Bus_perform(): Nothing to be sent on bus, why are we here?");
 
-  if (pbus->cur_req_owner == PROCESSOR)
-    Cache_send_on_bus(pbus->cur_req);
+  if (plane->cur_req_owner == PROCESSOR)
+    Cache_send_on_bus(plane->cur_req);
   
-  if (pbus->cur_req_owner == IO_MODULE)
-    IO_send_on_bus(pbus->cur_req);
+  if (plane->cur_req_owner == IO_MODULE)
+    IO_send_on_bus(plane->cur_req);
   
-  if (pbus->cur_req_owner == COORDINATOR)
-    MMC_send_on_bus(pbus->cur_req);
+  if (plane->cur_req_owner == COORDINATOR)
+    MMC_send_on_bus(plane->cur_req);
 }
 
 
@@ -849,6 +1009,32 @@ void Bus_finish_trans(BUS* pbus, REQ* req)
 
 
 
+/*=============================================================================
+ * Returns true if no transaction is on the bus, waiting for arbitration or
+ * waiting for a split-transaction reply, and no coherence message is in
+ * the directory network. Used to find a point at which the node state can
+ * be checkpointed without losing requests in flight.
+ */
+
+int Bus_idle(int nid)
+{
+  BUS *pbus = PID2BUS(nid);
+  int  n;
+
+  for (n = 0; n < pbus->num_lanes; n++)
+    if ((pbus->lanes[n].cur_req != NULL) ||
+	IsScheduled(pbus->lanes[n].issuer) ||
+	IsScheduled(pbus->lanes[n].performer))
+      return 0;
+
+  return ((pbus->arbwaiter_count == 0) &&
+	  (pbus->req_count == 0) &&
+	  IsNotScheduled(pbus->arbitrator) &&
+	  Directory_idle(nid));
+}
+
+
+
 /*****************************************************************************/
 /* Bus statistics functions                                                  */
 /*****************************************************************************/
@@ -870,6 +1056,13 @@ void Bus_print_params(int nid)
 	      BUS_TOTAL_REQUESTS, BUS_CPU_REQUESTS, BUS_IO_REQUESTS);
   YS__statmsg(nid,
 	      "  critical-word first :   %s\n", BUS_CRITICAL_WORD ? "on" : "off");
+  if (BUS_DATA_BUSES)
+    YS__statmsg(nid,
+		"  split bus:            1 address bus, %d data bus%s\n",
+		BUS_DATA_BUSES, (BUS_DATA_BUSES > 1) ? "es" : "");
+  else
+    YS__statmsg(nid,
+		"  multiplexed address/data bus\n");
   YS__statmsg(nid, "\n");
 }
 
@@ -960,6 +1153,24 @@ void Bus_stat_report(int nid)
 	  }
     }
   
+  if (BUS_DATA_BUSES)
+    {
+      YS__statmsg(nid, "\n  Lane Utilization\n");
+      for (n = 0; n < pbus->num_lanes; n++)
+	{
+	  if (n == 0)
+	    YS__statmsg(nid, "    Address bus \t\t\t%12lld (%2.2lf%%)\n",
+			pbus->lanes[n].busy_cycles,
+			100.0 * ((double)pbus->lanes[n].busy_cycles /
+				 total_cycles));
+	  else
+	    YS__statmsg(nid, "    Data bus %i \t\t\t%12lld (%2.2lf%%)\n",
+			n - 1, pbus->lanes[n].busy_cycles,
+			100.0 * ((double)pbus->lanes[n].busy_cycles /
+				 total_cycles));
+	}
+    }
+  
   YS__statmsg(nid, "\n\n");
 }
 
@@ -980,6 +1191,8 @@ void Bus_stat_clear(int nid)
       for (i = 0; i < sizeof(subtrans_count_t) / sizeof(long long); i++)
 	pbus->num_subtrans[n][i] = 0;
     }
+  for (n = 0; n < pbus->num_lanes; n++)
+    pbus->lanes[n].busy_cycles = 0;
   pbus->arb_delay   = 0.0;
   pbus->last_clear  = YS__Simtime;
 }
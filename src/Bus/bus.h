@@ -94,19 +94,40 @@ typedef struct
 } ARBWAITER;
 
 
+/*
+ * A set of wires that carries one transaction at a time. The multiplexed
+ * bus has a single lane for addresses and data. A split bus has the
+ * address bus as lane 0, used by address-only requests, and one lane per
+ * data bus for every transaction that moves data.
+ */
+typedef struct
+{
+  double     busy_until;
+  REQ       *cur_req;               /* request currently using the lane     */
+  int        cur_req_owner;
+  int        last_owner;            /* module that drove the lane last      */
+  EVENT     *issuer;
+  EVENT     *performer;
+  long long  busy_cycles;
+} BUSLANE;
+
+#define MAX_BUS_LANES           17
+
+
 typedef long long trans_count_t[BARRIER+1];
 typedef long long trans_latency_t[BARRIER+1];
 typedef long long subtrans_count_t[REQ_TYPE_MAX];
 
 typedef struct _bus_
 {
-  double     busy_until;
+  double     busy_until;             /* next arbitration slot             */
   int        state;
   int        nodeid;
 
-  /* request currently using the bus */
-  REQ       *cur_req;
-  int        cur_req_owner;
+  /* address bus and data buses */
+  BUSLANE   *lanes;
+  int        num_lanes;
+  int        next_lane;
 
   /* Outstanding requests. */
   REQ      **req_queue;
@@ -114,11 +135,16 @@ typedef struct _bus_
 
   /*
    * Arbitration related variables. The extra one is for main memory 
-   * controller.
+   * controller. The masks have one bit per module: all waiters, waiters
+   * with a request that needs a request number, and waiters with data
+   * for the memory controller (subject to write flow control).
    */
   int       *pstates;                /* states of processor/mmc */
   ARBWAITER *arbwaiters;
   int        arbwaiter_count;
+  modmask_t  arb_mask;
+  modmask_t  arb_req_mask;
+  modmask_t  arb_write_mask;
   int        rr_index;               /* to implement round-robin algorithm */
   int        cur_winner;
   int        next_winner;
@@ -128,10 +154,8 @@ typedef struct _bus_
   double     last_start_time;
   double     last_end_time;
 
-  /* Working bees to perform arbitration and transfer. */
+  /* Working bees to perform arbitration. */
   EVENT     *arbitrator;
-  EVENT     *issuer;
-  EVENT     *performer;
 
   int        write_flowcontrol;
   
@@ -163,6 +187,7 @@ extern int  BUS_CPU_REQUESTS;     /* number of requests per CPU              */
 extern int  BUS_IO_REQUESTS;      /* number of requests per IO device        */
 extern int  BUS_TRACE_ENABLE;     /* turn bus trace file on/off              */
 extern int  BUS_CRITICAL_WORD;    /* turn on critical word first data returns*/
+extern int  BUS_DATA_BUSES;       /* 0: multiplexed bus, else # data buses   */
 
 
 #define PID2BUS(nid)		(&(AllBusses[nid]))
@@ -181,9 +206,11 @@ extern int  BUS_CRITICAL_WORD;    /* turn on critical word first data returns*/
  *  - Next bus owner has not been chosen, or
  *  - The next bus owner has been chosen, but it will not start using bus
  *    before "current_sim_time + timeinc". 
+ * A split bus always goes through arbitration to get a data bus assigned.
  */
 #define BusIsIdleUntil(timeinc)   \
-	   (IsNotScheduled(pbus->issuer) && (pbus->next_winner == -1 || \
+	   ((BUS_DATA_BUSES == 0) && \
+	    IsNotScheduled(pbus->lanes[0].issuer) && (pbus->next_winner == -1 || \
             pbus->next_start_time > YS__Simtime + timeinc))
 
 /*
@@ -196,6 +223,7 @@ void Bus_start                   (REQ *req, int owner);
 void Bus_issuer                  (void);
 void Bus_perform                 (void);
 void Bus_recv_arb_req            (int, int, REQ *, double start_time);
+void Bus_replace_arb_req         (int, int, REQ *);
 void Bus_arbitrator              (BUS *pbus);
 void Bus_send_writeback          (REQ *);
 void Bus_send_writepurge         (REQ *);
@@ -214,6 +242,7 @@ void Bus_send_IO_reply           (REQ *);
 
 void Bus_start_trans             (BUS* pbus, REQ* req);
 void Bus_finish_trans            (BUS* pbus, REQ* req);
+int  Bus_idle                    (int);
 
 void Bus_print_params            (int);
 void Bus_stat_report             (int);
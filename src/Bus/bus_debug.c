@@ -143,19 +143,28 @@ void Bus_dump(int nid)
 	     "Arbitrator status: %sSCHEDULED\n", 
 	     IsNotScheduled(pbus->arbitrator) ? "UN" : " ");
 
-  YS__logmsg(pbus->nodeid,
-	     "Issuer status: %sSCHEDULED\n", 
-	     IsNotScheduled(pbus->issuer) ? "UN" : " ");
+  for (i = 0; i < pbus->num_lanes; i++)
+    {
+      BUSLANE *plane = &(pbus->lanes[i]);
 
-  YS__logmsg(pbus->nodeid,
-	     "Performer status: %sSCHEDULED\n", 
-	     IsNotScheduled(pbus->performer) ? "UN" : " ");
+      if (pbus->num_lanes > 1)
+	YS__logmsg(pbus->nodeid, "Lane %d: busy_until(%.0f)\n",
+		   i, plane->busy_until);
 
-  if (IsScheduled(pbus->issuer))
-    {
       YS__logmsg(pbus->nodeid,
-		 "issuing_req: %s\n", 
-		 (pbus->cur_req_owner == PROCESSOR) ? "PROCESSOR" : "MMC");
-      Cache_req_dump(pbus->cur_req, 0x53, nid);
+		 "Issuer status: %sSCHEDULED\n", 
+		 IsNotScheduled(plane->issuer) ? "UN" : " ");
+
+      YS__logmsg(pbus->nodeid,
+		 "Performer status: %sSCHEDULED\n", 
+		 IsNotScheduled(plane->performer) ? "UN" : " ");
+
+      if (IsScheduled(plane->issuer))
+	{
+	  YS__logmsg(pbus->nodeid,
+		     "issuing_req: %s\n", 
+		     (plane->cur_req_owner == PROCESSOR) ? "PROCESSOR" : "MMC");
+	  Cache_req_dump(plane->cur_req, 0x53, nid);
+	}
     }
 }
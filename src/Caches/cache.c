@@ -57,11 +57,18 @@
 #include <string.h>
 #include "Processor/simio.h"
 #include "Processor/capconf.h"
+#include "Processor/procstate.h"
+#include "Processor/predecode.h"
 #include "sim_main/simsys.h"
 #include "Caches/system.h"
 #include "Caches/req.h"
 #include "Caches/pipeline.h"
 #include "Caches/cache.h"
+#include "Caches/l3cache.h"
+#include "Memory/directory.h"
+
+
+static int trace_mode = 0;       /* running Cache_trace_run: no predecoding */
 
 
 
@@ -115,20 +122,18 @@ int Cache_search(CACHE *captr, unsigned vaddr, unsigned paddr, cline_t **cline)
 
 
 /*
- * Updates the cache ages in the set to indicate a hit on a reference;
- * age is not maintained for an infinite cache because there will be
- * no replacement.
+ * Updates the replacement state of the line to indicate a hit on a
+ * reference; it is not maintained for an infinite cache because there
+ * will be no replacement.
  */
 int Cache_hit_update(CACHE *captr, cline_t *pline, REQ * req)
 {
-  unsigned  lineidx, i, oldage;
-  cline_t  *cline;
   int       hit_cpref = 0; /* hit cache-initiated prefetch? */
 
   /*
-   * Update ages only if LRU is used and cache is not infinite.
+   * Update replacement state only if cache is not infinite.
    */
-  if (captr->replacement != LRU || captr->size == INFINITE)
+  if (captr->size == INFINITE)
     return 0;
 
   if (pline->pref && !req->prefetch)
@@ -175,18 +180,7 @@ int Cache_hit_update(CACHE *captr, cline_t *pline, REQ * req)
       pline->pref_tag_repl = -1;
     }
 
-  lineidx = pline->index & (~captr->set_mask);
-  oldage  = pline->age;
-
-  for (i = 0; i < captr->setsz; i++, lineidx++)
-    {
-      cline = &(captr->tags[lineidx]);
-      if (cline == pline)
-	cline->age = 1;  /* age of line hit is made 1 */
-      else if (cline->age < oldage)
-	/* age less than that the hit one is increased by one. */
-	cline->age++;
-    }
+  Repl_touch(captr, pline);
 
   return hit_cpref;
 }
@@ -194,44 +188,58 @@ int Cache_hit_update(CACHE *captr, cline_t *pline, REQ * req)
 
 
 /*
- * Updates cache age on a present miss. We distinguish present miss
- * from other types of misses only because they are easier to handle.
+ * Updates replacement state on a present miss. We distinguish present
+ * miss from other types of misses only because they are easier to handle.
  */
 void Cache_pmiss_update(CACHE * captr, REQ *req, int index, int prefonly)
 {
-  int      lineidx, i;
-  int      oldage;
   cline_t *cline;
 
   /*
-   * update ages only if LRU and not infinite cache are true.
+   * update replacement state only if not infinite cache.
    */
-  if (captr->replacement != LRU || captr->size == INFINITE)
+  if (captr->size == INFINITE)
     return;
 
-  oldage  = captr->tags[index].age;
-  lineidx = index & (~captr->set_mask);
+  cline = &(captr->tags[index]);
 
-  for (i = 0; i < captr->setsz; i++, lineidx++)
+  if (prefonly && req->prefetch)
     {
-      cline = &(captr->tags[lineidx]);
-      if (lineidx == index)
-	{
-	  if (prefonly && req->prefetch)
-	    {
-	      cline->pref = req->prefetch;
-	      cline->pref_time = YS__Simtime;
-	    }
-	  else    /* either only demand access or a late prefetch */
-	    cline->pref = 0;
+      cline->pref = req->prefetch;
+      cline->pref_time = YS__Simtime;
+    }
+  else    /* either only demand access or a late prefetch */
+    cline->pref = 0;
 
-	  /* this happens regardless, since nothing was replaced */
-	  cline->pref_tag_repl = -1;
-	  cline->age = 1;
-	}
-      else if (cline->age < oldage)
-	/* age less than that line is increased by one */
-	cline->age++;
+  /* this happens regardless, since nothing was replaced */
+  cline->pref_tag_repl = -1;
+
+  Repl_miss(captr, index >> captr->set_shift);
+  Repl_fill(captr, cline, 0);
+}
+
+
+
+/*
+ * Victim class of a line: invalid lines are replaced first. With LRU the
+ * classic heuristic prefers clean over private over dirty lines; the
+ * other policies treat all valid lines alike. Returns -1 for lines that
+ * cannot be replaced.
+ */
+static int Cache_victim_class(CACHE *captr, cline_t *pline)
+{
+  switch (pline->state)
+    {
+    case INVALID:
+      return 0;
+    case SH_CL:
+      return 1;
+    case PR_CL:
+      return captr->replacement == LRU ? 2 : 1;
+    case PR_DY:
+      return captr->replacement == LRU ? 3 : 1;
+    default:
+      return -1;
     }
 }
 
@@ -239,30 +247,28 @@ void Cache_pmiss_update(CACHE * captr, REQ *req, int index, int prefonly)
 
 /*
  * This function occurs in the case of a total miss. The function must
- * pick a victim and then update the age accordingly. The heuristic used
- * here is as follows:
+ * pick a victim and then update the replacement state accordingly. The
+ * heuristic used here is as follows:
  *    1, first, an INVALID line first;
  *    2, then, the oldest SH_CL line;
  *    3, then, the oldest PR_CL line;
  *    4, finally, the oldest PR_DY line.
+ * where "oldest" is the line ranked highest by the replacement policy;
+ * policies other than LRU only distinguish invalid and valid lines.
  * If all lines in the set have upgrades outstanding, then this function
  * cannot replace a line and thus must return 0. Otherwise, return 1 to 
  * indicate success, and put the line address into "*cline".
  */
 int Cache_miss_update(CACHE *captr, REQ *req, cline_t **cline, int prefonly)
 {
-  cline_t *pline;
-  int i, lineidx, repl_age, victim;
-  int bestinv     = -1;
-  int bestclean   = -1;
-  int bestprivate = -1;
-  int bestdirty   = -1;
-  int inv_age     = -1; /* invalid cache line with the largest age */
-  int clean_age   = -1; /* valid clean cache line with the largest age */
-  int private_age = -1; /* valid private clean cache line with largest age */
-  int dirty_age   = -1; /* dirty cache line with the largest age */
-  int reqtag      = (req->paddr >> captr->tag_shift);
-  int baseidx     = (*cline)->index & (~captr->set_mask);
+  cline_t  *pline;
+  int       i, lineidx, class, victim;
+  int       best[4]     = { -1, -1, -1, -1 };
+  unsigned  best_rank[4], rank;
+  int       reqtag      = (req->paddr >> captr->tag_shift);
+  int       baseidx     = (*cline)->index & (~captr->set_mask);
+
+  Repl_miss(captr, baseidx >> captr->set_shift);
 
   /*
    * Find a victim according to the heuristic rule described above.
@@ -274,42 +280,15 @@ int Cache_miss_update(CACHE *captr, REQ *req, cline_t **cline, int prefonly)
       if (pline->mshr_out)
 	continue;
 
-      switch (pline->state)
+      class = Cache_victim_class(captr, pline);
+      if (class >= 0)
 	{
-	case INVALID:
-	  if (inv_age < pline->age)
-	    {
-	      inv_age = pline->age;
-	      bestinv = i;
-	    }
-	  break;
-
-	case SH_CL:
-	  if (clean_age < pline->age)
+	  rank = Repl_rank(captr, pline);
+	  if (best[class] == -1 || best_rank[class] < rank)
 	    {
-	      clean_age = pline->age;
-	      bestclean = i;
+	      best[class]      = i;
+	      best_rank[class] = rank;
 	    }
-	  break;
-
-	case PR_CL:
-	  if (private_age < pline->age)
-	    {
-	      private_age = pline->age;
-	      bestprivate = i;
-	    }
-	  break;
-
-	case PR_DY:
-	  if (dirty_age < pline->age)
-	    {
-	      dirty_age = pline->age;
-	      bestdirty = i;
-	    }
-	  break;
-
-	default:
-	  break;
 	}
 
       if (pline->state != INVALID && pline->pref_tag_repl == reqtag)
@@ -326,91 +305,500 @@ int Cache_miss_update(CACHE *captr, REQ *req, cline_t **cline, int prefonly)
 	}
     }
 
-  if (bestinv != -1)
+  for (class = 0; class < 4; class++)
+    if (best[class] != -1)
+      break;
+
+  if (class == 4)   /* all lines in set have outstanding upgrades! */
+    return 0;
+
+  victim = best[class];
+  pline  = &(captr->tags[baseidx + victim]);
+
+  /*
+   * Found the victim, update prefetch statistics and replacement state
+   */
+  if (pline->state != INVALID)
     {
-      victim = bestinv;
-      repl_age = inv_age;
+      switch (pline->pref)
+	{
+	case 4:      /* @@@ fix @@@ */
+	  captr->pstats->l1dp.useless++;
+	  break;
+	case 8:
+	  captr->pstats->l2p.useless++;
+	  break;
+	case 1:
+	  captr->pstats->sl1.useless++;
+	  break;
+	case 2:
+	  captr->pstats->sl2.useless++;
+	  break;
+	default:
+	  break;
+	}
     }
-  else if (bestclean != -1)
+	
+  /*
+   * Save the replaced line's tag so that we can check if this
+   * prefetch replaces a useful line. If the replaced line is
+   * referenced before the prefetch line, the prefetch line
+   * is counted as a "damaging" prefetch.
+   */
+  if (req->prefetch && prefonly)
     {
-      victim = bestclean;
-      repl_age = clean_age;
+      if (pline->state != INVALID)
+	pline->pref_tag_repl = pline->tag;
+      else
+	pline->pref_tag_repl = -1;
+
+      pline->pref = req->prefetch;
+      pline->pref_time = YS__Simtime;
     }
-  else if (bestprivate != -1)
+  else
     {
-      victim = bestprivate;
-      repl_age = private_age;
+      pline->pref_tag_repl = -1;
+      pline->pref = 0;
     }
-  else if (bestdirty != -1)
+
+  Repl_fill(captr, pline, pline->state != INVALID);
+
+  *cline = pline;
+  return 1;
+}
+
+
+
+
+/*
+ * Functional cache model, used for warm-up while fast-forwarding and in
+ * trace-driven mode: bring the line addressed by "vaddr"/"paddr" into the
+ * cache without MSHRs, timing or bus traffic. Lines are installed
+ * shared-clean, so no dirty data or exclusive ownership is fabricated that
+ * the coherence protocol does not know about. Hits and misses are counted
+ * in "captr->fstat", with misses classified as in the detailed model.
+ *
+ * Returns: -1 -- no line could be allocated (all have upgrades pending)
+ *           0 -- hit, only the replacement state was updated
+ *           1 -- line installed; a copy of the replaced line is stored in
+ *                "*victim" (state INVALID if nothing valid was replaced)
+ * The installed or hit line is stored in "*cline".
+ */
+int Cache_warm(CACHE *captr, unsigned vaddr, unsigned paddr,
+	       cline_t **cline, cline_t *victim)
+{
+  cline_t  *pline;
+  int       i, lineidx, baseidx;
+  int       best     = -1;
+  int       best_inv = 0;
+  unsigned  best_rank = 0, rank;
+  MISS_TYPE type;
+
+  victim->state = INVALID;
+  captr->fstat.refs++;
+
+  switch (Cache_search(captr, vaddr, paddr, cline))
     {
-      victim = bestdirty;
-      repl_age = dirty_age;
+    case 0:
+      Repl_touch(captr, *cline);
+      captr->fstat.hits++;
+      return 0;
+
+    case 1:
+      type = CACHE_MISS_COHE;
+      break;
+
+    default:
+      type = CCD_ClassifyMiss(captr->ccd, paddr >> captr->block_shift);
+      break;
     }
-  else   /* all lines in set have outstanding upgrades! */
-    return 0;
 
+  captr->fstat.misses[type]++;
 
   /*
-   * Found the victim, update ages
+   * Present or total miss: reuse the invalid line still carrying the tag,
+   * or any invalid line, otherwise replace the line ranked highest by the
+   * replacement policy.
    */
+  baseidx = (*cline)->index & (~captr->set_mask);
+  Repl_miss(captr, baseidx >> captr->set_shift);
+
   for (lineidx = baseidx, i = 0; i < captr->setsz; i++, lineidx++)
     {
       pline = &(captr->tags[lineidx]);
-      if (i == victim) {
-	if (pline->state != INVALID)
-	  {
-	    switch (pline->pref)
-	      {
-	      case 4:      /* @@@ fix @@@ */
-		captr->pstats->l1dp.useless++;
-		break;
-	      case 8:
-		captr->pstats->l2p.useless++;
-		break;
-	      case 1:
-		captr->pstats->sl1.useless++;
-		break;
-	      case 2:
-		captr->pstats->sl2.useless++;
-		break;
-	      default:
-		break;
-	      }
-	  }
-	
-	/*
-	 * Save the replaced line's tag so that we can check if this
-	 * prefetch replaces a useful line. If the replaced line is
-	 * referenced before the prefetch line, the prefetch line
-	 * is counted as a "damaging" prefetch.
-	 */
-	if (req->prefetch && prefonly)
-	  {
-	    if (pline->state != INVALID)
-	      pline->pref_tag_repl = pline->tag;
-	    else
-	      pline->pref_tag_repl = -1;
-
-	    pline->pref = req->prefetch;
-	    pline->pref_time = YS__Simtime;
-	  }
-	else
-	  {
-	    pline->pref_tag_repl = -1;
-	    pline->pref = 0;
-	  }
-	pline->age = 1;
-      }
-      else if (pline->age < repl_age)
-	pline->age++;
+
+      if (pline->mshr_out)
+	continue;
+
+      if (pline->state == INVALID)
+	{
+	  if (pline == *cline || !best_inv)
+	    {
+	      best     = i;
+	      best_inv = 1;
+	    }
+	}
+      else if (!best_inv)
+	{
+	  rank = Repl_rank(captr, pline);
+	  if (best == -1 || rank > best_rank)
+	    {
+	      best      = i;
+	      best_rank = rank;
+	    }
+	}
     }
 
-  *cline = &(captr->tags[baseidx + victim]);
+  if (best == -1)
+    return -1;
+
+  pline = &(captr->tags[baseidx + best]);
+  if (pline->state != INVALID)
+    *victim = *pline;
+
+  Repl_fill(captr, pline, pline->state != INVALID);
+
+  pline->tag           = PADDR2TAG(paddr);
+  pline->vaddr         = vaddr & ~captr->block_mask;
+  pline->state         = SH_CL;
+  pline->pref          = 0;
+  pline->pref_tag_repl = -1;
+
+  *cline = pline;
   return 1;
 }
 
 
 
+/*
+ * Invalidate all lines of "captr" that are covered by the L2 line at
+ * "vaddr"/"paddr" (the functional counterpart of an L2 replacement
+ * invalidation, see L1DProcessTagCohe).
+ */
+static void Cache_warm_invalidate(CACHE *captr, unsigned vaddr, unsigned paddr)
+{
+  cline_t  *cline;
+  unsigned  eaddr;
+
+  paddr = paddr & block_mask2;
+  vaddr = vaddr & block_mask2;
+  eaddr = paddr + ARCH_linesz2;
+
+  for (; paddr < eaddr; paddr += captr->linesz, vaddr += captr->linesz)
+    if (Cache_search(captr, vaddr, paddr, &cline) == 0)
+      {
+	cline->tag   = -1;
+	cline->state = INVALID;
+      }
+}
+
+
+
+/*
+ * Is a miss outstanding at "captr" for any part of the L2 line "paddr"?
+ */
+static int Cache_line_busy(CACHE *captr, unsigned paddr)
+{
+  unsigned addr;
+
+  if (captr->mshr_count == 0)
+    return 0;
+
+  for (addr = paddr; addr < paddr + ARCH_linesz2; addr += captr->linesz)
+    if (Cache_lookup_mshr(captr, addr >> captr->block_shift))
+      return 1;
+
+  return 0;
+}
+
+
+
+/*
+ * Back-invalidation by an inclusive L3 cache (see l3cache.c): remove the
+ * L2 line at "paddr" and the L1 lines it covers. With "probe" set, only
+ * check whether this is possible now, which is not the case while a miss
+ * or upgrade for the line is outstanding in L1 or L2.
+ * Returns: -1 -- line is busy, nothing was done
+ *           0 -- line not present
+ *           1 -- clean line invalidated (or can be)
+ *           2 -- dirty line invalidated (or can be)
+ */
+int Cache_back_invalidate(CACHE *captr, unsigned paddr, int probe)
+{
+  cline_t *cline;
+  int      rc;
+
+  paddr = paddr & block_mask2;
+
+  if (Cache_line_busy(captr, paddr) ||
+      Cache_line_busy(captr->l1i_partner, paddr) ||
+      Cache_line_busy(captr->l1d_partner, paddr))
+    return -1;
+
+  if (Cache_search(captr, paddr, paddr, &cline) != 0)
+    return 0;
+
+  if (cline->mshr_out)
+    return -1;
+
+  rc = (cline->state == PR_DY) ? 2 : 1;
+  if (probe)
+    return rc;
+
+  Cache_warm_invalidate(captr->l1i_partner, cline->vaddr, paddr);
+  if (!cparam.L1D_perfect)
+    Cache_warm_invalidate(captr->l1d_partner, cline->vaddr, paddr);
+
+  cline->state = INVALID;
+  return rc;
+}
+
+
+
+/*
+ * Functional warm-up of the cache hierarchy of processor "gid" for one
+ * access. The L2 cache is warmed for every access; instruction fetches
+ * also warm the L1 I-cache (including the predecoded instructions), data
+ * reads warm the L1 D-cache. Writes allocate in the L1 D-cache only if it
+ * is a write-back cache.
+ * L2 victims are invalidated in both L1 caches to maintain inclusion.
+ * A shared L3 cache is warmed along with the L2 cache.
+ */
+void Cache_warm_access(int gid, unsigned vaddr, unsigned paddr,
+		       int ifetch, int write)
+{
+  CACHE   *captr;
+  cline_t *cline, victim;
+
+  if (!cparam.L2_perfect)
+    {
+      captr = L2Caches[gid];
+      if (L3Caches)
+	L3Cache_warm(captr->nodeid, captr->procid, paddr);
+      Directory_warm(captr->nodeid, captr->procid, paddr);
+
+      if ((Cache_warm(captr, vaddr, paddr, &cline, &victim) == 1) &&
+	  (victim.state != INVALID))
+	{
+	  unsigned vpaddr = (victim.tag << captr->tag_shift) |
+	    ((victim.index >> captr->set_shift) << captr->block_shift);
+
+	  Cache_warm_invalidate(captr->l1i_partner, victim.vaddr, vpaddr);
+	  Cache_warm_invalidate(captr->l1d_partner, victim.vaddr, vpaddr);
+	}
+    }
+
+  if (ifetch)
+    {
+      if (cparam.L1I_perfect)
+	return;
+
+      captr = L1ICaches[gid];
+      if ((Cache_warm(captr, vaddr, paddr, &cline, &victim) == 1) &&
+	  !trace_mode)
+	PredecodeBlock(paddr & block_mask1i, captr->nodeid,
+		       captr->data + cline->index *
+		       captr->linesz / SIZE_OF_SPARC_INSTRUCTION *
+		       SIZEOF_INSTR,
+		       captr->linesz / SIZE_OF_SPARC_INSTRUCTION);
+    }
+  else if ((!write || cparam.L1D_writeback) && !cparam.L1D_perfect)
+    Cache_warm(L1DCaches[gid], vaddr, paddr, &cline, &victim);
+}
+
+
+
+/*
+ * Trace-driven functional cache simulation: feed every reference of the
+ * trace file "fname" through Cache_warm_access and report the functional
+ * cache statistics of all local processors. Processors, buses and memory
+ * are not simulated. Each line of the trace holds
+ *
+ *      <cpu> <type> <vaddr> [<paddr>]
+ *
+ * where "cpu" is the global processor number, "type" is one of I
+ * (instruction fetch), R (read) or W (write), and the addresses are
+ * hexadecimal; "paddr" defaults to "vaddr". Empty lines and lines
+ * starting with '#' are ignored, as are references of remote nodes.
+ */
+void Cache_trace_run(char *fname)
+{
+  FILE      *fp;
+  char       line[256], type;
+  unsigned   vaddr, paddr;
+  int        gid, n, lineno = 0;
+  long long  refs = 0;
+
+  fp = fopen(fname, "r");
+  if (fp == NULL)
+    YS__errmsg(0, "Cannot open cache trace file %s", fname);
+
+  trace_mode = 1;
+
+  while (fgets(line, sizeof(line), fp))
+    {
+      lineno++;
+      if ((line[0] == '#') || (line[0] == '\n'))
+	continue;
+
+      n = sscanf(line, "%i %c %x %x", &gid, &type, &vaddr, &paddr);
+      if (n < 3)
+	YS__errmsg(0, "%s:%i: malformed trace record", fname, lineno);
+      if (n == 3)
+	paddr = vaddr;
+
+      if ((gid < 0) || (gid >= ARCH_numnodes * ARCH_cpus))
+	YS__errmsg(0, "%s:%i: invalid processor %i", fname, lineno, gid);
+
+      if ((gid / ARCH_cpus < ARCH_firstnode) ||
+	  (gid / ARCH_cpus >= ARCH_firstnode + ARCH_mynodes))
+	continue;
+
+      switch (type)
+	{
+	case 'I': case 'i':
+	  Cache_warm_access(gid, vaddr, paddr, 1, 0);
+	  break;
+	case 'R': case 'r':
+	  Cache_warm_access(gid, vaddr, paddr, 0, 0);
+	  break;
+	case 'W': case 'w':
+	  Cache_warm_access(gid, vaddr, paddr, 0, 1);
+	  break;
+	default:
+	  YS__errmsg(0, "%s:%i: unknown reference type '%c'",
+		     fname, lineno, type);
+	}
+
+      refs++;
+    }
+
+  fclose(fp);
+  trace_mode = 0;
+
+  for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+    {
+      YS__statmsg(n, "Cache trace %s: %lld references\n\n", fname, refs);
+      Cache_print_params(n);
+
+      for (gid = 0; gid < ARCH_cpus; gid++)
+	{
+	  YS__statmsg(n, "Processor %i\n", gid);
+	  Cache_func_stat_report(n, gid);
+	}
+    }
+}
+
+
+
+/*
+ * Save the tag array of a cache to a checkpoint. Only the geometry and the
+ * per-line tag, address and replacement state are written; the cache must
+ * be idle (no MSHRs in use), and data is always taken from memory.
+ * PLRU tree bits are not saved and restart from their reset state.
+ */
+void Cache_ckpt_save(CACHE *captr, CKPT *ckpt)
+{
+  cline_t *cline;
+  int      n;
+
+  Ckpt_section(ckpt, CKPT_TAG('C', 'A', 'C', 'H'));
+  Ckpt_write_int(ckpt, captr->size);
+  Ckpt_write_int(ckpt, captr->linesz);
+  Ckpt_write_int(ckpt, captr->setsz);
+  Ckpt_write_int(ckpt, captr->num_lines);
+  Ckpt_write_int(ckpt, captr->replacement);
+  Ckpt_write_int(ckpt, captr->repl_clock);
+  Ckpt_write_int(ckpt, captr->psel);
+
+  for (n = 0, cline = captr->tags; n < captr->num_lines; n++, cline++)
+    {
+      Ckpt_write_int(ckpt, cline->tag);
+      Ckpt_write_int(ckpt, cline->vaddr);
+      Ckpt_write_int(ckpt, cline->state);
+      Ckpt_write_int(ckpt, cline->age);
+    }
+}
+
+
+
+/*
+ * Restore the tag array of a cache from a checkpoint. If the geometry has
+ * changed the saved lines are skipped and the cache starts out cold. If
+ * only the replacement policy has changed its state is reset.
+ * Valid lines of the L1 I-cache are predecoded again from memory, which
+ * must have been restored before.
+ */
+void Cache_ckpt_restore(CACHE *captr, CKPT *ckpt)
+{
+  cline_t  *cline;
+  unsigned  paddr, clock;
+  int       n, size, linesz, setsz, num_lines, policy, psel;
+
+  Ckpt_expect(ckpt, CKPT_TAG('C', 'A', 'C', 'H'));
+  size      = Ckpt_read_int(ckpt);
+  linesz    = Ckpt_read_int(ckpt);
+  setsz     = Ckpt_read_int(ckpt);
+  num_lines = Ckpt_read_int(ckpt);
+  policy    = Ckpt_read_int(ckpt);
+  clock     = Ckpt_read_int(ckpt);
+  psel      = Ckpt_read_int(ckpt);
+
+  if ((size != captr->size) || (linesz != captr->linesz) ||
+      (setsz != captr->setsz) || (num_lines != captr->num_lines))
+    {
+      YS__warnmsg(captr->nodeid,
+		  "Cache %i: configuration differs from checkpoint %s - not restored",
+		  captr->gid, ckpt->name);
+      Ckpt_skip(ckpt, num_lines * 4 * sizeof(int));
+      return;
+    }
+
+  if (policy == captr->replacement)
+    {
+      captr->repl_clock = clock;
+      captr->psel       = psel;
+    }
+
+  for (n = 0, cline = captr->tags; n < captr->num_lines; n++, cline++)
+    {
+      cline->tag           = Ckpt_read_int(ckpt);
+      cline->vaddr         = Ckpt_read_int(ckpt);
+      cline->state         = (cline_state_t)Ckpt_read_int(ckpt);
+      cline->age           = Ckpt_read_int(ckpt);
+      if (policy != captr->replacement)
+	cline->age         = 0;
+      cline->mshr_out      = 0;
+      cline->pref          = 0;
+      cline->pref_tag_repl = -1;
+
+      if ((captr == L1ICaches[captr->gid]) && (cline->state != INVALID))
+	{
+	  paddr = (cline->tag << captr->tag_shift) |
+	    ((cline->index >> captr->set_shift) << captr->block_shift);
+	  PredecodeBlock(paddr, captr->nodeid,
+			 captr->data + cline->index *
+			 captr->linesz / SIZE_OF_SPARC_INSTRUCTION *
+			 SIZEOF_INSTR,
+			 captr->linesz / SIZE_OF_SPARC_INSTRUCTION);
+	}
+
+      /*
+       * Restored L2 lines must be known to an inclusive L3 cache and
+       * to the directory.
+       */
+      if ((captr == L2Caches[captr->gid]) && (cline->state != INVALID))
+	{
+	  paddr = (cline->tag << captr->tag_shift) |
+	    ((cline->index >> captr->set_shift) << captr->block_shift);
+	  if (L3Caches)
+	    L3Cache_warm(captr->nodeid, captr->procid, paddr);
+	  Directory_warm(captr->nodeid, captr->procid, paddr);
+	}
+    }
+}
+
+
 
 /*
  * Used by modules below cache system, such as bus, memory controller,
@@ -60,6 +60,7 @@
 #include "Caches/lqueue.h"
 #include "Caches/cache_param.h"
 #include "Caches/cache_stat.h"
+#include "sim_main/checkpoint.h"
 
 
 /*************************************************************************/ 
@@ -90,7 +91,7 @@ typedef struct CacheLine
   unsigned        tag;           /* tag of cache line */
   unsigned        vaddr;         /* virtual address of cache line */
   cline_state_t   state;         /* state of cache line */
-  unsigned short  age;           /* age of access -- used to implement LRU */
+  unsigned        age;           /* replacement state (LRU stamp or RRPV) */
   char            mshr_out;      /* upgrade is going on */
   char            pref;          /* used for prefetch stats */
   unsigned        pref_tag_repl; /* used for prefetch stats */
@@ -123,7 +124,7 @@ typedef struct _mshr_
   REQ     *coal_req[MAX_MAX_COALS]; /* Array of coalesced accesses           */
   short    counter;             /* The number of coalesced accesses          */
   short    next_move;
-  struct _mshr_ *next;
+  struct _mshr_ *next;          /* hash chain if valid, free list otherwise  */
 } MSHR;
 
 
@@ -182,6 +183,16 @@ typedef struct _cache_
   int      block_mask;          /* number of bits removed to generate block  */
   int      block_shift;         /* # of shift bits to specify block number   */
   int      tag_shift;           /* # of shift bits to specify tag            */
+
+  /* Replacement policy state (see replace.c) -------------------------------*/
+
+  unsigned       repl_clock;    /* LRU: time stamp of last access            */
+  unsigned       repl_seed;     /* random: generator state                   */
+  unsigned       repl_rand;     /* random: victim offset for current miss    */
+  unsigned char *plru;          /* PLRU: tree bits, setsz entries per set    */
+  int            psel;          /* DRRIP: policy selection counter           */
+  int            leader_stride; /* DRRIP: sets between leader sets           */
+  unsigned       brrip_count;   /* BRRIP: bimodal insertion counter          */
   
   /* MSHR-related data structure */
 
@@ -190,6 +201,10 @@ typedef struct _cache_
   int   reqmshr_count;          /* number of MSHRs used by REQUESTs          */
   int   reqs_at_mshr_count;     /* number of REQUESTs at MSHRs               */
   int   max_mshrs;              /* total number of MSHRs in cache            */
+  MSHR **mshr_hash;             /* valid MSHRs hashed by block number        */
+  unsigned mshr_hash_mask;      /* number of hash buckets - 1                */
+  MSHR *mshr_free;              /* free MSHRs, linked through "next"         */
+  STATREC *mshr_occ;            /* MSHR occupancy histogram                  */
 
   /* Input queues */
 
@@ -232,6 +247,8 @@ typedef struct _cache_
   STATREC   *pref_lateness;    /* extent to which late prefetches are late   */
   STATREC   *pref_earliness;   /* length of time useful prefetches sit in    */
   struct CapConfDetector *ccd; /* Capacity-conflict miss detector            */
+  struct Prefetcher *pf;       /* hardware prefetch engine (L1D and L2)      */
+  func_stat_t fstat;           /* functional cache model statistics          */
 } CACHE;
 
 
@@ -340,20 +357,39 @@ extern void L2CacheInSim   (int gid);
 
 /* Function used by processor to start up a new memory reference */
 void DCache_recv_addr      (int, struct instance *, long long, unsigned,
-		            int, int, int, int);
+		            unsigned, int, int, int, int);
 void DCache_recv_tlbfill   (int, void (*)(REQ*), unsigned char*, unsigned,
 			    void*);
 void DCache_recv_barrier   (int);
 void ICache_recv_addr      (int, unsigned, unsigned, int, int, unsigned);
+void ICache_prefetch       (int, unsigned, unsigned, int);
 
 
 /* Cache initialization and search routines. (cache_init.c, cache.c) */
 void Cache_init                (void);
 void Cache_init_aux            (CACHE *);
+void Cache_init_mshrs          (CACHE *, int, int, char *);
 int  Cache_search              (CACHE *, unsigned, unsigned, cline_t **);
 int  Cache_hit_update          (CACHE *, cline_t *, REQ *);
 void Cache_pmiss_update        (CACHE *, REQ *, int, int); 
 int  Cache_miss_update         (CACHE *, REQ *, cline_t **, int);   
+int  Cache_warm                (CACHE *, unsigned, unsigned, cline_t **,
+				cline_t *);
+void Cache_warm_access         (int, unsigned, unsigned, int, int);
+void Cache_trace_run           (char *);
+int  Cache_back_invalidate     (CACHE *, unsigned, int);
+void Cache_ckpt_save           (CACHE *, CKPT *);
+void Cache_ckpt_restore        (CACHE *, CKPT *);
+
+
+/* Replacement policies. (replace.c) */
+int      Repl_parse            (char *);
+char    *Repl_name             (int);
+void     Repl_init             (CACHE *);
+void     Repl_touch            (CACHE *, cline_t *);
+void     Repl_miss             (CACHE *, int);
+unsigned Repl_rank             (CACHE *, cline_t *);
+void     Repl_fill             (CACHE *, cline_t *, int);
 
 
 /* L1 write-buffer routines. (cache_wb.c) */
@@ -369,6 +405,8 @@ void Cache_arb_for_bus         (REQ *);
 void Cache_in_master_state     (REQ *);
 void Cache_send_on_bus         (REQ *);
 void Cache_get_cohe_request    (REQ *);
+void Cache_get_forward         (REQ *, int);
+void Cache_send_cohe_response  (CACHE *, REQ *, int);
 void Cache_get_noncoh_request  (REQ *);
 void Cache_get_data_response   (REQ *);
 void Cache_get_reply           (REQ *);
@@ -382,6 +420,7 @@ void  Cache_stat_set           (CACHE *captr, REQ *req);
 void  Cache_print_params       (int);
 void  Cache_stat_report        (int, int);
 void  Cache_stat_clear         (int, int);
+void  Cache_func_stat_report   (int, int);
 
 
 /* Some help functions. (cache_help.c, cache_debug.c) */
@@ -389,6 +428,8 @@ REQ  *Cache_make_req           (CACHE *, cline_t *, ReqType);
 int   Cache_send_out_req       (LinkQueue *, REQ *);
 int   Cache_uncoalesce_mshr    (CACHE *, MSHR *);
 int   Cache_free_mshr          (CACHE *captr, MSHR *pmshr);
+MSHR *Cache_alloc_mshr         (CACHE *captr, unsigned blocknum);
+MSHR *Cache_lookup_mshr        (CACHE *captr, unsigned blocknum);
 void  Cache_global_perform     (CACHE *, REQ *, int release_req);
 MSHR *Cache_find_mshr          (CACHE *captr, REQ *req);
 void  Cache_req_dump           (REQ *, int flag, int);
@@ -60,8 +60,10 @@
 #include "Caches/system.h"
 #include "Caches/req.h"
 #include "Caches/cache.h"
+#include "Caches/l3cache.h"
 #include "Caches/ubuf.h"
 #include "Bus/bus.h"
+#include "Memory/directory.h"
 
 
 
@@ -231,7 +233,7 @@ void Cache_arb_for_bus(REQ *req)
       if ((req->type == COHE_REPLY) && (oreq != NULL))
 	{
           lqueue_add_head(&(captr->arbwaiters), oreq, captr->nodeid);
-	  pbus->arbwaiters[req->src_proc].req = req;
+	  Bus_replace_arb_req(req->node, req->src_proc, req);
 	}
       else
 	{
@@ -388,23 +390,64 @@ void Cache_send_on_bus(REQ *req)
 /*=============================================================================
  * Getting a coherence request. Just put it into the coherence queue of 
  * every L2 cache in the node, including the one that started this request.
+ * An inclusive L3 cache limits this to the L2 caches that may hold the line.
+ * With the directory snoop filter, only the L2 caches named by the directory
+ * get the request, as a message over the network.
  */
 
 void Cache_get_cohe_request(REQ *req)
 {
-  CACHE  *captr;
-  int     i;
+  modmask_t snoopers;
+  int       i;
+
+  snoopers = L3Cache_snoop_filter(req) & Directory_snoop_filter(req);
 
+  req->snoopers = 0;
   for (i = 0; i < ARCH_cpus; i++)
     {
-      captr = PID2L2C(req->node, i);
-      lqueue_add(&(captr->cohe_queue), req, captr->nodeid);
-      captr->inq_empty = 0;
+      if (!(snoopers & MODMASK_BIT(i)))
+	continue;
+
+      req->snoopers++;
+      if (Directories)
+	Directory_forward(req, i);
+      else
+	Cache_get_forward(req, i);
     }
 }
 
 
 
+/*=============================================================================
+ * A coherence request arrives at the L2 cache of processor "procid".
+ */
+
+void Cache_get_forward(REQ *req, int procid)
+{
+  CACHE *captr = PID2L2C(req->node, procid);
+
+  lqueue_add(&(captr->cohe_queue), req, captr->nodeid);
+  captr->inq_empty = 0;
+}
+
+
+
+/*=============================================================================
+ * Send the coherence response of an L2 cache. The response to a forwarded
+ * request travels back to the directory over the network; otherwise it
+ * uses the dedicated lines to the memory controller.
+ */
+
+void Cache_send_cohe_response(CACHE *captr, REQ *req, int state)
+{
+  if (Directories && (req->src_proc != captr->procid))
+    Directory_send_response(req, state, captr->procid);
+  else
+    Bus_send_cohe_response(req, state);
+}
+
+
+
 void Cache_get_noncoh_request(REQ *req)
 {
   CACHE  *captr;
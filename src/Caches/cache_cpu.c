@@ -53,6 +53,7 @@
  */
 
 #include <malloc.h>
+#include "Processor/proc_config.h"
 #include "Processor/memunit.h"
 #include "Processor/tlb.h"
 #include "Processor/simio.h"
@@ -75,16 +76,18 @@
 void DCache_recv_addr(int proc_id,
 		      struct instance *inst,
 		      long long inst_tag, 
+		      unsigned pc,
 		      unsigned paddr,
 		      int memacctype,
 		      int memaccsize,
 		      int memattribute,
 		      int preflevel)
 {
+  int     core  = SMT_CORE(proc_id);
   CACHE  *captr;
   REQ    *req   = (REQ *) YS__PoolGetObj(&YS__ReqPool);  
 
-  captr = L1DCaches[proc_id];
+  captr = L1DCaches[core];
 
   /*
    * General information
@@ -92,7 +95,7 @@ void DCache_recv_addr(int proc_id,
   req->type              = REQUEST;
   req->prefetch          = preflevel;
   req->node              = proc_id / ARCH_cpus;
-  req->src_proc          = proc_id % ARCH_cpus;
+  req->src_proc          = core % ARCH_cpus;
   req->prcr_req_type     = (ReqType)memacctype;
   req->req_type          = BAD_REQ_TYPE;
   req->progress          = 0;
@@ -101,6 +104,7 @@ void DCache_recv_addr(int proc_id,
   req->parent            = NULL;
   req->paddr             = paddr;
   req->vaddr             = paddr;
+  req->pc                = pc;
   req->memattributes     = memattribute;
   req->size              = memaccsize;
   req->l1mshr            = 0;
@@ -137,7 +141,7 @@ void DCache_recv_addr(int proc_id,
    */
   lqueue_add(&(captr->request_queue), req, proc_id / ARCH_cpus);
   captr->inq_empty  = 0;
-  L1DQ_FULL[proc_id] = lqueue_full(&(captr->request_queue));
+  L1DQ_FULL[core] = lqueue_full(&(captr->request_queue));
 }
 
 
@@ -154,10 +158,11 @@ void DCache_recv_tlbfill(int proc_id,
 			 unsigned char *buf, 
 			 unsigned paddr, void *tlb)
 {
+  int     core  = SMT_CORE(proc_id);
   CACHE  *captr;
   REQ    *req   = (REQ *) YS__PoolGetObj(&YS__ReqPool);  
 
-  captr = L1DCaches[proc_id];
+  captr = L1DCaches[core];
 
   /*
    * General information
@@ -165,7 +170,7 @@ void DCache_recv_tlbfill(int proc_id,
   req->type              = REQUEST;
   req->prefetch          = 0;
   req->node              = proc_id / ARCH_cpus;
-  req->src_proc          = proc_id % ARCH_cpus;
+  req->src_proc          = core % ARCH_cpus;
   req->prcr_req_type     = READ;
   req->req_type          = BAD_REQ_TYPE;
   req->progress          = 0;
@@ -174,6 +179,7 @@ void DCache_recv_tlbfill(int proc_id,
   req->parent            = NULL;
   req->paddr             = paddr;
   req->vaddr             = paddr;
+  req->pc                = 0;
   req->memattributes     = 0;
   req->size              = sizeof(unsigned int);
   req->l1mshr            = 0;
@@ -205,7 +211,7 @@ void DCache_recv_tlbfill(int proc_id,
    */
   lqueue_add(&(captr->request_queue), req, proc_id / ARCH_cpus);
   captr->inq_empty  = 0;
-  L1DQ_FULL[proc_id] = lqueue_full(&(captr->request_queue));
+  L1DQ_FULL[core] = lqueue_full(&(captr->request_queue));
 }
 
 
@@ -217,17 +223,18 @@ void DCache_recv_tlbfill(int proc_id,
  */
 void DCache_recv_barrier(int proc_id)
 {
+  int     core  = SMT_CORE(proc_id);
   CACHE  *captr;
   REQ    *req   = (REQ *) YS__PoolGetObj(&YS__ReqPool);  
 
   
-  captr = L1DCaches[proc_id];
+  captr = L1DCaches[core];
 
   /* General information */
   req->type              = BARRIER;
   req->prefetch          = 0;
   req->node              = proc_id / ARCH_cpus;
-  req->src_proc          = proc_id % ARCH_cpus;
+  req->src_proc          = core % ARCH_cpus;
   req->dest_proc         = req->src_proc;
   req->prcr_req_type     = WRITE;
   req->paddr             = 0;
@@ -268,7 +275,7 @@ void DCache_recv_barrier(int proc_id)
    */
   lqueue_add(&(captr->request_queue), req, proc_id / ARCH_cpus);
   captr->inq_empty  = 0;
-  L1DQ_FULL[proc_id] = lqueue_full(&(captr->request_queue));
+  L1DQ_FULL[core] = lqueue_full(&(captr->request_queue));
 }
 
 
@@ -287,17 +294,19 @@ void ICache_recv_addr(int      proc_id,
 		      int      memattribute,
 		      unsigned pstate)
 {
+  int     core  = SMT_CORE(proc_id);
   CACHE  *captr;
   REQ    *req   = (REQ *) YS__PoolGetObj(&YS__ReqPool);  
 
 
-  captr = L1ICaches[proc_id];
+  captr = L1ICaches[core];
   
   req->node              = proc_id / ARCH_cpus;
-  req->src_proc          = proc_id % ARCH_cpus;
+  req->src_proc          = core % ARCH_cpus;
   req->dest_proc         = AddrMap_lookup(req->node, paddr);
   req->vaddr             = vaddr;
   req->paddr             = paddr;
+  req->pc                = vaddr;
   req->memattributes     = memattribute;
   req->size              = count * SIZE_OF_SPARC_INSTRUCTION;
   req->issue_time        = YS__Simtime;
@@ -340,7 +349,59 @@ void ICache_recv_addr(int      proc_id,
    */
   lqueue_add(&(captr->request_queue), req, proc_id / ARCH_cpus);
   captr->inq_empty  = 0;
-  L1IQ_FULL[proc_id] = lqueue_full(&(captr->request_queue));
+  L1IQ_FULL[core] = lqueue_full(&(captr->request_queue));
+}
+
+
+
+/*=============================================================================
+ * Prefetch an instruction cache line on behalf of the fetch target queue.
+ * Same as the L1I next-line prefetch, but the address comes from the
+ * processor's branch predictor. Uncached lines are not prefetched.
+ */
+void ICache_prefetch(int      proc_id,
+		     unsigned vaddr,
+		     unsigned paddr,
+		     int      memattribute)
+{
+  int     core  = SMT_CORE(proc_id);
+  CACHE  *captr = L1ICaches[core];
+  REQ    *req;
+
+  if (tlb_uncached(memattribute))
+    return;
+
+  captr->pstats->l1ip.total++;
+
+  if (L1IQ_FULL[core])
+    {
+      captr->pstats->l1ip.dropped++;
+      return;
+    }
+
+  req = (REQ *) YS__PoolGetObj(&YS__ReqPool);  
+
+  req->type          = REQUEST;
+  req->req_type      = READ;
+  req->prefetch      = 4;
+  req->node          = proc_id / ARCH_cpus;
+  req->src_proc      = core % ARCH_cpus;
+  req->dest_proc     = AddrMap_lookup(req->node, paddr);
+  req->prcr_req_type = READ;
+  req->paddr         = paddr & ~(captr->linesz - 1);
+  req->vaddr         = vaddr & ~(captr->linesz - 1);
+  req->pc            = vaddr;
+  req->ifetch        = 1;
+  req->l1mshr        = 0;
+  req->l2mshr        = 0;
+  req->memattributes = memattribute;
+  req->issue_time    = YS__Simtime;
+  req->hit_type      = UNKHIT;
+  req->line_cold     = 0;
+
+  lqueue_add(&(captr->request_queue), req, req->node);
+  captr->inq_empty  = 0;
+  L1IQ_FULL[core] = lqueue_full(&(captr->request_queue));
 }
 
 
@@ -353,11 +414,27 @@ void ICache_recv_addr(int      proc_id,
  */
 void Cache_global_perform(CACHE *captr, REQ *req, int release_req)
 {
+  int gid, n;
+
   Cache_stat_set(captr, req);
 
   req->perform(req);
   req->complete(req, req->hit_type);
 
+  /*
+   * The other SMT contexts sharing this cache never see a store as a
+   * coherence invalidation; check their speculative loads here instead.
+   */
+  if (Speculative_Loads && (SMT_THREADS > 1) &&
+      (req->perform == PerformData) && (!req->prefetch) &&
+      ((req->prcr_req_type == WRITE) || (req->prcr_req_type == RMW)))
+    {
+      gid = req->d.proc_data.proc_id;
+      for (n = SMT_CORE(gid); n < SMT_CORE(gid) + SMT_THREADS; n++)
+	if (n != gid)
+	  SpecLoadBufCohe(n, req->paddr, SLB_Cohe);
+    }
+
   if ((release_req) && (!req->cohe_count))
     YS__PoolReturnObj(&YS__ReqPool, req);
 }
@@ -81,62 +81,107 @@ int Cache_send_out_req(LinkQueue *lq, REQ * req)
 
 
 
+/*=============================================================================
+ * Take an MSHR off the free list and enter it into the hash table under
+ * "blocknum". Returns 0 if all MSHRs are in use. The caller fills in the
+ * rest of the MSHR and maintains the request counters.
+ */
+
+MSHR *Cache_alloc_mshr(CACHE *captr, unsigned blocknum)
+{
+  MSHR **bucket;
+  MSHR  *pmshr = captr->mshr_free;
+
+  if (pmshr == 0)
+    return 0;
+
+  captr->mshr_free = pmshr->next;
+
+  bucket          = &(captr->mshr_hash[blocknum & captr->mshr_hash_mask]);
+  pmshr->next     = *bucket;
+  *bucket         = pmshr;
+  pmshr->valid    = 1;
+  pmshr->blocknum = blocknum;
+  captr->mshr_count++;
+
+  StatrecUpdate(captr->mshr_occ, captr->mshr_count, (long long)YS__Simtime);
+
+  return pmshr;
+}
+
+
+
 /*=============================================================================
  * Update statistics and free the MSHR.
  */
 
 int Cache_free_mshr(CACHE *captr, MSHR *pmshr)
 {
+  MSHR **pp;
+
   if (pmshr->demand > 0.0)         /* there was a late prefetch */
     StatrecUpdate(captr->pref_lateness,
 		  (int)(YS__Simtime - pmshr->demand),
 		  1);
 
+  /*
+   * Unlink it from its hash chain and return it to the free list.
+   */
+  pp = &(captr->mshr_hash[pmshr->blocknum & captr->mshr_hash_mask]);
+  while (*pp != pmshr)
+    pp = &((*pp)->next);
+  *pp = pmshr->next;
+
+  pmshr->next      = captr->mshr_free;
+  captr->mshr_free = pmshr;
+
   pmshr->valid = 0;
   pmshr->releasing = 0;
   captr->mshr_count--;
 
-  if (pmshr->mainreq->type != COHE_REPLY)
+  StatrecUpdate(captr->mshr_occ, captr->mshr_count, (long long)YS__Simtime);
+
+  if ((pmshr->mainreq != NULL) && (pmshr->mainreq->type != COHE_REPLY))
     {
       /* We were using it as a temporary holding thing */
       captr->reqmshr_count--;
       captr->reqs_at_mshr_count -= pmshr->counter + 1;
     }
 
-#if 0
-   StatrecUpdate(captr->mshr_req_count, captr->reqs_at_mshr_count,
-                 (long long)YS__Simtime);
-   StatrecUpdate(captr->mshr_occ, captr->reqmshr_count,
-		 (long long)YS__Simtime);
-#endif
-
    return 0;
 }
 
 
 
 /*=============================================================================
- * Find which MSHR is being used by a current REQUEST.
+ * Find the MSHR (if any) that is working on block "blocknum".
  */
-MSHR *Cache_find_mshr(CACHE *captr, REQ *req)
+MSHR *Cache_lookup_mshr(CACHE *captr, unsigned blocknum)
 {
-  int i;
-  unsigned blocknum;
+  MSHR *pmshr;
 
   if (captr->mshr_count == 0)
     return 0;
 
-  blocknum = req->paddr >> captr->block_shift;
-  for (i = 0; i < captr->max_mshrs; i++)
-    {
-      if (captr->mshrs[i].valid && blocknum == captr->mshrs[i].blocknum)
-	return &(captr->mshrs[i]);
-    }
+  for (pmshr = captr->mshr_hash[blocknum & captr->mshr_hash_mask];
+       pmshr; pmshr = pmshr->next)
+    if (pmshr->blocknum == blocknum)
+      return pmshr;
 
   return 0;
 }
 
 
+
+/*=============================================================================
+ * Find which MSHR is being used by a current REQUEST.
+ */
+MSHR *Cache_find_mshr(CACHE *captr, REQ *req)
+{
+  return Cache_lookup_mshr(captr, req->paddr >> captr->block_shift);
+}
+
+
 /*=============================================================================
  * Allocate and initiate a link queue with default maximum size.
  */
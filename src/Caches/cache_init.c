@@ -65,6 +65,8 @@
 #include "Caches/req.h"
 #include "Caches/pipeline.h"
 #include "Caches/cache.h"
+#include "Caches/prefetch.h"
+#include "Caches/l3cache.h"
 #include "Bus/bus.h"
 #include "IO/io_generic.h"
 
@@ -261,10 +263,24 @@ void Cache_init(void)
 	  L1DCache_init(&(l1dcaches[i]), nodeid, procid);
 	  PID2L1D(nodeid, procid) = &(l1dcaches[i]);
 	  PID2L1D(nodeid, procid)->pstats = &(cachestats[i]);
+	  if (cparam.L1D_prefetch)
+	    PID2L1D(nodeid, procid)->pf =
+	      Prefetch_init(cparam.L1D_pf_engine, cparam.L1D_prefetch,
+			    ARCH_linesz1d, cparam.L1D_pf_degree,
+			    cparam.L1D_pf_distance, cparam.L1D_pf_table,
+			    cparam.L1D_pf_streams, cparam.L1D_pf_throttle,
+			    &(cachestats[i].l1dp));
 
 	  L2Cache_init(&(l2caches[i]), nodeid, procid);
 	  PID2L2C(nodeid, procid) = &(l2caches[i]);
 	  PID2L2C(nodeid, procid)->pstats = &(cachestats[i]);
+	  if (cparam.L2_prefetch)
+	    PID2L2C(nodeid, procid)->pf =
+	      Prefetch_init(cparam.L2_pf_engine, cparam.L2_prefetch,
+			    ARCH_linesz2, cparam.L2_pf_degree,
+			    cparam.L2_pf_distance, cparam.L2_pf_table,
+			    cparam.L2_pf_streams, cparam.L2_pf_throttle,
+			    &(cachestats[i].l2p));
 
 	  L1DCache_wbuffer_init(&(wbuffers[i]), nodeid, procid);
 	  PID2WBUF(nodeid, procid) = &(wbuffers[i]);
@@ -288,6 +304,9 @@ void Cache_init(void)
 
   block_mask2  = ~(l2caches[0].block_mask);
   block_shift2 = l2caches[0].block_shift;
+
+  if (cparam.L3_size > 0)
+    L3Cache_init();
 }
 
 
@@ -300,6 +319,8 @@ void Cache_init(void)
 
 void Cache_read_params(void)
 {
+  char name[32];
+
   cparam.L1I_prefetch   = 0;
   cparam.L1D_prefetch   = 0;
   cparam.L1D_writeback  = 1;
@@ -307,6 +328,26 @@ void Cache_read_params(void)
   cparam.collect_stats = 1;
   cparam.frequency     = 1;
 
+  cparam.L1I_replacement = LRU;
+  cparam.L1D_replacement = LRU;
+  cparam.L2_replacement  = LRU;
+
+  cparam.L1D_pf_engine   = cparam.L2_pf_engine   = PF_NEXTLINE;
+  cparam.L1D_pf_degree   = cparam.L2_pf_degree   = 1;
+  cparam.L1D_pf_distance = cparam.L2_pf_distance = 1;
+  cparam.L1D_pf_table    = cparam.L2_pf_table    = 256;
+  cparam.L1D_pf_streams  = cparam.L2_pf_streams  = 8;
+  cparam.L1D_pf_throttle = cparam.L2_pf_throttle = 0;
+
+  cparam.L3_size         = 0;
+  cparam.L3_set_size     = 8;
+  cparam.L3_banks        = 4;
+  cparam.L3_mshr_num     = 16;
+  cparam.L3_tag_delay    = 4;
+  cparam.L3_data_delay   = 12;
+  cparam.L3_inclusive    = 1;
+  cparam.L3_replacement  = LRU;
+
   get_parameter("Cache_collect_stats", &cparam.collect_stats, PARAM_INT);
   get_parameter("Cache_frequency",     &cparam.frequency,     PARAM_INT);
   get_parameter("Cache_mshr_coal",     &MAX_COALS,            PARAM_INT);
@@ -323,6 +364,10 @@ void Cache_read_params(void)
   get_parameter("L1IC_tag_latency",    &L1I_TAG_DELAY,        PARAM_INT);
   get_parameter("L1IC_tag_repeat",     &L1I_TAG_REPEAT,       PARAM_INT);
   get_parameter("L1IC_mshr",           &L1I_NUM_MSHRS,        PARAM_INT);
+
+  if (get_parameter("L1IC_replacement", name,                 PARAM_STRING) &&
+      (cparam.L1I_replacement = Repl_parse(name)) < 0)
+    YS__errmsg(0, "Unknown L1 I-cache replacement policy %s\n", name);
   
   get_parameter("L1DC_perfect",        &cparam.L1D_perfect,   PARAM_INT);
   get_parameter("L1DC_prefetch",       &cparam.L1D_prefetch,  PARAM_INT);
@@ -335,6 +380,19 @@ void Cache_read_params(void)
   get_parameter("L1DC_tag_repeat",     &L1D_TAG_REPEAT,       PARAM_INT);
   get_parameter("L1DC_wbuf_size",      &ARCH_wbufsz,          PARAM_INT);
   get_parameter("L1DC_mshr",           &L1D_NUM_MSHRS,        PARAM_INT);
+
+  if (get_parameter("L1DC_replacement", name,                 PARAM_STRING) &&
+      (cparam.L1D_replacement = Repl_parse(name)) < 0)
+    YS__errmsg(0, "Unknown L1 D-cache replacement policy %s\n", name);
+
+  if (get_parameter("L1DC_pf_engine",  name,                  PARAM_STRING) &&
+      (cparam.L1D_pf_engine = Prefetch_parse(name)) < 0)
+    YS__errmsg(0, "Unknown L1 D-cache prefetch engine %s\n", name);
+  get_parameter("L1DC_pf_degree",      &cparam.L1D_pf_degree,   PARAM_INT);
+  get_parameter("L1DC_pf_distance",    &cparam.L1D_pf_distance, PARAM_INT);
+  get_parameter("L1DC_pf_table",       &cparam.L1D_pf_table,    PARAM_INT);
+  get_parameter("L1DC_pf_streams",     &cparam.L1D_pf_streams,  PARAM_INT);
+  get_parameter("L1DC_pf_throttle",    &cparam.L1D_pf_throttle, PARAM_INT);
   
   get_parameter("L2C_prefetch",        &cparam.L2_prefetch,   PARAM_INT);
   get_parameter("L2C_perfect",         &cparam.L2_perfect,    PARAM_INT);
@@ -348,6 +406,31 @@ void Cache_read_params(void)
   get_parameter("L2C_data_repeat",     &L2_DATA_REPEAT,       PARAM_INT);
   get_parameter("L2C_mshr",            &L2_NUM_MSHRS,         PARAM_INT);
 
+  if (get_parameter("L2C_replacement",  name,                 PARAM_STRING) &&
+      (cparam.L2_replacement = Repl_parse(name)) < 0)
+    YS__errmsg(0, "Unknown L2 cache replacement policy %s\n", name);
+
+  if (get_parameter("L2C_pf_engine",   name,                  PARAM_STRING) &&
+      (cparam.L2_pf_engine = Prefetch_parse(name)) < 0)
+    YS__errmsg(0, "Unknown L2 cache prefetch engine %s\n", name);
+  get_parameter("L2C_pf_degree",       &cparam.L2_pf_degree,    PARAM_INT);
+  get_parameter("L2C_pf_distance",     &cparam.L2_pf_distance,  PARAM_INT);
+  get_parameter("L2C_pf_table",        &cparam.L2_pf_table,     PARAM_INT);
+  get_parameter("L2C_pf_streams",      &cparam.L2_pf_streams,   PARAM_INT);
+  get_parameter("L2C_pf_throttle",     &cparam.L2_pf_throttle,  PARAM_INT);
+
+  get_parameter("L3C_size",            &cparam.L3_size,       PARAM_INT);
+  get_parameter("L3C_assoc",           &cparam.L3_set_size,   PARAM_INT);
+  get_parameter("L3C_banks",           &cparam.L3_banks,      PARAM_INT);
+  get_parameter("L3C_mshr",            &cparam.L3_mshr_num,   PARAM_INT);
+  get_parameter("L3C_tag_latency",     &cparam.L3_tag_delay,  PARAM_INT);
+  get_parameter("L3C_data_latency",    &cparam.L3_data_delay, PARAM_INT);
+  get_parameter("L3C_inclusive",       &cparam.L3_inclusive,  PARAM_INT);
+
+  if (get_parameter("L3C_replacement",  name,                 PARAM_STRING) &&
+      (cparam.L3_replacement = Repl_parse(name)) < 0)
+    YS__errmsg(0, "Unknown L3 cache replacement policy %s\n", name);
+
   L1I_TAG_PORTS[0] = L1I_NUM_PORTS;
   L1D_TAG_PORTS[0] = L1D_NUM_PORTS;
   L2_TAG_PORTS[2]  = L2_NUM_PORTS;
@@ -423,7 +506,7 @@ static void L1ICache_init(CACHE *captr, int nodeid, int procid)
   captr->size        = ARCH_cacsz1i;
   captr->linesz      = ARCH_linesz1i;
   captr->setsz       = ARCH_setsz1i;
-  captr->replacement = LRU;
+  captr->replacement = cparam.L1I_replacement;
 
   
   /*
@@ -443,19 +526,7 @@ static void L1ICache_init(CACHE *captr, int nodeid, int procid)
   /*
    * Initialize MSHRs (Miss Status Hold Register?).
    */
-  captr->max_mshrs = L1I_NUM_MSHRS;
-  captr->mshrs = RSIM_CALLOC(MSHR, captr->max_mshrs);
-  if (captr->mshrs == NULL)
-    YS__errmsg(nodeid, "Malloc failed in %s:%i", __FILE__, __LINE__);
-
-  
-  for (i = 0; i < captr->max_mshrs; i++)
-    captr->mshrs[i].valid = 0;
-
-  
-  captr->mshr_count = 0;       /* counts WRBs in MSHRs, etc */
-  captr->reqmshr_count = 0;    /* only counting data requests */
-  captr->reqs_at_mshr_count = 0;
+  Cache_init_mshrs(captr, nodeid, L1I_NUM_MSHRS, "L1I MSHR occupancy");
 
   
   /*
@@ -525,7 +596,7 @@ static void L1DCache_init(CACHE *captr, int nodeid, int procid)
   captr->size        = ARCH_cacsz1d;
   captr->linesz      = ARCH_linesz1d;
   captr->setsz       = ARCH_setsz1d;
-  captr->replacement = LRU;
+  captr->replacement = cparam.L1D_replacement;
 
   
   /*
@@ -541,19 +612,7 @@ static void L1DCache_init(CACHE *captr, int nodeid, int procid)
   /*
    * Initialize MSHRs (Miss Status Hold Register?).
    */
-  captr->max_mshrs = L1D_NUM_MSHRS;
-  captr->mshrs = RSIM_CALLOC(MSHR, captr->max_mshrs);
-  if (captr->mshrs == NULL)
-    YS__errmsg(nodeid, "Malloc failed at %s:%i", __FILE__, __LINE__);
-
-  
-  for (i = 0; i < captr->max_mshrs; i++)
-    captr->mshrs[i].valid = 0;
-
-  
-  captr->mshr_count = 0;       /* counts WRBs in MSHRs, etc */
-  captr->reqmshr_count = 0;    /* only counting data requests */
-  captr->reqs_at_mshr_count = 0;
+  Cache_init_mshrs(captr, nodeid, L1D_NUM_MSHRS, "L1D MSHR occupancy");
 
   
   /*
@@ -620,7 +679,7 @@ static void L2Cache_init(CACHE *captr, int nodeid, int procid)
   captr->size        = ARCH_cacsz2;
   captr->linesz      = ARCH_linesz2;
   captr->setsz       = ARCH_setsz2;
-  captr->replacement = LRU;
+  captr->replacement = cparam.L2_replacement;
 
   /*
    * Initialize data array.
@@ -633,17 +692,7 @@ static void L2Cache_init(CACHE *captr, int nodeid, int procid)
   /*
    * Intialize MSHRs
    */
-  captr->max_mshrs = L2_NUM_MSHRS;
-  captr->mshrs = RSIM_CALLOC(MSHR, captr->max_mshrs);
-  if (captr->mshrs == NULL)
-    YS__errmsg(nodeid, "Malloc failed at %s:%i", __FILE__, __LINE__);
-
-  for (i = 0; i < captr->max_mshrs; i++)
-    captr->mshrs[i].valid = 0;
-
-  captr->mshr_count = 0;
-  captr->reqmshr_count = 0;
-  captr->reqs_at_mshr_count = 0;
+  Cache_init_mshrs(captr, nodeid, L2_NUM_MSHRS, "L2 MSHR occupancy");
 
   /*
    * Initialize input queues. As in L1 cache, it has three input queues.
@@ -714,6 +763,47 @@ static void L2Cache_init(CACHE *captr, int nodeid, int procid)
 
 
 
+/*===========================================================================
+ * Allocate the MSHRs of a cache. Valid MSHRs are kept in a small hash
+ * table keyed by block number (at least two buckets per MSHR, so chains
+ * rarely exceed one entry); free MSHRs are kept on a singly-linked list.
+ * Both lookup and allocation are therefore constant-time operations.
+ */
+
+void Cache_init_mshrs(CACHE *captr, int nodeid, int num, char *name)
+{
+  int i, buckets;
+
+  captr->max_mshrs = num;
+  captr->mshrs = RSIM_CALLOC(MSHR, captr->max_mshrs);
+  if (captr->mshrs == NULL)
+    YS__errmsg(nodeid, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  for (buckets = 1; buckets < 2 * num; buckets <<= 1)
+    ;
+  captr->mshr_hash = RSIM_CALLOC(MSHR *, buckets);
+  if (captr->mshr_hash == NULL)
+    YS__errmsg(nodeid, "Malloc failed at %s:%i", __FILE__, __LINE__);
+  captr->mshr_hash_mask = buckets - 1;
+
+  captr->mshr_free = NULL;
+  for (i = captr->max_mshrs - 1; i >= 0; i--)
+    {
+      captr->mshrs[i].valid = 0;
+      captr->mshrs[i].next  = captr->mshr_free;
+      captr->mshr_free      = &(captr->mshrs[i]);
+    }
+
+  captr->mshr_count = 0;       /* counts WRBs in MSHRs, etc */
+  captr->reqmshr_count = 0;    /* only counting data requests */
+  captr->reqs_at_mshr_count = 0;
+
+  captr->mshr_occ = NewStatrec(nodeid, name, INTERVAL, MEANS, HIST,
+			       num, 0, num);
+}
+
+
+
 /*===========================================================================
  * This routine initializes the tag SRAM array of a specified cache.
  * It allocates space for each cache line. Since there is no real data
@@ -803,10 +893,12 @@ void Cache_init_aux(CACHE * captr)
 	captr->tags[i+j].index         = i+j;
 	captr->tags[i+j].state         = INVALID;
 	captr->tags[i+j].tag           = -1;
-	captr->tags[i+j].age           = setsize;
+	captr->tags[i+j].age           = 0;
 	captr->tags[i+j].mshr_out      = 0;
 	captr->tags[i+j].pref          = 0;
 	captr->tags[i+j].pref_tag_repl = -1;
       }
+
+  Repl_init(captr);
 }
 
@@ -81,10 +81,16 @@
 #define MIN_CACHE_LINESZ       	16   /* minimum acceptable line size */
 #define L1CACHE 	       	1    /* First level caches */
 #define L2CACHE 	       	2    /* Second-level cache */
+#define L3CACHE 	       	3    /* Shared last-level cache bank */
 #define FULL_ASS   	       	-1   /* full associativity */
 #define LRU 		       	1    /* LRU replacement policy */
 #define MAX_MAX_COALS		32   /* maximum # reqs coalesced in an MSHR */
 #define NO_REPLACE 	       	2    /* Couldn't find a victim */
+#define PLRU 		       	3    /* tree pseudo-LRU replacement */
+#define SRRIP 		       	4    /* static re-reference interval pred. */
+#define BRRIP 		       	5    /* bimodal re-reference interval pred. */
+#define DRRIP 		       	6    /* dynamic RRIP (set dueling) */
+#define RANDOM_REPL	       	7    /* random replacement */
 #define INFINITE               	-1   /* infinite cache */
 
 
@@ -107,6 +113,10 @@ typedef struct {
    unsigned L1D_perfect;
    unsigned L2_prefetch;
    unsigned L2_perfect;
+   int      L1I_replacement;
+   int      L1D_replacement;
+   int      L2_replacement;
+   int      L3_replacement;
 
    /* 
     * L1 I-cache 
@@ -158,6 +168,33 @@ typedef struct {
    unsigned L2_req_queue;
    unsigned L2_cohe_queue;
 
+   /*
+    * Shared L3 cache (see l3cache.h), L3_size == 0: no L3
+    */
+   int L3_size;
+   int L3_set_size;
+   int L3_banks;
+   int L3_mshr_num;
+   int L3_tag_delay;
+   int L3_data_delay;
+   int L3_inclusive;
+
+   /*
+    * Hardware prefetch engines (see prefetch.h)
+    */
+   int L1D_pf_engine;
+   int L1D_pf_degree;
+   int L1D_pf_distance;
+   int L1D_pf_table;
+   int L1D_pf_streams;
+   int L1D_pf_throttle;
+   int L2_pf_engine;
+   int L2_pf_degree;
+   int L2_pf_distance;
+   int L2_pf_table;
+   int L2_pf_streams;
+   int L2_pf_throttle;
+
 #if 0
    unsigned L1_line_mask;
    unsigned L1_line_shift;
@@ -60,6 +60,7 @@
 #include "Caches/system.h"
 #include "Caches/req.h"
 #include "Caches/cache.h"
+#include "Caches/prefetch.h"
 #include "Caches/pipeline.h"
 
 
@@ -201,6 +202,7 @@ void Cache_stat_report(int nid, int pid)
 
   YS__statmsg(nid, "Cache Statistics\n\n");
 
+  Cache_func_stat_report(nid, pid);
 
   if (pstat->read.count <= 0)
     return;
@@ -300,12 +302,14 @@ void Cache_stat_report(int nid, int pid)
     {
       YS__statmsg(nid, "L1 Data Prefetch Statistics:\n");
       Cache_print_prefetch_stat(nid, &(pstat->l1dp));
+      Prefetch_stat_report(nid, "L1D", PID2L1D(nid, pid)->pf);
     }
   
   if (pstat->l2p.total > 0)
     {
       YS__statmsg(nid, "L2 Prefetch Statistics:\n");
       Cache_print_prefetch_stat(nid, &(pstat->l2p));
+      Prefetch_stat_report(nid, "L2", PID2L2C(nid, pid)->pf);
     }
 
   /* Stalls because of contention on MSHRs --------------------------------*/
@@ -318,6 +322,7 @@ void Cache_stat_report(int nid, int pid)
       CondPrintOne(nid, "  too many coal:   \t%lld",pstat->l1istall.coal);
       CondPrintOne(nid, "  releasing:       \t%lld",pstat->l1istall.release);
       CondPrintOne(nid, "  flush/purge:     \t%lld", pstat->l1istall.flush);
+      StatrecReport(nid, PID2L1I(nid, pid)->mshr_occ);
 
       YS__statmsg(nid, "L1 Data MSHR Stall:\n");
       CondPrintOne(nid, "  write after read:\t%lld",pstat->l1dstall.war);
@@ -326,6 +331,7 @@ void Cache_stat_report(int nid, int pid)
       CondPrintOne(nid, "  too many coal:   \t%lld",pstat->l1dstall.coal);
       CondPrintOne(nid, "  releasing:       \t%lld",pstat->l1dstall.release);
       CondPrintOne(nid, "  flush/purge:     \t%lld",pstat->l1dstall.flush);
+      StatrecReport(nid, PID2L1D(nid, pid)->mshr_occ);
 
       YS__statmsg(nid, "\nL2 MSHR Stall:\n");      
       CondPrintOne(nid, "  write after read:\t%lld",pstat->l2stall.war);
@@ -334,6 +340,7 @@ void Cache_stat_report(int nid, int pid)
       CondPrintOne(nid, "  too many coal:   \t%lld",pstat->l2stall.coal);
       CondPrintOne(nid, "  releasing:       \t%lld",pstat->l2stall.release);
       CondPrintOne(nid, "  flush/purge:     \t%lld",pstat->l2stall.flush);
+      StatrecReport(nid, PID2L2C(nid, pid)->mshr_occ);
     }
   
   /*-----------------------------------------------------------------------*/
@@ -456,6 +463,59 @@ void Cache_print_one_stat(int nid, char *name,
 
 
 
+/*===========================================================================
+ * Print the statistics of the functional cache model (fast-forward warm-up
+ * or trace-driven mode), if it has seen any references.
+ */
+
+static void Cache_print_func_stat(int nid, char *name, func_stat_t *fs)
+{
+  static char *FuncMissNames[NUM_CACHE_MISS_TYPES] =
+  {
+    "generic:  ",
+    "cold:     ",
+    "conflict: ",
+    "capacity: ",
+    "coherency:"
+  };
+
+  long long misses = fs->refs - fs->hits;
+  int       i;
+
+  if (fs->refs <= 0)
+    return;
+
+  YS__statmsg(nid, "  %s References:  %12lld\n", name, fs->refs);
+  YS__statmsg(nid, "    Hits:            %12lld  (%6.2f%%)\n",
+	      fs->hits, 100.0 * fs->hits / fs->refs);
+  YS__statmsg(nid, "    Misses:          %12lld  (%6.2f%%)\n",
+	      misses, 100.0 * misses / fs->refs);
+
+  for (i = 0; i < NUM_CACHE_MISS_TYPES; i++)
+    if (fs->misses[i] > 0)
+      YS__statmsg(nid, "      %s     %12lld  (%6.2f%%)\n",
+		  FuncMissNames[i], fs->misses[i],
+		  100.0 * fs->misses[i] / misses);
+}
+
+
+
+void Cache_func_stat_report(int nid, int pid)
+{
+  if ((PID2L1I(nid, pid)->fstat.refs == 0) &&
+      (PID2L1D(nid, pid)->fstat.refs == 0) &&
+      (PID2L2C(nid, pid)->fstat.refs == 0))
+    return;
+
+  YS__statmsg(nid, "Functional Cache Model\n");
+  Cache_print_func_stat(nid, "L1I", &(PID2L1I(nid, pid)->fstat));
+  Cache_print_func_stat(nid, "L1D", &(PID2L1D(nid, pid)->fstat));
+  Cache_print_func_stat(nid, "L2 ", &(PID2L2C(nid, pid)->fstat));
+  YS__statmsg(nid, "\n");
+}
+
+
+
 /*===========================================================================
  * Print prefetch statistics.
  */
@@ -496,6 +556,15 @@ void Cache_stat_clear(int nid, int pid)
 
   memset((char*)PID2L2C(nid, pid)->pstats, 0, sizeof(CacheStat));
 
+  if (PID2L1D(nid, pid)->pf)
+    Prefetch_stat_clear(PID2L1D(nid, pid)->pf);
+  if (PID2L2C(nid, pid)->pf)
+    Prefetch_stat_clear(PID2L2C(nid, pid)->pf);
+
+  StatrecReset(PID2L1I(nid, pid)->mshr_occ);
+  StatrecReset(PID2L1D(nid, pid)->mshr_occ);
+  StatrecReset(PID2L2C(nid, pid)->mshr_occ);
+
   PID2WBUF(nid, pid)->stall_wb_full = 0;
   PID2WBUF(nid, pid)->stall_match   = 0;
 }
@@ -530,6 +599,8 @@ void Cache_print_params(int nid)
       YS__statmsg(nid,
 		  "  delay:          %4d cycles\tfrequency:     %4d\n",
 		  cparam.L1I_tag_delay, cparam.frequency);
+      YS__statmsg(nid,
+		  "  replacement:     %s\n", Repl_name(cparam.L1I_replacement));
       YS__statmsg(nid,
 		  "  prefetch:        %s\n\n",
 		  cparam.L1I_prefetch ? " on" : "off");
@@ -557,9 +628,12 @@ void Cache_print_params(int nid)
       YS__statmsg(nid,
 		  "  delay:          %4d cycles\tfrequency:     %4d\n",
 		  cparam.L1D_tag_delay, cparam.frequency);
+      YS__statmsg(nid,
+		  "  replacement:     %s\n", Repl_name(cparam.L1D_replacement));
       YS__statmsg(nid,
 		  "  prefetch:        %s\n\n",
-		  cparam.L1D_prefetch ? " on" : "off");
+		  cparam.L1D_prefetch ?
+		  Prefetch_name(cparam.L1D_pf_engine) : "off");
     }
       
   
@@ -590,9 +664,12 @@ void Cache_print_params(int nid)
       YS__statmsg(nid,
 		  "  frequency:      %4d\n",
 		  cparam.frequency);
+      YS__statmsg(nid,
+		  "  replacement:     %s\n", Repl_name(cparam.L2_replacement));
       YS__statmsg(nid,
 		  "  prefetch:        %s\n\n",
-		  cparam.L2_prefetch ? " on" : "off");
+		  cparam.L2_prefetch ?
+		  Prefetch_name(cparam.L2_pf_engine) : "off");
     }
 }
 
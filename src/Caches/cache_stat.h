@@ -125,6 +125,20 @@ typedef struct
 
 
 
+/*
+ * References seen by the functional cache model (fast-forward warm-up
+ * and trace-driven mode) at one cache. These are not cleared with the
+ * detailed statistics.
+ */
+typedef struct
+{
+  long long refs;
+  long long hits;
+  long long misses[NUM_CACHE_MISS_TYPES];
+} func_stat_t;
+
+
+
 /*
  * Classification of MSHR stalls
  */
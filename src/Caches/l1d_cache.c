@@ -63,6 +63,7 @@
 #include "Caches/req.h"
 #include "Caches/pipeline.h"
 #include "Caches/cache.h"
+#include "Caches/prefetch.h"
 #include "Caches/ubuf.h"
 #include "Caches/syscontrol.h"
 
@@ -88,7 +89,8 @@ static int           L1DProcessTagReply       (CACHE*, REQ*);
 static int           L1DProcessTagCohe        (CACHE*, REQ*);
 static void          L1DProcessFlushPurge     (CACHE*, REQ*);
 static MSHR_Response L1DCache_check_mshr      (CACHE*, REQ*);
-static void          L1DCache_start_prefetch  (CACHE*, REQ*);
+static void          L1DCache_start_prefetch  (CACHE*, REQ*, int);
+static void          L1DCache_issue_prefetch  (CACHE*, REQ*, int);
 static int           L1DCache_uncoalesce_mshr (CACHE*, MSHR*);
 extern int           L2ProcessL1Reply         (CACHE*, REQ*);
 
@@ -136,7 +138,8 @@ void L1DCacheInSim(int gid)
     {
       if (IsSysControl_local(req))
 	{
-	  if (SysControl_local_request(gid, req))
+	  /* the local page belongs to the issuing context, not the core */
+	  if (SysControl_local_request(req->d.proc_data.proc_id, req))
 	    {
 	      req->progress = 0;
 	      L1DQ_FULL[gid] = lqueue_full(&(captr->request_queue));
@@ -306,8 +309,7 @@ static void L1DProcessFlushPurge(CACHE * captr, REQ * req)
   int paddr = req->paddr & block_mask2;
   int eaddr = paddr + ARCH_linesz2;
   int vaddr = req->vaddr & block_mask2;
-  int pbnum;
-  int i;
+  MSHR *pmshr;
   cline_t *cline;
   
 
@@ -321,18 +323,10 @@ static void L1DProcessFlushPurge(CACHE * captr, REQ * req)
 	   * flush/purge after all coalesced requests have been served.
 	   * It also stops the MSHR from coalesce more requests.
 	   */
-	  pbnum = paddr >> captr->block_shift;
-	  for (i = 0; i < captr->max_mshrs; i++)
-	    {
-	      if (captr->mshrs[i].valid && pbnum == captr->mshrs[i].blocknum)
-		{
-		  captr->mshrs[i].pend_opers = req->prcr_req_type;
-		  break;
-		}
-	    }
-
-	  if (i != captr->max_mshrs)
+	  pmshr = Cache_lookup_mshr(captr, paddr >> captr->block_shift);
+	  if (pmshr)
 	    {
+	      pmshr->pend_opers = req->prcr_req_type;
 	      req->hit_type = L1DHIT; 
 	      continue; 
 	    }
@@ -419,6 +413,10 @@ static int L1DProcessTagRequest(CACHE * captr, REQ * req)
 	       return 1;
  
 	     case MSHR_COAL: /* Coalesced into an MSHR. success. */
+	       /* table-based prefetchers train on coalesced misses too */
+	       if (cparam.L1D_prefetch &&
+		   Prefetch_trigger(captr->pf, req, 0, 0))
+		 L1DCache_start_prefetch(captr, req, 1);
 	       return 1;
  
 	     case MSHR_NEW: /* need to send down some sort of miss or upgrd */
@@ -430,7 +428,7 @@ static int L1DProcessTagRequest(CACHE * captr, REQ * req)
  
 	       if (cparam.L1D_prefetch && !req->prefetch &&
 		   req->hit_type != L1DHIT)
-		 L1DCache_start_prefetch(captr, req);
+		 L1DCache_start_prefetch(captr, req, 1);
 	       break;
  
 	     case MSHR_USELESS_FETCH:
@@ -520,25 +518,12 @@ static MSHR_Response L1DCache_check_mshr(CACHE *captr, REQ *req)
 {
   MSHR    *pmshr;
   cline_t *cline;
-  int      misscache, i;
+  int      misscache, pfhit;
 
   /* 
    * First determines whether the incoming transaction matches any MSHR 
    */
-  pmshr = 0; 
-  if (captr->mshr_count > 0)
-    {
-      unsigned blocknum = ADDR2BNUM1D(req->paddr);
-      for (i = 0; i < captr->max_mshrs; i++)
-	{
-	  if ((captr->mshrs[i].valid == 1) &&
-	      (blocknum == captr->mshrs[i].blocknum))
-	    {
-	      pmshr = &(captr->mshrs[i]);
-	      break;
-	    }
-	}
-    }
+  pmshr = Cache_lookup_mshr(captr, ADDR2BNUM1D(req->paddr));
 
 
   /* 
@@ -557,11 +542,10 @@ static MSHR_Response L1DCache_check_mshr(CACHE *captr, REQ *req)
     {  /* the line is not present in any MSHR */
       if (misscache == 0)    /* hit */
 	{
-	  if (Cache_hit_update(captr, cline, req))
-	    { /* update LRU ages */
-	      if (cparam.L1D_prefetch & 2)
-		L1DCache_start_prefetch(captr, req);
-	    }
+	  pfhit = Cache_hit_update(captr, cline, req); /* update LRU ages */
+	  if (cparam.L1D_prefetch &&
+	      Prefetch_trigger(captr->pf, req, 0, pfhit))
+	    L1DCache_start_prefetch(captr, req, 0);
          
 	  if (req->prcr_req_type == READ)
 	    {
@@ -631,22 +615,13 @@ static MSHR_Response L1DCache_check_mshr(CACHE *captr, REQ *req)
 
       
       /* 
-       * Find the first free MSHR.
+       * Take a free MSHR and enter it under this block number.
        */
-      for (i = 0; i < captr->max_mshrs; i++)
-	{
-	  if (captr->mshrs[i].valid != 1)
-	    {
-	      pmshr = &(captr->mshrs[i]);
-	      break;
-	    }
-	}
+      pmshr = Cache_alloc_mshr(captr, req->paddr >> captr->block_shift);
 
       req->l1mshr         = pmshr;
-      pmshr->valid        = 1;
       pmshr->mainreq      = req;
       pmshr->setnum       = cline->index >> captr->set_shift;
-      pmshr->blocknum     = req->paddr >> captr->block_shift;
       pmshr->counter      = 0;
       pmshr->pending_cohe = 0;
       pmshr->stall_WAR    = 0;
@@ -657,7 +632,6 @@ static MSHR_Response L1DCache_check_mshr(CACHE *captr, REQ *req)
       pmshr->misscache    = misscache;
       pmshr->pend_opers   = 0;
 
-      captr->mshr_count++;
       captr->reqmshr_count++;
       captr->reqs_at_mshr_count++;
 
@@ -1024,10 +998,12 @@ static int L1DProcessTagCohe(CACHE * captr, REQ * req)
 		    captr->pstats->l1dp.useless++;
 
 		  /* 
-		   * Invalidated; check outstanding speculative loads. 
+		   * Invalidated; check outstanding speculative loads of
+		   * every SMT context sharing this cache.
 		   */
 		  if (Speculative_Loads)      
-		    SpecLoadBufCohe(captr->procid, paddr, SLB_Cohe);
+		    for (i = 0; i < SMT_THREADS; i++)
+		      SpecLoadBufCohe(captr->gid + i, paddr, SLB_Cohe);
 		}
 	      else
 		cline->state = SH_CL;
@@ -1052,15 +1028,32 @@ static int L1DProcessTagCohe(CACHE * captr, REQ * req)
 
 
 /*=============================================================================
- * Start an L1-initiated prefetch. If L1Q is full, drop the prefetch.
+ * Start L1-initiated prefetches. The prefetch engine trains on the access
+ * and supplies the offsets of the lines to fetch.
+ */
+
+static void L1DCache_start_prefetch(CACHE *captr, REQ *req, int miss)
+{
+  int offsets[PF_MAX_DEGREE];
+  int n, i;
+
+  n = Prefetch_candidates(captr->pf, req, miss, offsets);
+  for (i = 0; i < n; i++)
+    L1DCache_issue_prefetch(captr, req, offsets[i]);
+}
+
+
+
+/*=============================================================================
+ * Issue one L1-initiated prefetch. If L1Q is full, drop the prefetch.
  * Note that prefetch can not cross page boudary and no prefetch for
  * non-cacheable address.
  */
 
-static void L1DCache_start_prefetch(CACHE *captr, REQ *req)
+static void L1DCache_issue_prefetch(CACHE *captr, REQ *req, int offset)
 {
   REQ *newreq;
-  unsigned newpaddr = req->paddr + captr->linesz;
+  unsigned newpaddr = req->paddr + offset;
 
   if (!SAMEPAGE(req->paddr, newpaddr) ||
       tlb_uncached(req->memattributes))
@@ -1086,7 +1079,8 @@ static void L1DCache_start_prefetch(CACHE *captr, REQ *req)
   newreq->src_proc      = captr->procid;
   newreq->prcr_req_type = req->prcr_req_type;
   newreq->paddr         = newpaddr;
-  newreq->vaddr         = req->vaddr + captr->linesz;
+  newreq->vaddr         = req->vaddr + offset;
+  newreq->pc            = req->pc;
   newreq->ifetch        = 0;
   newreq->l1mshr        = 0;
   newreq->l2mshr        = 0;
@@ -273,8 +273,7 @@ static void L1IProcessFlushPurge(CACHE * captr, REQ * req)
   int paddr = req->paddr & block_mask2;
   int eaddr = paddr + ARCH_linesz2;
   int vaddr = req->vaddr & block_mask2;
-  int pbnum;
-  int i;
+  MSHR *pmshr;
   cline_t *cline;
 
   for (; paddr < eaddr; paddr += ARCH_linesz1i, vaddr += ARCH_linesz1i)
@@ -287,18 +286,10 @@ static void L1IProcessFlushPurge(CACHE * captr, REQ * req)
 	   * flush/purge after all coalesced requests have been served.
 	   * It also stops the MSHR from coalesce more requests.
 	   */
-	  pbnum = paddr >> captr->block_shift;
-	  for (i = 0; i < captr->max_mshrs; i++)
-	    {
-	      if (captr->mshrs[i].valid && pbnum == captr->mshrs[i].blocknum)
-		{
-		  captr->mshrs[i].pend_opers = req->prcr_req_type;
-		  break;
-		}
-	    }
-	  
-	  if (i != captr->max_mshrs)
+	  pmshr = Cache_lookup_mshr(captr, paddr >> captr->block_shift);
+	  if (pmshr)
 	    {
+	      pmshr->pend_opers = req->prcr_req_type;
 	      req->hit_type = L1IHIT; 
 	      continue; 
 	    }
@@ -494,25 +485,12 @@ static MSHR_Response L1ICache_check_mshr(CACHE *captr, REQ *req)
 {
   MSHR    *pmshr;
   cline_t *cline;
-  int      misscache, i;
+  int      misscache;
 
   /* 
    * First determines whether the incoming transaction matches any MSHR 
    */
-  pmshr = 0; 
-  if (captr->mshr_count > 0)
-    {
-      unsigned blocknum = ADDR2BNUM1I(req->paddr);
-      for (i = 0; i < captr->max_mshrs; i++)
-	{
-	  if ((captr->mshrs[i].valid == 1) &&
-	      (blocknum == captr->mshrs[i].blocknum))
-	    {
-	      pmshr = &(captr->mshrs[i]);
-	      break;
-	    }
-	}
-    }
+  pmshr = Cache_lookup_mshr(captr, ADDR2BNUM1I(req->paddr));
 
 
   /* 
@@ -572,22 +550,13 @@ static MSHR_Response L1ICache_check_mshr(CACHE *captr, REQ *req)
 
       
       /* 
-       * Find the first free MSHR.
+       * Take a free MSHR and enter it under this block number.
        */
-      for (i = 0; i < captr->max_mshrs; i++)
-	{
-	  if (captr->mshrs[i].valid != 1)
-	    {
-	      pmshr = &(captr->mshrs[i]);
-	      break;
-	    }
-	}
+      pmshr = Cache_alloc_mshr(captr, req->paddr >> captr->block_shift);
 
       req->l1mshr         = pmshr;
-      pmshr->valid        = 1;
       pmshr->mainreq      = req;
       pmshr->setnum       = cline->index >> captr->set_shift;
-      pmshr->blocknum     = req->paddr >> captr->block_shift;
       pmshr->counter      = 0;
       pmshr->pending_cohe = 0;
       pmshr->stall_WAR    = 0;
@@ -598,7 +567,6 @@ static MSHR_Response L1ICache_check_mshr(CACHE *captr, REQ *req)
       pmshr->misscache    = misscache;
       pmshr->pend_opers   = 0;
 
-      captr->mshr_count++;
       captr->reqmshr_count++;
       captr->reqs_at_mshr_count++;
 
@@ -966,6 +934,7 @@ static void L1ICache_start_prefetch(CACHE *captr, REQ *req)
   newreq->prcr_req_type = req->prcr_req_type;
   newreq->paddr         = newpaddr;
   newreq->vaddr         = req->vaddr + captr->linesz;
+  newreq->pc            = req->pc;
   newreq->ifetch        = 1;
   newreq->l1mshr        = 0;
   newreq->l2mshr        = 0;
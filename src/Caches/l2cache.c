@@ -63,6 +63,7 @@
 #include "Caches/req.h"
 #include "Caches/pipeline.h"
 #include "Caches/cache.h"
+#include "Caches/prefetch.h"
 #include "Caches/ubuf.h"
 #include "Caches/syscontrol.h"
 #include "IO/addr_map.h"
@@ -98,7 +99,8 @@ static REQ *Cache_make_wb_req           (CACHE*, REQ*, ReqType);
 static REQ *Cache_make_cohe_to_l1       (CACHE*, REQ*, int state);
 static int  Cache_add_repl_to_l1        (CACHE*, REQ*);
 static MSHR_Response L2Cache_check_mshr (CACHE*, REQ*);
-static void L2Cache_start_prefetch      (CACHE*, REQ*);
+static void L2Cache_start_prefetch      (CACHE*, REQ*, int);
+static void L2Cache_issue_prefetch      (CACHE*, REQ*, int);
 static int  L2Cache_uncoalesce_mshr     (CACHE*, MSHR*);
 
 
@@ -540,6 +542,10 @@ static int L2ProcessTagRequest(CACHE * captr, REQ * req)
 	  if (req->prefetch == 2)
 	    captr->pstats->sl2.unnecessary++;
 
+	  /* table-based prefetchers train on coalesced misses too */
+	  if (cparam.L2_prefetch && Prefetch_trigger(captr->pf, req, 0, 0))
+	    L2Cache_start_prefetch(captr, req, 1);
+
 	  return 1;   /* success if coalesced */
 
 	case MSHR_NEW:
@@ -549,7 +555,7 @@ static int L2ProcessTagRequest(CACHE * captr, REQ * req)
 	    captr->pstats->l2p.issued++;
 
 	  if (cparam.L2_prefetch && req->prefetch == 0)
-            L2Cache_start_prefetch(captr, req);
+            L2Cache_start_prefetch(captr, req, 1);
 
 	  req->progress = 2;  /* this indicates that cache need to send
 				something out. */
@@ -618,7 +624,7 @@ static int L2ProcessTagRequest(CACHE * captr, REQ * req)
 
 static int L2ProcessFlushPurge(CACHE *captr, REQ *req)
 {
-  int      i;
+  MSHR    *pmshr;
   cline_t *cline;
   REQ     *ireq = NULL;
 
@@ -633,20 +639,13 @@ static int L2ProcessFlushPurge(CACHE *captr, REQ *req)
       req->wrb_req = 0;
       req->invl_req = 0;
 
-      if (captr->mshr_count > 0)
+      pmshr = Cache_lookup_mshr(captr, ADDR2BNUM2(req->paddr));
+      if (pmshr)
 	{
-	  unsigned blocknum = ADDR2BNUM2(req->paddr);
-	  for (i = 0; i < captr->max_mshrs; i++)
-	    {
-	      if (captr->mshrs[i].valid &&
-		  blocknum == captr->mshrs[i].blocknum)
-		{
-		  captr->mshrs[i].pend_opers = req->prcr_req_type;
-		  req->hit_type = MEMHIT;
-		  Cache_global_perform(captr, req, 1);
-		  return 1;
-		}
-	    }
+	  pmshr->pend_opers = req->prcr_req_type;
+	  req->hit_type = MEMHIT;
+	  Cache_global_perform(captr, req, 1);
+	  return 1;
 	}
 
       if (Cache_search(captr, req->vaddr, req->paddr, &cline) == 0)
@@ -779,24 +778,12 @@ static MSHR_Response L2Cache_check_mshr(CACHE * captr, REQ * req)
   MSHR_Response  response;
   MSHR          *pmshr;
   cline_t       *cline;
-  int            misscache, i;
+  int            misscache, pfhit;
 
   /*
    * First determines whether the incoming transaction matches any MSHR.
    */
-  pmshr = 0;
-  if (captr->mshr_count > 0)
-    {
-      unsigned blocknum = ADDR2BNUM2(req->paddr);
-      for (i = 0; i < captr->max_mshrs; i++)
-	{
-	  if (captr->mshrs[i].valid && blocknum == captr->mshrs[i].blocknum)
-	    {
-	      pmshr = &(captr->mshrs[i]);
-	      break;
-	    }
-	}
-    }
+  pmshr = Cache_lookup_mshr(captr, ADDR2BNUM2(req->paddr));
 
   /*
    * Determine if the desired line is available in the cache.
@@ -814,11 +801,10 @@ static MSHR_Response L2Cache_check_mshr(CACHE * captr, REQ * req)
     {  /* the line is not present in any MSHR */
       if (misscache == 0)
 	{ /* the line is in cache */
-	  if (Cache_hit_update(captr, cline, req))
-	    { /* update LRU ages */
-	      if (cparam.L2_prefetch & 2)
-		L2Cache_start_prefetch(captr, req);
-	    }
+	  pfhit = Cache_hit_update(captr, cline, req); /* update LRU ages */
+	  if (cparam.L2_prefetch &&
+	      Prefetch_trigger(captr->pf, req, 0, pfhit))
+	    L2Cache_start_prefetch(captr, req, 0);
 
 	  if (req->prcr_req_type == READ)
             return NOMSHR;
@@ -851,22 +837,13 @@ static MSHR_Response L2Cache_check_mshr(CACHE * captr, REQ * req)
 	}
 
       /*
-       * Find the first free MSHR
+       * Take a free MSHR and enter it under this block number.
        */
-      for (i = 0; i < captr->max_mshrs; i++)
-	{
-	  if (captr->mshrs[i].valid != 1)
-	    {
-	      pmshr = &(captr->mshrs[i]);
-	      break;
-	    }
-	}
+      pmshr = Cache_alloc_mshr(captr, req->paddr >> captr->block_shift);
 
       req->l2mshr         = pmshr;
-      pmshr->valid        = 1;
       pmshr->mainreq      = req;
       pmshr->setnum       = cline->index >> captr->idx_shift;
-      pmshr->blocknum     = req->paddr >> captr->block_shift;
       pmshr->counter      = 0;
       pmshr->pending_cohe = 0;
       pmshr->stall_WAR    = 0;
@@ -878,7 +855,6 @@ static MSHR_Response L2Cache_check_mshr(CACHE * captr, REQ * req)
       pmshr->has_writes   = (req->prcr_req_type == READ) ? 0 : 1;
       pmshr->releasing    = 0;
 
-      captr->mshr_count++;
       captr->reqmshr_count++;
       captr->reqs_at_mshr_count++;
       
@@ -1404,7 +1380,7 @@ int L2ProcessTagCoheReply(CACHE *captr, REQ *req)
 	captr->num_in_pipes++;
     }
 
-  Bus_send_cohe_response(req->parent, finalstate);
+  Cache_send_cohe_response(captr, req->parent, finalstate);
 
   YS__PoolReturnObj(&YS__ReqPool, req);
   return 1;
@@ -1420,7 +1396,7 @@ int L2ProcessTagCoheReply(CACHE *captr, REQ *req)
 
 static int L2ProcessTagCohe(CACHE * captr, REQ *req)
 {
-  int           i, misscache;
+  int           misscache;
   cline_state_t oldstate;
   MSHR          *pmshr;
   cline_t       *cline;
@@ -1428,7 +1404,7 @@ static int L2ProcessTagCohe(CACHE * captr, REQ *req)
 
   if (cparam.L2_perfect)
     {
-      Bus_send_cohe_response(req, REPLY_EXCL);
+      Cache_send_cohe_response(captr, req, REPLY_EXCL);
       return 1;
     }
 
@@ -1456,7 +1432,7 @@ static int L2ProcessTagCohe(CACHE * captr, REQ *req)
 	      req->stalled_mshrs[captr->procid] = req->l2mshr;
 	    }
 
-	  Bus_send_cohe_response(req, REPLY_EXCL);
+	  Cache_send_cohe_response(captr, req, REPLY_EXCL);
 
 	  return 1;
 	}
@@ -1488,21 +1464,7 @@ static int L2ProcessTagCohe(CACHE * captr, REQ *req)
    * request -- the first one -- is allowed to overpass any coalesced
    * requests of an MSHR. Too strict?
    */
-  pmshr = 0;
-
-  if (captr->mshr_count > 0)
-    {
-      unsigned blocknum = ADDR2BNUM2(req->paddr);
-      for (i = 0; i < captr->max_mshrs; i++)
-	{
-	  if ((captr->mshrs[i].valid) &&
-	      (blocknum == captr->mshrs[i].blocknum))
-	    {
-	      pmshr = &(captr->mshrs[i]);
-	      break;
-	    }
-	}
-    }
+  pmshr = Cache_lookup_mshr(captr, ADDR2BNUM2(req->paddr));
 
   if ((pmshr != 0) && (req->progress == 0))
     {  
@@ -1526,7 +1488,7 @@ static int L2ProcessTagCohe(CACHE * captr, REQ *req)
   misscache = Cache_search(captr, req->vaddr, req->paddr, &cline);
   if (misscache)
     { /* missing in L2 cache implies missing in L1 cache. */
-      Bus_send_cohe_response(req, REPLY_EXCL);
+      Cache_send_cohe_response(captr, req, REPLY_EXCL);
       return 1;
     }
 
@@ -1618,11 +1580,11 @@ static int L2ProcessTagCohe(CACHE * captr, REQ *req)
    * cache-to-cache copy.
    */
   if (req->req_type == READ_CURRENT)
-    Bus_send_cohe_response(req, REPLY_EXCL);
+    Cache_send_cohe_response(captr, req, REPLY_EXCL);
   else if (cline->state == SH_CL)
-    Bus_send_cohe_response(req, REPLY_SH);
+    Cache_send_cohe_response(captr, req, REPLY_SH);
   else if (cline->state == INVALID) /* && (req->type != WRITEPURGE)) */
-    Bus_send_cohe_response(req, REPLY_EXCL);
+    Cache_send_cohe_response(captr, req, REPLY_EXCL);
 
   /*
    * cache-to-cache transaction needs to access the data SRAM array.
@@ -1768,15 +1730,32 @@ static int Cache_add_repl_to_l1(CACHE *captr, REQ *req)
 
 
 /*=============================================================================
- * Start a L1-initiated prefetch. If L1Q is full, drop the prefetch.
+ * Start L2-initiated prefetches. The prefetch engine trains on the access
+ * and supplies the offsets of the lines to fetch.
+ */
+
+static void L2Cache_start_prefetch(CACHE *captr, REQ *req, int miss)
+{
+  int offsets[PF_MAX_DEGREE];
+  int n, i;
+
+  n = Prefetch_candidates(captr->pf, req, miss, offsets);
+  for (i = 0; i < n; i++)
+    L2Cache_issue_prefetch(captr, req, offsets[i]);
+}
+
+
+
+/*=============================================================================
+ * Issue one L2-initiated prefetch. If L2Q is full, drop the prefetch.
  * Note that prefetch can not cross page boundary and no prefetch for
  * non-cacheable address.
  */
 
-static void L2Cache_start_prefetch(CACHE *captr, REQ *req)
+static void L2Cache_issue_prefetch(CACHE *captr, REQ *req, int offset)
 {
   REQ *newreq;
-  unsigned newpaddr = req->paddr + captr->linesz;
+  unsigned newpaddr = req->paddr + offset;
 
   
   if (!SAMEPAGE(req->paddr, newpaddr) ||
@@ -1802,7 +1781,8 @@ static void L2Cache_start_prefetch(CACHE *captr, REQ *req)
   newreq->src_proc      = captr->procid;
   newreq->prcr_req_type = req->prcr_req_type;
   newreq->paddr         = newpaddr;
-  newreq->vaddr         = req->vaddr + captr->linesz;
+  newreq->vaddr         = req->vaddr + offset;
+  newreq->pc            = req->pc;
   newreq->ifetch        = req->ifetch;
   newreq->l1mshr        = 0;
   newreq->l2mshr        = 0;
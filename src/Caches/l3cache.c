@@ -0,0 +1,832 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "Processor/simio.h"
+#include "Processor/tlb.h"
+#include "sim_main/simsys.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/pipeline.h"
+#include "Caches/cache.h"
+#include "Caches/l3cache.h"
+#include "Memory/mmc.h"
+
+
+l3_cache_t *L3Caches = NULL;
+
+
+static void       L3Cache_tick      (void);
+static l3_bank_t *L3Cache_bank      (l3_cache_t *, unsigned, unsigned *);
+static cline_t   *L3Cache_allocate  (l3_cache_t *, l3_bank_t *, unsigned, int);
+static int        L3Cache_lookup    (l3_cache_t *, l3_bank_t *,
+				     mmc_trans_t *);
+
+
+/*
+ * Simple FIFO of MMC transactions, linked through "l3next".
+ */
+static void L3Cache_append(mmc_trans_t **head, mmc_trans_t **tail,
+			   mmc_trans_t *ptrans)
+{
+  ptrans->l3next = NULL;
+  if (*head == NULL)
+    *head = ptrans;
+  else
+    (*tail)->l3next = ptrans;
+  *tail = ptrans;
+}
+
+
+static mmc_trans_t *L3Cache_pop(mmc_trans_t **head, mmc_trans_t **tail)
+{
+  mmc_trans_t *ptrans = *head;
+
+  *head = ptrans->l3next;
+  if (*head == NULL)
+    *tail = NULL;
+  return ptrans;
+}
+
+
+static void L3Cache_schedule(l3_cache_t *pl3)
+{
+  if (IsNotScheduled(pl3->pevent))
+    {
+      schedule_event(pl3->pevent, YS__Simtime + 1);
+    }
+}
+
+
+
+/*=============================================================================
+ * Create the L3 cache of every node. Each bank gets its own tag array,
+ * presence vectors, MSHRs and tag/data pipelines; the banks of a node
+ * share one event that clocks them while transactions are in flight.
+ */
+void L3Cache_init(void)
+{
+  l3_cache_t *pl3;
+  l3_bank_t  *pbank;
+  CACHE      *captr;
+  int         nodeid, b, nsets;
+
+  if ((cparam.L3_banks <= 0) || (NumOfBits(cparam.L3_banks, 1) < 0))
+    YS__errmsg(0, "L3 cache: bank count (%d) must be a power of 2",
+	       cparam.L3_banks);
+
+  if (cparam.L3_size % cparam.L3_banks)
+    YS__errmsg(0, "L3 cache: size (%d kbytes) is not a multiple of the bank count (%d)",
+	       cparam.L3_size, cparam.L3_banks);
+
+  if (cparam.L3_mshr_num <= 0)
+    YS__errmsg(0, "L3 cache: needs at least one MSHR per bank");
+
+  if (cparam.L3_inclusive && cparam.L2_perfect)
+    {
+      YS__warnmsg(0, "L3 cache: inclusion not maintained with a perfect L2 cache");
+      cparam.L3_inclusive = 0;
+    }
+
+  L3Caches = RSIM_CALLOC(l3_cache_t, ARCH_numnodes);
+  if (L3Caches == NULL)
+    YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  for (nodeid = 0; nodeid < ARCH_numnodes; nodeid++)
+    {
+      pl3 = NID2L3(nodeid);
+      pl3->nodeid     = nodeid;
+      pl3->bank_shift = NumOfBits(cparam.L3_banks, 1);
+      pl3->inclusive  = cparam.L3_inclusive;
+      pl3->busy       = 0;
+
+      pl3->banks = RSIM_CALLOC(l3_bank_t, cparam.L3_banks);
+      if (pl3->banks == NULL)
+	YS__errmsg(nodeid, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+      for (b = 0; b < cparam.L3_banks; b++)
+	{
+	  pbank = &(pl3->banks[b]);
+	  captr = &(pbank->cache);
+
+	  captr->nodeid      = nodeid;
+	  captr->procid      = b;
+	  captr->gid         = -1;
+	  captr->type        = L3CACHE;
+	  captr->size        = cparam.L3_size / cparam.L3_banks;
+	  captr->linesz      = ARCH_linesz2;
+	  captr->setsz       = cparam.L3_set_size;
+	  captr->replacement = cparam.L3_replacement;
+
+	  Cache_init_aux(captr);
+
+	  nsets = captr->num_lines >> captr->set_shift;
+	  pbank->presence   = RSIM_CALLOC(modmask_t, captr->num_lines);
+	  pbank->unfiltered = RSIM_CALLOC(char, nsets);
+	  pbank->waiters    = RSIM_CALLOC(l3_waiters_t, cparam.L3_mshr_num);
+	  if (!pbank->presence || !pbank->unfiltered || !pbank->waiters)
+	    YS__errmsg(nodeid, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+	  Cache_init_mshrs(captr, nodeid, cparam.L3_mshr_num,
+			   "L3 MSHR occupancy");
+
+	  pbank->tag_pipe  = NewPipeline(1,
+					 cparam.frequency * cparam.L3_tag_delay,
+					 cparam.frequency,
+					 cparam.L3_tag_delay / cparam.frequency);
+	  pbank->data_pipe = NewPipeline(1,
+					 cparam.frequency * cparam.L3_data_delay,
+					 cparam.frequency,
+					 cparam.L3_data_delay / cparam.frequency);
+	}
+
+      pl3->pevent = NewEvent("L3 cache", L3Cache_tick, NODELETE, 0);
+      pl3->pevent->uptr1 = pl3;
+    }
+}
+
+
+
+/*=============================================================================
+ * Banks are interleaved on line addresses. Within a bank the tag array is
+ * indexed by the bank-local address, i.e. the line address with the bank
+ * select bits removed.
+ */
+static l3_bank_t *L3Cache_bank(l3_cache_t *pl3, unsigned paddr,
+			       unsigned *laddr)
+{
+  unsigned blocknum = paddr >> block_shift2;
+
+  *laddr = (blocknum >> pl3->bank_shift) << block_shift2;
+  return &(pl3->banks[blocknum & (cparam.L3_banks - 1)]);
+}
+
+
+static unsigned L3Cache_line_paddr(l3_cache_t *pl3, l3_bank_t *pbank,
+				   cline_t *cline)
+{
+  CACHE    *captr  = &(pbank->cache);
+  unsigned  lblock = (cline->tag << captr->idx_shift) |
+                     (cline->index >> captr->set_shift);
+
+  return ((lblock << pl3->bank_shift) | (pbank - pl3->banks)) <<
+    captr->block_shift;
+}
+
+
+
+/*=============================================================================
+ * A set whose lines could not all be tracked. Requests mapping to it are
+ * broadcast to every L2 cache from now on.
+ */
+static void L3Cache_overflow(l3_cache_t *pl3, l3_bank_t *pbank, cline_t *cline)
+{
+  int set = cline->index >> pbank->cache.set_shift;
+
+  if (pl3->inclusive && !pbank->unfiltered[set])
+    {
+      pbank->unfiltered[set] = 1;
+      pl3->stats.overflow_sets++;
+    }
+}
+
+
+
+/*=============================================================================
+ * Remove a line from all L2 caches (and their L1 caches) that may hold it.
+ * With "probe" set, only check that none of them has a miss or upgrade
+ * outstanding for the line. Returns 0 if the line cannot be removed now.
+ * A dirty L2 copy makes the L3 line dirty.
+ */
+static int L3Cache_back_invalidate(l3_cache_t *pl3, l3_bank_t *pbank,
+				   cline_t *cline, int probe)
+{
+  modmask_t presence = pbank->presence[cline->index];
+  unsigned  paddr    = L3Cache_line_paddr(pl3, pbank, cline);
+  int      n, rc;
+
+  for (n = 0; n < ARCH_cpus; n++)
+    {
+      if (!(presence & MODMASK_BIT(n)))
+	continue;
+
+      rc = Cache_back_invalidate(PID2L2C(pl3->nodeid, n), paddr, probe);
+      if (rc < 0)
+	return 0;
+
+      if (probe || rc == 0)
+	continue;
+
+      pl3->stats.back_invals++;
+      if (rc == 2)
+	{
+	  pl3->stats.back_invals_dirty++;
+	  cline->state = PR_DY;
+	}
+    }
+
+  if (!probe)
+    pbank->presence[cline->index] = 0;
+
+  return 1;
+}
+
+
+
+/*=============================================================================
+ * Allocate a line for bank-local address "laddr". Invalid lines are used
+ * first, then lines no L2 cache holds, and last (inclusive L3 only) lines
+ * whose L2 copies can be back-invalidated right now; within a class the
+ * line ranked highest by the replacement policy is replaced. Lines with
+ * a fill outstanding are never replaced. Dirty victims are written back
+ * to DRAM unless "functional" is set. Returns NULL if no line could be
+ * replaced.
+ */
+static cline_t *L3Cache_allocate(l3_cache_t *pl3, l3_bank_t *pbank,
+				 unsigned laddr, int functional)
+{
+  CACHE    *captr = &(pbank->cache);
+  cline_t  *cline, *pline, *best = NULL;
+  int       i, baseidx, class, best_class = 3;
+  unsigned  rank, best_rank = 0;
+
+  Cache_search(captr, laddr, laddr, &cline);
+  baseidx = cline->index & (~captr->set_mask);
+  Repl_miss(captr, baseidx >> captr->set_shift);
+
+  for (i = 0; i < captr->setsz; i++)
+    {
+      pline = &(captr->tags[baseidx + i]);
+
+      if (pline->mshr_out)
+	continue;
+
+      if (pline->state == INVALID)
+	class = 0;
+      else if (!pl3->inclusive || pbank->presence[pline->index] == 0)
+	class = 1;
+      else if ((best_class == 2 || best == NULL) &&
+	       L3Cache_back_invalidate(pl3, pbank, pline, 1))
+	class = 2;
+      else
+	continue;
+
+      rank = Repl_rank(captr, pline);
+      if ((best == NULL) || (class < best_class) ||
+	  ((class == best_class) && (rank > best_rank)))
+	{
+	  best       = pline;
+	  best_class = class;
+	  best_rank  = rank;
+	}
+    }
+
+  if (best == NULL)
+    return NULL;
+
+  if (best_class == 2)
+    L3Cache_back_invalidate(pl3, pbank, best, 0);
+
+  if ((best->state == PR_DY) && !functional)
+    {
+      pl3->stats.dirty_evictions++;
+      MMC_write_line(NID2MMC(pl3->nodeid),
+		     L3Cache_line_paddr(pl3, pbank, best));
+    }
+
+  Repl_fill(captr, best, best->state != INVALID);
+
+  best->tag      = PADDR2TAG(laddr);
+  best->state    = PR_CL;
+  best->mshr_out = 0;
+  pbank->presence[best->index] = 0;
+
+  return best;
+}
+
+
+
+/*=============================================================================
+ * The memory controller hands a transaction to the L3 cache. Tag state,
+ * allocation and the presence vector are updated right away, in bus
+ * order; the access then proceeds through the bank's tag pipeline.
+ * Uncached accesses bypass the L3 (return 0).
+ */
+int L3Cache_recv_trans(int nodeid, mmc_trans_t *ptrans, REQ *req)
+{
+  l3_cache_t *pl3 = NID2L3(nodeid);
+  l3_bank_t  *pbank;
+  CACHE      *captr;
+  cline_t    *cline, *pset;
+  unsigned    laddr;
+  modmask_t   pbit;
+  int         present;
+
+  if (tlb_uncached(req->memattributes))
+    return 0;
+
+  pbank = L3Cache_bank(pl3, ptrans->paddr, &laddr);
+  captr = &(pbank->cache);
+  pbit  = (req->src_proc < ARCH_cpus) ? MODMASK_BIT(req->src_proc) : 0;
+
+  ptrans->l3fill = 0;
+  ptrans->l3next = NULL;
+
+  present = (Cache_search(captr, laddr, laddr, &cline) == 0);
+  if (present)
+    Repl_touch(captr, cline);
+
+  if (ptrans->mtype == MMC_READ)
+    {
+      pl3->stats.reads++;
+
+      /*
+       * On a miss this transaction becomes the primary miss that fills
+       * the line. If no line can be replaced the read bypasses the L3,
+       * and the set can no longer filter coherence requests.
+       */
+      if (!present)
+	{
+	  pset  = cline;
+	  cline = L3Cache_allocate(pl3, pbank, laddr, 0);
+	  if (cline != NULL)
+	    {
+	      cline->mshr_out = 1;
+	      ptrans->l3fill  = 1;
+	      present         = 1;
+	    }
+	  else if (pbit)
+	    L3Cache_overflow(pl3, pbank, pset);
+	}
+
+      if (present && pbit)
+	{
+	  if (req->req_type == READ_OWN)
+	    pbank->presence[cline->index] = pbit;
+	  else
+	    pbank->presence[cline->index] |= pbit;
+	}
+    }
+  else
+    {
+      pl3->stats.writes++;
+
+      if (present)
+	pl3->stats.write_hits++;
+      else
+	cline = L3Cache_allocate(pl3, pbank, laddr, 0);
+
+      if (cline != NULL)
+	cline->state = PR_DY;
+    }
+
+  pl3->busy++;
+  if ((pbank->tagq != NULL) || !AddToPipe(pbank->tag_pipe, ptrans))
+    L3Cache_append(&(pbank->tagq), &(pbank->tagq_last), ptrans);
+
+  L3Cache_schedule(pl3);
+  return 1;
+}
+
+
+
+/*=============================================================================
+ * A transaction leaves the tag pipeline. Hits (and all writes to lines
+ * in the L3) continue to the data pipeline; a primary miss needs an MSHR
+ * before it is sent to DRAM; reads to a line being filled wait on the
+ * MSHR. Accesses whose line is not in the L3 go to DRAM directly.
+ * Returns 0 if the transaction has to wait for an MSHR.
+ */
+static int L3Cache_lookup(l3_cache_t *pl3, l3_bank_t *pbank,
+			  mmc_trans_t *ptrans)
+{
+  CACHE        *captr = &(pbank->cache);
+  cline_t      *cline;
+  MSHR         *pmshr;
+  l3_waiters_t *pwait;
+  unsigned      laddr;
+
+  L3Cache_bank(pl3, ptrans->paddr, &laddr);
+
+  if (Cache_search(captr, laddr, laddr, &cline) != 0)
+    {
+      pl3->stats.bypasses++;
+      ptrans->l3fill = 0;
+      MMC_memory_access(NID2MMC(pl3->nodeid), ptrans);
+      return 1;
+    }
+
+  if ((ptrans->mtype != MMC_READ) || !cline->mshr_out)
+    {
+      if (ptrans->mtype == MMC_READ)
+	pl3->stats.read_hits++;
+      L3Cache_append(&(pbank->dataq), &(pbank->dataq_last), ptrans);
+      pl3->busy++;
+      return 1;
+    }
+
+  pmshr = Cache_lookup_mshr(captr, laddr >> captr->block_shift);
+  if (pmshr != NULL)
+    {
+      pwait = &(pbank->waiters[pmshr - captr->mshrs]);
+      pl3->stats.read_coals++;
+      L3Cache_append(&(pwait->head), &(pwait->last), ptrans);
+      return 1;
+    }
+
+  /*
+   * The primary miss may still be ahead of us, waiting for an MSHR.
+   */
+  if (!ptrans->l3fill)
+    return 0;
+
+  pmshr = Cache_alloc_mshr(captr, laddr >> captr->block_shift);
+  if (pmshr == NULL)
+    return 0;
+
+  pmshr->mainreq = NULL;
+  pmshr->cline   = cline;
+  pmshr->demand  = 0.0;
+
+  pwait = &(pbank->waiters[pmshr - captr->mshrs]);
+  pwait->head = NULL;
+  pwait->last = NULL;
+
+  pl3->stats.read_misses++;
+  MMC_memory_access(NID2MMC(pl3->nodeid), ptrans);
+  return 1;
+}
+
+
+
+/*=============================================================================
+ * One cycle of an L3 bank: retire data pipeline accesses, retry lookups
+ * stalled on MSHRs (in order), drain the tag pipeline and refill both
+ * pipelines from their input queues.
+ */
+static void L3Cache_bank_cycle(l3_cache_t *pl3, l3_bank_t *pbank)
+{
+  mmc_trans_t *ptrans;
+  REQ         *elm;
+
+  for (;;)
+    {
+      GetPipeElt(elm, pbank->data_pipe);
+      if (elm == NULL)
+	break;
+      ClearPipeElt(pbank->data_pipe);
+      pl3->busy--;
+
+      ptrans = (mmc_trans_t *) elm;
+      if (ptrans->mtype == MMC_READ)
+	MMC_read_done(NID2MMC(pl3->nodeid), ptrans);
+      MMC_dram_done(pl3->nodeid, ptrans);
+    }
+
+  while (pbank->stallq != NULL)
+    {
+      ptrans = L3Cache_pop(&(pbank->stallq), &(pbank->stallq_last));
+      if (!L3Cache_lookup(pl3, pbank, ptrans))
+	{
+	  ptrans->l3next = pbank->stallq;
+	  pbank->stallq  = ptrans;
+	  if (pbank->stallq_last == NULL)
+	    pbank->stallq_last = ptrans;
+	  break;
+	}
+    }
+
+  for (;;)
+    {
+      GetPipeElt(elm, pbank->tag_pipe);
+      if (elm == NULL)
+	break;
+      ClearPipeElt(pbank->tag_pipe);
+      pl3->busy--;
+
+      ptrans = (mmc_trans_t *) elm;
+      if ((pbank->stallq != NULL) || !L3Cache_lookup(pl3, pbank, ptrans))
+	{
+	  pl3->stats.mshr_stalls++;
+	  L3Cache_append(&(pbank->stallq), &(pbank->stallq_last), ptrans);
+	}
+    }
+
+  while ((pbank->dataq != NULL) && AddToPipe(pbank->data_pipe, pbank->dataq))
+    L3Cache_pop(&(pbank->dataq), &(pbank->dataq_last));
+
+  while ((pbank->tagq != NULL) && AddToPipe(pbank->tag_pipe, pbank->tagq))
+    L3Cache_pop(&(pbank->tagq), &(pbank->tagq_last));
+}
+
+
+
+/*
+ * Clock event of the L3 cache of a node. It keeps running as long as
+ * transactions are queued or in a pipeline; transactions waiting for
+ * DRAM restart it through L3Cache_fill.
+ */
+static void L3Cache_tick(void)
+{
+  l3_cache_t *pl3 = (l3_cache_t *) YS__ActEvnt->uptr1;
+  int         b;
+
+  for (b = 0; b < cparam.L3_banks; b++)
+    L3Cache_bank_cycle(pl3, &(pl3->banks[b]));
+
+  if (pl3->busy > 0)
+    L3Cache_schedule(pl3);
+}
+
+
+
+/*=============================================================================
+ * Data for a primary L3 miss has arrived from DRAM. The line becomes
+ * valid, the MSHR is released and the reads that coalesced into it are
+ * read out of the data array. Called by the MMC.
+ */
+void L3Cache_fill(int nodeid, mmc_trans_t *ptrans)
+{
+  l3_cache_t   *pl3 = NID2L3(nodeid);
+  l3_bank_t    *pbank;
+  CACHE        *captr;
+  MSHR         *pmshr;
+  l3_waiters_t *pwait;
+  mmc_trans_t  *waiter;
+  unsigned      laddr;
+
+  pbank = L3Cache_bank(pl3, ptrans->paddr, &laddr);
+  captr = &(pbank->cache);
+  ptrans->l3fill = 0;
+
+  pmshr = Cache_lookup_mshr(captr, laddr >> captr->block_shift);
+  if (pmshr == NULL)
+    YS__errmsg(nodeid, "L3Cache_fill: no MSHR for line 0x%08X",
+	       ptrans->paddr & block_mask2);
+
+  pmshr->cline->mshr_out = 0;
+  pl3->stats.miss_cycles += YS__Simtime - ptrans->issued;
+
+  pwait = &(pbank->waiters[pmshr - captr->mshrs]);
+  while (pwait->head != NULL)
+    {
+      waiter = L3Cache_pop(&(pwait->head), &(pwait->last));
+      L3Cache_append(&(pbank->dataq), &(pbank->dataq_last), waiter);
+      pl3->busy++;
+    }
+
+  Cache_free_mshr(captr, pmshr);
+
+  L3Cache_schedule(pl3);
+}
+
+
+
+/*=============================================================================
+ * Called when a coherent request is put on the bus: returns the set of
+ * CPUs whose L2 cache has to snoop it. Without an inclusive L3 that is
+ * every CPU. Otherwise it is the requester plus the L2 caches recorded
+ * in the presence vector of the line; requests for ownership leave only
+ * the requester in the vector since all other copies get invalidated.
+ */
+modmask_t L3Cache_snoop_filter(REQ *req)
+{
+  l3_cache_t *pl3;
+  l3_bank_t  *pbank;
+  cline_t    *cline;
+  unsigned    laddr;
+  modmask_t   mask, pbit, all = MODMASK_BIT(ARCH_cpus) - 1;
+  int         n;
+
+  if (L3Caches == NULL)
+    return all;
+
+  pl3 = NID2L3(req->node);
+  if (!pl3->inclusive)
+    return all;
+
+  pbank = L3Cache_bank(pl3, req->paddr, &laddr);
+  pbit  = (req->src_proc < ARCH_cpus) ? MODMASK_BIT(req->src_proc) : 0;
+  mask  = pbit;
+
+  if (Cache_search(&(pbank->cache), laddr, laddr, &cline) == 0)
+    {
+      mask |= pbank->presence[cline->index];
+      if ((req->type == WRITEPURGE) ||
+	  (req->req_type == READ_OWN) || (req->req_type == UPGRADE))
+	pbank->presence[cline->index] = pbit;
+    }
+
+  if (pbank->unfiltered[cline->index >> pbank->cache.set_shift])
+    mask = all;
+
+  pl3->stats.snoops += ARCH_cpus;
+  for (n = 0; n < ARCH_cpus; n++)
+    if (!(mask & MODMASK_BIT(n)))
+      pl3->stats.snoops_filtered++;
+
+  return mask;
+}
+
+
+
+/*=============================================================================
+ * Functional counterpart of an L2 fill by processor "procid" of "nodeid",
+ * used while warming up the caches and when restoring L2 tags from a
+ * checkpoint: the line is installed without timing and the L2 cache is
+ * recorded in its presence vector.
+ */
+void L3Cache_warm(int nodeid, int procid, unsigned paddr)
+{
+  l3_cache_t *pl3 = NID2L3(nodeid);
+  l3_bank_t  *pbank;
+  cline_t    *cline, *pset;
+  unsigned    laddr;
+
+  pbank = L3Cache_bank(pl3, paddr, &laddr);
+
+  if (Cache_search(&(pbank->cache), laddr, laddr, &cline) == 0)
+    Repl_touch(&(pbank->cache), cline);
+  else
+    {
+      pset  = cline;
+      cline = L3Cache_allocate(pl3, pbank, laddr, 1);
+      if (cline == NULL)
+	{
+	  L3Cache_overflow(pl3, pbank, pset);
+	  return;
+	}
+    }
+
+  pbank->presence[cline->index] |= MODMASK_BIT(procid);
+}
+
+
+
+/*=============================================================================
+ * Print L3 cache configuration.
+ */
+void L3Cache_print_params(int nid)
+{
+  YS__statmsg(nid, "Shared L3 Cache Configuration\n");
+  YS__statmsg(nid,
+	      "  size:           %4d kbytes\tbanks:         %4d\n",
+	      cparam.L3_size, cparam.L3_banks);
+  YS__statmsg(nid,
+	      "  line size:      %4d bytes\tassociativity: %4d\n",
+	      ARCH_linesz2, cparam.L3_set_size);
+  YS__statmsg(nid,
+	      "  MSHR count:     %4d per bank\n", cparam.L3_mshr_num);
+  YS__statmsg(nid,
+	      "  tag delay:      %4d cycles\tdata delay:    %4d cycles\n",
+	      cparam.L3_tag_delay, cparam.L3_data_delay);
+  YS__statmsg(nid,
+	      "  replacement:     %s\n", Repl_name(cparam.L3_replacement));
+  YS__statmsg(nid,
+	      "  inclusion:       %s\n\n",
+	      cparam.L3_inclusive ? "inclusive (snoop filter)" : "non-inclusive");
+}
+
+
+
+/*=============================================================================
+ * Print L3 cache statistics.
+ */
+void L3Cache_stat_report(int nid)
+{
+  l3_cache_t *pl3 = NID2L3(nid);
+  l3_stat_t  *ps  = &(pl3->stats);
+  int         b;
+
+  if (cparam.collect_stats == 0)
+    return;
+
+  YS__statmsg(nid, "Shared L3 Cache Statistics\n");
+  YS__statmsg(nid,
+	      "  Reads:                %12lld\n", ps->reads);
+  if (ps->reads)
+    {
+      YS__statmsg(nid,
+		  "    hits:               %12lld\t(%.2f%%)\n",
+		  ps->read_hits, 100.0 * ps->read_hits / ps->reads);
+      YS__statmsg(nid,
+		  "    misses:             %12lld\t(%.2f%%)\n",
+		  ps->read_misses, 100.0 * ps->read_misses / ps->reads);
+      YS__statmsg(nid,
+		  "    coalesced:          %12lld\t(%.2f%%)\n",
+		  ps->read_coals, 100.0 * ps->read_coals / ps->reads);
+    }
+  if (ps->read_misses)
+    YS__statmsg(nid,
+		"    miss latency:       %12.2f\n",
+		ps->miss_cycles / ps->read_misses);
+
+  YS__statmsg(nid,
+	      "  Writes:               %12lld\n", ps->writes);
+  YS__statmsg(nid,
+	      "    hits:               %12lld\n", ps->write_hits);
+  YS__statmsg(nid,
+	      "  Bypasses:             %12lld\n", ps->bypasses);
+  YS__statmsg(nid,
+	      "  Dirty evictions:      %12lld\n", ps->dirty_evictions);
+  YS__statmsg(nid,
+	      "  MSHR stalls:          %12lld\n", ps->mshr_stalls);
+
+  if (cparam.L3_inclusive)
+    {
+      YS__statmsg(nid,
+		  "  Back-invalidations:   %12lld\t(dirty: %lld)\n",
+		  ps->back_invals, ps->back_invals_dirty);
+      YS__statmsg(nid,
+		  "  L2 snoops:            %12lld\n", ps->snoops);
+      if (ps->snoops)
+	YS__statmsg(nid,
+		    "    filtered:           %12lld\t(%.2f%%)\n",
+		    ps->snoops_filtered,
+		    100.0 * ps->snoops_filtered / ps->snoops);
+      if (ps->overflow_sets)
+	YS__statmsg(nid,
+		    "    unfiltered sets:    %12lld\n", ps->overflow_sets);
+    }
+
+  for (b = 0; b < cparam.L3_banks; b++)
+    {
+      YS__statmsg(nid, "  Bank %d:\n", b);
+      StatrecReport(nid, pl3->banks[b].cache.mshr_occ);
+    }
+
+  YS__statmsg(nid, "\n");
+}
+
+
+
+/*=============================================================================
+ * Clear L3 cache statistics.
+ */
+void L3Cache_stat_clear(int nid)
+{
+  l3_cache_t *pl3      = NID2L3(nid);
+  l3_stat_t  *ps       = &(pl3->stats);
+  long long   overflow = ps->overflow_sets;
+  int         b;
+
+  memset(ps, 0, sizeof(l3_stat_t));
+  ps->overflow_sets = overflow;          /* these sets stay unfiltered */
+
+  for (b = 0; b < cparam.L3_banks; b++)
+    StatrecReset(pl3->banks[b].cache.mshr_occ);
+}
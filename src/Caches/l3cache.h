@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+/*---------------------------------------------------------------------------*/
+/* Shared last-level (L3) cache. One L3 per node sits in front of the DRAM   */
+/* backend at the memory controller and is shared by all CPUs on the bus.    */
+/* It is split into address-interleaved banks, each with its own tag and     */
+/* data pipeline and MSHRs. When inclusive, each line records which L2       */
+/* caches may hold a copy, so that coherence requests are broadcast only to  */
+/* those L2 caches.                                                          */
+/*---------------------------------------------------------------------------*/
+
+#ifndef __RSIM_L3CACHE_H__
+#define __RSIM_L3CACHE_H__
+
+
+#include "sim_main/simsys.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/cache.h"
+
+
+struct mmc_trans;
+struct YS__Pipeline;
+
+
+/*
+ * Transactions that hit a line while it is being fetched. Outstanding
+ * fills use the regular MSHRs of the bank's cache structure (keyed by
+ * bank-local line number); the waiters of MSHR i are in waiters[i].
+ */
+typedef struct
+{
+  struct mmc_trans *head;       /* coalesced reads, linked by l3next        */
+  struct mmc_trans *last;
+} l3_waiters_t;
+
+
+/*
+ * One L3 bank. The tag array is a regular cache structure indexed by the
+ * bank-local line number (the bank select bits are removed).
+ */
+typedef struct
+{
+  CACHE                cache;
+  modmask_t           *presence;   /* per line: L2 caches that may hold it   */
+  char                *unfiltered; /* per set: inclusion could not be kept   */
+  l3_waiters_t        *waiters;    /* per MSHR of "cache"                    */
+  struct YS__Pipeline *tag_pipe;
+  struct YS__Pipeline *data_pipe;
+
+  struct mmc_trans    *tagq;       /* waiting to enter the tag pipeline      */
+  struct mmc_trans    *tagq_last;
+  struct mmc_trans    *stallq;     /* looked up, waiting for an MSHR         */
+  struct mmc_trans    *stallq_last;
+  struct mmc_trans    *dataq;      /* waiting to enter the data pipeline     */
+  struct mmc_trans    *dataq_last;
+} l3_bank_t;
+
+
+typedef struct
+{
+  long long reads;
+  long long read_hits;
+  long long read_misses;
+  long long read_coals;
+  long long writes;
+  long long write_hits;
+  long long bypasses;
+  long long dirty_evictions;
+  long long back_invals;
+  long long back_invals_dirty;
+  long long mshr_stalls;
+  long long snoops;
+  long long snoops_filtered;
+  long long overflow_sets;
+  double    miss_cycles;
+} l3_stat_t;
+
+
+typedef struct
+{
+  int         nodeid;
+  l3_bank_t  *banks;
+  int         bank_shift;
+  int         inclusive;
+  EVENT      *pevent;
+  int         busy;              /* transactions inside the L3               */
+  l3_stat_t   stats;
+} l3_cache_t;
+
+
+extern l3_cache_t *L3Caches;
+
+#define NID2L3(nid)             (&(L3Caches[nid]))
+
+
+void      L3Cache_init          (void);
+int       L3Cache_recv_trans    (int nodeid, struct mmc_trans *ptrans,
+				REQ *req);
+void      L3Cache_fill          (int nodeid, struct mmc_trans *ptrans);
+modmask_t L3Cache_snoop_filter  (REQ *req);
+void      L3Cache_warm          (int nodeid, int procid, unsigned paddr);
+void      L3Cache_print_params  (int nid);
+void      L3Cache_stat_report   (int nid);
+void      L3Cache_stat_clear    (int nid);
+
+
+#endif
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Processor/simio.h"
+#include "sim_main/simsys.h"
+#include "sim_main/util.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/prefetch.h"
+
+
+static char *pf_engine_names[] = { "nextline", "stride", "stream", "hybrid" };
+
+
+
+/*=============================================================================
+ * Allocate and initialize a prefetch engine. 'mode' is the value of the
+ * per-cache prefetch switch; degree and distance are the upper bounds the
+ * throttling logic may use.
+ */
+
+prefetcher_t *Prefetch_init(int engine, unsigned mode, int linesz,
+			    int degree, int distance, int table,
+			    int streams, int throttle,
+			    prefetch_stat_t *pstat)
+{
+  prefetcher_t *pf;
+
+  if (degree < 1 || degree > PF_MAX_DEGREE)
+    YS__errmsg(0, "Prefetch degree must be between 1 and %d\n",
+	       PF_MAX_DEGREE);
+
+  if (distance < 1 || distance > PF_MAX_DISTANCE)
+    YS__errmsg(0, "Prefetch distance must be between 1 and %d\n",
+	       PF_MAX_DISTANCE);
+
+  if (table < 1 || (table & (table - 1)) != 0)
+    YS__errmsg(0, "Prefetch stride table size must be a power of 2\n");
+
+  if (streams < 1)
+    YS__errmsg(0, "Prefetcher needs at least one stream\n");
+
+  pf = RSIM_CALLOC(prefetcher_t, 1);
+  if (pf == NULL)
+    YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  pf->engine       = engine;
+  pf->mode         = mode;
+  pf->block_shift  = NumOfBits(linesz, 1);
+  pf->degree       = degree;
+  pf->max_degree   = degree;
+  pf->distance     = distance;
+  pf->max_distance = distance;
+  pf->throttle     = throttle;
+  pf->pstat        = pstat;
+
+  if (engine == PF_STRIDE || engine == PF_HYBRID)
+    {
+      pf->rpt_size = table;
+      pf->rpt      = RSIM_CALLOC(pf_stride_t, table);
+      if (pf->rpt == NULL)
+	YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
+    }
+
+  if (engine == PF_STREAM || engine == PF_HYBRID)
+    {
+      pf->num_streams = streams;
+      pf->streams     = RSIM_CALLOC(pf_stream_t, streams);
+      if (pf->streams == NULL)
+	YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
+    }
+
+  return pf;
+}
+
+
+
+/*=============================================================================
+ * Translate between engine names and numbers. Returns -1 for unknown names.
+ */
+
+int Prefetch_parse(char *name)
+{
+  int n;
+
+  for (n = PF_NEXTLINE; n <= PF_HYBRID; n++)
+    if (!strcasecmp(name, pf_engine_names[n]))
+      return n;
+
+  return -1;
+}
+
+
+char *Prefetch_name(int engine)
+{
+  if (engine < PF_NEXTLINE || engine > PF_HYBRID)
+    return "unknown";
+
+  return pf_engine_names[engine];
+}
+
+
+
+/*=============================================================================
+ * Decide whether an access should invoke the prefetcher. The next-line
+ * engine keeps the original behavior: prefetch on a miss, and on a hit to
+ * a prefetched line if bit 1 of the prefetch switch is set. The table-based
+ * engines need to observe every demand access in order to train.
+ */
+
+int Prefetch_trigger(prefetcher_t *pf, REQ *req, int miss, int pfhit)
+{
+  if (pf->engine == PF_NEXTLINE)
+    return miss || ((pf->mode & 2) && pfhit);
+
+  return req->prefetch == 0;
+}
+
+
+
+/*=============================================================================
+ * Feedback-directed throttling: at the end of every interval of issued
+ * prefetches, compare the fraction of useful prefetches and the fraction
+ * of late ones against fixed thresholds and back off or ramp up.
+ */
+
+static void Prefetch_throttle(prefetcher_t *pf)
+{
+  long long issued, useful, late;
+  double    accuracy, lateness;
+
+  if (pf->pstat->issued < pf->ivl_issued)
+    {                                     /* statistics have been cleared */
+      pf->ivl_issued = pf->pstat->issued;
+      pf->ivl_useful = pf->pstat->useful;
+      pf->ivl_late   = pf->pstat->late;
+      return;
+    }
+
+  issued = pf->pstat->issued - pf->ivl_issued;
+  if (issued < PF_INTERVAL)
+    return;
+
+  useful = pf->pstat->useful - pf->ivl_useful;
+  late   = pf->pstat->late   - pf->ivl_late;
+
+  accuracy = (double)useful / issued;
+  lateness = useful > 0 ? (double)late / useful : 0.0;
+
+  if (accuracy < 0.40)
+    {
+      if (pf->degree > 1)
+	pf->degree--;
+      else if (pf->distance > 1)
+	pf->distance--;
+      pf->throttle_down++;
+    }
+  else if (accuracy >= 0.75 || lateness >= 0.10)
+    {
+      if (lateness >= 0.10 && pf->distance < pf->max_distance)
+	pf->distance++;
+      else if (pf->degree < pf->max_degree)
+	pf->degree++;
+      pf->throttle_up++;
+    }
+
+  pf->ivl_issued = pf->pstat->issued;
+  pf->ivl_useful = pf->pstat->useful;
+  pf->ivl_late   = pf->pstat->late;
+}
+
+
+
+/*=============================================================================
+ * Stride engine: a reference prediction table indexed by the load PC.
+ * An entry predicts once the same nonzero stride has been seen twice in
+ * a row. Strides below a cache line are rounded up to one line.
+ */
+
+static int Prefetch_stride(prefetcher_t *pf, REQ *req, int *offsets)
+{
+  pf_stride_t *entry;
+  int          delta, step, k, n;
+  int          linesz = 1 << pf->block_shift;
+
+  entry = &pf->rpt[(req->pc >> 2) & (pf->rpt_size - 1)];
+
+  if (entry->pc != req->pc)
+    {
+      entry->pc        = req->pc;
+      entry->last_addr = req->vaddr;
+      entry->stride    = 0;
+      entry->conf      = 0;
+      return 0;
+    }
+
+  delta = (int)(req->vaddr - entry->last_addr);
+  if (delta == 0)
+    return 0;
+
+  if (delta == entry->stride)
+    {
+      if (entry->conf < 3)
+	entry->conf++;
+    }
+  else
+    {
+      if (entry->conf > 0)
+	entry->conf--;
+      if (entry->conf == 0)
+	entry->stride = delta;
+    }
+
+  entry->last_addr = req->vaddr;
+
+  if (entry->conf < 2)
+    return 0;
+
+  step = entry->stride;
+  if (step > -linesz && step < linesz)
+    step = step > 0 ? linesz : -linesz;
+
+  for (n = 0, k = pf->distance; n < pf->degree; n++, k++)
+    offsets[n] = step * k;
+
+  pf->stride_preds += n;
+  return n;
+}
+
+
+
+/*=============================================================================
+ * Stream engine: tracks up to num_streams sequential streams of cache
+ * lines. A miss that does not fall into a tracked stream allocates the
+ * least recently used entry; a second access within two lines fixes the
+ * direction. A trained stream keeps up to 'distance' lines ahead of the
+ * demand stream and issues at most 'degree' lines per trigger.
+ */
+
+static int Prefetch_stream(prefetcher_t *pf, REQ *req, int miss,
+			   int *offsets)
+{
+  pf_stream_t *s, *victim = NULL;
+  unsigned     line = req->paddr >> pf->block_shift;
+  int          d, n, i;
+
+  for (i = 0; i < pf->num_streams; i++)
+    {
+      s = &pf->streams[i];
+      if (!s->valid)
+	{
+	  if (victim == NULL || victim->valid)
+	    victim = s;
+	  continue;
+	}
+
+      if (s->dir == 0)
+	{
+	  d = (int)(line - s->last_line);
+	  if (d != 0 && d >= -2 && d <= 2)
+	    {
+	      s->dir       = d > 0 ? 1 : -1;
+	      s->next_line = line + s->dir;
+	      break;
+	    }
+	}
+      else
+	{
+	  d = (int)(line - s->last_line) * s->dir;
+	  if (d >= 0 && d <= pf->distance)
+	    break;
+	}
+
+      if (victim == NULL || (victim->valid && s->lru < victim->lru))
+	victim = s;
+    }
+
+  if (i == pf->num_streams)
+    {
+      if (miss)
+	{
+	  victim->valid     = 1;
+	  victim->last_line = line;
+	  victim->next_line = line;
+	  victim->dir       = 0;
+	  victim->lru       = YS__Simtime;
+	  pf->stream_allocs++;
+	}
+      return 0;
+    }
+
+  s->last_line = line;
+  s->lru       = YS__Simtime;
+
+  if ((int)(s->next_line - line) * s->dir <= 0)
+    s->next_line = line + s->dir;
+
+  for (n = 0;
+       n < pf->degree && (int)(s->next_line - line) * s->dir <= pf->distance;
+       n++, s->next_line += s->dir)
+    offsets[n] = (int)(s->next_line - line) << pf->block_shift;
+
+  pf->stream_preds += n;
+  return n;
+}
+
+
+
+/*=============================================================================
+ * Train the engine on an access and return the number of prefetch
+ * candidates written to 'offsets' (byte offsets relative to the access).
+ * 'offsets' must have room for PF_MAX_DEGREE entries.
+ */
+
+int Prefetch_candidates(prefetcher_t *pf, REQ *req, int miss, int *offsets)
+{
+  int n;
+
+  if (pf->throttle)
+    Prefetch_throttle(pf);
+
+  switch (pf->engine)
+    {
+    case PF_STRIDE:
+      return Prefetch_stride(pf, req, offsets);
+
+    case PF_STREAM:
+      return Prefetch_stream(pf, req, miss, offsets);
+
+    case PF_HYBRID:
+      n = Prefetch_stride(pf, req, offsets);
+      if (n == 0)
+	n = Prefetch_stream(pf, req, miss, offsets);
+      return n;
+
+    default:
+      for (n = 0; n < pf->degree; n++)
+	offsets[n] = (pf->distance + n) << pf->block_shift;
+      return n;
+    }
+}
+
+
+
+/*=============================================================================
+ * Report and clear engine statistics.
+ */
+
+void Prefetch_stat_report(int nid, char *name, prefetcher_t *pf)
+{
+  YS__statmsg(nid, "  %s engine: %s\tdegree: %d/%d\tdistance: %d/%d\n",
+	      name, Prefetch_name(pf->engine),
+	      pf->degree, pf->max_degree, pf->distance, pf->max_distance);
+
+  if (pf->rpt)
+    YS__statmsg(nid, "  stride predictions: \t%12lld\n", pf->stride_preds);
+
+  if (pf->streams)
+    YS__statmsg(nid, "  stream predictions: \t%12lld\tstreams allocated: %lld\n",
+		pf->stream_preds, pf->stream_allocs);
+
+  if (pf->throttle)
+    YS__statmsg(nid, "  throttle up:        \t%12lld\tthrottle down: %lld\n",
+		pf->throttle_up, pf->throttle_down);
+
+  YS__statmsg(nid, "\n");
+}
+
+
+void Prefetch_stat_clear(prefetcher_t *pf)
+{
+  pf->stride_preds  = 0;
+  pf->stream_preds  = 0;
+  pf->stream_allocs = 0;
+  pf->throttle_up   = 0;
+  pf->throttle_down = 0;
+  pf->ivl_issued    = 0;
+  pf->ivl_useful    = 0;
+  pf->ivl_late      = 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+/*---------------------------------------------------------------------------*/
+/* Hardware prefetch engines for the L1 data cache and the L2 cache. The     */
+/* cache calls Prefetch_candidates on a triggering access; the engine        */
+/* trains its tables and returns the byte offsets (relative to the access)   */
+/* of the lines to fetch. The cache issues them through its request queue    */
+/* so they go through the normal MSHR path and prefetch statistics.          */
+/*---------------------------------------------------------------------------*/
+
+#ifndef __RSIM_PREFETCH_H__
+#define __RSIM_PREFETCH_H__
+
+
+#include "Caches/req.h"
+#include "Caches/cache_stat.h"
+
+
+/*
+ * Prefetch engines
+ */
+#define PF_NEXTLINE        0    /* next line on miss (and on prefetch hit)   */
+#define PF_STRIDE          1    /* PC-indexed reference prediction table     */
+#define PF_STREAM          2    /* multi-stream sequential detector          */
+#define PF_HYBRID          3    /* stride if confident, otherwise stream     */
+
+#define PF_MAX_DEGREE     16    /* upper bound on lines per trigger          */
+#define PF_MAX_DISTANCE   64    /* upper bound on lookahead (lines/strides)  */
+#define PF_INTERVAL      256    /* issued prefetches per throttle interval   */
+
+
+/*
+ * Reference prediction table entry, indexed and tagged by load PC
+ */
+typedef struct
+{
+  unsigned pc;
+  unsigned last_addr;
+  int      stride;
+  int      conf;                /* 2-bit saturating confidence counter       */
+} pf_stride_t;
+
+
+/*
+ * Stream detector entry. A stream trains on two accesses in the same
+ * direction within the detection window and then runs ahead of the
+ * demand stream by up to 'distance' lines.
+ */
+typedef struct
+{
+  int      valid;
+  unsigned last_line;           /* most recent demand line of the stream    */
+  unsigned next_line;           /* next line to prefetch                    */
+  int      dir;                 /* +1 ascending, -1 descending, 0 training  */
+  int      conf;
+  double   lru;
+} pf_stream_t;
+
+
+typedef struct Prefetcher
+{
+  int          engine;
+  unsigned     mode;            /* L1DC_prefetch / L2C_prefetch switch       */
+  int          block_shift;
+
+  int          degree;          /* current lines per trigger                 */
+  int          max_degree;
+  int          distance;        /* current lookahead                         */
+  int          max_distance;
+
+  pf_stride_t *rpt;
+  int          rpt_size;
+  pf_stream_t *streams;
+  int          num_streams;
+
+  /* Feedback-directed throttling ------------------------------------------*/
+  int              throttle;
+  prefetch_stat_t *pstat;       /* prefetch statistics of owning cache       */
+  long long        ivl_issued;  /* counter values at start of interval       */
+  long long        ivl_useful;
+  long long        ivl_late;
+
+  /* Engine statistics ------------------------------------------------------*/
+  long long    stride_preds;
+  long long    stream_preds;
+  long long    stream_allocs;
+  long long    throttle_up;
+  long long    throttle_down;
+} prefetcher_t;
+
+
+prefetcher_t *Prefetch_init       (int engine, unsigned mode, int linesz,
+				   int degree, int distance, int table,
+				   int streams, int throttle,
+				   prefetch_stat_t *pstat);
+int           Prefetch_parse      (char *name);
+char         *Prefetch_name       (int engine);
+int           Prefetch_trigger    (prefetcher_t *pf, REQ *req, int miss,
+				   int pfhit);
+int           Prefetch_candidates (prefetcher_t *pf, REQ *req, int miss,
+				   int *offsets);
+void          Prefetch_stat_report(int nid, char *name, prefetcher_t *pf);
+void          Prefetch_stat_clear (prefetcher_t *pf);
+
+
+#endif
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+/*
+ * Cache replacement policies. Each policy keeps its per-line state in the
+ * 'age' field of the cache line and any per-set or per-cache state in the
+ * cache structure. Hits and fills update only the accessed line (or the
+ * log2(assoc) tree nodes on its path for PLRU); victim selection ranks
+ * the lines of a set, the line with the highest rank is replaced first.
+ *
+ *   LRU:    age is a time stamp of the last access
+ *   PLRU:   binary tree of direction bits per set
+ *   SRRIP:  age is a 2-bit re-reference prediction value (RRPV), lines
+ *           are inserted with a long re-reference interval
+ *   BRRIP:  like SRRIP, but most lines are inserted with a distant
+ *           re-reference interval
+ *   DRRIP:  set dueling between SRRIP and BRRIP leader sets
+ *   RANDOM: a random line is replaced
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "Processor/simio.h"
+#include "sim_main/simsys.h"
+#include "sim_main/util.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/cache.h"
+
+
+#define RRPV_MAX           3    /* 2-bit re-reference prediction values     */
+#define BRRIP_EPSILON     32    /* BRRIP inserts 1 out of 32 lines as long  */
+#define DRRIP_LEADERS     32    /* leader sets per competing policy         */
+#define PSEL_MAX        1023    /* 10-bit policy selection counter          */
+
+
+static char *repl_names[] =
+  { "", "LRU", "", "PLRU", "SRRIP", "BRRIP", "DRRIP", "random" };
+
+
+
+/*=============================================================================
+ * Translate between policy names and numbers. Returns -1 for unknown names.
+ */
+
+int Repl_parse(char *name)
+{
+  int n;
+
+  for (n = LRU; n <= RANDOM_REPL; n++)
+    if (repl_names[n][0] && !strcasecmp(name, repl_names[n]))
+      return n;
+
+  return -1;
+}
+
+
+char *Repl_name(int policy)
+{
+  if (policy < LRU || policy > RANDOM_REPL || !repl_names[policy][0])
+    return "unknown";
+
+  return repl_names[policy];
+}
+
+
+
+/*=============================================================================
+ * Allocate the policy state of a cache. Called after the tag array has
+ * been set up.
+ */
+
+void Repl_init(CACHE *captr)
+{
+  int nof_sets = captr->num_lines / captr->setsz;
+
+  captr->repl_clock  = 0;
+  captr->repl_seed   = captr->gid * 2 + captr->type + 1;
+  captr->brrip_count = 0;
+  captr->psel        = PSEL_MAX / 2;
+
+  if (captr->replacement == PLRU)
+    {
+      captr->plru = RSIM_CALLOC(unsigned char, captr->num_lines);
+      if (captr->plru == NULL)
+	YS__errmsg(captr->nodeid, "Malloc failed at %s:%i",
+		   __FILE__, __LINE__);
+    }
+
+  if (captr->replacement == DRRIP)
+    {
+      if (nof_sets < 2)
+	{
+	  YS__warnmsg(captr->nodeid,
+		      "DRRIP needs at least 2 sets for set dueling; using SRRIP");
+	  captr->replacement = SRRIP;
+	}
+      else
+	captr->leader_stride = nof_sets / MIN(DRRIP_LEADERS, nof_sets / 2);
+    }
+}
+
+
+
+/*=============================================================================
+ * PLRU helpers. Tree node n of a set has children 2n and 2n+1; node 0 is
+ * unused. A node bit points toward the half that holds the next victim.
+ */
+
+static void Repl_plru_touch(CACHE *captr, cline_t *pline)
+{
+  unsigned char *bits = captr->plru + (pline->index & ~captr->set_mask);
+  int            way  = pline->index & captr->set_mask;
+  int            node = 1, level, b;
+
+  for (level = captr->set_shift - 1; level >= 0; level--)
+    {
+      b = (way >> level) & 1;
+      bits[node] = !b;
+      node = 2 * node + b;
+    }
+}
+
+
+static unsigned Repl_plru_rank(CACHE *captr, cline_t *pline)
+{
+  unsigned char *bits = captr->plru + (pline->index & ~captr->set_mask);
+  int            way  = pline->index & captr->set_mask;
+  int            node = 1, level, b;
+  unsigned       rank = 0;
+
+  for (level = captr->set_shift - 1; level >= 0; level--, rank++)
+    {
+      b = (way >> level) & 1;
+      if (bits[node] != b)
+	break;
+      node = 2 * node + b;
+    }
+
+  return rank;
+}
+
+
+
+/*=============================================================================
+ * DRRIP leader set classification: returns SRRIP or BRRIP for leader
+ * sets and DRRIP for follower sets.
+ */
+
+static int Repl_leader(CACHE *captr, int set)
+{
+  int pos = set % captr->leader_stride;
+
+  if (pos == 0)
+    return SRRIP;
+  if (pos == 1)
+    return BRRIP;
+  return DRRIP;
+}
+
+
+
+/*=============================================================================
+ * Update replacement state on a hit.
+ */
+
+void Repl_touch(CACHE *captr, cline_t *pline)
+{
+  switch (captr->replacement)
+    {
+    case LRU:
+      pline->age = ++captr->repl_clock;
+      break;
+
+    case PLRU:
+      Repl_plru_touch(captr, pline);
+      break;
+
+    case SRRIP:
+    case BRRIP:
+    case DRRIP:
+      pline->age = 0;
+      break;
+
+    default:
+      break;
+    }
+}
+
+
+
+/*=============================================================================
+ * Start of a miss in the given set: update the DRRIP policy selector
+ * and draw the random victim offset.
+ */
+
+void Repl_miss(CACHE *captr, int set)
+{
+  switch (captr->replacement)
+    {
+    case DRRIP:
+      switch (Repl_leader(captr, set))
+	{
+	case SRRIP:
+	  if (captr->psel < PSEL_MAX)
+	    captr->psel++;
+	  break;
+	case BRRIP:
+	  if (captr->psel > 0)
+	    captr->psel--;
+	  break;
+	}
+      break;
+
+    case RANDOM_REPL:
+      captr->repl_seed = captr->repl_seed * 1103515245 + 12345;
+      captr->repl_rand = captr->repl_seed >> 16;
+      break;
+
+    default:
+      break;
+    }
+}
+
+
+
+/*=============================================================================
+ * Victim rank of a line; among candidates of the same state class the
+ * line with the highest rank is replaced.
+ */
+
+unsigned Repl_rank(CACHE *captr, cline_t *pline)
+{
+  switch (captr->replacement)
+    {
+    case LRU:
+      return captr->repl_clock - pline->age;
+
+    case PLRU:
+      return Repl_plru_rank(captr, pline);
+
+    case SRRIP:
+    case BRRIP:
+    case DRRIP:
+      return pline->age;
+
+    case RANDOM_REPL:
+      return (pline->index - captr->repl_rand) & captr->set_mask;
+
+    default:
+      return 0;
+    }
+}
+
+
+
+/*=============================================================================
+ * Update replacement state when a line is filled. 'replaced' is set if
+ * a valid line was evicted; RRIP policies then age the whole set so that
+ * the victim's RRPV would have reached the maximum.
+ */
+
+void Repl_fill(CACHE *captr, cline_t *pline, int replaced)
+{
+  cline_t *cline;
+  int      i, delta, policy;
+
+  switch (captr->replacement)
+    {
+    case LRU:
+      pline->age = ++captr->repl_clock;
+      break;
+
+    case PLRU:
+      Repl_plru_touch(captr, pline);
+      break;
+
+    case SRRIP:
+    case BRRIP:
+    case DRRIP:
+      if (replaced && pline->age < RRPV_MAX)
+	{
+	  delta = RRPV_MAX - pline->age;
+	  cline = &(captr->tags[pline->index & ~captr->set_mask]);
+	  for (i = 0; i < captr->setsz; i++, cline++)
+	    cline->age = MIN(cline->age + delta, RRPV_MAX);
+	}
+
+      policy = captr->replacement;
+      if (policy == DRRIP)
+	{
+	  policy = Repl_leader(captr, pline->index >> captr->set_shift);
+	  if (policy == DRRIP)
+	    policy = captr->psel > PSEL_MAX / 2 ? BRRIP : SRRIP;
+	}
+
+      if (policy == BRRIP &&
+	  (captr->brrip_count++ % BRRIP_EPSILON) != 0)
+	pline->age = RRPV_MAX;
+      else
+	pline->age = RRPV_MAX - 1;
+      break;
+
+    default:
+      break;
+    }
+}
@@ -150,6 +150,7 @@ typedef struct _req_
   ReqType  cohe_type;                  /* result of coherence check          */
   unsigned vaddr;                      /* virtual address requested          */
   unsigned paddr;                      /* physical address requested         */
+  unsigned pc;                         /* PC of issuing instruction          */
   int      ifetch;                     /* distinguish data/instructions      */
   int      size;                       /* size of data requested             */
   int      memattributes;              /* page attributes                    */
@@ -159,6 +160,8 @@ typedef struct _req_
   short    data_done;     /* REQUEST: has data returned?                     */
   short    cohe_done;     /* REQUEST: is coherence check done?               */
   short    cohe_count;    /* REQUEST: how many cohe reports are expected?    */
+  short    snoopers;      /* REQUEST: how many L2 caches snoop it?           */
+  short    dir_shared;    /* REQUEST: directory saw other sharers?           */
   short    c2c_copy;      /* REQUEST: data provided by cache-to-cache copy?  */
   short    data_rtn;      /* REQUEST: has data returned from memory          */
   short    bus_cycles;    /* how many bus cycles this req needs              */
@@ -106,7 +106,7 @@ void SysControl_init(void)
  
 	  SysControls[i * ARCH_cpus + k] = scp;
  
-	  scp->above = PID2L1D(i, k);
+	  scp->above = PID2L1D(i, SMT_CORE(k));
 
 	  scp->below = PID2L2C(i, k);
 
@@ -193,7 +193,7 @@ int SysControl_local_request(int gid, REQ *req)
 
   old_addr = req->paddr;
   req->paddr = req->paddr - SYSCONTROL_LOCAL_LOW + SYSCONTROL_THIS_LOW(gid % ARCH_cpus);
-  ReplaceAddr(req->d.proc_data.inst, req->paddr);
+  ReplaceAddr(req->d.proc_data.proc_id, req->d.proc_data.inst, req->paddr);
 
   PerformData(req);
   MemDoneHeapInsert(req, IOHIT);
@@ -204,7 +204,7 @@ int SysControl_local_request(int gid, REQ *req)
 
 
   req->paddr = old_addr;
-  ReplaceAddr(req->d.proc_data.inst, req->paddr);  
+  ReplaceAddr(req->d.proc_data.proc_id, req->d.proc_data.inst, req->paddr);
   
   YS__PoolReturnObj(&YS__ReqPool, req);
 
@@ -241,7 +241,8 @@ int SysControl_external_request(int gid, REQ *req)
     {
       req->paddr = req->paddr - SYSCONTROL_LOCAL_LOW + SYSCONTROL_THIS_LOW(gid % ARCH_cpus);
       if (req->src_proc < ARCH_cpus)
-	ReplaceAddr(req->d.proc_data.inst, req->paddr);
+	ReplaceAddr(req->d.proc_data.proc_id, req->d.proc_data.inst,
+		    req->paddr);
     }
 
 
@@ -263,7 +264,8 @@ int SysControl_external_request(int gid, REQ *req)
 	    {
 	      creq->paddr = creq->paddr - SYSCONTROL_LOCAL_LOW + SYSCONTROL_THIS_LOW(gid % ARCH_cpus);
 	      if (req->src_proc < ARCH_cpus)
-		ReplaceAddr(creq->d.proc_data.inst, creq->paddr);
+		ReplaceAddr(creq->d.proc_data.proc_id, creq->d.proc_data.inst,
+			    creq->paddr);
 	    }
 
 	  creq->perform(creq);
@@ -274,7 +276,8 @@ int SysControl_external_request(int gid, REQ *req)
 	  
 	  creq->paddr = old_addr;
 	  if (req->src_proc < ARCH_cpus)
-	    ReplaceAddr(creq->d.proc_data.inst, creq->paddr);
+	    ReplaceAddr(creq->d.proc_data.proc_id, creq->d.proc_data.inst,
+			creq->paddr);
 	  creq->complete(creq, IOHIT);
 
 	  YS__PoolReturnObj(&YS__ReqPool, creq);
@@ -66,6 +66,8 @@
 #include "Caches/req.h"
 #include "Caches/cache.h"
 #include "Caches/cache_stat.h"
+#include "Caches/l3cache.h"
+#include "Memory/directory.h"
 #include "Caches/ubuf.h"
 #include "Caches/syscontrol.h"
 #include "IO/addr_map.h"
@@ -85,6 +87,7 @@ int ARCH_numnodes   = 1;
 int ARCH_mynodes    = 1;
 int ARCH_firstnode  = 0;
 int ARCH_cpus       = 1;
+int SMT_THREADS     = 1;
 int ARCH_ios        = 0;
 int ARCH_coh_ios    = 0;
 
@@ -123,9 +126,9 @@ const char *ReqName[REQ_TYPE_MAX] =
 /*=========================================================================*/
 /* Called by UserMain() to initialize the system. In the current           */
 /* simulator, the memory system is composed of L1 cache with write buffer, */
-/* L2 cache, system bus (i.e. cluster bus), main memory controller,        */
-/* DRAM backend, PCI bridge, zero or more Adaptec PCI SCSI controllers,    */
-/* and a realtime clock.                                                   */
+/* L2 cache, system bus (i.e. cluster bus), main memory controller with   */
+/* an optional shared L3 cache, DRAM backend, PCI bridge, zero or more     */
+/* Adaptec PCI SCSI controllers, and a realtime clock.                     */
 /*=========================================================================*/
 
 void SystemInit()
@@ -232,6 +235,10 @@ void StatReport(int node)
       if (!Proc_stat_report(node, n))
 	continue;
 
+      /* the other contexts of an SMT core report with the core's caches */
+      if (n != SMT_CORE(n))
+	continue;
+
       YS__statmsg(node,
 		  "------------------------------------------------------------------------\n\n");
       YS__statmsg(node,
@@ -249,6 +256,28 @@ void StatReport(int node)
       UBuffer_stat_report(node, n);
     }
 
+  if (L3Caches)
+    {
+      YS__statmsg(node,
+		  "------------------------------------------------------------------------\n\n");
+      YS__statmsg(node,
+		  "SHARED L3 CACHE STATISTICS\n\n");
+
+      L3Cache_print_params(node);
+      L3Cache_stat_report(node);
+    }
+
+  if (Directories)
+    {
+      YS__statmsg(node,
+		  "------------------------------------------------------------------------\n\n");
+      YS__statmsg(node,
+		  "DIRECTORY STATISTICS\n\n");
+
+      Directory_print_params(node);
+      Directory_stat_report(node);
+    }
+
   YS__statmsg(node,
 	  "------------------------------------------------------------------------\n\n");
   YS__statmsg(node,
@@ -323,6 +352,10 @@ void StatClear(int node)
       UBuffer_stat_clear (node, n);
     }
 
+  if (L3Caches)
+    L3Cache_stat_clear (node);
+  if (Directories)
+    Directory_stat_clear (node);
   Bus_stat_clear       (node);
   MMC_stat_clear       (node);
   DRAM_stat_clear      (node);
@@ -70,8 +70,19 @@ extern int EXIT;
 
 
 #define MAX_NODES           32        /* maximum number of nodes             */
-#define MAX_MEMSYS_PROCS    16        /* maximum number of CPUs per node     */
-#define MAX_MEMSYS_SNOOPERS 24        /* maximum number of snoopers per node */
+#define MAX_MEMSYS_PROCS    32        /* maximum number of CPUs per node     */
+#define MAX_MEMSYS_SNOOPERS 40        /* maximum number of snoopers per node */
+
+
+/*
+ * Set of CPUs or bus modules of one node, one bit per module. Used for the
+ * bus arbitration masks, the L3 presence bits and the directory sharer
+ * vectors, so it must hold all CPUs, I/O modules and the memory controller.
+ */
+typedef unsigned long long modmask_t;
+
+#define MODMASK_BITS        64
+#define MODMASK_BIT(n)      ((modmask_t)1 << (n))
 
 
 /*
@@ -81,6 +92,7 @@ extern int ARCH_numnodes;  /* total number of nodes in system                */
 extern int ARCH_mynodes;   /* number of nodes local to this simulator        */
 extern int ARCH_firstnode; /* first node in this simulator                   */
 extern int ARCH_cpus;      /* number of cpus per node                        */
+extern int SMT_THREADS;    /* hardware contexts per SMT core                 */
 extern int ARCH_ios;       /* number of I/O (other) bus modules per node     */
 extern int ARCH_coh_ios;   /* number of coherent I/O modules per node        */
 extern int ARCH_cacsz1i;   /* L1 I-cache size                                */
@@ -94,6 +106,13 @@ extern int ARCH_cacsz2;    /* L2 cache size                                  */
 extern int ARCH_setsz2;    /* L2 cache associativity                         */
 extern int ARCH_linesz2;   /* L2 cache line size                             */
 
+/*
+ * The contexts of an SMT core share the caches, write buffer and uncached
+ * buffer of its first context. Requests are routed to those and carry the
+ * global id of the issuing context only for completion.
+ */
+#define SMT_CORE(gid)       ((gid) - (gid) % SMT_THREADS)
+
 extern int CPU_CLK_PERIOD;
 extern unsigned int PHYSICAL_MEMORY;
 
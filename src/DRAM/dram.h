@@ -71,6 +71,7 @@ typedef struct dram_trans
   unsigned char	
     locked       : 1,          /* is locked at the head of waiting queue?    */
     open_row     : 1,          /* leave row open after this access?          */
+    marked       : 1,          /* belongs to the current scheduling batch?   */
     is_write     : 1;          /* 0 -- read access; 1 -- write access        */
 } dram_trans_t;
 
@@ -132,6 +133,9 @@ typedef struct _databuf_
 
 
 
+/* Maximum number of DDR4 bank groups per rank */
+#define DDR_MAX_BANK_GROUPS 8
+
 typedef struct _chip_
 {
   int           id;
@@ -140,6 +144,15 @@ typedef struct _chip_
   int           last_type;                 /* Is last access a write/read?   */
   int           last_bank;                 /* the bank the last access goes  */
 
+  /* DDR3/DDR4 only; a chip models one rank */
+  rsim_time_t   act_hist[4];               /* last four ACTs (tFAW window)   */
+  int           act_next;                  /* oldest entry in act_hist       */
+  rsim_time_t   last_act;                  /* last ACT to any bank           */
+  rsim_time_t   last_cas;                  /* last read/write to any bank    */
+  rsim_time_t   bg_act[DDR_MAX_BANK_GROUPS]; /* last ACT per bank group      */
+  rsim_time_t   bg_cas[DDR_MAX_BANK_GROUPS]; /* last CAS per bank group      */
+  rsim_time_t   wr_end;                    /* end of last write data burst   */
+
   EVENT        *refresh_event;             /* refreshing task                */
   int 	        refresh_needed;            /* need refresh                   */
   int 		refresh_on;                /* refresh operation is underway  */
@@ -173,6 +186,9 @@ typedef struct
 
 
 
+/* Bins of the log2 queueing delay histogram */
+#define DRAM_QHIST_BINS 12
+
 /* Bank-related statistics. One for each DRAM bank */
 typedef struct
 {
@@ -188,6 +204,10 @@ typedef struct
   double     queue_cycles;         /* time spent on the waiting queue        */
   double     access_cycles;        /* sum of the latency of all accesses     */
   long long  overlap;              /* total overlapped cycles                */
+  long long  reorders;             /* accesses scheduled ahead of the head   */
+  long long  batches;              /* request batches formed                 */
+  long long  write_drains;         /* write drain episodes                   */
+  long long  queue_hist[2][DRAM_QHIST_BINS]; /* read/write queueing delay    */
 } dbank_stat_t;
 
 
@@ -209,6 +229,10 @@ typedef	struct _bank_
   rsim_time_t    expire;           /* by when the hot row is expired         */
   char		 hitmiss;          /* hot row hit/miss history               */
   int            last_type;        /* Is last access a write/read?           */
+  int            batch_left;       /* marked accesses left in current batch  */
+  int            group;            /* DDR4 bank group within the rank        */
+  rsim_time_t    pre_ready;        /* DDR: earliest PRE of the open row      */
+  int            draining;         /* writes are being drained               */
 
   dbank_stat_t   stats;            /* statistics                             */
 } dram_bank_t;
@@ -221,6 +245,7 @@ typedef	struct _bank_
 typedef struct
 {
   char	          nodeid;	       /* processor ID                       */
+  int             channel;             /* memory channel of this backend     */
   LinkQueue       freedramlist;        /* free dram transactions             */
   dram_sa_bus_t   sa_bus;              /* Slave Address busses               */
   dram_sd_bus_t   sd_bus;              /* Slave Data busses                  */
@@ -233,6 +258,9 @@ typedef struct
   rsim_time_t     total_cycles;        /*   of a DRAM access.                */
   long long       sgle_count;          /* statistics for the average cycles  */
   rsim_time_t     sgle_cycles;         /*   of a DRAM access.                */
+  long long       refreshes;           /* DDR: rank refresh operations       */
+  long long       faw_waits;           /* DDR: ACTs delayed by tFAW          */
+  long long       wtr_waits;           /* DDR: reads delayed by tWTR         */
 
   LinkQueue       waitlist;
   EVENT          *pevent;
@@ -242,7 +270,9 @@ typedef struct
 
 extern dram_info_t *DBs;
 
-#define NID2DRAM(nid)	&(DBs[(nid)])
+/* One backend per memory channel, channels of a node are adjacent */
+#define NID2DRAM(nid)	&(DBs[(nid) * dparam.channels])
+#define DRAM_CHANNEL(nid, ch)	&(DBs[(nid) * dparam.channels + (ch)])
 
 
 
@@ -251,9 +281,19 @@ extern dram_info_t *DBs;
 /********************* Useful macros **************************************/
 /**************************************************************************/
 
-/* Find the associated bank for a specified physical address */
-#define DRAM_paddr_to_bank(pdb, paddr)			\
-           (&(pdb->banks[(paddr >> dparam.bank_shift) & dparam.bank_mask]))
+/* Find the memory channel that serves a physical address */
+#define DRAM_paddr_to_channel(paddr)				\
+           (((paddr) >> dparam.chan_shift) & dparam.chan_mask)
+
+/*
+ * Find the associated bank for a specified physical address. With bank
+ * XOR hashing, the low row bits are folded into the bank index so that
+ * rows conflicting in one bank are spread across banks.
+ */
+#define DRAM_paddr_to_bank(pdb, paddr)				\
+           (&(pdb->banks[(((paddr) >> dparam.bank_shift) ^	\
+                          (((paddr) >> dparam.row_shift) &	\
+                           dparam.xor_mask)) & dparam.bank_mask]))
 
 /* Find the associated chip for a bank */
 #define DRAM_bankid_to_chip(pdb, bankid)			\
@@ -317,6 +357,8 @@ void          DRAM_access_SDRAM_bank (dram_info_t *, dram_trans_t *,
 				      rsim_time_t);
 void          DRAM_access_RDRAM_bank (dram_info_t *, dram_trans_t *,
 				      rsim_time_t);
+void          DRAM_access_DDR_bank   (dram_info_t *, dram_trans_t *,
+				      rsim_time_t);
 void          DRAM_bank_done         (void);
 void          DRAM_databuf_data_ready (void);
 void          DRAM_databuf_done       (void);
@@ -332,8 +374,18 @@ void          DRAM_nosim_done        (void);
 
 
 
+/* dram_sched.c */
+bank_queue_elm_t *DRAM_sched_select  (dram_bank_t *pbank);
+int           DRAM_sched_row_pending (dram_bank_t *pbank, dram_trans_t *);
+void          DRAM_sched_stat        (dram_bank_t *pbank, dram_trans_t *,
+				      rsim_time_t delay);
+char         *DRAM_sched_name        (int policy);
+
+
+
 /* dram_refresh.c */
 void          DRAM_refresh           (void);
+void          DRAM_refresh_chip      (dram_info_t *pdb, dram_chip_t *pchip);
 void          DRAM_refresh_done      (void);
 void          DRAM_start_refresh     (dram_info_t *pdb, int bank);
 int           DRAM_do_refresh        (dram_info_t *pdb, int bank);
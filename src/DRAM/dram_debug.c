@@ -73,9 +73,9 @@ void DRAM_exit(void)
   int   i, j, k;
   dram_info_t  *pdb;
 
-  for (i = 0; i < ARCH_numnodes; i++)
+  for (i = 0; i < ARCH_numnodes * dparam.channels; i++)
     {
-      dram_info_t *pdb = NID2DRAM(i);
+      dram_info_t *pdb = &(DBs[i]);
       
       for (k = 0; k < dparam.num_banks; k++)
 	{
@@ -93,13 +93,25 @@ void DRAM_exit(void)
  * queues in SA busses, SD busses, RD busses, and DRAM banks. The output
  * seems a little bit messy, put finer control later.
  */
+static void DRAM_channel_dump(int nodeid, dram_info_t *pdb);
+
 void DRAM_dump(int nodeid)
 {
-  dram_info_t  *pdb = &(DBs[nodeid]);
+  int c;
+
+  for (c = 0; c < dparam.channels; c++)
+    DRAM_channel_dump(nodeid, DRAM_CHANNEL(nodeid, c));
+}
+
+
+
+static void DRAM_channel_dump(int nodeid, dram_info_t *pdb)
+{
   dram_trans_t *dtrans;
   int k;
 
-  YS__logmsg(nodeid, "\n====== DRAM Scheduler ======\n");
+  YS__logmsg(nodeid, "\n====== DRAM Scheduler (channel %d) ======\n",
+	     pdb->channel);
  
   if (dparam.sim_on == 0)
     {
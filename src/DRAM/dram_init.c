@@ -151,6 +151,26 @@ void DRAM_read_params(void)
   get_parameter("DRAM_interleaving",   &dparam.interleaving,   PARAM_INT);
   get_parameter("DRAM_max_bwaiters",   &dparam.max_bwaiters,   PARAM_INT);
 
+  /*
+   * Memory channels are set up by the MMC; the address map decides
+   * whether channel or bank bits come first above the interleaving unit.
+   */
+  dparam.channels = mparam.channels;
+  dparam.addr_map = DRAM_MAP_ROW_BANK_CHAN;
+  dparam.bank_xor = 0;
+
+  if (get_parameter("DRAM_addr_map", tmpbuf, PARAM_STRING))
+    {
+      if (!strcasecmp(tmpbuf, "RoBaCh"))
+	dparam.addr_map = DRAM_MAP_ROW_BANK_CHAN;
+      else if (!strcasecmp(tmpbuf, "RoChBa"))
+	dparam.addr_map = DRAM_MAP_ROW_CHAN_BANK;
+      else
+	YS__errmsg(0, "Unknown DRAM address map %s\n", tmpbuf);
+    }
+
+  get_parameter("DRAM_bank_xor",       &dparam.bank_xor,       PARAM_INT);
+
   if (dparam.rd_busses > DRAM_MAX_RD_BUSSES)
     YS__errmsg(0, "Too many smcs: %d (DRAM_init)\n", dparam.rd_busses);
 
@@ -183,6 +203,10 @@ void DRAM_read_params(void)
 	dparam.dram_type = SDRAM;
       else if (!strcmp(tmpbuf, "RDRAM"))
 	dparam.dram_type = RDRAM;
+      else if (!strcmp(tmpbuf, "DDR3"))
+	dparam.dram_type = DDR3;
+      else if (!strcmp(tmpbuf, "DDR4"))
+	dparam.dram_type = DDR4;
       else
 	YS__errmsg(0, "Unknown DRAM type %s\n", tmpbuf);
     }
@@ -192,6 +216,39 @@ void DRAM_read_params(void)
   get_parameter("DRAM_mini_access",      &dparam.mini_access,    PARAM_INT);
   get_parameter("DRAM_block_size",       &dparam.block_size,     PARAM_INT);
 
+  /*
+   * Bank waiting queue scheduling.
+   */
+  dparam.sched_policy = DRAM_SCHED_FCFS;
+  dparam.batch_cap    = DRAM_BATCH_CAP;
+  dparam.write_high   = (dparam.bank_depth * 3) / 4;
+  dparam.write_low    = dparam.bank_depth / 4;
+
+  if (get_parameter("DRAM_sched_policy", tmpbuf, PARAM_STRING))
+    {
+      for (dparam.sched_policy = DRAM_SCHED_FCFS;
+	   dparam.sched_policy <= DRAM_SCHED_RDFIRST;
+	   dparam.sched_policy++)
+	if (!strcasecmp(tmpbuf, DRAM_sched_name(dparam.sched_policy)))
+	  break;
+
+      if (dparam.sched_policy > DRAM_SCHED_RDFIRST)
+	YS__errmsg(0, "Unknown DRAM scheduling policy %s\n", tmpbuf);
+    }
+
+  get_parameter("DRAM_batch_cap",        &dparam.batch_cap,      PARAM_INT);
+  get_parameter("DRAM_write_high",       &dparam.write_high,     PARAM_INT);
+  get_parameter("DRAM_write_low",        &dparam.write_low,      PARAM_INT);
+
+  if (dparam.batch_cap < 1)
+    YS__errmsg(0, "DRAM_batch_cap must be positive: %d (DRAM_init)\n",
+	       dparam.batch_cap);
+
+  if (dparam.write_low >= dparam.write_high ||
+      dparam.write_high > dparam.bank_depth)
+    YS__errmsg(0, "Bad write drain watermarks %d/%d (DRAM_init)\n",
+	       dparam.write_low, dparam.write_high);
+
   if (dparam.dram_type == SDRAM)
     {
       dparam.dtime.s.CCD    = SDRAM_tCCD;
@@ -219,7 +276,7 @@ void DRAM_read_params(void)
       get_parameter("SDRAM_refresh_delay", &dparam.refresh_delay,  PARAM_INT);
       get_parameter("SDRAM_refresh_period",&dparam.refresh_period, PARAM_INT);
     }
-  else
+  else if (dparam.dram_type == RDRAM)
     {
       dparam.dtime.r.PACKET = RDRAM_tPACKET;
       dparam.dtime.r.RC     = RDRAM_tRC;
@@ -246,6 +303,81 @@ void DRAM_read_params(void)
       get_parameter("RDRAM_refresh_delay", &dparam.refresh_delay,  PARAM_INT);
       get_parameter("RDRAM_refresh_period",&dparam.refresh_period, PARAM_INT);
     }
+  else
+    {
+      if (dparam.dram_type == DDR3)
+	{
+	  dparam.dtime.d.CL    = DDR3_tCL;
+	  dparam.dtime.d.CWL   = DDR3_tCWL;
+	  dparam.dtime.d.RCD   = DDR3_tRCD;
+	  dparam.dtime.d.RP    = DDR3_tRP;
+	  dparam.dtime.d.RAS   = DDR3_tRAS;
+	  dparam.dtime.d.CCD_S = DDR3_tCCD;
+	  dparam.dtime.d.CCD_L = DDR3_tCCD;
+	  dparam.dtime.d.RRD_S = DDR3_tRRD;
+	  dparam.dtime.d.RRD_L = DDR3_tRRD;
+	  dparam.dtime.d.FAW   = DDR3_tFAW;
+	  dparam.dtime.d.WTR   = DDR3_tWTR;
+	  dparam.dtime.d.RTP   = DDR3_tRTP;
+	  dparam.dtime.d.WR    = DDR3_tWR;
+	  dparam.refresh_delay  = DDR3_tRFC;
+	  dparam.refresh_period = DDR3_tREFI;
+	  dparam.bank_groups    = 1;
+	}
+      else
+	{
+	  dparam.dtime.d.CL    = DDR4_tCL;
+	  dparam.dtime.d.CWL   = DDR4_tCWL;
+	  dparam.dtime.d.RCD   = DDR4_tRCD;
+	  dparam.dtime.d.RP    = DDR4_tRP;
+	  dparam.dtime.d.RAS   = DDR4_tRAS;
+	  dparam.dtime.d.CCD_S = DDR4_tCCD_S;
+	  dparam.dtime.d.CCD_L = DDR4_tCCD_L;
+	  dparam.dtime.d.RRD_S = DDR4_tRRD_S;
+	  dparam.dtime.d.RRD_L = DDR4_tRRD_L;
+	  dparam.dtime.d.FAW   = DDR4_tFAW;
+	  dparam.dtime.d.WTR   = DDR4_tWTR;
+	  dparam.dtime.d.RTP   = DDR4_tRTP;
+	  dparam.dtime.d.WR    = DDR4_tWR;
+	  dparam.refresh_delay  = DDR4_tRFC;
+	  dparam.refresh_period = DDR4_tREFI;
+	  dparam.bank_groups    = MIN(DDR4_BANK_GROUPS, dparam.banks_per_chip);
+	}
+      dparam.dtime.d.BL = DDR_BL;
+      dparam.burst_chop = 0;
+
+      get_parameter("DDR_tCL",       &dparam.dtime.d.CL,     PARAM_INT);
+      get_parameter("DDR_tCWL",      &dparam.dtime.d.CWL,    PARAM_INT);
+      get_parameter("DDR_tRCD",      &dparam.dtime.d.RCD,    PARAM_INT);
+      get_parameter("DDR_tRP",       &dparam.dtime.d.RP,     PARAM_INT);
+      get_parameter("DDR_tRAS",      &dparam.dtime.d.RAS,    PARAM_INT);
+      get_parameter("DDR_tCCD_S",    &dparam.dtime.d.CCD_S,  PARAM_INT);
+      get_parameter("DDR_tCCD_L",    &dparam.dtime.d.CCD_L,  PARAM_INT);
+      get_parameter("DDR_tRRD_S",    &dparam.dtime.d.RRD_S,  PARAM_INT);
+      get_parameter("DDR_tRRD_L",    &dparam.dtime.d.RRD_L,  PARAM_INT);
+      get_parameter("DDR_tFAW",      &dparam.dtime.d.FAW,    PARAM_INT);
+      get_parameter("DDR_tWTR",      &dparam.dtime.d.WTR,    PARAM_INT);
+      get_parameter("DDR_tRTP",      &dparam.dtime.d.RTP,    PARAM_INT);
+      get_parameter("DDR_tWR",       &dparam.dtime.d.WR,     PARAM_INT);
+      get_parameter("DDR_tRFC",      &dparam.refresh_delay,  PARAM_INT);
+      get_parameter("DDR_tREFI",     &dparam.refresh_period, PARAM_INT);
+      get_parameter("DDR_burst_length", &dparam.dtime.d.BL, PARAM_INT);
+      get_parameter("DDR_burst_chop",   &dparam.burst_chop,  PARAM_INT);
+      get_parameter("DDR_bank_groups",  &dparam.bank_groups, PARAM_INT);
+
+      get_parameter("DDR_row_size",      &dparam.row_size,      PARAM_INT);
+      get_parameter("DDR_row_hold_time", &dparam.row_hold_time, PARAM_INT);
+
+      if (dparam.bank_groups < 1 ||
+	  dparam.bank_groups > DDR_MAX_BANK_GROUPS ||
+	  dparam.banks_per_chip % dparam.bank_groups)
+	YS__errmsg(0, "Bad number of bank groups %d for %d banks per chip "
+		   "(DRAM_init)\n", dparam.bank_groups, dparam.banks_per_chip);
+
+      if (dparam.dtime.d.BL != 4 && dparam.dtime.d.BL != 8)
+	YS__errmsg(0, "DDR burst length must be 4 or 8: %d (DRAM_init)\n",
+		   dparam.dtime.d.BL);
+    }
 
   
   /* 
@@ -254,7 +386,8 @@ void DRAM_read_params(void)
    */
   dparam.num_chips    = dparam.num_banks / dparam.banks_per_chip;
   dparam.width_shift  = NumOfBits(dparam.width, 1);
-  dparam.row_shift    = NumOfBits(dparam.row_size * dparam.num_banks, 1);
+  dparam.row_shift    = NumOfBits(dparam.row_size * dparam.num_banks *
+				  dparam.channels, 1);
   dparam.sd_bus_shift = NumOfBits(dparam.sd_bus_width, 1);
 
   if (!(dparam.interleaving & 1)) /* 0 or 2*/
@@ -262,7 +395,17 @@ void DRAM_read_params(void)
   else /* 1 or 3 */
     dparam.bank_shift = NumOfBits(dparam.row_size, 1);
 
+  if (dparam.addr_map == DRAM_MAP_ROW_BANK_CHAN)
+    {
+      dparam.chan_shift  = dparam.bank_shift;
+      dparam.bank_shift += NumOfBits(dparam.channels, 1);
+    }
+  else
+    dparam.chan_shift  = dparam.bank_shift + NumOfBits(dparam.num_banks, 1);
+
+  dparam.chan_mask     = dparam.channels - 1;
   dparam.bank_mask     = dparam.num_banks - 1;
+  dparam.xor_mask      = dparam.bank_xor ? dparam.bank_mask : 0;
   dparam.chip_shift    = NumOfBits(dparam.banks_per_chip, 1);
   dparam.chip_mask     = dparam.num_chips - 1;
   dparam.rd_bus_shift  = NumOfBits(dparam.num_banks / dparam.rd_busses, 1);
@@ -299,7 +442,7 @@ void DRAM_read_params(void)
 	dparam.dtime.s.RCD + dparam.dtime.s.AA + 
 	dparam.dtime.s.PACKET;
     }
-  else
+  else if (dparam.dram_type == RDRAM)
     {
       dparam.dtime.r.PACKET *= dparam.frequency;
       dparam.dtime.r.RC     *= dparam.frequency;
@@ -314,6 +457,28 @@ void DRAM_read_params(void)
       dparam.co2d_cycles = dparam.dtime.r.RCD + dparam.dtime.r.PACKET + 
 	dparam.dtime.r.CAC + dparam.dtime.r.RP;
     }
+  else
+    {
+      dparam.dtime.d.CL    *= dparam.frequency;
+      dparam.dtime.d.CWL   *= dparam.frequency;
+      dparam.dtime.d.RCD   *= dparam.frequency;
+      dparam.dtime.d.RP    *= dparam.frequency;
+      dparam.dtime.d.RAS   *= dparam.frequency;
+      dparam.dtime.d.CCD_S *= dparam.frequency;
+      dparam.dtime.d.CCD_L *= dparam.frequency;
+      dparam.dtime.d.RRD_S *= dparam.frequency;
+      dparam.dtime.d.RRD_L *= dparam.frequency;
+      dparam.dtime.d.FAW   *= dparam.frequency;
+      dparam.dtime.d.WTR   *= dparam.frequency;
+      dparam.dtime.d.RTP   *= dparam.frequency;
+      dparam.dtime.d.WR    *= dparam.frequency;
+
+      /*
+       * Data is transferred on both clock edges.
+       */
+      dparam.co2d_cycles = dparam.dtime.d.RCD + dparam.dtime.d.CL + 
+	dparam.dtime.d.RP + (dparam.dtime.d.BL >> 1) * dparam.frequency;
+    }
 }
 
 
@@ -334,7 +499,23 @@ void DRAM_bank_init(dram_info_t *pdb, int bid)
   pbank->expire    = 0;
   pbank->hitmiss   = 0;
   pbank->last_type = DRAM_READ;
+  pbank->batch_left = 0;
+  pbank->draining  = 0;
   pbank->chip      = DRAM_bankid_to_chip(pdb, bid);
+  pbank->pre_ready = 0;
+
+  /*
+   * Consecutive banks of a chip (rank) go to different bank groups.
+   */
+  if (DRAM_IS_DDR(dparam.dram_type))
+    {
+      if (dparam.interleaving & 2)
+	pbank->group = (bid & (dparam.banks_per_chip - 1)) % dparam.bank_groups;
+      else
+	pbank->group = (bid / dparam.num_chips) % dparam.bank_groups;
+    }
+  else
+    pbank->group = 0;
 
   /*
    * Initialize the waiting queue.
@@ -366,7 +547,7 @@ void DRAM_bank_init(dram_info_t *pdb, int bid)
  */
 void DRAM_init(void)
 {
-  int           i, j, k;
+  int           i, j, k, n;
   dram_info_t   *pdb;
   dram_trans_t  *dtrans;
 
@@ -375,13 +556,14 @@ void DRAM_init(void)
    */
   DRAM_read_params();
 
-  if (!(DBs = RSIM_CALLOC(dram_info_t, ARCH_numnodes)))
+  if (!(DBs = RSIM_CALLOC(dram_info_t, ARCH_numnodes * dparam.channels)))
     YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
 
-  for (i = 0; i < ARCH_numnodes; i++)
+  for (n = 0; n < ARCH_numnodes * dparam.channels; n++)
     {
-      pdb         = &(DBs[i]);
-      pdb->nodeid = i;
+      pdb          = &(DBs[n]);
+      pdb->nodeid  = i = n / dparam.channels;
+      pdb->channel = n % dparam.channels;
 
       /* 
        * Queue up all the dram transactions into a free list.
@@ -495,6 +677,13 @@ void DRAM_init(void)
 	  pchip->refresh_event->ival1 = j;
 	  pchip->refresh_on           = 0;
 	  pchip->refresh_needed       = 0;
+
+	  pchip->act_next = 0;
+	  pchip->last_act = pchip->last_cas = pchip->wr_end = -1.0e9;
+	  for (k = 0; k < 4; k++)
+	    pchip->act_hist[k] = -1.0e9;
+	  for (k = 0; k < DDR_MAX_BANK_GROUPS; k++)
+	    pchip->bg_act[k] = pchip->bg_cas[k] = -1.0e9;
 	}
 
       /*
@@ -509,6 +698,18 @@ void DRAM_init(void)
       pdb->total_bwaiters = 0;
       pdb->total_count = 0;
       pdb->total_cycles = 0;
+      pdb->refreshes = 0;
+      pdb->faw_waits = 0;
+      pdb->wtr_waits = 0;
+
+      /*
+       * DDR ranks are refreshed every tREFI, staggered across the ranks.
+       */
+      if (DRAM_IS_DDR(dparam.dram_type))
+	for (j = 0; j < dparam.num_chips; j++)
+	  schedule_event(pdb->chips[j].refresh_event,
+			 (double)dparam.refresh_period * (j + 1) /
+			 dparam.num_chips);
     }
 }
 
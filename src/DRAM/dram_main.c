@@ -65,7 +65,7 @@
 void  DRAM_recv_request(int nodeid, mmc_trans_t *ptrans,
 			unsigned paddr, int size, int is_write)
 {
-  dram_info_t   *pdb = NID2DRAM(nodeid);
+  dram_info_t   *pdb = DRAM_CHANNEL(nodeid, DRAM_paddr_to_channel(paddr));
   dram_sa_bus_t *psabus;
   EVENT	        *pevent;
   dram_trans_t  *dtrans = DRAM_new_transaction(pdb, ptrans, paddr, size, 
@@ -141,7 +141,7 @@ void DRAM_arrive_smc(void)
    * - If the bank is busy, put the access into the waiting queue.
    * - otherwise, access the bank.
    */
-  if (pbank->busy || pbank->chip->refresh_on)
+  if (pbank->busy || pbank->chip->refresh_on || pbank->chip->refresh_needed)
     {
       if (Bank_queue_full(&(pbank->waiters)))
 	YS__errmsg(0, "pbank->waiters are full\n");
@@ -218,6 +218,10 @@ void  DRAM_access_bank(dram_info_t *pdb, dram_trans_t *dtrans,
 	case RDRAM:
 	  DRAM_access_RDRAM_bank(pdb, dtrans, starttime);
 	  break;
+	case DDR3:
+	case DDR4:
+	  DRAM_access_DDR_bank(pdb, dtrans, starttime);
+	  break;
 	default:
 	  YS__errmsg(pdb->nodeid, "Unkown DRAM type %d\n", dparam.dram_type);
 	}
@@ -253,6 +257,10 @@ void  DRAM_access_bank_aux1(dram_info_t *pdb, dram_trans_t *dtrans,
   if (dparam.dram_type == RDRAM) 
     nxttime = YS__Simtime + dparam.co2d_cycles + 
       dparam.dtime.r.PACKET * (size >> dparam.width_shift);
+  else if (DRAM_IS_DDR(dparam.dram_type))
+    nxttime = YS__Simtime + dparam.co2d_cycles +
+      (dparam.dtime.d.BL >> 1) * dparam.frequency *
+      ((size - 1) / (dparam.width * dparam.dtime.d.BL));
   else
     nxttime = YS__Simtime + dparam.co2d_cycles +  
       dparam.dtime.s.PACKET * (size >> dparam.width_shift);
@@ -357,6 +365,7 @@ void  DRAM_access_SDRAM_bank(dram_info_t *pdb, dram_trans_t *dtrans,
 	}
       
       pbank->stats.queue_cycles += start_time - dtrans->time;
+      DRAM_sched_stat(pbank, dtrans, start_time - dtrans->time);
       dtrans->time = start_time;
       if (start_time < prdbus->busy_until)
 	pbank->stats.overlap += prdbus->busy_until - start_time;
@@ -557,6 +566,7 @@ void DRAM_access_RDRAM_bank(dram_info_t *pdb, dram_trans_t *dtrans,
 	}
 
       pbank->stats.queue_cycles += start_time - dtrans->time;
+      DRAM_sched_stat(pbank, dtrans, start_time - dtrans->time);
       dtrans->time = start_time;
       if (start_time < prdbus->busy_until)
 	pbank->stats.overlap += prdbus->busy_until - start_time;
@@ -611,6 +621,174 @@ void DRAM_access_RDRAM_bank(dram_info_t *pdb, dram_trans_t *dtrans,
 
 
 
+/*
+ * DDR3/DDR4 SDRAM. A chip models one rank, split into bank groups, and
+ * the RD bus is the data bus of the rank. As for SDRAM, find the earliest
+ * time to issue the ACT and read/write commands under the bank, bank group
+ * and rank constraints, and then reserve the data bus. Precharge is
+ * folded into the next ACT of the bank through pre_ready.
+ */
+void DRAM_access_DDR_bank(dram_info_t *pdb, dram_trans_t *dtrans,
+			  rsim_time_t starttime)
+{
+  unsigned       paddr     = dtrans->paddr;
+  int            row_num   = paddr >> dparam.row_shift;
+  dram_bank_t   *pbank     = DRAM_paddr_to_bank(pdb, paddr);
+  dram_rd_bus_t *prdbus    = DRAM_bankid_to_rd_bus(pdb, pbank->id);
+  dram_chip_t   *pchip     = pbank->chip;
+  EVENT         *pevent    = pbank->pevent;
+  ddr_timing_t  *dt        = &(dparam.dtime.d);
+  int            group     = pbank->group;
+  int            burst     = dparam.width * dt->BL;
+  int            bursts, hit_row;
+  rsim_time_t    burst_time, gap, latency, act, cas, last_cas;
+  rsim_time_t    start_time, data_start, data_end;
+   
+  /*
+   * First, find out if it hits/misses on the hot row.
+   */
+  if (row_num == pbank->hot_row && pbank->expire > starttime) 
+    hit_row = 1;
+  else
+    hit_row = 0;
+
+  pbank->hitmiss = (pbank->hitmiss << 1) | (row_num == pbank->hot_row);
+
+  /*
+   * A burst transfers two beats per DRAM cycle. With burst chop, an access
+   * that fits into half a burst only transfers BL/2 beats, but successive
+   * bursts are still spaced by tCCD.
+   */
+  bursts     = (dtrans->size + burst - 1) / burst;
+  burst_time = (dt->BL >> 1) * dparam.frequency;
+  if (dparam.burst_chop && dt->BL == 8 && dtrans->size <= (burst >> 1))
+    burst_time /= 2;
+  gap = MAX(dt->CCD_L, burst_time);
+
+  /*
+   * Activate the row on a miss, after the precharge of the previous row
+   * and subject to tRRD_S/tRRD_L and the four-activate window of the rank.
+   */
+  act = starttime;
+  if (!hit_row)
+    {
+      act = MAX(act, pbank->pre_ready + dt->RP);
+      act = MAX(act, pchip->last_act + dt->RRD_S);
+      act = MAX(act, pchip->bg_act[group] + dt->RRD_L);
+      if (act < pchip->act_hist[pchip->act_next] + dt->FAW)
+	{
+	  act = pchip->act_hist[pchip->act_next] + dt->FAW;
+	  if (dparam.collect_stats)
+	    pdb->faw_waits++;
+	}
+
+      pchip->act_hist[pchip->act_next] = act;
+      pchip->act_next      = (pchip->act_next + 1) & 3;
+      pchip->last_act      = MAX(pchip->last_act, act);
+      pchip->bg_act[group] = MAX(pchip->bg_act[group], act);
+      cas = act + dt->RCD;
+    }
+  else
+    cas = starttime;
+
+  /*
+   * Column command: tCCD_S/tCCD_L to earlier reads/writes of the rank,
+   * write-to-read turnaround, and a free data bus for the data burst.
+   */
+  cas = MAX(cas, pchip->last_cas + dt->CCD_S);
+  cas = MAX(cas, pchip->bg_cas[group] + dt->CCD_L);
+  if (!dtrans->is_write && cas < pchip->wr_end + dt->WTR)
+    {
+      cas = pchip->wr_end + dt->WTR;
+      if (dparam.collect_stats)
+	pdb->wtr_waits++;
+    }
+
+  latency    = dtrans->is_write ? dt->CWL : dt->CL;
+  start_time = hit_row ? cas : act;
+
+  /*
+   * Collect statistics.
+   */
+  if (dparam.collect_stats)
+    {
+      prdbus->count++;
+      prdbus->cycles += burst_time * bursts;
+      if (cas + latency < prdbus->busy_until)
+	{
+	  prdbus->waits++;
+	  prdbus->wcycles += prdbus->busy_until - (cas + latency);
+	  prdbus->cycles  += prdbus->busy_until - (cas + latency);
+	}
+
+      if (hit_row)
+	{
+	  if (dtrans->is_write)
+	    pbank->stats.write_hits++;
+	  else  
+	    pbank->stats.read_hits++;
+	}
+      else if (pbank->expire > starttime)
+	{
+	  if (dtrans->is_write)
+	    pbank->stats.write_misses++;
+	  else  
+	    pbank->stats.read_misses++;
+	}
+      
+      pbank->stats.queue_cycles += start_time - dtrans->time;
+      DRAM_sched_stat(pbank, dtrans, start_time - dtrans->time);
+      dtrans->time = start_time;
+      if (start_time < prdbus->busy_until)
+	pbank->stats.overlap += prdbus->busy_until - start_time;
+    }
+
+  if (cas + latency < prdbus->busy_until)
+    cas = prdbus->busy_until - latency;
+
+  data_start = cas + latency;
+  data_end   = data_start + (bursts - 1) * gap + burst_time;
+  last_cas   = cas + (bursts - 1) * gap;
+
+  /*
+   * Update the rank, bank group and data bus state.
+   */
+  pchip->last_cas      = MAX(pchip->last_cas, last_cas);
+  pchip->bg_cas[group] = MAX(pchip->bg_cas[group], last_cas);
+  prdbus->busy_until   = data_end;
+  if (dtrans->is_write)
+    pchip->wr_end = MAX(pchip->wr_end, data_end);
+
+  /*
+   * The row may be precharged tRAS after the ACT, tRTP after the last
+   * read or tWR after the write data. Without an open-row hint, auto
+   * precharge closes it as early as possible.
+   */
+  if (!hit_row)
+    pbank->pre_ready = act + dt->RAS;
+  if (dtrans->is_write)
+    pbank->pre_ready = MAX(pbank->pre_ready, data_end + dt->WR);
+  else
+    pbank->pre_ready = MAX(pbank->pre_ready, last_cas + dt->RTP);
+
+  pbank->hot_row = row_num;
+  if (dtrans->open_row)
+    pbank->expire = start_time + dparam.row_hold_time;
+  else
+    pbank->expire = 0;
+
+  pchip->last_bank = pbank->id;
+  pchip->last_type = dtrans->is_write;
+
+  /*
+   * Schedule the event to call DRAM_bank_done when the access is done.
+   */
+  pbank->busy = dtrans;
+  schedule_event(pevent, data_end);
+}
+
+
+
 /*
  * Called when a dram access is done.
  */
@@ -655,7 +833,8 @@ void DRAM_bank_done(void)
    */
   if (pbank->chip->refresh_needed)
     {
-      DRAM_refresh();
+      pbank->busy = 0;
+      DRAM_refresh_chip(pdb, pbank->chip);
     }
   else if (pbank->waiters.size > 0)
     {
@@ -820,8 +999,8 @@ void Bank_queue_enqueue(bank_queue_t *bq, dram_trans_t *dtrans)
 #define DRAM_STATUS_BITS 5
 
 /*
- * Dequeue the head of the bank waiting queue. Also, find out
- * if the hot row should remain open after this access.
+ * Dequeue the access selected by the bank scheduler from the bank waiting
+ * queue. Also, find out if the hot row should remain open after this access.
  */
 dram_trans_t * Bank_queue_dequeue(dram_bank_t *pbank)
 {
@@ -833,26 +1012,37 @@ dram_trans_t * Bank_queue_dequeue(dram_bank_t *pbank)
     YS__errmsg(0, "The waiting queue is empty\n");
 
   /*
-   * Dequeue the head of the waiting queue.
+   * Unlink the selected access, which is the head unless a reordering
+   * scheduling policy is in effect.
    */
+  qelm = DRAM_sched_select(pbank);
+  if (qelm != bq->head && dparam.collect_stats)
+    pbank->stats.reorders++;
+
   if (--bq->size == 0)
     {
-      qelm     = bq->head;
       bq->head = bq->tail = 0;
     }
   else
     {
-      qelm = bq->head;
-
-      bq->head = bq->head->next;
-      bq->head->prev = bq->tail;
-      bq->tail->next = bq->head;
+      qelm->prev->next = qelm->next;
+      qelm->next->prev = qelm->prev;
+      if (qelm == bq->head)
+	bq->head = qelm->next;
+      if (qelm == bq->tail)
+	bq->tail = qelm->prev;
     }
   
   dtrans     = qelm->data;
   qelm->next = bq->free;
   bq->free   = qelm;
 
+  if (dtrans->marked)
+    {
+      dtrans->marked = 0;
+      pbank->batch_left--;
+    }
+
   /*
    * Check the hot row hit/miss history to decide whether or not to leave
    * the hot row open after the access is done.
@@ -863,17 +1053,26 @@ dram_trans_t * Bank_queue_dequeue(dram_bank_t *pbank)
    *   * If the next transaction will access the same row, leave the hot row
    *     open after this access and lock the next one in the head.
    *   * Otherwise, use the selected hot-row algorithm.
+   * With a reordering scheduling policy, the row is also left open under
+   * policy 0 and 2 if any waiting access targets it, since the scheduler
+   * will prefer that access next.
    */
   switch (dparam.hot_row_policy)
     {
     case 0:
-      dtrans->open_row = 0;
+      dtrans->open_row = (dparam.sched_policy != DRAM_SCHED_FCFS &&
+			  DRAM_sched_row_pending(pbank, dtrans));
       break;
     case 1:
       dtrans->open_row = 1;
       break;
     case 2:
-      if (bq->size && 
+      if (dparam.sched_policy != DRAM_SCHED_FCFS &&
+	  DRAM_sched_row_pending(pbank, dtrans))
+	{
+	  dtrans->open_row = 1;
+	}
+      else if (bq->size && 
 	  DRAM_in_same_row(dtrans->paddr, bq->head->data->paddr))
 	{
 	  dtrans->open_row = 1;
@@ -924,6 +1123,7 @@ dram_trans_t * DRAM_new_transaction(dram_info_t *pdb, mmc_trans_t *ptrans,
   dtrans->paddr       = paddr;
   dtrans->size        = size;
   dtrans->locked      = 0;
+  dtrans->marked      = 0;
   dtrans->is_write    = is_write;
 
   return dtrans;
@@ -83,6 +83,10 @@
  */
 #define  SDRAM                     1
 #define  RDRAM                     2
+#define  DDR3                      3
+#define  DDR4                      4
+
+#define  DRAM_IS_DDR(type)         ((type) == DDR3 || (type) == DDR4)
 
 #define  DRAM_ROW_SIZE             512
 #define  DRAM_BLOCK_SIZE           128
@@ -112,6 +116,60 @@
 #define  RDRAM_tCAC	8
 #define  RDRAM_tCWD	6
 
+#define  DDR3_tCL	11
+#define  DDR3_tCWL	8
+#define  DDR3_tRCD	11
+#define  DDR3_tRP	11
+#define  DDR3_tRAS	28
+#define  DDR3_tCCD	4
+#define  DDR3_tRRD	5
+#define  DDR3_tFAW	24
+#define  DDR3_tWTR	6
+#define  DDR3_tRTP	6
+#define  DDR3_tWR	12
+#define  DDR3_tRFC	208
+#define  DDR3_tREFI	6240
+
+#define  DDR4_tCL	16
+#define  DDR4_tCWL	12
+#define  DDR4_tRCD	16
+#define  DDR4_tRP	16
+#define  DDR4_tRAS	39
+#define  DDR4_tCCD_S	4
+#define  DDR4_tCCD_L	6
+#define  DDR4_tRRD_S	4
+#define  DDR4_tRRD_L	6
+#define  DDR4_tFAW	26
+#define  DDR4_tWTR	9
+#define  DDR4_tRTP	9
+#define  DDR4_tWR	18
+#define  DDR4_tRFC	420
+#define  DDR4_tREFI	9360
+#define  DDR4_BANK_GROUPS 4
+
+#define  DDR_BL         8
+
+
+
+/*
+ * Address mapping, from the most to the least significant field above
+ * the interleaving unit (cache line or row, see DRAM_interleaving).
+ */
+#define  DRAM_MAP_ROW_BANK_CHAN    0   /* consecutive units across channels */
+#define  DRAM_MAP_ROW_CHAN_BANK    1   /* consecutive units across banks    */
+
+
+
+/*
+ * Bank waiting queue scheduling policies
+ */
+#define  DRAM_SCHED_FCFS           0   /* strict arrival order              */
+#define  DRAM_SCHED_FRFCFS         1   /* row hits first, then oldest       */
+#define  DRAM_SCHED_BATCH          2   /* PAR-BS style request batching     */
+#define  DRAM_SCHED_RDFIRST        3   /* reads first, drain writes at mark */
+
+#define  DRAM_BATCH_CAP            5
+
 
 
 /* 
@@ -150,6 +208,30 @@ typedef struct
 
 
 
+/*
+ * DDR3/DDR4 timing. The _S/_L variants apply to commands to different or
+ * the same bank group; DDR3 has a single bank group and S == L.
+ */
+typedef struct
+{
+  int    CL;          /* read command to data                                */
+  int    CWL;         /* write command to data                               */
+  int    RCD;         /* ACT to read/write command                            */
+  int    RP;          /* PRE to ACT command                                  */
+  int    RAS;         /* ACT to PRE command                                  */
+  int    CCD_S;       /* CAS to CAS, different bank group                    */
+  int    CCD_L;       /* CAS to CAS, same bank group                         */
+  int    RRD_S;       /* ACT to ACT, different bank group                    */
+  int    RRD_L;       /* ACT to ACT, same bank group                         */
+  int    FAW;         /* window for four ACT commands to a rank              */
+  int    WTR;         /* end of write data to read command                   */
+  int    RTP;         /* read command to PRE command                         */
+  int    WR;          /* end of write data to PRE command                    */
+  int    BL;          /* burst length in data beats                          */
+} ddr_timing_t;
+
+
+
 typedef struct
 {
   /* 
@@ -182,11 +264,18 @@ typedef struct
   int    num_banks;
   int    bank_depth;
   int    interleaving;
+  int    channels;
+  int    addr_map;
+  int    bank_xor;
   
   /* 
    * DRAM bank parameter 
    */
   int    hot_row_policy;
+  int    sched_policy;
+  int    batch_cap;
+  int    write_high;
+  int    write_low;
   int    row_size;
   int    block_size;
   int    mini_access;
@@ -200,7 +289,11 @@ typedef struct
   {
     sdram_timing_t s;
     rdram_timing_t r;
+    ddr_timing_t   d;
   } dtime;
+
+  int    bank_groups;
+  int    burst_chop;
   
   int    max_bwaiters;
 
@@ -211,6 +304,9 @@ typedef struct
   int    sd_bus_shift;
   int    bank_shift;
   int    bank_mask;
+  int    chan_shift;
+  int    chan_mask;
+  int    xor_mask;
   int    chip_shift;
   int    chip_mask;
   int    databuf_shift;
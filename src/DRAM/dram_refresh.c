@@ -83,14 +83,25 @@ void DRAM_start_refresh(dram_info_t *pdb, int chipid)
  */
 void DRAM_refresh(void)
 {
-  dram_info_t *pdb   = YS__ActEvnt->uptr1;
-  dram_chip_t *pchip = YS__ActEvnt->uptr2;
+  DRAM_refresh_chip(YS__ActEvnt->uptr1, YS__ActEvnt->uptr2);
+}
+
+
+
+/*
+ * Refresh a chip (a rank for DDR) if none of its banks is busy. Otherwise
+ * mark the refresh as needed; DRAM_bank_done retries it when a bank
+ * finishes, and new accesses wait in the bank queues in the meantime.
+ */
+void DRAM_refresh_chip(dram_info_t *pdb, dram_chip_t *pchip)
+{
+  EVENT       *pevent = pchip->refresh_event;
   dram_bank_t *pbank;
   int          i;
 
 #ifdef TRACEDRAM
   if (dparam.debug_on)
-    fprintf(logfile, "DRAM_refresh at %.0f cycles\n", pevent->time);
+    fprintf(logfile, "DRAM_refresh at %.0f cycles\n", YS__Simtime);
 #endif
 
   if (pchip->refresh_on)
@@ -108,18 +119,17 @@ void DRAM_refresh(void)
       if (pbank->busy)
 	{
 	  pchip->refresh_needed = 1;
-	  break;
+	  return;
 	}
     }
   
-  if (i == dparam.banks_per_chip)
-    {
-      pchip->refresh_needed = 0;
-      pchip->refresh_on     = 1;
+  pchip->refresh_needed = 0;
+  pchip->refresh_on     = 1;
+  if (dparam.collect_stats)
+    pdb->refreshes++;
       
-      YS__ActEvnt->body = DRAM_refresh_done;
-      schedule_event(YS__ActEvnt, YS__ActEvnt->time + dparam.refresh_delay);
-    }
+  pevent->body = DRAM_refresh_done;
+  schedule_event(pevent, YS__Simtime + dparam.refresh_delay);
 }
 
 
@@ -148,13 +158,13 @@ void DRAM_refresh_done(void)
     }
   
   /*
-   * Do next memory access for the bank.
+   * Do next memory access for every bank that has accesses waiting.
    */
   for (i = 0; i < dparam.banks_per_chip; i++ )
     {
       pbank = &(pdb->banks[pchip->id + dparam.num_chips * i]);
 
-      if (pbank->waiters.size > 0)
+      if (pbank->waiters.size == 0)
 	pbank->busy = 0;
       else
 	{
@@ -169,7 +179,6 @@ void DRAM_refresh_done(void)
 	    }
 	  
 	  DRAM_access_bank(pdb, dtrans, YS__Simtime);
-	  break;
 	}
     }
 
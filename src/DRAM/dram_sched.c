@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include "Processor/simio.h"
+#include "sim_main/simsys.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "DRAM/cqueue.h"
+#include "Memory/mmc.h"
+#include "DRAM/dram_param.h"
+#include "DRAM/dram.h"
+
+
+/*
+ * Bank waiting queue scheduler. Bank_queue_dequeue asks the scheduler
+ * which waiting access should be granted the bank next. Apart from FCFS,
+ * all policies may pick an access from the middle of the queue, as long
+ * as it has no data dependence on an older access and the head is not
+ * locked by the hot-row predictor. Among the candidates of equal rank
+ * the oldest one wins.
+ *  - FRFCFS:  accesses that hit on the open row first;
+ *  - BATCH:   accesses of the current batch first, then row hits. A new
+ *             batch marks up to batch_cap of the oldest accesses of
+ *             every source once the previous batch is served;
+ *  - RDFIRST: reads first, then row hits. When the number of queued
+ *             writes reaches write_high, writes are drained until it
+ *             drops to write_low.
+ */
+
+static char *sched_names[] = { "FCFS", "FRFCFS", "BATCH", "RDFIRST" };
+
+
+
+char *DRAM_sched_name(int policy)
+{
+  if (policy < 0 || policy > DRAM_SCHED_RDFIRST)
+    return "unknown";
+  return sched_names[policy];
+}
+
+
+
+/*
+ * Does the access hit on the row that is currently open in this bank?
+ */
+static int DRAM_sched_row_hit(dram_bank_t *pbank, dram_trans_t *dtrans)
+{
+  return ((dtrans->paddr >> dparam.row_shift) == pbank->hot_row &&
+	  pbank->expire > YS__Simtime);
+}
+
+
+
+/*
+ * The module that issued the access, or -1 for accesses without a request
+ * (e.g. cache writebacks forwarded by the MMC).
+ */
+static int DRAM_sched_source(dram_trans_t *dtrans)
+{
+  if (dtrans->ptrans && dtrans->ptrans->req)
+    return dtrans->ptrans->req->src_proc;
+  return -1;
+}
+
+
+
+/*
+ * An access may bypass the older accesses in the queue only if it does
+ * not overlap with any of them.
+ */
+static int DRAM_sched_ready(bank_queue_t *bq, bank_queue_elm_t *qelm)
+{
+  bank_queue_elm_t *older;
+
+  for (older = bq->head; older != qelm; older = older->next)
+    if (DRAM_check_data_dependence(older->data, qelm->data))
+      return 0;
+
+  return 1;
+}
+
+
+
+/*
+ * Form a new batch: mark the oldest batch_cap accesses of every source.
+ */
+static void DRAM_sched_mark_batch(dram_bank_t *pbank)
+{
+  bank_queue_t     *bq = &(pbank->waiters);
+  bank_queue_elm_t *qelm, *older;
+  int               i, count, src;
+
+  for (i = 0, qelm = bq->head; i < bq->size; i++, qelm = qelm->next)
+    {
+      src = DRAM_sched_source(qelm->data);
+      for (count = 0, older = bq->head; older != qelm; older = older->next)
+	if (older->data->marked && DRAM_sched_source(older->data) == src)
+	  count++;
+
+      if (count < dparam.batch_cap)
+	{
+	  qelm->data->marked = 1;
+	  pbank->batch_left++;
+	}
+    }
+
+  if (dparam.collect_stats)
+    pbank->stats.batches++;
+}
+
+
+
+/*
+ * Select the waiting access that is granted the bank next.
+ */
+bank_queue_elm_t *DRAM_sched_select(dram_bank_t *pbank)
+{
+  bank_queue_t     *bq = &(pbank->waiters);
+  bank_queue_elm_t *qelm, *best;
+  int               i, rank, best_rank, writes;
+
+  if (dparam.sched_policy == DRAM_SCHED_FCFS || bq->head->data->locked)
+    return bq->head;
+
+  if (dparam.sched_policy == DRAM_SCHED_BATCH && pbank->batch_left == 0)
+    DRAM_sched_mark_batch(pbank);
+
+  if (dparam.sched_policy == DRAM_SCHED_RDFIRST)
+    {
+      for (i = writes = 0, qelm = bq->head; i < bq->size;
+	   i++, qelm = qelm->next)
+	writes += qelm->data->is_write;
+
+      if (!pbank->draining && writes >= dparam.write_high)
+	{
+	  pbank->draining = 1;
+	  if (dparam.collect_stats)
+	    pbank->stats.write_drains++;
+	}
+      else if (pbank->draining && writes <= dparam.write_low)
+	pbank->draining = 0;
+    }
+
+  /*
+   * The head is always ready, so there is at least one candidate.
+   */
+  best      = bq->head;
+  best_rank = -1;
+  for (i = 0, qelm = bq->head; i < bq->size; i++, qelm = qelm->next)
+    {
+      if (!DRAM_sched_ready(bq, qelm))
+	continue;
+
+      rank = DRAM_sched_row_hit(pbank, qelm->data);
+      if (dparam.sched_policy == DRAM_SCHED_BATCH)
+	rank += qelm->data->marked << 1;
+      else if (dparam.sched_policy == DRAM_SCHED_RDFIRST)
+	rank += (qelm->data->is_write == pbank->draining) << 1;
+
+      if (rank > best_rank)
+	{
+	  best      = qelm;
+	  best_rank = rank;
+	}
+    }
+
+  return best;
+}
+
+
+
+/*
+ * Is there another access waiting for the same row? The reordering
+ * policies will pick it next, so the row should remain open.
+ */
+int DRAM_sched_row_pending(dram_bank_t *pbank, dram_trans_t *dtrans)
+{
+  bank_queue_t     *bq = &(pbank->waiters);
+  bank_queue_elm_t *qelm;
+  int               i;
+
+  for (i = 0, qelm = bq->head; i < bq->size; i++, qelm = qelm->next)
+    if (DRAM_in_same_row(dtrans->paddr, qelm->data->paddr))
+      return 1;
+
+  return 0;
+}
+
+
+
+/*
+ * Record the queueing delay of an access in a log2 histogram; bin 0
+ * holds zero-delay accesses, bin i delays of [2^(i-1), 2^i) cycles.
+ */
+void DRAM_sched_stat(dram_bank_t *pbank, dram_trans_t *dtrans,
+		     rsim_time_t delay)
+{
+  long long cycles = (long long) delay;
+  int       bin    = 0;
+
+  while (cycles > 0 && bin < DRAM_QHIST_BINS - 1)
+    {
+      cycles >>= 1;
+      bin++;
+    }
+
+  pbank->stats.queue_hist[dtrans->is_write][bin]++;
+}
@@ -66,10 +66,11 @@
 
 /* Report the DRAM backend statistics =======================================*/
 
+static void DRAM_channel_stat_report(int nid, dram_info_t *pdb);
+
 void DRAM_stat_report(int nid)
 {
-  int          k, jtwid, bankid, rd_busid;
-  dram_info_t *pdb = NID2DRAM(nid);
+  int c;
 
 #ifdef TRACEDRAM
   if (dparam.trace_on)
@@ -78,8 +79,23 @@ void DRAM_stat_report(int nid)
 
   if (dparam.collect_stats == 0 || Cache_perfect())
     return;
-  
-  YS__statmsg(nid, "DRAM Backend Statistics\n");
+
+  for (c = 0; c < dparam.channels; c++)
+    DRAM_channel_stat_report(nid, DRAM_CHANNEL(nid, c));
+}
+
+
+
+static void DRAM_channel_stat_report(int nid, dram_info_t *pdb)
+{
+  int          k, b;
+  long long    hits = 0, accesses = 0;
+  long long    hist[2][DRAM_QHIST_BINS];
+
+  if (dparam.channels > 1)
+    YS__statmsg(nid, "DRAM Backend Statistics (channel %d)\n", pdb->channel);
+  else
+    YS__statmsg(nid, "DRAM Backend Statistics\n");
 
 
   YS__statmsg(nid, "  Statistics for slave address bus\n");
@@ -185,6 +201,65 @@ void DRAM_stat_report(int nid)
       YS__statmsg(nid,
 	      "    average service:         %8.0f cycles\n",
 	      1.0*pbstats->access_cycles / pbstats->readwrites);
+
+      if (dparam.sched_policy != DRAM_SCHED_FCFS)
+	{
+	  YS__statmsg(nid,
+		  "    reordered accesses:  %12lld\t", pbstats->reorders);
+	  YS__statmsg(nid,
+		  "  reorder ratio:       %6.3f\n",
+		  1.0*pbstats->reorders / pbstats->queue_waits);
+	  if (dparam.sched_policy == DRAM_SCHED_BATCH)
+	    YS__statmsg(nid,
+		    "    batches:             %12lld\n", pbstats->batches);
+	  if (dparam.sched_policy == DRAM_SCHED_RDFIRST)
+	    YS__statmsg(nid,
+		    "    write drains:        %12lld\n", pbstats->write_drains);
+	}
+
+      hits     += pbstats->read_hits + pbstats->write_hits;
+      accesses += pbstats->reads + pbstats->writes;
+    }
+
+  if (DRAM_IS_DDR(dparam.dram_type))
+    {
+      YS__statmsg(nid, "\n  DDR rank statistics\n");
+      YS__statmsg(nid, "    refreshes:           %12lld\n", pdb->refreshes);
+      YS__statmsg(nid, "    tFAW stalled ACTs:   %12lld\t", pdb->faw_waits);
+      YS__statmsg(nid, "  tWTR stalled reads:  %12lld\n", pdb->wtr_waits);
+    }
+
+  /*
+   * Row hit rate and queueing delay distribution over all banks, as
+   * achieved by the selected scheduling policy.
+   */
+  YS__statmsg(nid, "\n  Bank scheduling (%s)\n",
+	      DRAM_sched_name(dparam.sched_policy));
+  YS__statmsg(nid, "    row hits:            %12lld\t", hits);
+  YS__statmsg(nid, "  row hit rate:        %6.3f\n",
+	      accesses ? 100.0 * hits / accesses : 0.0);
+
+  for (b = 0; b < DRAM_QHIST_BINS; b++)
+    {
+      hist[DRAM_READ][b] = hist[DRAM_WRITE][b] = 0;
+      for (k = 0; k < dparam.num_banks; k++)
+	{
+	  hist[DRAM_READ][b]  += pdb->banks[k].stats.queue_hist[DRAM_READ][b];
+	  hist[DRAM_WRITE][b] += pdb->banks[k].stats.queue_hist[DRAM_WRITE][b];
+	}
+    }
+
+  YS__statmsg(nid, "    queueing delay          reads       writes\n");
+  for (b = 0; b < DRAM_QHIST_BINS; b++)
+    {
+      if (b == 0)
+	YS__statmsg(nid, "             0 ");
+      else if (b == DRAM_QHIST_BINS - 1)
+	YS__statmsg(nid, "    >= %7d ", 1 << (b - 1));
+      else
+	YS__statmsg(nid, "    %4d - %4d ", 1 << (b - 1), (1 << b) - 1);
+      YS__statmsg(nid, "%12lld %12lld\n",
+		  hist[DRAM_READ][b], hist[DRAM_WRITE][b]);
     }
 
   YS__statmsg(nid, "\n");
@@ -221,12 +296,27 @@ void DRAM_print_params(int nid)
 	  dparam.scheduler_on ? " on" : "off");
   YS__statmsg(nid, "  num_smcs(RD bus)    %4d\t", dparam.rd_busses);
   YS__statmsg(nid, "num_databufs        %4d\n",   dparam.num_databufs);
+  YS__statmsg(nid, "  channels            %4d\t", dparam.channels);
+  YS__statmsg(nid, "address map       %s%s\n",
+	  (dparam.addr_map == DRAM_MAP_ROW_BANK_CHAN) ? "RoBaCh" : "RoChBa",
+	  dparam.bank_xor ? "+xor" : "    ");
   YS__statmsg(nid, "  num_banks           %4d\t", dparam.num_banks);
   YS__statmsg(nid, "banks_per_chip      %4d\n",   dparam.banks_per_chip);
   YS__statmsg(nid, "  DRAM type          %s\n", 
-	  (dparam.dram_type == RDRAM) ? "RDRAM" : "SDRAM");
+	  (dparam.dram_type == RDRAM) ? "RDRAM" :
+	  (dparam.dram_type == DDR3)  ? "DDR3"  :
+	  (dparam.dram_type == DDR4)  ? "DDR4"  : "SDRAM");
   YS__statmsg(nid, "  hot row policy      %4d\t", dparam.hot_row_policy);
   YS__statmsg(nid, "interleaving        %4d\n", dparam.interleaving);
+  YS__statmsg(nid, "  sched policy   %8s\t", 
+	  DRAM_sched_name(dparam.sched_policy));
+  if (dparam.sched_policy == DRAM_SCHED_BATCH)
+    YS__statmsg(nid, "batch cap           %4d\n", dparam.batch_cap);
+  else if (dparam.sched_policy == DRAM_SCHED_RDFIRST)
+    YS__statmsg(nid, "write watermarks %3d/%-3d\n",
+		dparam.write_high, dparam.write_low);
+  else
+    YS__statmsg(nid, "\n");
   YS__statmsg(nid, "  row size            %4d\t", dparam.row_size);
   YS__statmsg(nid, "block size          %4d\n",   dparam.block_size);
   YS__statmsg(nid, "  mininum access      %4d\t", dparam.mini_access);
@@ -255,7 +345,7 @@ void DRAM_print_params(int nid)
       YS__statmsg(nid,
 	      "tDPL cycles         %4d\n\n", dparam.dtime.s.DPL);
     }
-  else
+  else if (dparam.dram_type == RDRAM)
     {
       YS__statmsg(nid,
 		  "RDRAM Configuration\n");
@@ -278,6 +368,42 @@ void DRAM_print_params(int nid)
       YS__statmsg(nid,
 	      "tCWD cycles         %4d\n\n", dparam.dtime.r.CWD);
     }
+  else
+    {
+      YS__statmsg(nid,
+		  "DDR%d Configuration\n", dparam.dram_type);
+      YS__statmsg(nid,
+	      "  tCL cycles          %4d\t", dparam.dtime.d.CL);
+      YS__statmsg(nid,
+	      "tCWL cycles         %4d\n",   dparam.dtime.d.CWL);
+      YS__statmsg(nid,
+	      "  tRCD cycles         %4d\t", dparam.dtime.d.RCD);
+      YS__statmsg(nid,
+	      "tRP cycles          %4d\n",   dparam.dtime.d.RP);
+      YS__statmsg(nid,
+	      "  tRAS cycles         %4d\t", dparam.dtime.d.RAS);
+      YS__statmsg(nid,
+	      "tFAW cycles         %4d\n",   dparam.dtime.d.FAW);
+      YS__statmsg(nid,
+	      "  tCCD_S cycles       %4d\t", dparam.dtime.d.CCD_S);
+      YS__statmsg(nid,
+	      "tCCD_L cycles       %4d\n",   dparam.dtime.d.CCD_L);
+      YS__statmsg(nid,
+	      "  tRRD_S cycles       %4d\t", dparam.dtime.d.RRD_S);
+      YS__statmsg(nid,
+	      "tRRD_L cycles       %4d\n",   dparam.dtime.d.RRD_L);
+      YS__statmsg(nid,
+	      "  tWTR cycles         %4d\t", dparam.dtime.d.WTR);
+      YS__statmsg(nid,
+	      "tRTP cycles         %4d\n",   dparam.dtime.d.RTP);
+      YS__statmsg(nid,
+	      "  tWR cycles          %4d\t", dparam.dtime.d.WR);
+      YS__statmsg(nid,
+	      "burst length        %4d%s\n", dparam.dtime.d.BL,
+	      dparam.burst_chop ? " (chop)" : "");
+      YS__statmsg(nid,
+	      "  bank groups         %4d\n\n", dparam.bank_groups);
+    }
   
   YS__statmsg(nid, "  row hold_time   %8d\n",     dparam.row_hold_time);
   YS__statmsg(nid, "  refresh_delay   %8d\t",     dparam.refresh_delay);
@@ -292,19 +418,32 @@ void DRAM_print_params(int nid)
 /*=============================================================================
  * Reset the statistics
  */
+static void DRAM_channel_stat_clear(dram_info_t *pdb);
+
 void DRAM_stat_clear(int nid)
 {
-  int k;
-  dram_info_t *pdb = NID2DRAM(nid);
-
+  int c;
 
   if (!dparam.collect_stats)
     return;
 
+  for (c = 0; c < dparam.channels; c++)
+    DRAM_channel_stat_clear(DRAM_CHANNEL(nid, c));
+}
+
+
+
+static void DRAM_channel_stat_clear(dram_info_t *pdb)
+{
+  int k;
+
   pdb->total_count  = 0;
   pdb->total_cycles = 0;
   pdb->sgle_count   = 0;
   pdb->sgle_cycles  = 0;
+  pdb->refreshes    = 0;
+  pdb->faw_waits    = 0;
+  pdb->wtr_waits    = 0;
 
   if (dparam.sim_on == 0)
     return;
@@ -59,6 +59,7 @@
 #include <malloc.h>
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
 #include <values.h>
 
 #include "sim_main/simsys.h"
@@ -107,7 +108,11 @@ SCSI_CONTROLLER_SPEC ahc_spec =
   ahc_print_params,
   ahc_stat_report,
   ahc_stat_clear,
-  ahc_dump
+  ahc_dump,
+
+  ahc_idle,
+  ahc_ckpt_save,
+  ahc_ckpt_restore
 };
 
 
@@ -2120,6 +2125,80 @@ void AHC_scb_dump(ahc_scb_t *scb, int nid)
 }
 
 
+
+
+/*=========================================================================*/
+/* Checkpoint support. The controller can only be checkpointed while the   */
+/* sequencer is idle and no SCB is in use, so only the control registers,  */
+/* the software-visible part of the SCB array and the output queue need to */
+/* be saved. The register page itself is remapped by the PCI restore.      */
+/*=========================================================================*/
+
+int ahc_idle(void *controller)
+{
+  ahc_t *ahc = (ahc_t*)controller;
+  int    n;
+
+  if ((ahc->seq_state != SEQ_IDLE) ||
+      (ahc_queue_size(ahc->qin_fifo) != 0) ||
+      (ahc_queue_size(ahc->reconnect_scbs) != 0))
+    return 0;
+
+  for (n = 0; n < ahc->max_scbs; n++)
+    if ((ahc->scbs[n].status != SCB_INACTIVE) || (ahc->scbs[n].req != NULL))
+      return 0;
+
+  for (n = 0; n < SCSI_WIDTH * 8; n++)
+    if (ahc->pending[n] != NULL)
+      return 0;
+
+  return 1;
+}
+
+
+
+void ahc_ckpt_save(void *controller, CKPT *ckpt)
+{
+  ahc_t *ahc = (ahc_t*)controller;
+  int    n;
+
+  Ckpt_section(ckpt, CKPT_TAG('A', 'H', 'C', ' '));
+  Ckpt_write_int(ckpt, ahc->max_scbs);
+  Ckpt_write(ckpt, ahc->regs, AHC_REG_END);
+
+  for (n = 0; n < ahc->max_scbs; n++)
+    Ckpt_write(ckpt, &(ahc->scbs[n]), offsetof(ahc_scb_t, dma_segments));
+
+  Ckpt_write(ckpt, &(ahc->qout_fifo), sizeof(ahc->qout_fifo));
+  Ckpt_write_int(ckpt, ahc->seq_pause);
+  Ckpt_write_int(ckpt, ahc->seq_scb);
+}
+
+
+
+void ahc_ckpt_restore(void *controller, CKPT *ckpt)
+{
+  ahc_t *ahc = (ahc_t*)controller;
+  int    n;
+
+  Ckpt_expect(ckpt, CKPT_TAG('A', 'H', 'C', ' '));
+  if (Ckpt_read_int(ckpt) != ahc->max_scbs)
+    YS__errmsg(ahc->scsi_me->scsi_bus->node_id,
+	       "AHC[%i]: number of SCBs differs from checkpoint %s",
+	       ahc->scsi_me->mid, ckpt->name);
+  Ckpt_read(ckpt, ahc->regs, AHC_REG_END);
+
+  for (n = 0; n < ahc->max_scbs; n++)
+    Ckpt_read(ckpt, &(ahc->scbs[n]), offsetof(ahc_scb_t, dma_segments));
+
+  Ckpt_read(ckpt, &(ahc->qout_fifo), sizeof(ahc->qout_fifo));
+  ahc->seq_pause = Ckpt_read_int(ckpt);
+  ahc->seq_scb   = Ckpt_read_int(ckpt);
+
+  if ((!ahc->seq_pause) && (IsNotScheduled(ahc->sequencer)))
+    schedule_event(ahc->sequencer, YS__Simtime + ahc->seq_cycle_fast);
+}
+
 void ahc_dump(void *controller)
 {
   ahc_t *ahc = (ahc_t*)controller;
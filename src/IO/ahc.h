@@ -345,6 +345,7 @@ typedef struct ahc_t ahc_t;
 
 struct SCSI_CONTROLLER;
 struct SCSI_REQ;
+struct CKPT;
 
 
 
@@ -367,6 +368,10 @@ void ahc_stat_report   (void*);
 void ahc_stat_clear    (void*);
 void ahc_dump          (void*);
 
+int  ahc_idle          (void*);
+void ahc_ckpt_save     (void*, struct CKPT*);
+void ahc_ckpt_restore  (void*, struct CKPT*);
+
 void ahc_sequencer     ();
 void ahc_dma           (ahc_t*, ahc_scb_t*);
 int  ahc_scsi_command  (ahc_t*, ahc_scb_t*);
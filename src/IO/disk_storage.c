@@ -311,6 +311,58 @@ int block_empty(char *buf)
 }
 
 
+/*=========================================================================*/
+/* Write the in-memory hash table to the index file.                       */
+/*=========================================================================*/
+
+static void DISK_storage_write_index(SCSI_DISK *pdisk)
+{
+  DISK_STORAGE_SECTOR *current;
+  int                  file, n;
+
+  while ((file = open(pdisk->storage.index_file_name, O_RDWR)) < 0)
+    {
+      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
+		 "DISK: Open %s failed (%s)\n",
+		 pdisk->storage.index_file_name, YS__strerror(errno));
+      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
+		 "Retry in %i secs ...\n", FILEOP_RETRY_PERIOD);
+      sleep(FILEOP_RETRY_PERIOD);
+    }
+
+  for (n = 0; n < DISK_STORAGE_HASH; n++)
+    {
+      current = &(pdisk->storage.sectors[n]);
+      do
+	{
+	  /* switch byte order for external, platform-independent storage */
+	  current->lba = swap_word(current->lba);
+	  current->pba = swap_word(current->pba);
+
+	  while (write(file, current, sizeof(DISK_STORAGE_SECTOR)) < 0)
+	    {
+	      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
+			 "DISK: Write file %s failed (%s)\n",
+			 pdisk->storage.index_file_name, YS__strerror(errno));
+	      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
+			 "Retry in %i secs ...\n", FILEOP_RETRY_PERIOD);
+              sleep(FILEOP_RETRY_PERIOD);
+	    }
+
+	  /* switch byte order back for internal storage */
+	  current->lba = swap_word(current->lba);
+	  current->pba = swap_word(current->pba);
+
+	  current = current->next;
+	}
+      while (current != NULL);
+    }
+  
+  close(file);
+}
+
+
+
 /*=========================================================================*/
 /* 'Perform' disk write by writing data from buffer into the file.         */
 /* For every block, find file block in hash table or allocate new block    */
@@ -432,47 +484,114 @@ void DISK_storage_write(SCSI_DISK *pdisk, int sector, int length, char *buf)
 
   close(file);
 
+  DISK_storage_write_index(pdisk);
+}
 
-  
-  /* write new hash table -------------------------------------------------*/
 
-  while ((file = open(pdisk->storage.index_file_name, O_RDWR)) < 0)
-    {
-      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
-		 "DISK: Open %s failed (%s)\n",
-		 pdisk->storage.index_file_name, YS__strerror(errno));
-      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
-		 "Retry in %i secs ...\n", FILEOP_RETRY_PERIOD);
-      sleep(FILEOP_RETRY_PERIOD);
-    }
+
+/*=========================================================================*/
+/* Checkpoint support: save all stored sectors with their logical block    */
+/* number. On restore, the data file is rewritten from scratch with the    */
+/* saved sectors and a new index is written, so the disk contents match    */
+/* the checkpoint regardless of what the files contained before.           */
+/*=========================================================================*/
+
+void DISK_storage_ckpt_save(SCSI_DISK *pdisk, CKPT *ckpt)
+{
+  DISK_STORAGE_SECTOR *current;
+  char                 buf[SCSI_BLOCK_SIZE];
+  int                  file, n, count = 0;
 
   for (n = 0; n < DISK_STORAGE_HASH; n++)
+    for (current = &(pdisk->storage.sectors[n]);
+	 current != NULL;
+	 current = current->next)
+      if (current->lba != -1)
+	count++;
+
+  Ckpt_section(ckpt, CKPT_TAG('D', 'I', 'S', 'K'));
+  Ckpt_write_int(ckpt, count);
+
+  if ((file = open(pdisk->storage.data_file_name, O_RDONLY)) < 0)
+    YS__errmsg(ckpt->nodeid, "DISK: Open %s failed (%s)",
+	       pdisk->storage.data_file_name, YS__strerror(errno));
+
+  for (n = 0; n < DISK_STORAGE_HASH; n++)
+    for (current = &(pdisk->storage.sectors[n]);
+	 current != NULL;
+	 current = current->next)
+      {
+	if (current->lba == -1)
+	  continue;
+
+	if (pread(file, buf, SCSI_BLOCK_SIZE, current->pba) < 0)
+	  YS__errmsg(ckpt->nodeid, "DISK: Read file %s failed (%s)",
+		     pdisk->storage.data_file_name, YS__strerror(errno));
+
+	Ckpt_write_int(ckpt, current->lba);
+	Ckpt_write_page(ckpt, buf, SCSI_BLOCK_SIZE);
+      }
+
+  close(file);
+}
+
+
+
+void DISK_storage_ckpt_restore(SCSI_DISK *pdisk, CKPT *ckpt)
+{
+  DISK_STORAGE_SECTOR *current, *next;
+  char                 buf[SCSI_BLOCK_SIZE];
+  int                  file, n, count, lba, pba;
+
+  Ckpt_expect(ckpt, CKPT_TAG('D', 'I', 'S', 'K'));
+  count = Ckpt_read_int(ckpt);
+
+  for (n = 0; n < DISK_STORAGE_HASH; n++)         /* clear hash table      */
     {
-      current = &(pdisk->storage.sectors[n]);
-      do
+      current = pdisk->storage.sectors[n].next;
+      while (current != NULL)
 	{
-	  /* switch byte order for external, platform-independent storage */
-	  current->lba = swap_word(current->lba);
-	  current->pba = swap_word(current->pba);
+	  next = current->next;
+	  free(current);
+	  current = next;
+	}
 
-	  while (write(file, current, sizeof(DISK_STORAGE_SECTOR)) < 0)
-	    {
-	      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
-			 "DISK: Write file %s failed (%s)\n",
-			 pdisk->storage.index_file_name, YS__strerror(errno));
-	      YS__logmsg(pdisk->scsi_me->scsi_bus->node_id,
-			 "Retry in %i secs ...\n", FILEOP_RETRY_PERIOD);
-              sleep(FILEOP_RETRY_PERIOD);
-	    }
+      pdisk->storage.sectors[n].lba  = -1;
+      pdisk->storage.sectors[n].pba  = -1;
+      pdisk->storage.sectors[n].next = NULL;
+    }
 
-	  /* switch byte order back for internal storage */
-	  current->lba = swap_word(current->lba);
-	  current->pba = swap_word(current->pba);
+  file = open(pdisk->storage.data_file_name, O_RDWR | O_TRUNC);
+  if ((file < 0) || (truncate(pdisk->storage.index_file_name, 0) < 0))
+    YS__errmsg(ckpt->nodeid, "DISK: Truncate %s failed (%s)",
+	       file < 0 ? pdisk->storage.data_file_name :
+	       pdisk->storage.index_file_name,
+	       YS__strerror(errno));
 
+  for (n = 0, pba = 0; n < count; n++, pba += SCSI_BLOCK_SIZE)
+    {
+      lba = Ckpt_read_int(ckpt);
+      Ckpt_read_page(ckpt, buf, SCSI_BLOCK_SIZE);
+
+      current = &(pdisk->storage.sectors[lba % DISK_STORAGE_HASH]);
+      if (current->lba != -1)
+	{
+	  while (current->next != NULL)
+	    current = current->next;
+	  current->next = (DISK_STORAGE_SECTOR*)malloc(sizeof(DISK_STORAGE_SECTOR));
 	  current = current->next;
 	}
-      while (current != NULL);
+
+      current->lba  = lba;
+      current->pba  = pba;
+      current->next = NULL;
+
+      if (pwrite(file, buf, SCSI_BLOCK_SIZE, pba) < 0)
+	YS__errmsg(ckpt->nodeid, "DISK: Write file %s failed (%s)",
+		   pdisk->storage.data_file_name, YS__strerror(errno));
     }
-  
+
   close(file);
+
+  DISK_storage_write_index(pdisk);
 }
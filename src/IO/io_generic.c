@@ -638,7 +638,7 @@ int IO_arb_for_bus(REQ *req)
       if ((req->type == COHE_REPLY) && (oreq != NULL))
         {
           lqueue_add_head(&(pio->arbwaiters), oreq, pio->nodeid);
-          pbus->arbwaiters[req->src_proc].req = req;
+          Bus_replace_arb_req(req->node, req->src_proc, req);
         }
       else
         {
@@ -1045,6 +1045,33 @@ void IO_empty_func(REQ *req, HIT_TYPE h)
 }
 
 
+/*===========================================================================*/
+/* Returns true if none of the generic I/O interfaces of a node has a        */
+/* request queued, in a pipeline or outstanding on the bus.                  */
+/*===========================================================================*/
+
+int IO_idle(int nid)
+{
+  IO_GENERIC *pio;
+  int         n;
+
+  for (n = 0; n < ARCH_ios; n++)
+    {
+      pio = PID2IO(nid, ARCH_cpus + n);
+
+      if ((pio->arbwaiters_count != 0) ||
+	  !lqueue_empty(&(pio->cohqueue)) ||
+	  !lqueue_empty(&(pio->inqueue)) || !PipeEmpty(pio->inpipe) ||
+	  !lqueue_empty(&(pio->outqueue)) || !PipeEmpty(pio->outpipe) ||
+	  (pio->writebacks != NULL) || (pio->scoreboard.req_count != 0))
+	return 0;
+    }
+
+  return 1;
+}
+
+
+
 /*===========================================================================*/
 /*===========================================================================*/
 
@@ -130,6 +130,8 @@ void IO_send_on_bus         (REQ*);
 void IO_get_reply           (REQ*);
 void IO_get_data_response   (REQ*);
 
+int  IO_idle                (int);
+
 void IO_scoreboard_init     (IO_GENERIC*);
 void IO_scoreboard_insert   (IO_GENERIC*, REQ*);
 REQ* IO_scoreboard_lookup   (IO_GENERIC*, REQ*);
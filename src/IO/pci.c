@@ -925,6 +925,65 @@ void PCI_print_config(int node, PCI_CONFIG *pdev)
 
 
 
+/*=========================================================================*/
+/* Checkpoint support: save the configuration spaces of all devices. On    */
+/* restore, replay the base address register writes through the device    */
+/* mapping callbacks so that devices map their registers at the addresses  */
+/* assigned by the simulated operating system.                              */
+/*=========================================================================*/
+
+void PCI_ckpt_save(CKPT *ckpt, int nid)
+{
+  Ckpt_section(ckpt, CKPT_TAG('P', 'C', 'I', ' '));
+  Ckpt_write_int(ckpt, PCI_BUSES[nid].device_count);
+  Ckpt_write(ckpt, PCI_BUSES[nid].config, sizeof(PCI_BUSES[nid].config));
+}
+
+
+
+void PCI_ckpt_restore(CKPT *ckpt, int nid)
+{
+  PCI_BUS    *pci = &PCI_BUSES[nid];
+  PCI_CONFIG *pdev;
+  unsigned    base_addr, size, flags;
+  int         dev, func, m;
+
+  Ckpt_expect(ckpt, CKPT_TAG('P', 'C', 'I', ' '));
+  if (Ckpt_read_int(ckpt) != pci->device_count)
+    YS__errmsg(nid, "Checkpoint %s: PCI device configuration differs",
+	       ckpt->name);
+  Ckpt_read(ckpt, pci->config, sizeof(pci->config));
+
+  for (dev = 0; dev < pci->device_count; dev++)
+    {
+      if (pci->map_func[dev] == NULL)
+	continue;
+
+      for (func = 0; func < PCI_MAX_FUNCTIONS; func++)
+	{
+	  pdev = &pci->config[dev * PCI_MAX_FUNCTIONS + func];
+	  if (swap_short(pdev->vendor_id) == PCI_VENDOR_INVALID)
+	    continue;
+
+	  for (m = 0;
+	       m < (PCI_MAPREG_END - PCI_MAPREG_START) / sizeof(unsigned);
+	       m++)
+	    {
+	      base_addr = swap_word(pdev->base_addr[m]);
+
+	      if ((PCI_MAPREG_MEM_ADDR(base_addr) == 0xFFFFFFFF) ||
+		  (PCI_MAPREG_MEM_ADDR(base_addr) == 0x00000000))
+		continue;
+
+	      pci->map_func[dev](base_addr, nid, pci->bus_id[dev],
+				 func, m, &size, &flags);
+	    }
+	}
+    }
+}
+
+
+
 /*=========================================================================*/
 /*=========================================================================*/
 
@@ -65,6 +65,7 @@
 #define _RSIM_PCI_H_
 
 
+#include "sim_main/checkpoint.h"
 #include "../../lamix/machine/pci_machdep.h"
 
 
@@ -156,4 +157,7 @@ void        PCI_BRIDGE_init(void);
 
 void        PCI_BRIDGE_dump(int);
 
+void        PCI_ckpt_save(CKPT*, int);
+void        PCI_ckpt_restore(CKPT*, int);
+
 #endif
@@ -670,3 +670,42 @@ void RTC_dump(int nid)
 	     IsScheduled(RTCs[nid].update) ? "yes" : "no");
   IO_dump(pio);
 }
+
+
+
+/*===========================================================================*/
+/* Checkpoint support: save and restore the clock registers and counters.   */
+/* The periodic update event keeps running and simply continues with the    */
+/* restored clock value.                                                     */
+/*===========================================================================*/
+
+#define RTC_REG_SIZE 0x10
+
+void RTC_ckpt_save(CKPT *ckpt, int nid)
+{
+  REALTIME_CLOCK *prtc = &RTCs[nid];
+
+  Ckpt_section(ckpt, CKPT_TAG('R', 'T', 'C', ' '));
+  Ckpt_write(ckpt, PageTable_lookup(nid, RTC_BASE_ADDR), RTC_REG_SIZE);
+  Ckpt_write(ckpt, &prtc->old_write_bit, sizeof(prtc->old_write_bit));
+  Ckpt_write(ckpt, &prtc->old_status,    sizeof(prtc->old_status));
+  Ckpt_write(ckpt, &prtc->clock,         sizeof(prtc->clock));
+  Ckpt_write(ckpt, &prtc->rt,            sizeof(prtc->rt));
+  Ckpt_write(ckpt, &prtc->vector1,       sizeof(prtc->vector1));
+  Ckpt_write(ckpt, &prtc->vector2,       sizeof(prtc->vector2));
+}
+
+
+void RTC_ckpt_restore(CKPT *ckpt, int nid)
+{
+  REALTIME_CLOCK *prtc = &RTCs[nid];
+
+  Ckpt_expect(ckpt, CKPT_TAG('R', 'T', 'C', ' '));
+  Ckpt_read(ckpt, PageTable_lookup(nid, RTC_BASE_ADDR), RTC_REG_SIZE);
+  Ckpt_read(ckpt, &prtc->old_write_bit, sizeof(prtc->old_write_bit));
+  Ckpt_read(ckpt, &prtc->old_status,    sizeof(prtc->old_status));
+  Ckpt_read(ckpt, &prtc->clock,         sizeof(prtc->clock));
+  Ckpt_read(ckpt, &prtc->rt,            sizeof(prtc->rt));
+  Ckpt_read(ckpt, &prtc->vector1,       sizeof(prtc->vector1));
+  Ckpt_read(ckpt, &prtc->vector2,       sizeof(prtc->vector2));
+}
@@ -67,6 +67,7 @@
 
 #include "Caches/req.h"
 #include "Caches/lqueue.h"
+#include "sim_main/checkpoint.h"
 #include "time.h"
 
 
@@ -130,4 +131,7 @@ void RTC_stat_clear     (int);
 
 void RTC_dump           (int);
 
+void RTC_ckpt_save      (CKPT*, int);
+void RTC_ckpt_restore   (CKPT*, int);
+
 #endif
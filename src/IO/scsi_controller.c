@@ -592,3 +592,71 @@ void SCSI_cntl_dump(int nid, int mid)
   SCSI_bus_dump(pscsi->scsi_bus);
 }
 
+
+
+
+/*===========================================================================*/
+/* Checkpoint support: the controller, SCSI bus and attached disks are idle  */
+/* if no request is queued or in flight anywhere. Only then can the state   */
+/* be captured without saving events and request structures.                */
+/*===========================================================================*/
+
+int SCSI_cntl_idle(int nid, int mid)
+{
+  SCSI_CONTROLLER *pscsi = PID2SCSI(nid, mid + first_scsi_cntr);
+  SCSI_BUS        *psbus = pscsi->scsi_bus;
+  int d;
+
+  if ((!lqueue_empty(&(pscsi->reply_queue))) ||
+      (!lqueue_empty(&(pscsi->dma_queue))) ||
+      (!lqueue_empty(&(pscsi->interrupt_queue))) ||
+      (IsScheduled(pscsi->bus_interface)))
+    return 0;
+
+  if ((psbus->state != SCSI_BUS_IDLE) ||
+      (psbus->current_req != NULL) ||
+      (IsScheduled(psbus->arbitrate)) ||
+      (IsScheduled(psbus->send_request)) ||
+      (IsScheduled(psbus->send_response)))
+    return 0;
+
+  if ((pscsi->contr_spec->idle) &&
+      (!pscsi->contr_spec->idle(pscsi->controller)))
+    return 0;
+
+  for (d = 0; d < ARCH_disks; d++)
+    if (!DISK_idle((SCSI_DISK*)psbus->devices[d]->device))
+      return 0;
+
+  return 1;
+}
+
+
+
+void SCSI_cntl_ckpt_save(CKPT *ckpt, int nid, int mid)
+{
+  SCSI_CONTROLLER *pscsi = PID2SCSI(nid, mid + first_scsi_cntr);
+  int d;
+
+  if (pscsi->contr_spec->ckpt_save)
+    pscsi->contr_spec->ckpt_save(pscsi->controller, ckpt);
+
+  for (d = 0; d < ARCH_disks; d++)
+    DISK_storage_ckpt_save(
+      (SCSI_DISK*)pscsi->scsi_bus->devices[d]->device, ckpt);
+}
+
+
+
+void SCSI_cntl_ckpt_restore(CKPT *ckpt, int nid, int mid)
+{
+  SCSI_CONTROLLER *pscsi = PID2SCSI(nid, mid + first_scsi_cntr);
+  int d;
+
+  if (pscsi->contr_spec->ckpt_restore)
+    pscsi->contr_spec->ckpt_restore(pscsi->controller, ckpt);
+
+  for (d = 0; d < ARCH_disks; d++)
+    DISK_storage_ckpt_restore(
+      (SCSI_DISK*)pscsi->scsi_bus->devices[d]->device, ckpt);
+}
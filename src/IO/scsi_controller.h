@@ -67,6 +67,7 @@
 #include "sim_main/evlst.h"
 #include "Caches/req.h"
 #include "Caches/lqueue.h"
+#include "sim_main/checkpoint.h"
 
 
 /* uncomment to compile SCSI controller with debugging output */
@@ -103,6 +104,10 @@ struct SCSI_CONTROLLER_SPEC
   void (*stat_report)   (void*);
   void (*stat_clear)    (void*);
   void (*dump)          (void*);
+
+  int  (*idle)          (void*);
+  void (*ckpt_save)     (void*, CKPT*);
+  void (*ckpt_restore)  (void*, CKPT*);
 };
 
 typedef struct SCSI_CONTROLLER_SPEC SCSI_CONTROLLER_SPEC;
@@ -167,5 +172,9 @@ void SCSI_cntl_stat_clear     (int, int);
 
 void SCSI_cntl_dump           (int, int);
 
+int  SCSI_cntl_idle           (int, int);
+void SCSI_cntl_ckpt_save      (CKPT*, int, int);
+void SCSI_cntl_ckpt_restore   (CKPT*, int, int);
+
 #endif
 
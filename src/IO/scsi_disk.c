@@ -1802,6 +1802,22 @@ void DISK_perform(void *ptr, SCSI_REQ *req)
 
 
 
+/*=========================================================================*/
+/* Returns true if the disk has no request queued or in progress and the   */
+/* mechanism is not busy, e.g. with a prefetch or a cached write.          */
+/*=========================================================================*/
+
+int DISK_idle(SCSI_DISK *pdisk)
+{
+  return ((pdisk->state == DISK_IDLE) && (pdisk->current_req == NULL) &&
+	  lqueue_empty(&(pdisk->inqueue)) && lqueue_empty(&(pdisk->outqueue)) &&
+	  IsNotScheduled(pdisk->request_event) &&
+	  IsNotScheduled(pdisk->seek_event) &&
+	  IsNotScheduled(pdisk->sector_event));
+}
+
+
+
 
 
 /*=========================================================================*/
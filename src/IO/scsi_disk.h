@@ -63,6 +63,7 @@
 
 #include "Caches/lqueue.h"
 #include "IO/scsi_bus.h"
+#include "sim_main/checkpoint.h"
 
 
 /* uncomment to compile disk model with debugging output */
@@ -227,6 +228,7 @@ typedef struct
 /* disk model routines                                                     */
 
 void    SCSI_disk_init            (SCSI_BUS*, int);
+int     DISK_idle                 (SCSI_DISK*);
 
 /* mechanical model routines */
 int     DISK_sector_at_time       (SCSI_DISK*, int head, int, double);
@@ -254,5 +256,7 @@ int     DISK_cache_segment_full   (SCSI_DISK*, int);
 void    DISK_storage_init         (SCSI_DISK*);
 void    DISK_storage_read         (SCSI_DISK*, int, int, char*);
 void    DISK_storage_write        (SCSI_DISK*, int, int, char*);
+void    DISK_storage_ckpt_save    (SCSI_DISK*, CKPT*);
+void    DISK_storage_ckpt_restore (SCSI_DISK*, CKPT*);
 
 #endif
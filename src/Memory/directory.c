@@ -0,0 +1,664 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "Processor/simio.h"
+#include "sim_main/simsys.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/cache.h"
+#include "Memory/mmc.h"
+#include "Memory/directory.h"
+
+
+directory_t *Directories = NULL;
+
+static int DIR_ENTRIES       = 65536; /* entries per node                   */
+static int DIR_ASSOC         = 8;
+static int DIR_SETS;
+static int DIR_LATENCY       = 4;   /* directory lookup at the home         */
+static int NET_TOPOLOGY      = NET_CROSSBAR;
+static int NET_HOP_LATENCY   = 2;   /* crossbar traversal or per mesh hop   */
+static int NET_OCCUPANCY     = 1;   /* cycles a message holds a port        */
+static int NET_MESH_DIM      = 1;   /* mesh is NET_MESH_DIM x NET_MESH_DIM  */
+
+static dir_msg_t *free_msgs = NULL;
+
+
+static void Directory_deliver (void);
+
+
+
+/*=============================================================================
+ * Create a directory and a network for every node, if the directory snoop
+ * filter is enabled. The CPUs and the directory are the endpoints of
+ * the network; in a mesh the directory sits at the center and the CPUs
+ * fill the remaining positions in row-major order.
+ */
+void Directory_init(void)
+{
+  directory_t *pdir;
+  dir_port_t  *pport;
+  char         name[64];
+  int          enable = 0, nid, n;
+
+  get_parameter("DIR_enable",         &enable,            PARAM_INT);
+  if (!enable)
+    return;
+
+  get_parameter("DIR_entries",        &DIR_ENTRIES,       PARAM_INT);
+  get_parameter("DIR_assoc",          &DIR_ASSOC,         PARAM_INT);
+  get_parameter("DIR_latency",        &DIR_LATENCY,       PARAM_INT);
+  get_parameter("NET_hop_latency",    &NET_HOP_LATENCY,   PARAM_INT);
+  get_parameter("NET_occupancy",      &NET_OCCUPANCY,     PARAM_INT);
+
+  name[0] = 0;
+  get_parameter("NET_topology",       name,               PARAM_STRING);
+  if ((name[0] == 0) || (strncasecmp(name, "cross", 5) == 0) ||
+      (strncasecmp(name, "xbar", 4) == 0))
+    NET_TOPOLOGY = NET_CROSSBAR;
+  else if (strncasecmp(name, "mesh", 4) == 0)
+    NET_TOPOLOGY = NET_MESH;
+  else
+    YS__errmsg(0, "Unknown network topology %s\n", name);
+
+  if ((DIR_ASSOC <= 0) || (DIR_ENTRIES < DIR_ASSOC) ||
+      (DIR_ENTRIES % DIR_ASSOC != 0))
+    YS__errmsg(0, "Directory size must be a multiple of its associativity");
+  DIR_SETS = DIR_ENTRIES / DIR_ASSOC;
+
+  if ((DIR_LATENCY < 0) || (NET_HOP_LATENCY < 0) || (NET_OCCUPANCY < 0))
+    YS__errmsg(0, "Directory and network latencies must not be negative");
+
+  while (NET_MESH_DIM * NET_MESH_DIM < ARCH_cpus + 1)
+    NET_MESH_DIM++;
+
+  Directories = RSIM_CALLOC(directory_t, ARCH_numnodes);
+  if (!Directories)
+    YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  for (nid = 0; nid < ARCH_numnodes; nid++)
+    {
+      pdir = NID2DIR(nid);
+      pdir->nodeid = nid;
+
+      pdir->table      = RSIM_CALLOC(dir_entry_t, DIR_ENTRIES);
+      pdir->unfiltered = RSIM_CALLOC(char, DIR_SETS);
+      pdir->ports      = RSIM_CALLOC(dir_port_t, ARCH_cpus + 1);
+      if (!pdir->table || !pdir->unfiltered || !pdir->ports)
+	YS__errmsg(nid, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+      for (n = 0; n < DIR_ENTRIES; n++)
+	pdir->table[n].owner = -1;
+
+      for (n = 0; n <= ARCH_cpus; n++)
+	{
+	  pport = &(pdir->ports[n]);
+	  pport->dest    = n;
+	  pport->free_at = 0.0;
+	  pport->head    = NULL;
+	  pport->tail    = NULL;
+
+	  sprintf(name, "network port %d", n);
+	  pport->pevent = NewEvent(name, Directory_deliver, NODELETE, 0);
+	  pport->pevent->uptr1 = (void *) pport;
+	}
+    }
+}
+
+
+
+/*=============================================================================
+ * Network latency between two endpoints (CPU number, or ARCH_cpus for the
+ * directory). Messages from a CPU to itself do not enter the network.
+ */
+static int Directory_net_latency(int src, int dest)
+{
+  int center, ps, pd, hops;
+
+  if (src == dest)
+    return 0;
+
+  if (NET_TOPOLOGY == NET_CROSSBAR)
+    return NET_HOP_LATENCY;
+
+  /*
+   * Map endpoints to mesh positions: the directory takes the center,
+   * CPUs at or behind it are shifted by one.
+   */
+  center = (NET_MESH_DIM / 2) * NET_MESH_DIM + NET_MESH_DIM / 2;
+  ps = (src  == ARCH_cpus) ? center : ((src  >= center) ? src  + 1 : src);
+  pd = (dest == ARCH_cpus) ? center : ((dest >= center) ? dest + 1 : dest);
+
+  hops = abs(ps % NET_MESH_DIM - pd % NET_MESH_DIM) +
+    abs(ps / NET_MESH_DIM - pd / NET_MESH_DIM);
+
+  return hops * NET_HOP_LATENCY;
+}
+
+
+
+/*=============================================================================
+ * Hand a message to the network. It arrives at the destination port
+ * "delay" cycles from now, but not before the previous message to that port
+ * has been delivered and has released the port. Local messages (a CPU's
+ * own request) only queue up behind earlier messages.
+ */
+static void Directory_send(directory_t *pdir, int dest, REQ *req, int state,
+			   double delay, int local)
+{
+  dir_port_t *pport = &(pdir->ports[dest]);
+  dir_msg_t  *pmsg;
+  double      arrival = YS__Simtime + delay;
+
+  if (arrival < pport->free_at)
+    {
+      if (!local)
+	pdir->stats.port_cycles += pport->free_at - arrival;
+      arrival = pport->free_at;
+    }
+  pport->free_at = arrival + NET_OCCUPANCY;
+
+  if (!local)
+    {
+      pdir->stats.messages++;
+      pdir->stats.net_cycles += arrival - YS__Simtime;
+    }
+
+  /*
+   * Nothing ahead of it and no latency: deliver right away.
+   */
+  if ((pport->head == NULL) && (arrival <= YS__Simtime))
+    {
+      if (dest == ARCH_cpus)
+	MMC_recv_cohe_response(req, state);
+      else
+	Cache_get_forward(req, dest);
+      return;
+    }
+
+  if (free_msgs)
+    {
+      pmsg = free_msgs;
+      free_msgs = pmsg->next;
+    }
+  else if (!(pmsg = RSIM_CALLOC(dir_msg_t, 1)))
+    YS__errmsg(pdir->nodeid, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  pmsg->req   = req;
+  pmsg->state = state;
+  pmsg->time  = arrival;
+  pmsg->next  = NULL;
+
+  if (pport->head == NULL)
+    pport->head = pmsg;
+  else
+    pport->tail->next = pmsg;
+  pport->tail = pmsg;
+
+  if (IsNotScheduled(pport->pevent))
+    {
+      schedule_event(pport->pevent, pport->head->time);
+    }
+}
+
+
+
+/*=============================================================================
+ * Event handler of a network port: deliver all messages that have arrived.
+ */
+static void Directory_deliver(void)
+{
+  dir_port_t *pport = (dir_port_t *) YS__ActEvnt->uptr1;
+  dir_msg_t  *pmsg;
+
+  while ((pmsg = pport->head) && (pmsg->time <= YS__Simtime))
+    {
+      pport->head = pmsg->next;
+      if (pport->head == NULL)
+	pport->tail = NULL;
+
+      if (pport->dest == ARCH_cpus)
+	MMC_recv_cohe_response(pmsg->req, pmsg->state);
+      else
+	Cache_get_forward(pmsg->req, pport->dest);
+
+      pmsg->next = free_msgs;
+      free_msgs = pmsg;
+    }
+
+  if (pport->head)
+    {
+      schedule_event(pport->pevent, pport->head->time);
+    }
+}
+
+
+
+/*=============================================================================
+ * Remove a line from the L2 caches (and their L1 caches) named by a
+ * directory entry. With "probe" set, only check that none of them has a
+ * miss or upgrade outstanding for the line. Returns 0 if the line cannot
+ * be removed now. A dirty L2 copy is written back to memory unless
+ * "functional" is set.
+ */
+static int Directory_back_invalidate(directory_t *pdir, dir_entry_t *pent,
+				     int probe, int functional)
+{
+  unsigned paddr = pent->lnum * ARCH_linesz2;
+  int      n, rc;
+
+  for (n = 0; n < ARCH_cpus; n++)
+    {
+      if (!(pent->sharers & MODMASK_BIT(n)))
+	continue;
+
+      rc = Cache_back_invalidate(PID2L2C(pdir->nodeid, n), paddr, probe);
+      if (rc < 0)
+	return 0;
+
+      if (probe || rc == 0)
+	continue;
+
+      pdir->stats.back_invals++;
+      if (rc == 2)
+	{
+	  pdir->stats.back_invals_dirty++;
+	  if (!functional)
+	    MMC_write_line(NID2MMC(pdir->nodeid), paddr);
+	}
+    }
+
+  if (!probe)
+    {
+      pent->sharers = 0;
+      pent->owner   = -1;
+    }
+
+  return 1;
+}
+
+
+
+/*=============================================================================
+ * Find the directory entry of a line, optionally creating it. A new entry
+ * takes a free entry of the set if there is one, otherwise the least
+ * recently used entry whose sharers can be back-invalidated right now.
+ * If no entry can be replaced, the set stops filtering: it has lost track
+ * of a line, so from now on its requests go to every L2 cache. Returns
+ * NULL if the line has no entry or its set is unfiltered.
+ */
+static dir_entry_t *Directory_entry(directory_t *pdir, unsigned paddr,
+				    int create, int functional)
+{
+  unsigned     lnum = paddr / ARCH_linesz2;
+  int          set  = lnum % DIR_SETS;
+  dir_entry_t *pset = &(pdir->table[set * DIR_ASSOC]);
+  dir_entry_t *pent, *best = NULL;
+  int          i;
+
+  if (pdir->unfiltered[set])
+    return NULL;
+
+  for (i = 0; i < DIR_ASSOC; i++)
+    {
+      pent = &(pset[i]);
+      if (pent->sharers && (pent->lnum == lnum))
+	{
+	  pent->used = ++pdir->clock;
+	  return pent;
+	}
+    }
+
+  if (!create)
+    return NULL;
+
+  for (i = 0; i < DIR_ASSOC; i++)
+    {
+      pent = &(pset[i]);
+      if (pent->sharers == 0)
+	{
+	  best = pent;
+	  break;
+	}
+
+      if (((best == NULL) || (pent->used < best->used)) &&
+	  Directory_back_invalidate(pdir, pent, 1, functional))
+	best = pent;
+    }
+
+  if (best == NULL)
+    {
+      pdir->unfiltered[set] = 1;
+      pdir->stats.overflow_sets++;
+      return NULL;
+    }
+
+  if (best->sharers)
+    {
+      pdir->stats.replacements++;
+      Directory_back_invalidate(pdir, best, 0, functional);
+    }
+
+  pdir->stats.allocations++;
+  best->lnum    = lnum;
+  best->sharers = 0;
+  best->owner   = -1;
+  best->used    = ++pdir->clock;
+  return best;
+}
+
+
+
+/*=============================================================================
+ * Called when a coherent request reaches the home node: returns the set of
+ * CPUs whose L2 cache has to see the request and updates the entry.
+ * The requester is always part of the set, it orders its own request
+ * against forwarded ones. Reads only need the exclusive owner, since
+ * shared copies stay valid; the directory itself tells the memory
+ * controller to grant the line shared if other copies exist. Requests for
+ * ownership go to every sharer and leave the requester as the only one.
+ * Without a directory every CPU snoops the request.
+ */
+modmask_t Directory_snoop_filter(REQ *req)
+{
+  directory_t *pdir;
+  dir_entry_t *pent;
+  modmask_t    mask, pbit, others;
+  int          n;
+
+  req->dir_shared = 0;
+
+  if (Directories == NULL)
+    return MODMASK_BIT(ARCH_cpus) - 1;
+
+  pdir = NID2DIR(req->node);
+  pbit = (req->src_proc < ARCH_cpus) ? MODMASK_BIT(req->src_proc) : 0;
+  mask = pbit;
+
+  pdir->stats.lookups++;
+  pdir->stats.broadcast += pbit ? ARCH_cpus - 1 : ARCH_cpus;
+
+  pent   = Directory_entry(pdir, req->paddr, pbit != 0, 0);
+  others = pent ? (pent->sharers & ~pbit) : 0;
+
+  /*
+   * Unfiltered set: every L2 cache snoops, and reports a shared copy
+   * itself.
+   */
+  if (pdir->unfiltered[(req->paddr / ARCH_linesz2) % DIR_SETS])
+    mask = MODMASK_BIT(ARCH_cpus) - 1;
+  else if ((req->type == WRITEPURGE) ||
+	   (req->req_type == READ_OWN) || (req->req_type == UPGRADE))
+    {
+      mask |= others;
+      if (pent)
+	{
+	  pent->sharers = pbit;
+	  pent->owner   = pbit ? req->src_proc : -1;
+	}
+    }
+  else if (pent)
+    {
+      if ((pent->owner >= 0) && (pent->owner != req->src_proc))
+	mask |= MODMASK_BIT(pent->owner);
+
+      if (req->req_type == READ_SH)
+	{
+	  if (others)
+	    {
+	      req->dir_shared = 1;
+	      pdir->stats.shared_grants++;
+	      pent->owner = -1;
+	    }
+	  else if (pbit)
+	    pent->owner = req->src_proc;
+	  pent->sharers |= pbit;
+	}
+    }
+
+  for (n = 0; n < ARCH_cpus; n++)
+    if ((mask & ~pbit) & MODMASK_BIT(n))
+      pdir->stats.forwards++;
+
+  return mask;
+}
+
+
+
+/*=============================================================================
+ * Send a coherence request to the L2 cache of "procid". Forwards to other
+ * CPUs pay the directory lookup and the network latency from the home
+ * node; the requester's own copy only has to keep its place in line.
+ */
+void Directory_forward(REQ *req, int procid)
+{
+  directory_t *pdir = NID2DIR(req->node);
+
+  if (procid == req->src_proc)
+    Directory_send(pdir, procid, req, 0, 0.0, 1);
+  else
+    Directory_send(pdir, procid, req, 0,
+		   (double)(DIR_LATENCY +
+			    Directory_net_latency(ARCH_cpus, procid)), 0);
+}
+
+
+
+/*=============================================================================
+ * Coherence response of the L2 cache of "procid" to a forwarded request,
+ * sent back to the directory over the network.
+ */
+void Directory_send_response(REQ *req, int state, int procid)
+{
+  directory_t *pdir = NID2DIR(req->node);
+
+  pdir->stats.acks++;
+  Directory_send(pdir, ARCH_cpus, req, state,
+		 (double)Directory_net_latency(procid, ARCH_cpus), 0);
+}
+
+
+
+/*=============================================================================
+ * A dirty line has been written back: its owner no longer holds it. The
+ * sharer bit is kept because a new request by the same CPU may have
+ * overtaken the writeback.
+ */
+void Directory_writeback(REQ *req)
+{
+  dir_entry_t *pent;
+
+  if ((Directories == NULL) || (req->src_proc >= ARCH_cpus))
+    return;
+
+  pent = Directory_entry(NID2DIR(req->node), req->paddr, 0, 0);
+  if (pent && (pent->owner == req->src_proc))
+    pent->owner = -1;
+}
+
+
+
+/*=============================================================================
+ * Functional counterpart of an L2 fill, used while warming up the caches
+ * and when restoring L2 tags from a checkpoint. The line is recorded as
+ * shared, so later writes by other CPUs invalidate it.
+ */
+void Directory_warm(int nodeid, int procid, unsigned paddr)
+{
+  dir_entry_t *pent;
+
+  if (Directories == NULL)
+    return;
+
+  pent = Directory_entry(NID2DIR(nodeid), paddr, 1, 1);
+  if (pent == NULL)
+    return;
+
+  pent->sharers |= MODMASK_BIT(procid);
+  if (pent->owner != procid)
+    pent->owner = -1;
+}
+
+
+
+/*=============================================================================
+ * Returns true if no message is in flight in the network of the node.
+ */
+int Directory_idle(int nodeid)
+{
+  directory_t *pdir;
+  int          n;
+
+  if (Directories == NULL)
+    return 1;
+
+  pdir = NID2DIR(nodeid);
+  for (n = 0; n <= ARCH_cpus; n++)
+    if (pdir->ports[n].head)
+      return 0;
+
+  return 1;
+}
+
+
+
+/*=============================================================================
+ * Print directory configuration.
+ */
+void Directory_print_params(int nid)
+{
+  YS__statmsg(nid, "Directory Configuration\n");
+  YS__statmsg(nid,
+	      "  protocol:        MESI snoop filter, full-map sharer vector\n");
+  YS__statmsg(nid,
+	      "  entries:        %6d (%d-way set-associative)\n",
+	      DIR_ENTRIES, DIR_ASSOC);
+  YS__statmsg(nid,
+	      "  lookup latency: %4d cycles\n", DIR_LATENCY);
+  if (NET_TOPOLOGY == NET_MESH)
+    YS__statmsg(nid,
+		"  network:         %dx%d mesh, %d cycles per hop\n",
+		NET_MESH_DIM, NET_MESH_DIM, NET_HOP_LATENCY);
+  else
+    YS__statmsg(nid,
+		"  network:         crossbar, %d cycles\n", NET_HOP_LATENCY);
+  YS__statmsg(nid,
+	      "  port occupancy: %4d cycles per message\n\n", NET_OCCUPANCY);
+}
+
+
+
+/*=============================================================================
+ * Print directory statistics.
+ */
+void Directory_stat_report(int nid)
+{
+  dir_stat_t *ps = &(NID2DIR(nid)->stats);
+
+  YS__statmsg(nid, "Directory Statistics\n");
+  YS__statmsg(nid,
+	      "  Lookups:              %12lld\n", ps->lookups);
+  YS__statmsg(nid,
+	      "  Allocations:          %12lld\n", ps->allocations);
+  YS__statmsg(nid,
+	      "  Replacements:         %12lld\n", ps->replacements);
+  YS__statmsg(nid,
+	      "  Back-invalidations:   %12lld\t(dirty: %lld)\n",
+	      ps->back_invals, ps->back_invals_dirty);
+  if (ps->overflow_sets)
+    YS__statmsg(nid,
+		"    unfiltered sets:    %12lld\n", ps->overflow_sets);
+  YS__statmsg(nid,
+	      "  Shared grants:        %12lld\n", ps->shared_grants);
+  YS__statmsg(nid,
+	      "  Forwards:             %12lld\n", ps->forwards);
+  if (ps->broadcast)
+    YS__statmsg(nid,
+		"    broadcast avoided:  %12lld\t(%.2f%%)\n",
+		ps->broadcast - ps->forwards,
+		100.0 * (ps->broadcast - ps->forwards) / ps->broadcast);
+  YS__statmsg(nid,
+	      "  Acknowledgements:     %12lld\n", ps->acks);
+  YS__statmsg(nid,
+	      "  Network messages:     %12lld\n", ps->messages);
+  if (ps->messages)
+    {
+      YS__statmsg(nid,
+		  "    avg. latency:       %12.2f\n",
+		  ps->net_cycles / ps->messages);
+      YS__statmsg(nid,
+		  "    avg. port wait:     %12.2f\n",
+		  ps->port_cycles / ps->messages);
+    }
+  YS__statmsg(nid, "\n");
+}
+
+
+
+/*=============================================================================
+ * Reset directory statistics. The count of unfiltered sets describes the
+ * directory contents and is kept.
+ */
+void Directory_stat_clear(int nid)
+{
+  dir_stat_t *ps       = &(NID2DIR(nid)->stats);
+  long long   overflow = ps->overflow_sets;
+
+  memset(ps, 0, sizeof(dir_stat_t));
+  ps->overflow_sets = overflow;          /* these sets stay unfiltered */
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+/*---------------------------------------------------------------------------*/
+/* Directory snoop filter. Each node's memory controller keeps a full-map    */
+/* sharer vector for the lines cached by its CPUs in a set-associative       */
+/* sparse directory. Replacing an entry back-invalidates the L2 copies of    */
+/* its line; a set whose entries cannot be replaced is no longer filtered    */
+/* and broadcasts all of its requests. Requests, data and writebacks still   */
+/* use the bus, and the bus remains the ordering point of the node: the      */
+/* directory only decides which L2 caches have to snoop a request. Those     */
+/* snoops and their coherence responses travel as point-to-point messages    */
+/* over a crossbar or 2D mesh instead of being broadcast, so the traffic     */
+/* they cause no longer grows with the number of CPUs, but bus bandwidth     */
+/* still does. The line states of the caches (MESI) are unchanged.           */
+/*---------------------------------------------------------------------------*/
+
+#ifndef __RSIM_DIRECTORY_H__
+#define __RSIM_DIRECTORY_H__
+
+
+#include "sim_main/simsys.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+
+
+#define NET_CROSSBAR            0
+#define NET_MESH                1
+
+
+/*
+ * Directory entry of one line. "owner" is the L2 cache that was granted
+ * the line exclusively (E or M state), or -1 if the line is uncached or
+ * shared. Clean lines are replaced silently, so "sharers" may name caches
+ * that no longer hold the line. An entry without sharers is free.
+ */
+typedef struct
+{
+  unsigned          lnum;       /* line number                              */
+  modmask_t         sharers;    /* one bit per CPU                          */
+  int               owner;
+  long long         used;       /* LRU stamp                                */
+} dir_entry_t;
+
+
+/*
+ * Point-to-point message: a forwarded coherence request on its way to an
+ * L2 cache, or a coherence response on its way back to the directory.
+ */
+typedef struct dir_msg
+{
+  REQ            *req;
+  int             state;        /* coherence response carried by an ack     */
+  double          time;         /* arrival time at the destination port     */
+  struct dir_msg *next;
+} dir_msg_t;
+
+
+/*
+ * Network destination port. Messages to one port are delivered in the
+ * order they were sent; each message occupies the port for a fixed number
+ * of cycles.
+ */
+typedef struct
+{
+  int        dest;              /* CPU, or ARCH_cpus for the directory      */
+  double     free_at;
+  dir_msg_t *head;
+  dir_msg_t *tail;
+  EVENT     *pevent;
+} dir_port_t;
+
+
+typedef struct
+{
+  long long lookups;
+  long long allocations;
+  long long replacements;       /* entries replaced while in use            */
+  long long back_invals;        /* L2 copies removed by replacements        */
+  long long back_invals_dirty;
+  long long overflow_sets;      /* sets that broadcast all requests         */
+  long long shared_grants;      /* reads answered shared by the directory   */
+  long long forwards;           /* forwards to L2 caches other than source  */
+  long long broadcast;          /* snoops a bus broadcast would have sent   */
+  long long acks;
+  long long messages;
+  double    net_cycles;         /* network latency incl. port contention    */
+  double    port_cycles;        /* port contention only                     */
+} dir_stat_t;
+
+
+typedef struct
+{
+  int           nodeid;
+  dir_entry_t  *table;          /* DIR_sets x DIR_assoc entries             */
+  char         *unfiltered;     /* per set: entries could not be replaced   */
+  long long     clock;          /* LRU time stamps                          */
+  dir_port_t   *ports;          /* one per CPU plus one for the directory   */
+  dir_stat_t    stats;
+} directory_t;
+
+
+extern directory_t *Directories;
+
+#define NID2DIR(nid)            (&(Directories[nid]))
+
+
+void      Directory_init          (void);
+modmask_t Directory_snoop_filter (REQ *req);
+void      Directory_forward       (REQ *req, int procid);
+void      Directory_send_response (REQ *req, int state, int procid);
+void      Directory_writeback     (REQ *req);
+void      Directory_warm          (int nodeid, int procid, unsigned paddr);
+int       Directory_idle          (int nodeid);
+void      Directory_print_params  (int nid);
+void      Directory_stat_report   (int nid);
+void      Directory_stat_clear    (int nid);
+
+
+#endif
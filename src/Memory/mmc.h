@@ -96,6 +96,9 @@ typedef struct mmc_trans
   unsigned          size;        /* Access size                              */
   int               c2c_copy;    /* has been satisfied by cache-2-cache copy */
   unsigned         *pdata;       /* Write Purge Data                         */
+  int               channel;     /* Memory channel serving this transaction  */
+  int               l3fill;      /* primary L3 miss, fill line when done     */
+  struct mmc_trans *l3next;      /* L3 cache queues and MSHR waiters         */
 
   rsim_time_t       issued;      /* Time issued to MMC                       */
   rsim_time_t       time;        /* time to enter different stage            */
@@ -103,6 +106,21 @@ typedef struct mmc_trans
 
 
 
+/*
+ * Each memory channel has its own queue of transactions waiting for the
+ * DRAM backend of that channel.
+ */
+typedef struct
+{
+  int              id;
+  int              slave_count;  /* transactions outstanding in the DRAMs    */
+  LinkQueue        waitlist;
+  EVENT           *waittask;
+  mmc_chan_stat_t  stats;
+} mmc_channel_t;
+
+
+
 /*
  * Data structure to hold information in per MMC base.
  */
@@ -111,14 +129,16 @@ typedef struct
   /* General internal data structures */
   int          nodeid;
   mmc_stat_t   stats;
+  rsim_time_t  stat_start;
   int          trans_count;
   rsim_time_t  busy_start;
   rsim_time_t  free_start;
-  int          slave_count;
   int          wb_count;
   LinkQueue    freelist;
-  LinkQueue    waitlist;
-  EVENT       *waittask;
+  LinkQueue    waitlist;         /* used when not simulating in detail       */
+
+  /* Memory channels */
+  mmc_channel_t *channels;
 
   /* Interface with bus module */
   DLinkQueue   reqqueue;
@@ -152,6 +172,9 @@ int          MMC_sim_on              (void);
 
 /* mmc_main.c */
 void         MMC_recv_trans          (mmc_info_t *, REQ *req);
+void         MMC_memory_access       (mmc_info_t *, mmc_trans_t *);
+void         MMC_write_line          (mmc_info_t *, unsigned paddr);
+void         MMC_read_done           (mmc_info_t *, mmc_trans_t *);
 void         MMC_process_waiter      (void);
 void         MMC_dram_data_ready     (int nodeid, mmc_trans_t *);
 void         MMC_dram_done           (int nodeid, mmc_trans_t *);
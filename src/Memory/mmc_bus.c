@@ -61,6 +61,7 @@
 #include "Caches/req.h"
 #include "Caches/cache.h"
 #include "Memory/mmc.h"
+#include "Memory/directory.h"
 #include "Bus/bus.h"
 
 
@@ -87,11 +88,12 @@ void MMC_recv_request(REQ *req)
   req->hit_type   = MEMHIT;
   req->line_cold  = 0; /* support it??? */
   req->data_rtn   = 0;
+  req->memtrans   = NULL;
 
   if (!tlb_non_coh(req->memattributes))
     {
-      req->cohe_count = ARCH_cpus + ARCH_coh_ios;
-      req->cohe_type  = REPLY_EXCL;
+      req->cohe_count = req->snoopers + ARCH_coh_ios;
+      req->cohe_type  = req->dir_shared ? REPLY_SH : REPLY_EXCL;
     }
   else
     req->cohe_count = 0;
@@ -135,6 +137,8 @@ void MMC_recv_write(REQ *req)
 {
   mmc_info_t *pmmc = NID2MMC(req->node);
 
+  Directory_writeback(req);
+
   req->cohe_count = 0;
   MMC_recv_trans(pmmc, req);
 }
@@ -210,7 +214,8 @@ void MMC_recv_data_response(REQ *req)
   if (par->cohe_count == 0)     /* was commented out @@@ */
     MMC_send_reply(pmmc, par);
 
-  par->memtrans->c2c_copy = 1;
+  if (par->memtrans)
+    par->memtrans->c2c_copy = 1;
 
   req->type = WRITEBACK;
   MMC_recv_trans(pmmc, req);
@@ -153,11 +153,17 @@ void MMC_dump(int nid)
   /*
    * Internal queues
    */
-  YS__logmsg(nid, "\ntrans_count = %d, slave_count = %d\n", 
-	     pmmc->trans_count, pmmc->slave_count);
-  DumpLinkQueue("wait list", &(pmmc->waitlist), 0, MMC_trans_dump, nid);
-  YS__logmsg(nid, "waittask scheduled: %s\n", 
-	     IsScheduled(pmmc->waittask) ? "YES" : "NO");
+  YS__logmsg(nid, "\ntrans_count = %d\n", pmmc->trans_count);
+  for (i = 0; i < mparam.channels; i++)
+    {
+      mmc_channel_t *pchan = &(pmmc->channels[i]);
+
+      YS__logmsg(nid, "channel %d: slave_count = %d\n", 
+		 i, pchan->slave_count);
+      DumpLinkQueue("wait list", &(pchan->waitlist), 0, MMC_trans_dump, nid);
+      YS__logmsg(nid, "waittask scheduled: %s\n", 
+		 IsScheduled(pchan->waittask) ? "YES" : "NO");
+    }
 }
 
 
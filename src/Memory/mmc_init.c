@@ -58,6 +58,7 @@
 #include "Processor/simio.h"
 #include "sim_main/util.h"
 #include "Memory/mmc.h"
+#include "Memory/directory.h"
 #include "IO/addr_map.h"
 #include "Bus/bus.h"
 #include "../../lamix/mm/mm.h"
@@ -94,7 +95,7 @@ void MMC_init(void)
       pmmc->trans_count = 0;
       pmmc->busy_start  = 0;
       pmmc->free_start  = 0;
-      pmmc->slave_count = 0;
+      pmmc->stat_start  = 0;
       pmmc->wb_count    = 0;
 
       lqueue_init(&(pmmc->waitlist), MAX_TRANS + mparam.max_writeback_count);
@@ -122,13 +123,30 @@ void MMC_init(void)
 	  continue;
 	}
 
-      pmmc->waittask = NewEvent("mmc_access", MMC_process_waiter, NODELETE, 0);
-      pmmc->waittask->uptr1 = (void *)pmmc;
+      if (!(pmmc->channels = RSIM_CALLOC(mmc_channel_t, mparam.channels)))
+	YS__errmsg(i, "malloc failed at %s:%i", __FILE__, __LINE__);
+
+      for (j = 0; j < mparam.channels; j++)
+	{
+	  mmc_channel_t *pchan = &(pmmc->channels[j]);
+
+	  pchan->id          = j;
+	  pchan->slave_count = 0;
+	  lqueue_init(&(pchan->waitlist),
+		      MAX_TRANS + mparam.max_writeback_count);
+
+	  pchan->waittask = NewEvent("mmc_access", MMC_process_waiter,
+				     NODELETE, 0);
+	  pchan->waittask->uptr1 = (void *)pmmc;
+	  pchan->waittask->uptr2 = (void *)pchan;
+	}
 
       dqueue_init(&(pmmc->reqqueue), BUS_TOTAL_REQUESTS * 2);
       lqueue_init(&(pmmc->arbwaiters), MAX_TRANS);
       pmmc->arbwaiters_count = 0;
     }
+
+  Directory_init();
 }
 
 
@@ -175,6 +193,14 @@ void MMC_read_params(void)
   if (mparam.max_writeback_count < ARCH_cpus + ARCH_coh_ios)
     YS__warnmsg(0, "Too few writebacks allowed by MC; possible deadlock!");
 
+  mparam.channels = 1;
+  get_parameter("MMC_channels",      &mparam.channels,             PARAM_INT);
+
+  if (mparam.channels < 1 || mparam.channels > MMC_MAX_CHANNELS ||
+      NumOfBits(mparam.channels, 1) == -1)
+    YS__errmsg(0, "MMC_channels must be a power of 2 up to %d: %d",
+	       MMC_MAX_CHANNELS, mparam.channels);
+
   mparam.cache_line_size = L2_DEFAULT_SIZE;
   get_parameter("L2C_line_size",     &mparam.cache_line_size, PARAM_INT);
   
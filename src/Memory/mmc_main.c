@@ -58,10 +58,25 @@
 #include "Memory/mmc.h"
 #include "Bus/bus.h"
 #include "DRAM/cqueue.h"
+#include "DRAM/dram_param.h"
 #include "DRAM/dram.h"
+#include "Caches/l3cache.h"
 
 static void MMC_trans_enqueue(mmc_info_t *pmmc, mmc_trans_t *ptrans);
 
+/*
+ * Account for a write entering the MMC; the bus stops sending write
+ * backs when too many of them are outstanding.
+ */
+static void MMC_write_start(mmc_info_t *pmmc)
+{
+  pmmc->wb_count++;
+  if (pmmc->wb_count == mparam.max_writeback_count - 1)
+    PID2BUS(pmmc->nodeid)->write_flowcontrol++;
+}
+
+
+
 /*
  * MMC receives a transaction. The first thing MMC does is to check the
  * cache. If the data is in cache, bingo! Otherwise, access the DRAMs.
@@ -75,6 +90,8 @@ void MMC_recv_trans(mmc_info_t *pmmc, REQ *req)
   ptrans->paddr       = req->paddr;
   ptrans->size        = mparam.cache_line_size;
   ptrans->c2c_copy    = 0;
+  ptrans->l3fill      = 0;
+  ptrans->l3next      = NULL;
 
   req->memtrans = ptrans;
 
@@ -91,15 +108,12 @@ void MMC_recv_trans(mmc_info_t *pmmc, REQ *req)
       pmmc->stats.writes++;
       ptrans->mtype = MMC_WRITE;
       ptrans->req   = 0;
-      if (req->type == WRITEBACK)
-	YS__PoolReturnObj(&YS__ReqPool, req);
       break;
 
     case COHE_REPLY:
       pmmc->stats.copyouts++;
       ptrans->mtype = MMC_WRITE;
       ptrans->req   = 0;
-      YS__PoolReturnObj(&YS__ReqPool, req);
       break;
   
     default:
@@ -108,12 +122,23 @@ void MMC_recv_trans(mmc_info_t *pmmc, REQ *req)
     }
 
   if (ptrans->mtype == MMC_WRITE)
-    {
-      pmmc->wb_count++;
-      if (pmmc->wb_count == mparam.max_writeback_count - 1)
-	PID2BUS(pmmc->nodeid)->write_flowcontrol++;
-    }
-  
+    MMC_write_start(pmmc);
+
+  if ((L3Caches == NULL) || !L3Cache_recv_trans(pmmc->nodeid, ptrans, req))
+    MMC_memory_access(pmmc, ptrans);
+
+  if ((req->type == WRITEBACK) || (req->type == COHE_REPLY))
+    YS__PoolReturnObj(&YS__ReqPool, req);
+}
+
+
+
+/*
+ * Send a transaction to the DRAM backend, or to the fixed-latency model
+ * when memory is not simulated in detail.
+ */
+void MMC_memory_access(mmc_info_t *pmmc, mmc_trans_t *ptrans)
+{
   if (mparam.sim == MMC_SIM_DETAILED)
     MMC_trans_enqueue(pmmc, ptrans);
   else
@@ -122,39 +147,81 @@ void MMC_recv_trans(mmc_info_t *pmmc, REQ *req)
 
 
 
+/*
+ * Write a line back to DRAM that is not associated with a bus transaction,
+ * such as a dirty victim of the L3 cache.
+ */
+void MMC_write_line(mmc_info_t *pmmc, unsigned paddr)
+{
+  mmc_trans_t *ptrans;
+
+  ptrans = MMC_get_free_trans(pmmc);
+  ptrans->issued      = YS__Simtime;
+  ptrans->paddr       = paddr;
+  ptrans->size        = mparam.cache_line_size;
+  ptrans->c2c_copy    = 0;
+  ptrans->l3fill      = 0;
+  ptrans->l3next      = NULL;
+  ptrans->mtype       = MMC_WRITE;
+  ptrans->req         = 0;
+
+  MMC_write_start(pmmc);
+  MMC_memory_access(pmmc, ptrans);
+}
+
+
+
 
 /*
- * First step a memory transaction need go through.
+ * First step a memory transaction need go through: queue it up at the
+ * memory channel its address maps to.
  */
 static void MMC_trans_enqueue(mmc_info_t *pmmc, mmc_trans_t *ptrans)
 {
-  ptrans->time = YS__Simtime;
+  mmc_channel_t *pchan;
+
+  ptrans->time    = YS__Simtime;
+  ptrans->channel = DRAM_paddr_to_channel(ptrans->paddr);
+  pchan           = &(pmmc->channels[ptrans->channel]);
+
+  if (mparam.collect_stats)
+    {
+      if (ptrans->mtype == MMC_READ)
+	pchan->stats.reads++;
+      else
+	pchan->stats.writes++;
+      pchan->stats.bytes     += ptrans->size;
+      pchan->stats.queue_len += pchan->waitlist.size;
+      if (pchan->waitlist.size >= pchan->stats.queue_max)
+	pchan->stats.queue_max = pchan->waitlist.size + 1;
+    }
 
-  lqueue_add(&(pmmc->waitlist), ptrans, pmmc->nodeid);
+  lqueue_add(&(pchan->waitlist), ptrans, pmmc->nodeid);
 
-  if (IsNotScheduled(pmmc->waittask))
+  if (IsNotScheduled(pchan->waittask))
     {
-      if (pmmc->waitlist.size != 1)
+      if (pchan->waitlist.size != 1)
 	YS__errmsg(pmmc->nodeid,
 		   "MMCGetRequest: no event scheduled for waiting req");
 
-      schedule_event(pmmc->waittask, ptrans->time);
+      schedule_event(pchan->waittask, ptrans->time);
     }
 }
 
 
 
 /*
- * This functions is activated by event "waittask". Try to process one
- * transaction from the wait list or the high priority list.
+ * This functions is activated by the "waittask" of a channel. Try to
+ * process one transaction from the wait list of that channel.
  */
 void MMC_process_waiter(void)
 {
-  mmc_info_t  *pmmc = (mmc_info_t *) YS__ActEvnt->uptr1;
-  mmc_trans_t *ptrans = 0;
+  mmc_info_t    *pmmc   = (mmc_info_t *) YS__ActEvnt->uptr1;
+  mmc_channel_t *pchan  = (mmc_channel_t *) YS__ActEvnt->uptr2;
+  mmc_trans_t   *ptrans = 0;
 
 #ifdef DEBUG
-  if (pmmc->waitlist.size == 0)
+  if (pchan->waitlist.size == 0)
     {
       YS__warnmsg(pmmc->nodeid, "MMC_process_waiter: nothing to be processed");
       return;
@@ -164,36 +231,38 @@ void MMC_process_waiter(void)
   /*
    * Check the wait list. 
    */
-  if (pmmc->slave_count < 8 && pmmc->waitlist.size > 0 && 
-	   ((mmc_trans_t*)(lqueue_head(&pmmc->waitlist)))->time <= YS__Simtime)
+  if (pchan->slave_count < MMC_SLAVE_MAX && pchan->waitlist.size > 0 && 
+	   ((mmc_trans_t*)(lqueue_head(&pchan->waitlist)))->time <= YS__Simtime)
     {
-      lqueue_get(&(pmmc->waitlist), ptrans);
+      lqueue_get(&(pchan->waitlist), ptrans);
     }
 
   if (ptrans)
     {
-      pmmc->slave_count++;
+      pchan->slave_count++;
       DRAM_recv_request(pmmc->nodeid, ptrans, ptrans->paddr, 
 			mparam.cache_line_size, 
 			(ptrans->mtype != MMC_READ));
     }
-  else if (pmmc->slave_count >= 8)
+  else if (pchan->slave_count >= MMC_SLAVE_MAX)
     {
-      schedule_event(pmmc->waittask, YS__Simtime + 1);
+      if (mparam.collect_stats)
+	pchan->stats.slave_stalls++;
+      schedule_event(pchan->waittask, YS__Simtime + 1);
       return;
     }
 
   /*
    * Schedule for next transaction
    */
-  ptrans = lqueue_head(&pmmc->waitlist);
+  ptrans = lqueue_head(&pchan->waitlist);
   if (ptrans)
     {
       rsim_time_t nexttime = 1.0e20;
       if (ptrans)
 	nexttime = MIN(nexttime, ptrans->time);
    
-      schedule_event(pmmc->waittask, MAX(YS__Simtime, nexttime));
+      schedule_event(pchan->waittask, MAX(YS__Simtime, nexttime));
     }
 }
 
@@ -210,11 +279,28 @@ void MMC_dram_data_ready(int nodeid, mmc_trans_t *ptrans)
   /*
    * The transaction has gathered all the data it needs. Consider it done.
    */
-  pmmc->slave_count--;
+  pmmc->channels[ptrans->channel].slave_count--;
   if (ptrans->mtype == MMC_READ)
+    MMC_read_done(pmmc, ptrans);
+}
+
+
+
+/*
+ * The data of a read is available, from DRAM or from the L3 cache. Fill
+ * the L3 cache if this was a primary L3 miss, and return the data unless
+ * a cache-to-cache copy supplies it. The request no longer needs to know
+ * its transaction, which is released soon.
+ */
+void MMC_read_done(mmc_info_t *pmmc, mmc_trans_t *ptrans)
+{
+  if (ptrans->l3fill)
+    L3Cache_fill(pmmc->nodeid, ptrans);
+
+  if (!ptrans->c2c_copy)
     {
-      if (!ptrans->c2c_copy)
-	MMC_data_fetch_done(pmmc, ptrans->req);
+      ptrans->req->memtrans = NULL;
+      MMC_data_fetch_done(pmmc, ptrans->req);
     }
 }
 
@@ -335,10 +421,7 @@ void MMC_nosim_done(void)
 	  YS__PoolReturnObj(&YS__ReqPool, req);
 	}
       else
-	{
-          if (!ptrans->c2c_copy)
-   	    MMC_data_fetch_done(pmmc, req);
-	}
+	MMC_read_done(pmmc, ptrans);
     }
 
   if (pmmc->waitlist.size > 0)
@@ -71,6 +71,7 @@ typedef struct
   int  collect_stats;
   int  max_writeback_count;
   int  cache_line_size;
+  int  channels;
 } mmc_param_t;
 
 extern mmc_param_t  mparam;
@@ -79,4 +80,7 @@ extern mmc_param_t  mparam;
 #define MMC_SIM_PIPELINED  2
 #define MMC_SIM_DETAILED   3
 
+#define MMC_MAX_CHANNELS   16
+#define MMC_SLAVE_MAX      8
+
 #endif
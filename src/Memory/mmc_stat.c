@@ -72,6 +72,8 @@ void MMC_stat_report(int nid)
 {
   mmc_info_t *pmmc = NID2MMC(nid);
   long long   total;
+  rsim_time_t cycles;
+  int         k;
 
   if (mparam.collect_stats == 0 || Cache_perfect()) 
     return;
@@ -113,6 +115,37 @@ void MMC_stat_report(int nid)
   YS__statmsg(nid,
 	      "  load latency:         %12.2f\n\n",
 	      1.0*pmmc->stats.load_cycles / pmmc->stats.load_count+2);
+
+  if (mparam.sim != MMC_SIM_DETAILED)
+    return;
+
+  /*
+   * Bandwidth and queue depth of each memory channel.
+   */
+  cycles = YS__Simtime - pmmc->stat_start;
+  for (k = 0; k < mparam.channels; k++)
+    {
+      mmc_chan_stat_t *pcs = &(pmmc->channels[k].stats);
+      long long        count = pcs->reads + pcs->writes;
+
+      YS__statmsg(nid, "  Channel %d\n", k);
+      YS__statmsg(nid,
+		  "    reads:              %12lld\t", pcs->reads);
+      YS__statmsg(nid,
+		  "  writes:              %12lld\n", pcs->writes);
+      YS__statmsg(nid,
+		  "    bytes:              %12lld\t", pcs->bytes);
+      YS__statmsg(nid,
+		  "  bytes/cycle:         %12.3f\n",
+		  cycles > 0 ? pcs->bytes / cycles : 0.0);
+      YS__statmsg(nid,
+		  "    avg queue depth:    %12.3f\t",
+		  count ? 1.0 * pcs->queue_len / count : 0.0);
+      YS__statmsg(nid,
+		  "  max queue depth:     %12lld\n", pcs->queue_max);
+      YS__statmsg(nid,
+		  "    DRAM slot stalls:   %12lld\n\n", pcs->slave_stalls);
+    }
 }
 
 
@@ -142,6 +175,9 @@ void MMC_print_params(int nid)
 		  mparam.frequency);
     }
 
+  if (mparam.sim == MMC_SIM_DETAILED)
+    YS__statmsg(nid, "  channels\t%4d\n", mparam.channels);
+
   YS__statmsg(nid, "  statistics\t  %s \n\n",
 	      mparam.collect_stats ? "On" : "Of");
 }
@@ -157,4 +193,14 @@ void MMC_stat_clear(int nid)
     return;
 
   bzero(&((NID2MMC(nid))->stats), sizeof(mmc_stat_t));
+
+  if (mparam.sim == MMC_SIM_DETAILED)
+    {
+      mmc_info_t *pmmc = NID2MMC(nid);
+      int         k;
+
+      pmmc->stat_start = YS__Simtime;
+      for (k = 0; k < mparam.channels; k++)
+	bzero(&(pmmc->channels[k].stats), sizeof(mmc_chan_stat_t));
+    }
 }
@@ -78,6 +78,20 @@ typedef struct mmcstat
   long long  load_count;
 } mmc_stat_t;
 
+
+/*
+ * Per-channel statistics
+ */
+typedef struct mmcchanstat
+{
+  long long  reads;
+  long long  writes;
+  long long  bytes;
+  long long  queue_len;		/* sum of wait list lengths at arrival */
+  long long  queue_max;
+  long long  slave_stalls;	/* cycles with all DRAM slots in use   */
+} mmc_chan_stat_t;
+
 #endif
 
 
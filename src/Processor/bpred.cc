@@ -0,0 +1,654 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include "sim_main/simsys.h"
+}
+
+#include "Processor/bpred.h"
+
+
+btbtype BTB_TYPE   = BTBNONE;
+int     BTB_SIZE   = 512;
+int     BTB_ASSOC  = 4;
+int     BP_PROFILE = 16;
+
+
+/* history lengths of the tagged tables, at most 64 bits of history */
+static const int tage_hist[TAGE_TABLES]     = { 5, 12, 27, 60 };
+static const int ittage_hist[ITTAGE_TABLES] = { 4, 12, 32 };
+
+
+
+/*************************************************************************/
+/* Helper functions                                                      */
+/*************************************************************************/
+
+/*
+ * Round a table size down to a power of two, return log2 in 'bits'
+ */
+static unsigned TableSize(int size, int &bits)
+{
+  unsigned n = 1;
+
+  bits = 0;
+  while ((int)(n << 1) <= size)
+    {
+      n <<= 1;
+      bits++;
+    }
+
+  return(n);
+}
+
+
+/*
+ * Fold the youngest 'len' bits of history into 'bits' bits
+ */
+static inline unsigned Fold(unsigned long long hist, int len, int bits)
+{
+  unsigned result = 0;
+
+  if (len < 64)
+    hist &= (1ULL << len) - 1;
+
+  while (hist)
+    {
+      result ^= (unsigned)hist & ((1 << bits) - 1);
+      hist >>= bits;
+    }
+
+  return(result);
+}
+
+
+static inline void CounterUpdate(unsigned char &ctr, int up, int max)
+{
+  if (up && ctr < max)
+    ctr++;
+  else if (!up && ctr > 0)
+    ctr--;
+}
+
+
+
+/*************************************************************************/
+/* gshare                                                                */
+/*************************************************************************/
+
+GsharePredictor::GsharePredictor(int size)
+{
+  int bits;
+  unsigned n = TableSize(size, bits);
+
+  pht  = new unsigned char[n];
+  memset(pht, 1, n);
+  mask = n - 1;
+}
+
+
+int GsharePredictor::Predict(unsigned pc, unsigned long long hist)
+{
+  return(pht[((pc >> 2) ^ (unsigned)hist) & mask] >= 2);
+}
+
+
+void GsharePredictor::Update(unsigned pc, unsigned long long hist, int taken)
+{
+  CounterUpdate(pht[((pc >> 2) ^ (unsigned)hist) & mask], taken, 3);
+}
+
+
+
+/*************************************************************************/
+/* Tournament                                                            */
+/*************************************************************************/
+
+TournamentPredictor::TournamentPredictor(int size)
+{
+  int bits;
+  unsigned n = TableSize(size, bits);
+
+  localhist = new unsigned short[n];
+  localpht  = new unsigned char[1 << TOURN_LOCAL_BITS];
+  globalpht = new unsigned char[n];
+  chooser   = new unsigned char[n];
+  mask      = n - 1;
+
+  memset(localhist, 0, n * sizeof(unsigned short));
+  memset(localpht, 3, 1 << TOURN_LOCAL_BITS);
+  memset(globalpht, 1, n);
+  memset(chooser, 1, n);
+}
+
+
+int TournamentPredictor::Predict(unsigned pc, unsigned long long hist)
+{
+  unsigned g = (unsigned)hist & mask;
+
+  if (chooser[g] >= 2)
+    return(globalpht[g] >= 2);
+  else
+    return(localpht[localhist[(pc >> 2) & mask]] >= 4);
+}
+
+
+void TournamentPredictor::Update(unsigned pc, unsigned long long hist,
+				 int taken)
+{
+  unsigned g = (unsigned)hist & mask;
+  unsigned l = (pc >> 2) & mask;
+  int lpred = localpht[localhist[l]] >= 4;
+  int gpred = globalpht[g] >= 2;
+
+  if (lpred != gpred)
+    CounterUpdate(chooser[g], gpred == taken, 3);
+
+  CounterUpdate(localpht[localhist[l]], taken, 7);
+  CounterUpdate(globalpht[g], taken, 3);
+
+  localhist[l] = ((localhist[l] << 1) | taken) &
+    ((1 << TOURN_LOCAL_BITS) - 1);
+}
+
+
+
+/*************************************************************************/
+/* TAGE                                                                  */
+/*************************************************************************/
+
+TagePredictor::TagePredictor(int size)
+{
+  unsigned n = TableSize(size, logsize);
+  int t;
+
+  base = new unsigned char[n];
+  memset(base, 1, n);
+
+  for (t = 0; t < TAGE_TABLES; t++)
+    {
+      table[t] = new TageEntry[n];
+      memset(table[t], 0, n * sizeof(TageEntry));
+    }
+
+  mask    = n - 1;
+  updates = 0;
+}
+
+
+/*
+ * Compute index and tag for every tagged table and find the longest
+ * (provider) and second longest (alternate) matching table, -1 if none
+ */
+void TagePredictor::Lookup(unsigned pc, unsigned long long hist,
+			   unsigned *idx, unsigned *tag,
+			   int &provider, int &alt)
+{
+  int t;
+
+  provider = alt = -1;
+
+  for (t = 0; t < TAGE_TABLES; t++)
+    {
+      idx[t] = ((pc >> 2) ^ (pc >> (2 + logsize)) ^
+		Fold(hist, tage_hist[t], logsize)) & mask;
+      tag[t] = ((pc >> 2) ^ Fold(hist, tage_hist[t], TAGE_TAG_BITS) ^
+		(Fold(hist, tage_hist[t], TAGE_TAG_BITS - 1) << 1)) &
+	((1 << TAGE_TAG_BITS) - 1);
+
+      if (table[t][idx[t]].tag == tag[t])
+	{
+	  alt = provider;
+	  provider = t;
+	}
+    }
+}
+
+
+int TagePredictor::Predict(unsigned pc, unsigned long long hist)
+{
+  unsigned idx[TAGE_TABLES], tag[TAGE_TABLES];
+  int provider, alt;
+
+  Lookup(pc, hist, idx, tag, provider, alt);
+
+  if (provider >= 0)
+    return(table[provider][idx[provider]].ctr >= 0);
+  else
+    return(base[(pc >> 2) & mask] >= 2);
+}
+
+
+void TagePredictor::Update(unsigned pc, unsigned long long hist, int taken)
+{
+  unsigned idx[TAGE_TABLES], tag[TAGE_TABLES];
+  int provider, alt, pred, altpred, t, n;
+
+  Lookup(pc, hist, idx, tag, provider, alt);
+
+  if (alt >= 0)
+    altpred = table[alt][idx[alt]].ctr >= 0;
+  else
+    altpred = base[(pc >> 2) & mask] >= 2;
+
+  if (provider >= 0)
+    {
+      TageEntry *e = &table[provider][idx[provider]];
+
+      pred = e->ctr >= 0;
+      if (pred != altpred)
+	{
+	  if (pred == taken && e->u < 3)
+	    e->u++;
+	  else if (pred != taken && e->u > 0)
+	    e->u--;
+	}
+
+      if (taken && e->ctr < 3)
+	e->ctr++;
+      else if (!taken && e->ctr > -4)
+	e->ctr--;
+    }
+  else
+    {
+      pred = altpred;
+      CounterUpdate(base[(pc >> 2) & mask], taken, 3);
+    }
+
+  // on a misprediction, allocate an entry in a table with longer history
+  if (pred != taken && provider < TAGE_TABLES - 1)
+    {
+      for (t = provider + 1; t < TAGE_TABLES; t++)
+	if (table[t][idx[t]].u == 0)
+	  {
+	    table[t][idx[t]].tag = tag[t];
+	    table[t][idx[t]].ctr = taken ? 0 : -1;
+	    break;
+	  }
+
+      if (t == TAGE_TABLES)
+	for (t = provider + 1; t < TAGE_TABLES; t++)
+	  if (table[t][idx[t]].u > 0)
+	    table[t][idx[t]].u--;
+    }
+
+  // age the usefulness counters periodically
+  if (++updates >= TAGE_RESET_PERIOD)
+    {
+      updates = 0;
+      for (t = 0; t < TAGE_TABLES; t++)
+	for (n = 0; n <= (int)mask; n++)
+	  table[t][n].u >>= 1;
+    }
+}
+
+
+
+/*************************************************************************/
+/* Branch target buffer                                                  */
+/*************************************************************************/
+
+BranchTargetBuffer::BranchTargetBuffer(int size, int assoc)
+{
+  int bits;
+  unsigned n;
+
+  if (assoc < 1)
+    assoc = 1;
+  if (size < assoc)
+    size = assoc;
+
+  n = TableSize(size / assoc, bits);
+
+  this->assoc = assoc;
+  entries = new BTBEntry[n * assoc];
+  memset(entries, 0, n * assoc * sizeof(BTBEntry));
+  setmask = n - 1;
+  clock   = 0;
+}
+
+
+BTBEntry *BranchTargetBuffer::Find(unsigned pc)
+{
+  BTBEntry *set = &entries[((pc >> 2) & setmask) * assoc];
+  int n;
+
+  for (n = 0; n < assoc; n++)
+    if (set[n].lru && set[n].pc == pc)
+      return(&set[n]);
+
+  return(NULL);
+}
+
+
+unsigned BranchTargetBuffer::Predict(unsigned pc, unsigned long long)
+{
+  BTBEntry *e = Find(pc);
+
+  if (e == NULL)
+    return(BP_NOTARGET);
+
+  e->lru = ++clock;
+  return(e->target);
+}
+
+
+void BranchTargetBuffer::Update(unsigned pc, unsigned long long,
+				unsigned target)
+{
+  BTBEntry *e = Find(pc);
+  int n;
+
+  if (e == NULL)
+    {
+      BTBEntry *set = &entries[((pc >> 2) & setmask) * assoc];
+
+      e = &set[0];
+      for (n = 1; n < assoc; n++)
+	if (set[n].lru < e->lru)
+	  e = &set[n];
+
+      e->pc = pc;
+    }
+
+  e->target = target;
+  e->lru    = ++clock;
+}
+
+
+void BranchTargetBuffer::Invalidate(unsigned pc)
+{
+  BTBEntry *e = Find(pc);
+
+  if (e != NULL)
+    e->lru = 0;
+}
+
+
+
+/*************************************************************************/
+/* ITTAGE                                                                */
+/*************************************************************************/
+
+IttagePredictor::IttagePredictor(int size, int assoc):
+  btb(size, assoc)
+{
+  unsigned n = TableSize(size, logsize);
+  int t;
+
+  for (t = 0; t < ITTAGE_TABLES; t++)
+    {
+      table[t] = new IttageEntry[n];
+      memset(table[t], 0, n * sizeof(IttageEntry));
+    }
+
+  mask = n - 1;
+}
+
+
+void IttagePredictor::Lookup(unsigned pc, unsigned long long hist,
+			     unsigned *idx, unsigned *tag, int &provider)
+{
+  int t;
+
+  provider = -1;
+
+  for (t = 0; t < ITTAGE_TABLES; t++)
+    {
+      idx[t] = ((pc >> 2) ^ Fold(hist, ittage_hist[t], logsize)) & mask;
+      tag[t] = ((pc >> 2) ^ (pc >> (2 + TAGE_TAG_BITS)) ^
+		Fold(hist, ittage_hist[t], TAGE_TAG_BITS)) &
+	((1 << TAGE_TAG_BITS) - 1);
+
+      if (table[t][idx[t]].target != 0 && table[t][idx[t]].tag == tag[t])
+	provider = t;
+    }
+}
+
+
+unsigned IttagePredictor::Predict(unsigned pc, unsigned long long hist)
+{
+  unsigned idx[ITTAGE_TABLES], tag[ITTAGE_TABLES];
+  int provider;
+
+  Lookup(pc, hist, idx, tag, provider);
+
+  if (provider >= 0)
+    return(table[provider][idx[provider]].target);
+  else
+    return(btb.Predict(pc, hist));
+}
+
+
+void IttagePredictor::Update(unsigned pc, unsigned long long hist,
+			     unsigned target)
+{
+  unsigned idx[ITTAGE_TABLES], tag[ITTAGE_TABLES];
+  unsigned pred;
+  int provider, t;
+
+  Lookup(pc, hist, idx, tag, provider);
+
+  if (provider >= 0)
+    {
+      IttageEntry *e = &table[provider][idx[provider]];
+
+      pred = e->target;
+      if (pred == target)
+	{
+	  if (e->ctr < 3)
+	    e->ctr++;
+	  e->u = 1;
+	}
+      else if (e->ctr > 0)
+	e->ctr--;
+      else
+	{
+	  e->target = target;
+	  e->u = 0;
+	}
+    }
+  else
+    pred = btb.Predict(pc, hist);
+
+  btb.Update(pc, hist, target);
+
+  // on a misprediction, allocate an entry in a table with longer history
+  if (pred != target && provider < ITTAGE_TABLES - 1)
+    {
+      for (t = provider + 1; t < ITTAGE_TABLES; t++)
+	if (table[t][idx[t]].u == 0)
+	  {
+	    table[t][idx[t]].tag    = tag[t];
+	    table[t][idx[t]].target = target;
+	    table[t][idx[t]].ctr    = 0;
+	    break;
+	  }
+
+      if (t == ITTAGE_TABLES)
+	for (t = provider + 1; t < ITTAGE_TABLES; t++)
+	  table[t][idx[t]].u = 0;
+    }
+}
+
+
+
+/*************************************************************************/
+/* Per-PC misprediction profile                                          */
+/*************************************************************************/
+
+BranchProfile::BranchProfile()
+{
+  size    = 1024;
+  used    = 0;
+  entries = new BranchProfEntry[size];
+  memset(entries, 0, size * sizeof(BranchProfEntry));
+}
+
+
+/*
+ * Open addressing with linear probing; grow when half full
+ */
+BranchProfEntry *BranchProfile::Find(unsigned pc)
+{
+  unsigned n;
+
+  if (2 * (used + 1) > size)
+    {
+      BranchProfEntry *old = entries;
+      unsigned oldsize = size;
+
+      size *= 2;
+      entries = new BranchProfEntry[size];
+      memset(entries, 0, size * sizeof(BranchProfEntry));
+
+      for (n = 0; n < oldsize; n++)
+	if (old[n].pc != 0)
+	  {
+	    unsigned i = (old[n].pc >> 2) & (size - 1);
+	    while (entries[i].pc != 0)
+	      i = (i + 1) & (size - 1);
+	    entries[i] = old[n];
+	  }
+
+      delete[] old;
+    }
+
+  n = (pc >> 2) & (size - 1);
+  while (entries[n].pc != 0 && entries[n].pc != pc)
+    n = (n + 1) & (size - 1);
+
+  if (entries[n].pc == 0)
+    {
+      entries[n].pc = pc;
+      used++;
+    }
+
+  return(&entries[n]);
+}
+
+
+void BranchProfile::Record(unsigned pc, int mispredicted, int flushed)
+{
+  BranchProfEntry *e = Find(pc);
+
+  e->predicts++;
+  if (mispredicted)
+    {
+      e->mispredicts++;
+      e->flushed += flushed;
+    }
+}
+
+
+static int ProfileCompare(const void *a, const void *b)
+{
+  const BranchProfEntry *pa = *(const BranchProfEntry **)a;
+  const BranchProfEntry *pb = *(const BranchProfEntry **)b;
+
+  if (pa->mispredicts != pb->mispredicts)
+    return(pa->mispredicts < pb->mispredicts ? 1 : -1);
+  if (pa->flushed != pb->flushed)
+    return(pa->flushed < pb->flushed ? 1 : -1);
+  return(pa->pc < pb->pc ? -1 : 1);
+}
+
+
+/*
+ * Print the branches with the most mispredictions
+ */
+void BranchProfile::Report(int nid, int count)
+{
+  BranchProfEntry **sorted;
+  unsigned n, m;
+
+  if (used == 0)
+    return;
+
+  sorted = new BranchProfEntry*[used];
+  for (n = 0, m = 0; n < size; n++)
+    if (entries[n].pc != 0)
+      sorted[m++] = &entries[n];
+
+  qsort(sorted, used, sizeof(BranchProfEntry*), ProfileCompare);
+
+  YS__statmsg(nid, "Most frequently mispredicted branches (%u total)\n\n",
+	      used);
+  YS__statmsg(nid, "  PC          predictions  mispredicts    rate   flushed\n");
+
+  for (n = 0; n < used && (int)n < count; n++)
+    {
+      if (sorted[n]->mispredicts == 0)
+	break;
+
+      YS__statmsg(nid, "  0x%08X %12lld %12lld %6.2f%% %9lld\n",
+		  sorted[n]->pc, sorted[n]->predicts, sorted[n]->mispredicts,
+		  100.0 * double(sorted[n]->mispredicts) / sorted[n]->predicts,
+		  sorted[n]->flushed);
+    }
+
+  delete[] sorted;
+}
+
+
+void BranchProfile::Reset()
+{
+  memset(entries, 0, size * sizeof(BranchProfEntry));
+  used = 0;
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#ifndef __RSIM_BPRED_H__
+#define __RSIM_BPRED_H__
+
+/*
+ * Dynamic branch predictors beyond the bimodal and agree tables that
+ * ProcState keeps inline. Direction predictors (gshare, tournament, TAGE)
+ * are selected with 'bpbtype', target predictors for indirect jumps
+ * (set-associative BTB, ITTAGE) with 'btbtype'. All of them are indexed
+ * with the global direction history that ProcState maintains speculatively
+ * at fetch and repairs on mispredictions; every branch instance carries
+ * the history it was predicted with, so that updates at resolution see
+ * the same table entries as the prediction did.
+ */
+
+/***************************************************************************/
+/***************** Target predictor configuration **************************/
+/***************************************************************************/
+
+enum btbtype
+{
+  BTBNONE,                   /* indirect jumps are not predicted           */
+  BTBASSOC,                  /* set-associative branch target buffer       */
+  BTBITTAGE                  /* ITTAGE tagged tables backed by a BTB       */
+};
+
+extern btbtype BTB_TYPE;
+extern int     BTB_SIZE;                  /* BTB/ITTAGE table entries      */
+extern int     BTB_ASSOC;                 /* BTB associativity             */
+extern int     BP_PROFILE;                /* branches in per-PC profile    */
+
+#define BP_NOTARGET   ((unsigned) -1)     /* no target prediction          */
+
+
+
+/***************************************************************************/
+/********************* Direction predictors ********************************/
+/***************************************************************************/
+
+class DirPredictor
+{
+public:
+  virtual ~DirPredictor() {}
+
+  virtual int  Predict(unsigned pc, unsigned long long hist) = 0;
+  virtual void Update (unsigned pc, unsigned long long hist, int taken) = 0;
+};
+
+
+/*
+ * gshare: one table of 2-bit counters indexed by PC xor global history
+ */
+class GsharePredictor : public DirPredictor
+{
+private:
+  unsigned char *pht;
+  unsigned       mask;
+
+public:
+  GsharePredictor(int size);
+
+  int  Predict(unsigned pc, unsigned long long hist);
+  void Update (unsigned pc, unsigned long long hist, int taken);
+};
+
+
+/*
+ * tournament: Alpha 21264 style, a per-branch local history predictor and
+ * a global history predictor, with a global chooser between the two
+ */
+#define TOURN_LOCAL_BITS   10
+
+class TournamentPredictor : public DirPredictor
+{
+private:
+  unsigned short *localhist;              /* per-branch histories          */
+  unsigned char  *localpht;               /* 3-bit counters                */
+  unsigned char  *globalpht;              /* 2-bit counters                */
+  unsigned char  *chooser;                /* 2-bit, >= 2 selects global    */
+  unsigned        mask;
+
+public:
+  TournamentPredictor(int size);
+
+  int  Predict(unsigned pc, unsigned long long hist);
+  void Update (unsigned pc, unsigned long long hist, int taken);
+};
+
+
+/*
+ * TAGE: a bimodal base table plus tagged tables indexed with geometrically
+ * increasing history lengths; the longest matching table provides the
+ * prediction
+ */
+#define TAGE_TABLES        4
+#define TAGE_TAG_BITS      9
+#define TAGE_RESET_PERIOD  (256 * 1024)   /* updates between u-bit aging   */
+
+struct TageEntry
+{
+  unsigned short tag;
+  signed char    ctr;                     /* 3-bit signed, >= 0 is taken   */
+  unsigned char  u;                       /* 2-bit usefulness              */
+};
+
+class TagePredictor : public DirPredictor
+{
+private:
+  unsigned char *base;
+  TageEntry     *table[TAGE_TABLES];
+  unsigned       mask;
+  int            logsize;
+  int            updates;
+
+  void Lookup(unsigned pc, unsigned long long hist,
+	      unsigned *idx, unsigned *tag, int &provider, int &alt);
+
+public:
+  TagePredictor(int size);
+
+  int  Predict(unsigned pc, unsigned long long hist);
+  void Update (unsigned pc, unsigned long long hist, int taken);
+};
+
+
+
+/***************************************************************************/
+/*********************** Target predictors *********************************/
+/***************************************************************************/
+
+class TargetPredictor
+{
+public:
+  virtual ~TargetPredictor() {}
+
+  virtual unsigned Predict(unsigned pc, unsigned long long hist) = 0;
+  virtual void     Update (unsigned pc, unsigned long long hist,
+			   unsigned target) = 0;
+};
+
+
+struct BTBEntry
+{
+  unsigned pc;
+  unsigned target;
+  unsigned lru;                           /* last use, 0 if invalid        */
+};
+
+class BranchTargetBuffer : public TargetPredictor
+{
+private:
+  BTBEntry *entries;
+  unsigned  setmask;
+  int       assoc;
+  unsigned  clock;
+
+  BTBEntry *Find(unsigned pc);
+
+public:
+  BranchTargetBuffer(int size, int assoc);
+
+  unsigned Predict(unsigned pc, unsigned long long hist);
+  void     Update (unsigned pc, unsigned long long hist, unsigned target);
+  void     Invalidate(unsigned pc);
+};
+
+
+/*
+ * ITTAGE: TAGE organization storing targets instead of directions; the BTB
+ * serves as the untagged base predictor
+ */
+#define ITTAGE_TABLES      3
+
+struct IttageEntry
+{
+  unsigned short tag;
+  unsigned char  ctr;                     /* 2-bit target confidence       */
+  unsigned char  u;                       /* usefulness bit                */
+  unsigned       target;
+};
+
+class IttagePredictor : public TargetPredictor
+{
+private:
+  BranchTargetBuffer  btb;
+  IttageEntry        *table[ITTAGE_TABLES];
+  unsigned            mask;
+  int                 logsize;
+
+  void Lookup(unsigned pc, unsigned long long hist,
+	      unsigned *idx, unsigned *tag, int &provider);
+
+public:
+  IttagePredictor(int size, int assoc);
+
+  unsigned Predict(unsigned pc, unsigned long long hist);
+  void     Update (unsigned pc, unsigned long long hist, unsigned target);
+};
+
+
+
+/***************************************************************************/
+/*********************** Per-PC misprediction profile **********************/
+/***************************************************************************/
+
+struct BranchProfEntry
+{
+  unsigned  pc;                           /* 0 marks an empty slot         */
+  long long predicts;                     /* resolved predictions          */
+  long long mispredicts;                  /* bad or missing predictions    */
+  long long flushed;                      /* instructions flushed          */
+};
+
+class BranchProfile
+{
+private:
+  BranchProfEntry *entries;
+  unsigned         size;
+  unsigned         used;
+
+  BranchProfEntry *Find(unsigned pc);
+
+public:
+  BranchProfile();
+
+  void Record(unsigned pc, int mispredicted, int flushed);
+  void Report(int nid, int count);
+  void Reset();
+};
+
+#endif
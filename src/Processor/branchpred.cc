@@ -60,6 +60,7 @@ extern "C"
 #include "Processor/procstate.h"
 #include "Processor/mainsim.h"
 #include "Processor/branchpred.h"
+#include "Processor/ftq.h"
 #include "Processor/simio.h"
 #include "Processor/fastnews.h"
 #include "Processor/tagcvt.hh"
@@ -250,9 +251,14 @@ void GoodPrediction(instance * inst, ProcState * proc)
 {
   if (inst->code.uncond_branch == 4)                  // if it's a RAS access
     proc->ras_good_predicts++;
+  else if (inst->code.uncond_branch)                  // indirect jump
+    proc->jmp_good_predicts++;
   else
     proc->bpb_good_predicts++;
 
+  if (proc->BranchProf)
+    proc->BranchProf->Record(inst->pc, 0, 0);
+
   long long tag_to_use = inst->tag;
   instance *inst2;
 
@@ -321,9 +327,17 @@ void BadPrediction(instance * inst, ProcState * proc)
 
   if (inst->code.uncond_branch == 4)  // if it's a RAS access
     proc->ras_bad_predicts++;
+  else if (inst->code.uncond_branch)  // indirect jump
+    proc->jmp_bad_predicts++;
   else
     proc->bpb_bad_predicts++;
 
+  // repair the global history, later branches were on the wrong path
+  if (inst->code.cond_branch && inst->code.aux1 != 0)
+    proc->bp_history = (inst->bp_hist << 1) | !inst->taken;
+  else
+    proc->bp_history = inst->bp_hist;
+
   long long tag_to_use = inst->tag;
   instance *inst2;
 
@@ -339,6 +353,9 @@ void BadPrediction(instance * inst, ProcState * proc)
     {
       // The delay slot (and things after it) have not been issued yet!
       proc->copymappernext = 0; // We are saved the touble of saving mappers
+
+      if (proc->BranchProf)
+	proc->BranchProf->Record(inst->pc, 1, 0);
       return;
     }
 
@@ -403,6 +420,9 @@ void BadPrediction(instance * inst, ProcState * proc)
 #ifndef NOSTAT
   StatrecUpdate(proc->BadPredFlushes, pre - post, 1);
 #endif
+
+  if (proc->BranchProf)
+    proc->BranchProf->Record(inst->pc, 1, pre - post);
   
   return;
 }
@@ -417,6 +437,10 @@ void HandleUnPredicted(instance * inst, ProcState * proc)
   long long tag_to_use = inst->tag;
   instance *inst2;
 
+  proc->jmp_unpredicted++;
+  if (proc->BranchProf)
+    proc->BranchProf->Record(inst->pc, 1, 0);
+
   if (inst->code.annul == 0)
     {
       tag_to_use = inst->tag + 1;
@@ -472,6 +496,10 @@ void FlushFetchQ(ProcState *proc)
       DeleteInstance(fqe.inst, proc);
       fetch_queue->Dequeue();
     }
+
+  // stop fetching down this path, decode redirects the FTQ
+  if (proc->ftq)
+    proc->ftq->Flush();
 }
 
 
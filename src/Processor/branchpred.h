@@ -117,7 +117,10 @@ enum bptype
 {
   TWOBIT,                    /* Two-bit hardware bimodal prediction scheme */
   TWOBITAGREE,               /* Two-bit hardware agree prediction scheme   */
-  STATIC                     /* static prediction scheme                   */
+  STATIC,                    /* static prediction scheme                   */
+  GSHARE,                    /* global history xor PC (see bpred.h)        */
+  TOURNAMENT,                /* local/global tournament predictor          */
+  TAGE                       /* tagged geometric history length predictor  */
 };
 
 
@@ -55,6 +55,8 @@
 #ifndef __RSIM_BRANCHPRED_HH__
 #define __RSIM_BRANCHPRED_HH__
 
+#include "Processor/bpred.h"
+
 /*
  * Predict the direction of control transfer for branch.
  * this function is called when we first see that an instruction is a
@@ -69,6 +71,8 @@ inline void StartCtlXfer(instance * inst, ProcState * proc)
 {
   int result = 0;
 
+  inst->bp_hist = proc->bp_history;
+
   if (inst->code.uncond_branch == 2 || inst->code.uncond_branch == 3)
     {
       // in this case, we know the address we want to go to.
@@ -97,10 +101,17 @@ inline void StartCtlXfer(instance * inst, ProcState * proc)
   
   else if (inst->code.uncond_branch)
     { // it's a random jump
-      // CURRENTLY, WE DON'T PREDICT THIS SORT OF ACCESS
-      result = 3;
-      inst->branch_pred = (unsigned) -1;
+      // predict the target if there is a BTB, otherwise wait for it
+      if (proc->TargetPred != NULL)
+	inst->branch_pred = proc->TargetPred->Predict(inst->pc,
+						      proc->bp_history);
+      else
+	inst->branch_pred = BP_NOTARGET;
 
+      if (inst->branch_pred != BP_NOTARGET)
+	result = 1;
+      else
+	result = 3;
     }
   else
     { // a conditional branch
@@ -108,7 +119,10 @@ inline void StartCtlXfer(instance * inst, ProcState * proc)
         // it's a "bn" -- "instruction prefetch" so intentionally mispredict
         result = 1;
       else
-        result = proc->BPBPredict(inst->pc, inst->code.taken);
+	{
+	  result = proc->BPBPredict(inst->pc, inst->code.taken);
+	  proc->bp_history = (proc->bp_history << 1) | result;
+	}
 
       if (result)
         inst->branch_pred = inst->pc +
@@ -147,6 +161,8 @@ inline void StartCtlXfer(instance * inst, ProcState * proc)
 /*                                                                       */
 /* We support either regular 2-bit prediction or 2-bit agree prediction  */
 /* (for agree, replace T/NT with A/NA)                                   */
+/*                                                                       */
+/* gshare, tournament and TAGE are implemented in bpred.cc               */
 /*************************************************************************/
 
 /*
@@ -154,6 +170,12 @@ inline void StartCtlXfer(instance * inst, ProcState * proc)
  */
 inline void ProcState::BPBSetup()
 {
+  BranchPred = PrevPred = NULL;
+  DirPred    = NULL;
+  TargetPred = NULL;
+  BranchProf = NULL;
+  bp_history = 0;
+
   if (BPB_SIZE > 0)
     {
       if (BPB_TYPE == TWOBIT || BPB_TYPE == TWOBITAGREE)
@@ -167,6 +189,12 @@ inline void ProcState::BPBSetup()
 	      PrevPred[i] = 0;
 	    }
 	}
+      else if (BPB_TYPE == GSHARE)
+	DirPred = new GsharePredictor(BPB_SIZE);
+      else if (BPB_TYPE == TOURNAMENT)
+	DirPred = new TournamentPredictor(BPB_SIZE);
+      else if (BPB_TYPE == TAGE)
+	DirPred = new TagePredictor(BPB_SIZE);
     }
   else
     {
@@ -178,6 +206,17 @@ inline void ProcState::BPBSetup()
 	  BPB_TYPE = STATIC;
 	}
     }
+
+  if (BTB_SIZE > 0)
+    {
+      if (BTB_TYPE == BTBASSOC)
+	TargetPred = new BranchTargetBuffer(BTB_SIZE, BTB_ASSOC);
+      else if (BTB_TYPE == BTBITTAGE)
+	TargetPred = new IttagePredictor(BTB_SIZE, BTB_ASSOC);
+    }
+
+  if (BP_PROFILE > 0)
+    BranchProf = new BranchProfile;
 }
 
 
@@ -189,7 +228,9 @@ inline void ProcState::BPBSetup()
  */
 inline int ProcState::BPBPredict(unsigned bpc, int statpred)
 {
-  if (BPB_TYPE == TWOBIT)
+  if (DirPred != NULL)
+    return DirPred->Predict(bpc, bp_history);
+  else if (BPB_TYPE == TWOBIT)
     return BranchPred[(bpc / SIZE_OF_SPARC_INSTRUCTION) & (BPB_SIZE - 1)];
   else if (BPB_TYPE == TWOBITAGREE)
     // this is an XNOR of (dynamic) agree prediction & static prediction
@@ -202,12 +243,20 @@ inline int ProcState::BPBPredict(unsigned bpc, int statpred)
 
 /*
  * BPBComplete: called when branch speculation resolved. Set actual
- *              history here
+ *              history here. 'hist' is the global history the branch
+ *              was predicted with.
  */
-inline void ProcState::BPBComplete(unsigned bpc, int taken, int statpred)
+inline void ProcState::BPBComplete(unsigned bpc, int taken, int statpred,
+				   unsigned long long hist)
 {
   int inbit;
 
+  if (DirPred != NULL)
+    {
+      DirPred->Update(bpc, hist, taken);
+      return;
+    }
+
   if (BPB_TYPE == TWOBIT)
     inbit = taken;
   else if (BPB_TYPE == TWOBITAGREE)
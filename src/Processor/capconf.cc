@@ -73,7 +73,7 @@ extern "C" {
 /***************************************************************************/
 
 CapConfDetector::CapConfDetector(int linect):
-   lines_hash(11), lines_circq(linect), lines(linect)
+   lines_hash(11), lines_circq(linect), seen_hash(11), lines(linect)
 {
 #ifdef DEBUG_CCD
   fprintf(simout, "New Capacity Conflict detector started -- lines %d\n",
@@ -105,11 +105,8 @@ NewCapConfDetector(int lines)
 /***************************************************************************/
 
 
-extern "C" MISS_TYPE CCD_InsertNewLine(CapConfDetector * ccd, int tag)
+static MISS_TYPE CCD_Insert(CapConfDetector * ccd, int tag)
 {
-#ifdef NOSTAT
-  return CACHE_MISS_NONSPECIFIC;
-#else
   unsigned tmp;
 
   if (ccd->lines_hash.lookup(tag, &tmp))
@@ -135,5 +132,36 @@ extern "C" MISS_TYPE CCD_InsertNewLine(CapConfDetector * ccd, int tag)
       
       return CACHE_MISS_CAP;
     }
+}
+
+
+
+extern "C" MISS_TYPE CCD_InsertNewLine(CapConfDetector * ccd, int tag)
+{
+#ifdef NOSTAT
+  return CACHE_MISS_NONSPECIFIC;
+#else
+  return CCD_Insert(ccd, tag);
 #endif
 }
+
+
+
+/***************************************************************************/
+/* CCD_ClassifyMiss: used by the functional cache model, whose miss        */
+/* breakdown is its only output, so it classifies even with NOSTAT. A      */
+/* line that has never been inserted before is a cold miss; otherwise the  */
+/* miss is classified by CCD_InsertNewLine's rule.                         */
+/***************************************************************************/
+
+extern "C" MISS_TYPE CCD_ClassifyMiss(CapConfDetector * ccd, int tag)
+{
+  MISS_TYPE type = CCD_Insert(ccd, tag);
+  unsigned  tmp;
+
+  if (ccd->seen_hash.lookup(tag, &tmp))
+    return type;
+
+  ccd->seen_hash.insert(tag, tag);
+  return CACHE_MISS_COLD;
+}
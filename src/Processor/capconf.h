@@ -77,6 +77,9 @@
 /*   have been brought into the structure, where Z is the number of          */
 /*   lines available in the cache. Thus, this can be considered a            */
 /*   capacity miss.                                                          */
+/*                                                                           */
+/*   The functional cache model additionally remembers every line it has     */
+/*   ever seen, so that cold misses can be told apart (CCD_ClassifyMiss).    */
 /*****************************************************************************/
 
 #include "Caches/cache_stat.h"
@@ -86,6 +89,7 @@
 struct CapConfDetector {
    HashTable < unsigned, unsigned >lines_hash;
    circq < unsigned >lines_circq;
+   HashTable < unsigned, unsigned >seen_hash;
    int lines;
    CapConfDetector(int);
 };
@@ -98,6 +102,7 @@ struct CapConfDetector;
 
 struct CapConfDetector *NewCapConfDetector(int);
 MISS_TYPE CCD_InsertNewLine(struct CapConfDetector *, int);
+MISS_TYPE CCD_ClassifyMiss(struct CapConfDetector *, int);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include "sim_main/simsys.h"
+#include "sim_main/util.h"
+#include "sim_main/evlst.h"
+#include "sim_main/checkpoint.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/cache.h"
+#include "Caches/ubuf.h"
+#include "Bus/bus.h"
+#include "IO/io_generic.h"
+#include "IO/pci.h"
+#include "IO/realtime_clock.h"
+#include "IO/scsi_controller.h"
+}
+
+#include "Processor/procstate.h"
+#include "Processor/branchpred.h"
+#include "Processor/memunit.h"
+#include "Processor/exec.h"
+#include "Processor/multiprocessor.h"
+#include "Processor/pagetable.h"
+#include "Processor/filedesc.h"
+#include "Processor/tlb.h"
+#include "Processor/fastfwd.h"
+#include "Processor/checkpoint.h"
+#include "Processor/fastnews.h"
+#include "Processor/procstate.hh"
+#include "Processor/tagcvt.hh"
+#include "Processor/memunit.hh"
+#include "Processor/stallq.hh"
+#include "Processor/active.hh"
+
+
+#define CKPT_END_OF_PAGES 0xFFFFFFFF
+
+
+
+/***************************************************************************/
+/* CheckpointQuiescent: no instruction, memory reference or I/O request   */
+/* is in flight anywhere in the node. Only then does the state consist of  */
+/* module variables alone; the event list and request structures need not */
+/* be saved.                                                               */
+/***************************************************************************/
+
+static int CheckpointQuiescent(int node)
+{
+  int i, n;
+
+  for (i = node * ARCH_cpus; i < (node + 1) * ARCH_cpus; i++)
+    {
+      if (!FastFwdDrained(AllProcs[i]))
+	return 0;
+
+      if (L1ICaches[i]->num_in_pipes || !L1ICaches[i]->inq_empty)
+	return 0;
+    }
+
+  if (!Bus_idle(node) || !IO_idle(node))
+    return 0;
+
+  for (n = 0; n < ARCH_scsi_cntrs; n++)
+    if (!SCSI_cntl_idle(node, n))
+      return 0;
+
+  return 1;
+}
+
+
+
+/***************************************************************************/
+/* CheckpointMemory: save or restore all pages of main memory. Each page   */
+/* is preceded by its physical address; pages that do not exist yet are   */
+/* allocated on restore. Pages in I/O space belong to the devices and are  */
+/* restored by them or regenerated from the configuration.                 */
+/* With mem_mmap set, the pages are written to a sparse memory image file  */
+/* <checkpoint>.mem instead, which restore maps copy-on-write.            */
+/***************************************************************************/
+
+static void CheckpointMemory(CKPT *ckpt, int node)
+{
+  unsigned  addr, *pages;
+  char     *page, name[PATH_MAX + 8];
+  int       image, count, n;
+
+  sprintf(name, "%s.mem", ckpt->name);
+
+  if (ckpt->write)
+    {
+      Ckpt_section(ckpt, CKPT_TAG('M', 'E', 'M', ' '));
+      Ckpt_write_int(ckpt, MEM_MMAP);
+
+      // memory image: list of existing pages, contents in image file
+      if (MEM_MMAP)
+	{
+	  count = PageTable_write_image(node, name, &pages);
+	  Ckpt_write_int(ckpt, count);
+	  Ckpt_write(ckpt, pages, count * sizeof(unsigned));
+	  free(pages);
+	  return;
+	}
+
+      for (addr = 0; addr < IO_SEGMENT_LOW; addr += PAGE_SIZE)
+	{
+	  page = PageTables[node]->lookup(addr);
+	  if (page == NULL)
+	    continue;
+
+	  Ckpt_write_int(ckpt, addr);
+	  Ckpt_write_page(ckpt, page, PAGE_SIZE);
+	}
+      Ckpt_write_int(ckpt, CKPT_END_OF_PAGES);
+      return;
+    }
+
+  Ckpt_expect(ckpt, CKPT_TAG('M', 'E', 'M', ' '));
+  image = Ckpt_read_int(ckpt);
+
+  if (image)
+    {
+      count = Ckpt_read_int(ckpt);
+      pages = RSIM_CALLOC(unsigned, count + 1);
+      if (pages == NULL)
+	YS__errmsg(node, "Malloc failed in %s:%i", __FILE__, __LINE__);
+
+      Ckpt_read(ckpt, pages, count * sizeof(unsigned));
+      for (n = 0; n < count; n++)
+	if (pages[n] >= IO_SEGMENT_LOW)
+	  YS__errmsg(node, "Corrupt page list in checkpoint %s", ckpt->name);
+
+      PageTable_map_image(node, name, pages, count);
+      free(pages);
+      return;
+    }
+
+  while ((addr = Ckpt_read_int(ckpt)) != CKPT_END_OF_PAGES)
+    {
+      page = PageTables[node]->lookup(addr);
+      if (page == NULL)
+	{
+	  PageTable_insert_alloc(node, addr);
+	  page = PageTables[node]->lookup(addr);
+	}
+
+      Ckpt_read_page(ckpt, page, PAGE_SIZE);
+    }
+}
+
+
+
+/***************************************************************************/
+/* CheckpointProcessor: save or restore the architectural state of a       */
+/* processor (logical register files and state registers) and its branch  */
+/* predictor and TLBs. The physical registers and mappers are rebuilt from */
+/* the logical registers on restore, and fetch restarts at the saved PC.   */
+/***************************************************************************/
+
+static void CheckpointProcessor(CKPT *ckpt, ProcState *proc)
+{
+  int *regs[] =
+  {
+    (int*)&proc->pc,              (int*)&proc->npc,
+    (int*)&proc->pstate,          &proc->tl,
+    &proc->pil,                   &proc->itlb_random,
+    &proc->itlb_wired,            &proc->dtlb_random,
+    &proc->dtlb_wired,            &proc->cwp,
+    &proc->cansave,               &proc->canrestore,
+    &proc->otherwin,              &proc->cleanwin,
+    (int*)&proc->fp754_trap_mask, (int*)&proc->fp754_aexc,
+    (int*)&proc->fp754_cexc,      (int*)&proc->fp_trap_type,
+    &proc->interrupt_pending,     &proc->halt,
+    &proc->ktext_segment_low,     &proc->ktext_segment_high,
+    &proc->kdata_segment_low,     &proc->kdata_segment_high
+  };
+  int n, type, size, rassize;
+
+  if (ckpt->write)
+    {
+      Ckpt_section(ckpt, CKPT_TAG('C', 'P', 'U', ' '));
+      Ckpt_write(ckpt, proc->log_int_reg_file, sizeof(proc->log_int_reg_file));
+      Ckpt_write(ckpt, proc->log_fp_reg_file, sizeof(proc->log_fp_reg_file));
+      for (n = 0; n < (int)(sizeof(regs) / sizeof(regs[0])); n++)
+	Ckpt_write_int(ckpt, *regs[n]);
+      Ckpt_write(ckpt, &proc->tick_base, sizeof(proc->tick_base));
+
+      Ckpt_section(ckpt, CKPT_TAG('B', 'P', 'B', ' '));
+      Ckpt_write_int(ckpt, BPB_TYPE);
+      Ckpt_write_int(ckpt, BPB_SIZE);
+      Ckpt_write_int(ckpt, RAS_STKSZ);
+      if (proc->BranchPred)
+	{
+	  Ckpt_write(ckpt, proc->BranchPred, BPB_SIZE * sizeof(int));
+	  Ckpt_write(ckpt, proc->PrevPred, BPB_SIZE * sizeof(int));
+	}
+      if (RAS_STKSZ > 0)
+	{
+	  Ckpt_write(ckpt, proc->ReturnAddressStack,
+		     RAS_STKSZ * sizeof(unsigned));
+	  Ckpt_write_int(ckpt, proc->rasptr);
+	  Ckpt_write_int(ckpt, proc->rascnt);
+	}
+
+      proc->itlb->CkptSave(ckpt);
+      proc->dtlb->CkptSave(ckpt);
+      return;
+    }
+
+  Ckpt_expect(ckpt, CKPT_TAG('C', 'P', 'U', ' '));
+  Ckpt_read(ckpt, proc->log_int_reg_file, sizeof(proc->log_int_reg_file));
+  Ckpt_read(ckpt, proc->log_fp_reg_file, sizeof(proc->log_fp_reg_file));
+  for (n = 0; n < (int)(sizeof(regs) / sizeof(regs[0])); n++)
+    *regs[n] = Ckpt_read_int(ckpt);
+  Ckpt_read(ckpt, &proc->tick_base, sizeof(proc->tick_base));
+
+  // the restored node starts at time 0, keep the TICK register continuous
+  proc->tick_base -= (long long)ckpt->simtime;
+
+  Ckpt_expect(ckpt, CKPT_TAG('B', 'P', 'B', ' '));
+  type    = Ckpt_read_int(ckpt);
+  size    = Ckpt_read_int(ckpt);
+  rassize = Ckpt_read_int(ckpt);
+
+  if ((type != BPB_TYPE) || (size != BPB_SIZE))
+    {
+      YS__warnmsg(proc->proc_id / ARCH_cpus,
+		  "Branch predictor configuration differs from checkpoint %s - not restored",
+		  ckpt->name);
+      if ((size > 0) && ((type == TWOBIT) || (type == TWOBITAGREE)))
+	Ckpt_skip(ckpt, 2 * size * sizeof(int));
+    }
+  else if (proc->BranchPred)
+    {
+      Ckpt_read(ckpt, proc->BranchPred, BPB_SIZE * sizeof(int));
+      Ckpt_read(ckpt, proc->PrevPred, BPB_SIZE * sizeof(int));
+    }
+
+  if (rassize != RAS_STKSZ)
+    {
+      if (rassize > 0)
+	Ckpt_skip(ckpt, rassize * sizeof(unsigned) + 2 * sizeof(int));
+    }
+  else if (RAS_STKSZ > 0)
+    {
+      Ckpt_read(ckpt, proc->ReturnAddressStack, RAS_STKSZ * sizeof(unsigned));
+      proc->rasptr = Ckpt_read_int(ckpt);
+      proc->rascnt = Ckpt_read_int(ckpt);
+    }
+
+  proc->itlb->CkptRestore(ckpt);
+  proc->dtlb->CkptRestore(ckpt);
+
+  FastFwdSync(proc);
+}
+
+
+
+/***************************************************************************/
+/* CheckpointNode: save or restore one node. The order of the sections is  */
+/* fixed; memory comes first so that the I-cache can be predecoded from it */
+/* and PCI configuration precedes the devices whose registers it maps.     */
+/***************************************************************************/
+
+static void CheckpointNode(CKPT *ckpt, int node)
+{
+  int i, n;
+
+  CheckpointMemory(ckpt, node);
+
+  for (i = node * ARCH_cpus; i < (node + 1) * ARCH_cpus; i++)
+    {
+      CheckpointProcessor(ckpt, AllProcs[i]);
+
+      if (ckpt->write)
+	{
+	  Cache_ckpt_save(L1ICaches[i], ckpt);
+	  Cache_ckpt_save(L1DCaches[i], ckpt);
+	  Cache_ckpt_save(L2Caches[i], ckpt);
+	}
+      else
+	{
+	  Cache_ckpt_restore(L1ICaches[i], ckpt);
+	  Cache_ckpt_restore(L1DCaches[i], ckpt);
+	  Cache_ckpt_restore(L2Caches[i], ckpt);
+	}
+    }
+
+  if (ckpt->write)
+    {
+      RTC_ckpt_save(ckpt, node);
+      PCI_ckpt_save(ckpt, node);
+      for (n = 0; n < ARCH_scsi_cntrs; n++)
+	SCSI_cntl_ckpt_save(ckpt, node, n);
+      FD_ckpt_save(ckpt);
+    }
+  else
+    {
+      RTC_ckpt_restore(ckpt, node);
+      PCI_ckpt_restore(ckpt, node);
+      for (n = 0; n < ARCH_scsi_cntrs; n++)
+	SCSI_cntl_ckpt_restore(ckpt, node, n);
+      FD_ckpt_restore(ckpt);
+    }
+}
+
+
+
+/***************************************************************************/
+/* CheckpointHandle: wait until all local nodes are quiescent, then write  */
+/* a checkpoint for each of them and terminate the simulation. Processors  */
+/* keep fast-forwarding while devices finish outstanding requests.         */
+/***************************************************************************/
+
+extern "C" void CheckpointHandle()
+{
+  EVENT *ev = (EVENT*)EventGetArg(NULL);
+  CKPT  *ckpt;
+  int    n;
+
+  for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+    if (!CheckpointQuiescent(n))
+      {
+	schedule_event(ev, YS__Simtime + 1.0);
+	return;
+      }
+
+  for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+    {
+      ckpt = Ckpt_open(ckpt_write_file, n, 1);
+      CheckpointNode(ckpt, n);
+      YS__logmsg(n, "%.0f: Checkpoint written to %s\n",
+		 YS__Simtime, ckpt->name);
+      Ckpt_close(ckpt);
+    }
+
+  for (n = 0; n < ARCH_mynodes * ARCH_cpus; n++)
+    DoExit();
+
+  exit(0);
+}
+
+
+
+/***************************************************************************/
+/* CheckpointStart: called when the fast-forward count is reached and a   */
+/* checkpoint file is given; detailed simulation is not started.          */
+/***************************************************************************/
+
+void CheckpointStart()
+{
+  EVENT *ev;
+  int    n;
+
+  for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+    YS__logmsg(n, "%.0f: Waiting for quiescent state to write checkpoint\n",
+	       YS__Simtime);
+
+  ev = NewEvent("Checkpoint", CheckpointHandle, NODELETE, 0);
+  EventSetArg(ev, ev, sizeof(ev));
+  schedule_event(ev, YS__Simtime + 1.0);
+}
+
+
+
+/***************************************************************************/
+/* CheckpointRestore: restore a node from the checkpoint file given with   */
+/* -l. Called after system initialization, before simulation starts.       */
+/***************************************************************************/
+
+void CheckpointRestore(int node)
+{
+  CKPT *ckpt;
+
+  ckpt = Ckpt_open(ckpt_restore_file, node, 0);
+  CheckpointNode(ckpt, node);
+
+  YS__logmsg(node, "Restored checkpoint %s (written at cycle %.0f)\n",
+	     ckpt->name, ckpt->simtime);
+  Ckpt_close(ckpt);
+}
@@ -67,16 +67,28 @@ extern "C"
 #include "Processor/procstate.h"
 #include "Processor/simio.h"
 #include "Processor/branchpred.h"
+#include "Processor/bpred.h"
+#include "Processor/ftq.h"
+#include "Processor/smt.h"
 #include "Processor/tlb.h"
+#include "Processor/fastfwd.h"
+#include "Processor/simpoint.h"
+#include "Processor/multiprocessor.h"
+#include "Processor/cputhreads.h"
+#include "Processor/predecode.h"
+#include "Processor/pagetable.h"
 
 static void ConfigureInt       (void *, char *);
 static void ConfigureStr       (void *, char *);
 static void ConfigureIntKB     (void *, char *);
 static void ConfigureDoubleInt (void *, char *);
 static void ConfigureBPBType   (void *, char *);
+static void ConfigureBTBType   (void *, char *);
+static void ConfigureSMTPolicy (void *, char *);
 static void ConfigureTLBType   (void *, char *);
 static void ConfigureTLBFill   (void *, char *);
 static void ConfigureUBufType  (void *, char *);
+static void ConfigureEventList (void *, char *);
 
 
 
@@ -106,10 +118,18 @@ void ParseConfigFile()
     { "activelist",      &MAX_ACTIVE_NUMBER,        ConfigureInt      },
     { "bpbtype",         &BPB_TYPE,                 ConfigureBPBType  },
     { "bpbsize",         &BPB_SIZE,                 ConfigureInt      },
+    { "bpprofile",       &BP_PROFILE,               ConfigureInt      },
+    { "btbtype",         &BTB_TYPE,                 ConfigureBTBType  },
+    { "btbsize",         &BTB_SIZE,                 ConfigureInt      },
+    { "btbassoc",        &BTB_ASSOC,                ConfigureInt      },
     { "decoderate",      &DECODES_PER_CYCLE,        ConfigureInt      },
+    { "fetchblocks",     &FETCH_BLOCKS,             ConfigureInt      },
     { "fetchqueue",      &FETCH_QUEUE_SIZE,         ConfigureInt      },
     { "fetchrate",       &FETCHES_PER_CYCLE,        ConfigureInt      },
     { "flushrate",       &EXCEPT_FLUSHES_PER_CYCLE, ConfigureInt      },
+    { "ftbsize",         &FTB_SIZE,                 ConfigureInt      },
+    { "ftqprefetch",     &FTQ_PREFETCH,             ConfigureInt      },
+    { "ftqsize",         &FTQ_SIZE,                 ConfigureInt      },
     { "graduationrate",  &GRADUATES_PER_CYCLE,      ConfigureInt      },
     { "kernel",          &fnkernel,                 ConfigureStr      },
     { "latdiv",          &LAT_ALU_DIV,              ConfigureInt      },
@@ -141,7 +161,13 @@ void ParseConfigFile()
     { "repmul",          &REP_ALU_MUL,              ConfigureInt      },
     { "repshift",        &REP_ALU_SHIFT,            ConfigureInt      },
     { "shadowmappers",   &MAX_SPEC,                 ConfigureInt      },
+    { "smtthreads",      &SMT_THREADS,              ConfigureInt      },
+    { "smtfetch",        &SMT_FETCH,                ConfigureInt      },
+    { "smtpolicy",       &SMT_POLICY,               ConfigureSMTPolicy},
+    { "smtcap",          &SMT_CAP,                  ConfigureInt      },
     { "storebuffer",     &MAX_STORE_BUF,            ConfigureInt      },
+    { "storewait",       &STORE_WAIT_SIZE,          ConfigureInt      },
+    { "storewaitclear",  &STORE_WAIT_CLEAR,         ConfigureInt      },
     { "itlbassoc",       &ITLB_ASSOCIATIVITY,       ConfigureInt      },
     { "itlbsize",        &ITLB_SIZE,                ConfigureInt      },
     { "itlbtype",        &ITLB_TYPE,                ConfigureTLBType  },
@@ -151,7 +177,17 @@ void ParseConfigFile()
     { "dtlbsize",        &DTLB_SIZE,                ConfigureInt      },
     { "dtlbtype",        &DTLB_TYPE,                ConfigureTLBType  },
     { "dtlbfill",        &DTLB_HARDWARE_FILL,       ConfigureTLBFill  },
-    { "dtlbtag",         &DTLB_TAGGED,              ConfigureInt      }
+    { "dtlbtag",         &DTLB_TAGGED,              ConfigureInt      },
+    { "eventlist",       &EventListType,            ConfigureEventList},
+    { "fastfwd_rate",    &FASTFWD_RATE,             ConfigureInt      },
+    { "fastfwd_warm",    &FASTFWD_WARM,             ConfigureInt      },
+    { "simpoint_interval", &SIMPOINT_INTERVAL,      ConfigureInt      },
+    { "simpoint_warmup", &SIMPOINT_WARMUP,          ConfigureInt      },
+    { "mp_lookahead",    &MP_LOOKAHEAD,             ConfigureInt      },
+    { "mp_latency",      &MP_LATENCY,               ConfigureInt      },
+    { "parallel_cpus",   &PARALLEL_CPUS,            ConfigureInt      },
+    { "predecode_pages", &PREDECODE_PAGES,          ConfigureInt      },
+    { "mem_mmap",        &MEM_MMAP,                 ConfigureInt      }
   };
 
   char   buf[1024], *bp;
@@ -281,9 +317,62 @@ static void ConfigureBPBType(void *dp, char *s)
     *((bptype *) dp) = TWOBITAGREE;
   else if (strcasecmp(s, "static") == 0)
     *((bptype *) dp) = STATIC;
+  else if (strcasecmp(s, "gshare") == 0)
+    *((bptype *) dp) = GSHARE;
+  else if (strcasecmp(s, "tournament") == 0)
+    *((bptype *) dp) = TOURNAMENT;
+  else if (strcasecmp(s, "tage") == 0)
+    *((bptype *) dp) = TAGE;
   else
     {
       fprintf(stderr, "Unknown BPB type %s\n", s);
       exit(1);
     }
 }
+
+
+
+static void ConfigureBTBType(void *dp, char *s)
+{
+  if (strcasecmp(s, "none") == 0)
+    *((btbtype *) dp) = BTBNONE;
+  else if (strcasecmp(s, "btb") == 0)
+    *((btbtype *) dp) = BTBASSOC;
+  else if (strcasecmp(s, "ittage") == 0)
+    *((btbtype *) dp) = BTBITTAGE;
+  else
+    {
+      fprintf(stderr, "Unknown BTB type %s\n", s);
+      exit(1);
+    }
+}
+
+
+
+static void ConfigureSMTPolicy(void *dp, char *s)
+{
+  if (strcasecmp(s, "icount") == 0)
+    *((smtpolicy *) dp) = SMT_ICOUNT;
+  else if (strcasecmp(s, "rr") == 0)
+    *((smtpolicy *) dp) = SMT_ROUNDROBIN;
+  else
+    {
+      fprintf(stderr, "Unknown SMT fetch policy %s\n", s);
+      exit(1);
+    }
+}
+
+
+
+static void ConfigureEventList(void *dp, char *s)
+{
+  if (strcasecmp(s, "calendar") == 0)
+    EventListSelect(EVLST_CALENDAR);
+  else if (strcasecmp(s, "list") == 0)
+    EventListSelect(EVLST_LIST);
+  else
+    {
+      fprintf(stderr, "Unknown event list type %s\n", s);
+      exit(1);
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+
+extern "C"
+{
+#include "sim_main/simsys.h"
+#include "sim_main/util.h"
+#include "Caches/system.h"
+}
+
+#include "Processor/procstate.h"
+#include "Processor/cputhreads.h"
+
+
+int PARALLEL_CPUS      = 0;            // host threads for processor stages
+int CpuThreadsParallel = 0;            // CpuThreadsRun in progress
+
+static int                 num_threads = 1;
+static pthread_barrier_t   start_barrier;
+static pthread_barrier_t   done_barrier;
+
+static ProcState         **work_procs;
+static int                 work_count;
+static void              (*work_func)(ProcState *);
+
+
+
+/***************************************************************************/
+/* Processors are assigned to threads round-robin. Each processor is       */
+/* stepped by exactly one thread and stages only modify processor-local    */
+/* state, so the assignment does not affect the results.                  */
+/***************************************************************************/
+
+static void CpuThreadsWork(int t, int stride)
+{
+  int n;
+
+  for (n = t; n < work_count; n += stride)
+    work_func(work_procs[n]);
+}
+
+
+
+static void *CpuThreadsMain(void *arg)
+{
+  int      t = (int)(long)arg;
+  sigset_t mask;
+
+  // asynchronous signals go to the main thread; FP exceptions and faults
+  // are delivered to the thread that causes them
+  sigfillset(&mask);
+  sigdelset(&mask, SIGFPE);
+  sigdelset(&mask, SIGSEGV);
+  sigdelset(&mask, SIGBUS);
+  sigdelset(&mask, SIGILL);
+  pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+  while (1)
+    {
+      pthread_barrier_wait(&start_barrier);
+      CpuThreadsWork(t, num_threads);
+      pthread_barrier_wait(&done_barrier);
+    }
+
+  return NULL;
+}
+
+
+
+/***************************************************************************/
+/* CpuThreadsInit: start the worker threads. Called after the simulation   */
+/* processes have been forked, since threads do not survive fork.         */
+/***************************************************************************/
+
+void CpuThreadsInit()
+{
+  pthread_t thread;
+  int       n;
+
+  if (PARALLEL_CPUS <= 1)
+    return;
+
+  num_threads = PARALLEL_CPUS;
+  if (num_threads > ARCH_mynodes * ARCH_cpus)
+    num_threads = ARCH_mynodes * ARCH_cpus;
+
+  if (num_threads <= 1)
+    return;
+
+  if (pthread_barrier_init(&start_barrier, NULL, num_threads) ||
+      pthread_barrier_init(&done_barrier, NULL, num_threads))
+    YS__errmsg(ARCH_firstnode, "Barrier init failed in %s:%i",
+	       __FILE__, __LINE__);
+
+  for (n = 1; n < num_threads; n++)
+    if (pthread_create(&thread, NULL, CpuThreadsMain, (void*)(long)n))
+      YS__errmsg(ARCH_firstnode, "Thread create failed in %s:%i",
+		 __FILE__, __LINE__);
+
+  for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+    YS__logmsg(n, "Simulating processors on %i threads\n", num_threads);
+}
+
+
+
+/***************************************************************************/
+/* CpuThreadsRun: apply a pipeline stage to a list of processors, in       */
+/* parallel if worker threads exist. Returns when all are done.            */
+/***************************************************************************/
+
+void CpuThreadsRun(ProcState **procs, int count, void (*func)(ProcState *))
+{
+  work_procs = procs;
+  work_count = count;
+  work_func  = func;
+
+  CpuThreadsParallel = 1;
+
+  if ((num_threads == 1) || (count <= 1))
+    CpuThreadsWork(0, 1);
+  else
+    {
+      pthread_barrier_wait(&start_barrier);
+      CpuThreadsWork(0, num_threads);
+      pthread_barrier_wait(&done_barrier);
+    }
+
+  CpuThreadsParallel = 0;
+}
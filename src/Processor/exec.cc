@@ -62,6 +62,7 @@ extern "C"
 
 #include "Processor/procstate.h"
 #include "Processor/branchpred.h"
+#include "Processor/ftq.h"
 #include "Processor/memunit.h"
 #include "Processor/mainsim.h"
 #include "Processor/exec.h"
@@ -69,6 +70,7 @@ extern "C"
 #include "Processor/simio.h"
 #include "Processor/fastnews.h"
 #include "Processor/fsr.h"
+#include "Processor/cputhreads.h"
 #include "Processor/tagcvt.hh"
 #include "Processor/active.hh"
 #include "Processor/procstate.hh"
@@ -99,18 +101,164 @@ instr *TheBadPC = new instr(iSETHI);
 
 
 
+/*
+ * I-TLB lookup for instruction fetch, leaves the physical address and the
+ * page attributes in 'phys_pc' and 'attributes'
+ */
+static int fetch_translate(ProcState *proc, unsigned *phys_pc,
+			   int *attributes)
+{
+  *attributes = 0;
+  if (!PSTATE_GET_ITE(proc->pstate))
+    return(TLB_HIT);
+
+  return(proc->itlb->
+	 LookUp(phys_pc, attributes,
+		proc->log_int_reg_file[arch_to_log(proc,
+						   proc->cwp,
+						   PRIV_TLB_CONTEXT)],
+		0, PSTATE_GET_PRIV(proc->pstate), LLONG_MAX));
+}
+
+
+/*
+ * Insert a NOP with an I-TLB miss or instruction fault set for 'pc'
+ */
+static void fetch_exception(ProcState *proc, unsigned pc, int rc)
+{
+  fetch_queue_entry fqe;
+
+  if (proc->fetch_queue->NumItems() >= proc->fetch_queue_size)
+    return;
+
+  if (rc == TLB_MISS)
+    fqe.exception_code = ITLB_MISS;
+
+  if (rc == TLB_FAULT)
+    fqe.exception_code = INSTR_FAULT;
+
+  fqe.inst = NewInstance(TheBadPC, proc);
+  fqe.pc   = pc;
+
+  proc->fetch_queue->Enqueue(fqe);
+}
+
+
+
+/***************************************************************************/
+/* ftq_fetch_cycle: decoupled front end. The next-block predictor appends  */
+/* blocks to the FTQ, then up to FETCH_BLOCKS I-cache requests are sent    */
+/* for the oldest blocks, as long as the fetch queue has room for all      */
+/* instructions in flight. One block further back is prefetched.           */
+/***************************************************************************/
+
+static int ftq_fetch_cycle(ProcState * proc)
+{
+  FetchTargetQueue *ftq = proc->ftq;
+  FetchBlock       *blk;
+  int               rc, n, space, issued;
+  unsigned          phys_pc;
+  int               attributes;
+
+  ftq->Predict(ARCH_linesz1i, proc->fetch_rate);
+
+  space = proc->fetch_queue_size - proc->fetch_queue->NumItems();
+  for (n = 0; n < ftq->NumItems(); n++)
+    if (ftq->Block(n)->state != FTQ_PREDICTED)
+      space -= ftq->Block(n)->count;
+
+
+  //-------------------------------------------------------------------------
+  // fetch the oldest blocks that are not in flight yet
+
+  issued = 0;
+  for (n = 0; n < ftq->NumItems(); n++)
+    {
+      blk = ftq->Block(n);
+      if (blk->state != FTQ_PREDICTED)
+	continue;
+
+      if ((issued == FETCH_BLOCKS) || (blk->count > space) ||
+	  (L1IQ_FULL[proc->core_id]))
+	break;
+
+      blk->phys_pc = blk->pc;
+      rc = fetch_translate(proc, &blk->phys_pc, &blk->attributes);
+      if (rc != TLB_HIT)
+	{
+	  // the exception must not pass instructions of older blocks
+	  if (n == 0)
+	    fetch_exception(proc, blk->pc, rc);
+	  break;
+	}
+
+      if (PSTATE_GET_ITE(proc->pstate))
+	ftq->Translated(blk->pc, blk->phys_pc, blk->attributes);
+
+      blk->state = FTQ_ISSUED;
+      ICache_recv_addr(proc->proc_id, blk->pc, blk->phys_pc,
+		       blk->count, blk->attributes,
+		       proc->pstate);
+
+      space -= blk->count;
+      issued++;
+    }
+
+  if (issued > 1)
+    proc->ftq_multifetch++;
+
+
+  //-------------------------------------------------------------------------
+  // prefetch the next queued block that starts a new cache line
+
+  if ((!FTQ_PREFETCH) || (L1IQ_FULL[proc->core_id]))
+    return(0);
+
+  for (; n < ftq->NumItems(); n++)
+    {
+      blk = ftq->Block(n);
+      if (blk->prefetch != FTQ_PF_NONE)
+	continue;
+
+      blk->prefetch = FTQ_PF_DONE;
+      if ((n > 0) &&
+	  (blk->pc / ARCH_linesz1i == ftq->Block(n - 1)->pc / ARCH_linesz1i))
+	continue;
+
+      phys_pc = blk->pc;
+      attributes = 0;
+      if (PSTATE_GET_ITE(proc->pstate) &&
+	  !ftq->Translate(blk->pc, &phys_pc, &attributes))
+	continue;
+
+      ICache_prefetch(proc->proc_id, blk->pc, phys_pc, attributes);
+      break;
+    }
+
+  return 0;
+}
+
+
+
 /***************************************************************************/
 /***************************************************************************/
 
 int fetch_cycle(ProcState * proc)
 {
-  instr                    *instrn;
   int                       rc, attributes, count;
   unsigned                  phys_pc;
   Queue<fetch_queue_entry> *fetch_queue = proc->fetch_queue;
   fetch_queue_entry         fqe;
 
 
+  // the caches are shared state: the whole stage runs after the parallel
+  // stage, where it sees the L1I and interrupts as the serial loop does
+  if (CpuThreadsParallel)
+    {
+      proc->fetch_deferred = 1;
+      return(0);
+    }
+
   if ((proc->interrupt_pending) &&
       (PSTATE_GET_IE(proc->pstate) &&
        (fetch_queue->NumItems() < proc->fetch_queue_size)))
@@ -125,15 +273,17 @@ int fetch_cycle(ProcState * proc)
 	  fqe.exception_code = (enum except)(INTERRUPT_00 - n);
 
 	  fqe.inst = NewInstance(TheBadPC, proc); // TLB miss or prot. fault
-	  fqe.pc   = proc->fetch_pc;         // insert NOP with exception set
-
+	  fqe.pc   = proc->ftq ? proc->ftq->NextPC() : proc->fetch_pc;
+	                                     // insert NOP with exception set
 	  fetch_queue->Enqueue(fqe);
 	  return(0);
 	}
     }
 
+  if (proc->ftq)
+    return(ftq_fetch_cycle(proc));
   
-  if ((!proc->fetch_done) || (L1IQ_FULL[proc->proc_id]))
+  if ((!proc->fetch_done) || (L1IQ_FULL[proc->core_id]))
     return(0);
 
   count = min(proc->fetch_rate,
@@ -145,34 +295,11 @@ int fetch_cycle(ProcState * proc)
   // do one TLB access if I-TLB is enabled
 
   phys_pc = proc->fetch_pc;
-  attributes = 0;
-  if (PSTATE_GET_ITE(proc->pstate))
+  rc = fetch_translate(proc, &phys_pc, &attributes);
+  if (rc != TLB_HIT)
     {
-      rc = proc->itlb->
-	LookUp(&phys_pc, &attributes,
-	       proc->log_int_reg_file[arch_to_log(proc,
-						  proc->cwp,
-						  PRIV_TLB_CONTEXT)],
-	       0, PSTATE_GET_PRIV(proc->pstate), LLONG_MAX);
-
-      if (rc != TLB_HIT)
-	{
-	  if (fetch_queue->NumItems() < proc->fetch_queue_size)
-	    {
-	      if (rc == TLB_MISS)
-		fqe.exception_code = ITLB_MISS;
-
-	      if (rc == TLB_FAULT)
-		fqe.exception_code = INSTR_FAULT;
-
-	      fqe.inst = NewInstance(TheBadPC, proc);
-	      fqe.pc   = proc->fetch_pc;       // insert NOP with exception set
-
-	      fetch_queue->Enqueue(fqe);
-	    }
-	  
-	  return(0);
-	}
+      fetch_exception(proc, proc->fetch_pc, rc);
+      return(0);
     }
 
   ICache_recv_addr(proc->proc_id, proc->fetch_pc, phys_pc,
@@ -251,10 +378,26 @@ int decode_cycle(ProcState * proc)
 
   while ((count < decoderate) && (brk == 0) && !proc->sync)
     {
+      /* while fast-forwarding, only decode handed-over instructions */
+      if (proc->fastfwd && proc->fastfwd_detail == 0)
+	break;
+
       /* get the instruction from the fetch queue */
       if (fetch_queue->Empty())
 	{
-	  if (proc->fetch_pc != proc->pc)
+	  if (count == 0)
+	    proc->fetch_bubbles++;
+
+	  if (proc->ftq)
+	    {
+	      if (proc->ftq->NextPC() != proc->pc)
+		{
+		  if (proc->ftq->Train(proc->pc))
+		    proc->ftq_redirects++;
+		  proc->ftq->Redirect(proc->pc);
+		}
+	    }
+	  else if (proc->fetch_pc != proc->pc)
 	    {
 	      proc->fetch_pc = proc->pc;
               proc->fetch_done = 1;
@@ -276,10 +419,25 @@ int decode_cycle(ProcState * proc)
       if (fqe.pc != proc->pc)
 	{
 	  DeleteInstance(inst, proc);
+
+	  // the FTQ went down a different path than decode: learn the
+	  // transfer and restart fetch at the decode PC
+	  if (proc->ftq)
+	    {
+	      if (proc->ftq->Train(proc->pc))
+		proc->ftq_redirects++;
+	      FlushFetchQ(proc);
+	      proc->ftq->Redirect(proc->pc);
+	    }
 	  continue;
 	}
 
+      if (proc->ftq)
+	proc->ftq->Decoded(proc->pc);
+
       count++;
+      if (proc->fastfwd)
+	proc->fastfwd_detail--;
 
       inst->decode_instruction(proc);
       AddtoTagConverter(inst->tag, inst, proc);
@@ -339,6 +497,8 @@ int instance::decode_instruction(ProcState * proc)
   partial_overlap  = 0;
   limbo            = 0;
   kill             = 0;
+  lsq_next         = NULL;
+  lsq_bucket       = LSQ_NONE;
   vsbfwd           = 0;
   miss             = L1DHIT;
   latepf           = 0;
@@ -617,7 +777,8 @@ int check_dependencies(instance * inst, ProcState * proc)
     {
       if (stat_sched ||
 	  (proc->active_instr[inst->unit_type] >=
-	   proc->max_active_instr[inst->unit_type]))
+	   proc->max_active_instr[inst->unit_type]) ||
+	  SMTQueueFull(proc, inst->unit_type))
 	{
 	  // Make sure there's space in the issue queue before
 	  // even trying to get renaming registers, etc.
@@ -654,7 +815,8 @@ int check_dependencies(instance * inst, ProcState * proc)
 	  
         case 3:
           // Copy old mapping to active list
-          if (proc->active_list.NumEntries() == proc->max_active_list)
+          if (proc->active_list.NumEntries() == proc->max_active_list ||
+              SMTWindowFull(proc))
             {
               // No space in active list for fp
               inst->strucdep = 1;
@@ -735,7 +897,8 @@ int check_dependencies(instance * inst, ProcState * proc)
           
         case 4:
           // Copy old mapping to active list
-          if (proc->active_list.NumEntries() == proc->max_active_list)
+          if (proc->active_list.NumEntries() == proc->max_active_list ||
+              SMTWindowFull(proc))
             {
               if (inst->prd != proc->intmapper[ZEROREG])
                 {
@@ -1340,7 +1503,8 @@ int SendToFU(instance * inst, ProcState * proc)
   if (inst->unit_type == uMEM)
     return 0;
 
-  if (proc->UnitsFree[inst->unit_type] == 0)
+  if ((proc->UnitsFree[inst->unit_type] == 0) ||
+      SMTUnitsBusy(proc, inst->unit_type))
     {
       proc->UnitQ[inst->unit_type].AddElt(inst, proc);
       inst->stallqs++;
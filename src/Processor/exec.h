@@ -73,6 +73,7 @@ extern EFP   instr_func[];
 /* Inline functions are declared in exec.hh */
 inline void LetOneUnitStalledGuyGo (ProcState * proc, UTYPE func_unit);
 inline int  maindecode             (ProcState *);
+inline int  maindecode_finish      (ProcState *, int);
 inline void graduate_cycle         (ProcState *);
 
 extern int  fetch_cycle            (ProcState *); 
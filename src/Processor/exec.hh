@@ -55,6 +55,8 @@
 #ifndef __RSIM_EXEC_HH__
 #define __RSIM_EXEC_HH__
 
+#include "Processor/smt.h"
+
 /*
  * The maindecode function is called every cycle, and is used to call,
  * successively, the stages related to pipeline-processing.
@@ -87,6 +89,24 @@ inline int maindecode(ProcState * proc)
 
   graduate_cycle(proc);
 
+  /* parallel stage: the rest of the cycle follows the exception handler */
+  if (proc->deferred_exception)
+    {
+      proc->deferred_sync = old_sync;
+      return 0;
+    }
+
+  return maindecode_finish(proc, old_sync);
+}
+
+
+
+/**************************************************************************/
+/* maindecode_finish : second half of maindecode, after graduation        */
+/**************************************************************************/
+
+inline int maindecode_finish(ProcState * proc, int old_sync)
+{
   proc->intregbusy[proc->intmapper[ZEROREG]] = 0;
 
   /* perform the decoding associated with this cycle */
@@ -99,7 +119,8 @@ inline int maindecode(ProcState * proc)
     // we won't take new ops if so
     {
       decode_cycle(proc);
-      fetch_cycle(proc);
+      if (proc->smt_fetch)
+	fetch_cycle(proc);
     }
 
   /* Go on to the execution unit */
@@ -160,6 +181,15 @@ inline void graduate_cycle(ProcState * proc)
 	}
       
       proc->time_pre_exception = proc->curr_cycle;
+
+      // exceptions may access shared state, handle them after the
+      // parallel stage (see CpuThreadsRun)
+      if (PARALLEL_CPUS)
+	{
+	  proc->deferred_exception = rettagval;
+	  return;
+	}
+
       PreExceptionHandler(rettagval, proc);
     }
 
@@ -189,6 +219,8 @@ inline void LetOneUnitStalledGuyGo(ProcState * proc, UTYPE func_unit)
 	  inst->stallqs--;
 	  issue(inst, proc);
 	}
+      else if (SMT_THREADS > 1)
+	SMTWakeUnit(proc, func_unit);
     }
 }
 
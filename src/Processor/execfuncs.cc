@@ -61,6 +61,7 @@ extern "C"
 #include "Processor/memunit.h"
 #include "Processor/exec.h"
 #include "Processor/mainsim.h"
+#include "Processor/smt.h"
 
 
 int   latencies[numUTYPES];
@@ -344,18 +345,18 @@ void UnitSetup(ProcState * proc, int except)
       repeat[uADDR] = 1;
     }
 
-  proc->UnitsFree[uALU] = proc->MaxUnits[uALU] = ALU_UNITS;
-  proc->UnitsFree[uFP] = proc->MaxUnits[uFP] = FPU_UNITS;
-  proc->MaxUnits[uMEM] = MEM_UNITS;
+  proc->UnitsFree[uALU] = proc->MaxUnits[uALU] = SMTCap(ALU_UNITS);
+  proc->UnitsFree[uFP] = proc->MaxUnits[uFP] = SMTCap(FPU_UNITS);
+  proc->MaxUnits[uMEM] = SMTCap(MEM_UNITS);
 
   if (!except)
     {
       /* we don't reset this on an exception since we don't 
          flush cache ports on exception */
-      proc->UnitsFree[uMEM] = MEM_UNITS;        
+      proc->UnitsFree[uMEM] = SMTCap(MEM_UNITS);        
     }
 
-  proc->UnitsFree[uADDR] = proc->MaxUnits[uADDR] = ADDR_UNITS;
+  proc->UnitsFree[uADDR] = proc->MaxUnits[uADDR] = SMTCap(ADDR_UNITS);
 
 
   /* also, go through and empty all heaps */
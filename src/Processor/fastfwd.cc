@@ -0,0 +1,609 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include <limits.h>
+
+extern "C"
+{
+#include "sim_main/simsys.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/cache.h"
+#include "Caches/ubuf.h"
+}
+
+#include "Processor/procstate.h"
+#include "Processor/exec.h"
+#include "Processor/memunit.h"
+#include "Processor/branchpred.h"
+#include "Processor/predecode.h"
+#include "Processor/tlb.h"
+#include "Processor/fastfwd.h"
+#include "Processor/simpoint.h"
+#include "Processor/fastnews.h"
+#include "Processor/branchpred.hh"
+#include "Processor/procstate.hh"
+#include "Processor/tagcvt.hh"
+#include "Processor/memunit.hh"
+#include "Processor/stallq.hh"
+#include "Processor/active.hh"
+
+
+long long fastfwd_instruction = 0;      // when to switch to detailed sim.
+int       FASTFWD_RATE        = 100;    // instructions per cycle
+int       FASTFWD_WARM        = 1;      // warm L1 and L2 caches
+
+
+
+/***************************************************************************/
+/* FastFwdDrained: the pipeline has no instructions or memory operations   */
+/* in flight, so the logical register file and simulated memory hold the   */
+/* architectural state. Outstanding cache misses would install lines that  */
+/* functional warm-up may install as well, so caches must be idle, too.    */
+/***************************************************************************/
+
+int FastFwdDrained(ProcState *proc)
+{
+  int i = proc->core_id;
+
+  if ((proc->active_list.NumElements() != 0) ||
+      (proc->in_exception != NULL) ||
+      (proc->inst_save != NULL))
+    return 0;
+
+#ifdef STORE_ORDERING
+  if (proc->MemQueue.NumItems())
+    return 0;
+#else
+  if (proc->LoadQueue.NumItems() || proc->StoreQueue.NumItems())
+    return 0;
+#endif
+
+  if (WBuffers[i]->write_queue.size || WBuffers[i]->inqueue.size ||
+      WBuffers[i]->num_in_pipes || UBuffers[i]->num_entries)
+    return 0;
+
+  if (L1ICaches[i]->mshr_count || L1DCaches[i]->mshr_count ||
+      L2Caches[i]->mshr_count ||
+      L1DCaches[i]->num_in_pipes || !L1DCaches[i]->inq_empty ||
+      L2Caches[i]->num_in_pipes  || !L2Caches[i]->inq_empty)
+    return 0;
+
+  return 1;
+}
+
+
+
+/***************************************************************************/
+/* FastFwdSync: the logical register file has been updated functionally;  */
+/* rebuild the physical registers and mappers from it and redirect         */
+/* instruction fetch to the current PC, like the exception handler does.   */
+/***************************************************************************/
+
+void FastFwdSync(ProcState *proc)
+{
+  FlushFetchQ(proc);
+  proc->reset_lists();
+
+  proc->fetch_pc   = proc->pc;
+  proc->fetch_done = 1;
+}
+
+
+
+/***************************************************************************/
+/* FastFwdExecute: execute the instruction at proc->pc functionally.       */
+/* Source operands are read from and results written to the logical       */
+/* register file, using the same register mapping as the pipeline. Returns */
+/* 0 without changing any state if the instruction must be handed over to  */
+/* the detailed pipeline (pending interrupt, TLB miss or fault, traps,     */
+/* serializing instructions, uncached or I/O accesses).                    */
+/***************************************************************************/
+
+static int FastFwdExecute(ProcState *proc)
+{
+  instance  inst;
+  unsigned  phys_pc, vaddr = 0;
+  int       attributes, rc, n, win, taken, acctype = 0;
+  int      *ireg  = proc->log_int_reg_file;
+  double   *fpreg = proc->log_fp_reg_file;
+  short     lrs1, lrs2, lrd, lrcc;
+
+
+  //-------------------------------------------------------------------------
+  // external interrupts are taken by the pipeline
+
+  if ((proc->interrupt_pending) && (PSTATE_GET_IE(proc->pstate)))
+    {
+      n = 31;
+      while (((proc->interrupt_pending & (0x00000001 << n)) == 0) && (n > 0))
+	n--;
+
+      if (n > proc->pil)
+	return 0;
+    }
+
+
+  //-------------------------------------------------------------------------
+  // instruction fetch: I-TLB lookup, I-cache warm-up and predecode
+
+  phys_pc = proc->pc;
+  attributes = 0;
+  if (PSTATE_GET_ITE(proc->pstate))
+    {
+      rc = proc->itlb->
+	LookUp(&phys_pc, &attributes,
+	       ireg[arch_to_log(proc, proc->cwp, PRIV_TLB_CONTEXT)],
+	       0, PSTATE_GET_PRIV(proc->pstate), LLONG_MAX);
+
+      if ((rc != TLB_HIT) || tlb_uncached(attributes))
+	return 0;
+    }
+
+  if (!PredecodeBlock(phys_pc, proc->proc_id / ARCH_cpus,
+		      (char *)&inst.code, 1))
+    return 0;
+
+  if ((inst.code.sync) ||
+      (inst.code.wpchange == WPC_FLUSHW) ||
+      (inst.code.rs1_regtype == REG_FSR) ||
+      (inst.code.rs2_regtype == REG_FSR) ||
+      (inst.code.rd_regtype == REG_FSR))
+    return 0;
+
+  if ((inst.code.rs1_regtype == REG_INTPAIR && (inst.code.rs1 & 1)) ||
+      (inst.code.rd_regtype == REG_INTPAIR && (inst.code.rd & 1)))
+    return 0;
+
+  inst.unit_type      = unit[inst.code.instruction];
+  inst.win_num        = proc->cwp;
+  inst.pc             = proc->pc;
+  inst.npc            = proc->npc;
+  inst.newpc          = 0;
+  inst.addr           = 0;
+  inst.exception_code = OK;
+  inst.mispredicted   = 0;
+  inst.taken          = 1;         // actual direction = !mispredicted
+  inst.branch_pred    = 0;
+  inst.bp_hist        = proc->bp_history;
+  inst.rs1valf        = inst.rs2valf = 0;
+  inst.rsccvali       = 0;
+  inst.rsdvalf        = 0;
+  inst.rccvali        = inst.rdvali = 0;
+
+  if (inst.code.uncond_branch == 2 || inst.code.uncond_branch == 3)
+    inst.newpc = inst.pc + (inst.code.imm * SIZE_OF_SPARC_INSTRUCTION);
+
+
+  //-------------------------------------------------------------------------
+  // register window changes: sources see the old window, destinations
+  // the new one; spill/fill and clean-window traps go to the pipeline
+
+  win = proc->cwp;
+  if (inst.code.wpchange == WPC_SAVE)
+    {
+      if ((!proc->cansave) || (proc->cleanwin - proc->canrestore == 0))
+	return 0;
+      win = unsigned(win + 1) % NUM_WINS;
+    }
+  else if (inst.code.wpchange == WPC_RESTORE)
+    {
+      if (!proc->canrestore)
+	return 0;
+      win = unsigned(win + NUM_WINS - 1) % NUM_WINS;
+    }
+
+
+  //-------------------------------------------------------------------------
+  // read source operands
+
+  switch (inst.code.rs1_regtype)
+    {
+    case REG_INT:
+      lrs1 = arch_to_log(proc, proc->cwp, inst.code.rs1);
+      inst.rs1vali = ireg[lrs1];
+      break;
+
+    case REG_INT64:
+      lrs1 = arch_to_log(proc, proc->cwp, inst.code.rs1);
+      inst.rs1valll = ireg[lrs1];
+      break;
+
+    case REG_FP:
+      inst.rs1valf = fpreg[(unsigned int)inst.code.rs1];
+      break;
+
+    case REG_FPHALF:
+      {
+	float *address = (float *) (&fpreg[unsigned(inst.code.rs1) & ~1U]);
+#ifdef ENDIAN_SWAP
+	if (!(inst.code.rs1 & 1))  /* the odd half */
+	  address += 1;
+#else
+	if (inst.code.rs1 & 1)     /* the odd half */
+	  address += 1;
+#endif
+	inst.rs1valfh = *address;
+	break;
+      }
+
+    case REG_INTPAIR:
+      lrs1 = arch_to_log(proc, proc->cwp, inst.code.rs1);
+      inst.rs1valipair.a = ireg[lrs1];
+      inst.rs1valipair.b = ireg[lrs1 + 1];
+      break;
+
+    default:
+      break;
+    }
+
+  switch (inst.code.rs2_regtype)
+    {
+    case REG_INT:
+      lrs2 = arch_to_log(proc, proc->cwp, inst.code.rs2);
+      inst.rs2vali = ireg[lrs2];
+      break;
+
+    case REG_INT64:
+      lrs2 = arch_to_log(proc, proc->cwp, inst.code.rs2);
+      inst.rs2valll = ireg[lrs2];
+      break;
+
+    case REG_FP:
+      inst.rs2valf = fpreg[(unsigned int)inst.code.rs2];
+      break;
+
+    case REG_FPHALF:
+      {
+	float *address = (float *) (&fpreg[unsigned(inst.code.rs2) & ~1U]);
+#ifdef ENDIAN_SWAP
+	if (!(inst.code.rs2 & 1))  /* the odd half */
+	  address += 1;
+#else
+	if (inst.code.rs2 & 1)     /* the odd half */
+	  address += 1;
+#endif
+	inst.rs2valfh = *address;
+	break;
+      }
+
+    default:
+      break;
+    }
+
+  inst.rsccvali = ireg[arch_to_log(proc, proc->cwp, inst.code.rscc)];
+
+  if (inst.code.rd_regtype == REG_FPHALF)
+    inst.rsdvalf = fpreg[unsigned(inst.code.rd) & ~1U];
+
+
+  //-------------------------------------------------------------------------
+  // memory operations: address calculation, alignment, D-TLB lookup.
+  // Only cacheable accesses to main memory are performed functionally.
+
+  if (inst.unit_type == uMEM)
+    {
+      acctype = mem_acctype[inst.code.instruction];
+      if ((acctype != READ) && (acctype != WRITE) && (acctype != RMW))
+	return 0;
+
+      if (inst.code.instruction == iCASA || inst.code.instruction == iCASXA)
+	inst.addr = inst.rs2vali;
+      else if (inst.code.aux1)
+	inst.addr = inst.rs2vali + inst.code.imm;
+      else
+	inst.addr = inst.rs2vali + inst.rsccvali;
+      vaddr = inst.addr;
+
+      if ((inst.addr & (mem_length[inst.code.instruction] - 1)) != 0)
+	return 0;
+
+      inst.addr_attributes = 0;
+      if (PSTATE_GET_DTE(proc->pstate))
+	{
+	  rc = proc->dtlb->
+	    LookUp(&inst.addr, &inst.addr_attributes,
+		   ireg[arch_to_log(proc, proc->cwp, PRIV_TLB_CONTEXT)],
+		   acctype == WRITE || acctype == RMW,
+		   PSTATE_GET_PRIV(proc->pstate), LLONG_MAX);
+
+	  if ((rc != TLB_HIT) || tlb_uncached(inst.addr_attributes))
+	    return 0;
+	}
+
+      if ((inst.addr >= IO_SEGMENT_LOW) || (GetMap(&inst, proc) == NULL))
+	return 0;
+    }
+
+
+  //-------------------------------------------------------------------------
+  // execute; instructions raising an exception are re-executed by the
+  // pipeline, nothing has been written back at this point
+
+  (*(instr_func[inst.code.instruction]))(&inst, proc);
+
+  if (inst.exception_code != OK)
+    return 0;
+
+
+  //-------------------------------------------------------------------------
+  // write back results into the new register window
+
+  proc->cwp = win;
+  if (inst.code.wpchange == WPC_SAVE || inst.code.wpchange == WPC_RESTORE)
+    {
+      proc->cansave    -= inst.code.wpchange;
+      proc->canrestore += inst.code.wpchange;
+    }
+
+  switch (inst.code.rd_regtype)
+    {
+    case REG_INT:
+    case REG_INT64:
+      lrd = arch_to_log(proc, win, inst.code.rd);
+      if (lrd != ZEROREG)
+	ireg[lrd] = inst.rdvali;
+      break;
+
+    case REG_FP:
+      fpreg[(unsigned int)inst.code.rd] = inst.rdvalf;
+      ireg[arch_to_log(proc, win, STATE_FPRS)] |=
+	inst.code.rd >= 32 ? FPRS_DU : FPRS_DL;
+      break;
+
+    case REG_FPHALF:
+      {
+	double *dreg = &fpreg[unsigned(inst.code.rd) & ~1U];
+	*dreg = inst.rsdvalf;
+	float *address = (float *) dreg;
+#ifdef ENDIAN_SWAP
+	if (!(inst.code.rd & 1))   /* the odd half */
+	  address += 1;
+#else
+	if (inst.code.rd & 1)      /* the odd half */
+	  address += 1;
+#endif
+	*address = inst.rdvalfh;
+	ireg[arch_to_log(proc, win, STATE_FPRS)] |= FPRS_DL;
+	break;
+      }
+
+    case REG_INTPAIR:
+      lrd = arch_to_log(proc, win, inst.code.rd);
+      if (lrd != ZEROREG)
+	ireg[lrd] = inst.rdvalipair.a;
+      ireg[lrd + 1] = inst.rdvalipair.b;
+      break;
+
+    default:
+      break;
+    }
+
+  if (inst.code.rd_regtype != REG_INTPAIR)
+    {
+      lrcc = arch_to_log(proc, win, inst.code.rcc);
+      if (lrcc != ZEROREG)
+	ireg[lrcc] = inst.rccvali;
+    }
+
+
+  //-------------------------------------------------------------------------
+  // next PC, following the delay slot and annul rules of
+  // decode_branch_instruction
+
+  if (inst.code.uncond_branch)
+    {
+      if (inst.code.uncond_branch == 3)
+	proc->RASInsert(inst.pc + (2 * SIZE_OF_SPARC_INSTRUCTION));
+      else if (inst.code.uncond_branch == 4)
+	proc->RASPredict();
+
+      if (inst.code.annul == 0)
+	{
+	  proc->pc  = proc->npc;
+	  proc->npc = inst.newpc;
+	}
+      else
+	{
+	  proc->pc  = inst.newpc;
+	  proc->npc = proc->pc + SIZE_OF_SPARC_INSTRUCTION;
+	}
+    }
+  else if (inst.code.cond_branch)
+    {
+      taken = !inst.mispredicted;
+
+      if (inst.code.aux1 != 0)                    // not a "bn"
+	proc->bp_history = (proc->bp_history << 1) | taken;
+
+      if (inst.code.annul == 0 || taken)
+	{
+	  proc->pc  = proc->npc;
+	  proc->npc = taken ? inst.newpc : proc->pc + SIZE_OF_SPARC_INSTRUCTION;
+	}
+      else
+	{
+	  proc->pc  = proc->npc + SIZE_OF_SPARC_INSTRUCTION;
+	  proc->npc = proc->pc + SIZE_OF_SPARC_INSTRUCTION;
+	}
+    }
+  else
+    {
+      proc->pc  = proc->npc;
+      proc->npc = proc->pc + SIZE_OF_SPARC_INSTRUCTION;
+    }
+
+
+  //-------------------------------------------------------------------------
+  // cache warm-up
+
+  if (FASTFWD_WARM)
+    {
+      Cache_warm_access(proc->core_id, inst.pc, phys_pc, 1, 0);
+
+      if (inst.unit_type == uMEM)
+	Cache_warm_access(proc->core_id, vaddr, inst.addr, 0,
+			  acctype != READ);
+    }
+
+  if (bbv_file)
+    SimpointProfile(proc, inst.pc,
+		    inst.code.cond_branch || inst.code.uncond_branch);
+
+  proc->graduates++;
+  proc->graduation_count++;
+  proc->fastfwd_insts++;
+
+  return 1;
+}
+
+
+
+/***************************************************************************/
+/* FastFwdCycle: called by RSIM_EVENT for a fast-forwarding processor in   */
+/* place of the pipeline stages. Executes up to FASTFWD_RATE instructions  */
+/* and returns 1, or returns 0 if the pipeline must run this cycle because */
+/* an instruction has been handed over or has not yet drained.            */
+/***************************************************************************/
+
+int FastFwdCycle(ProcState *proc)
+{
+  int n;
+
+  if (proc->fastfwd == FASTFWD_HANDOVER)
+    {
+      if (!FastFwdDrained(proc))
+	return 0;
+
+      proc->fastfwd = FASTFWD_FUNC;
+    }
+
+  proc->curr_cycle = (long long) YS__Simtime;
+
+  for (n = 0; n < FASTFWD_RATE; n++)
+    if (!FastFwdExecute(proc))
+      {
+	FastFwdSync(proc);
+	proc->fastfwd        = FASTFWD_HANDOVER;
+	proc->fastfwd_detail = 1;
+	proc->fastfwd_handovers++;
+	return 0;
+      }
+
+  return 1;
+}
+
+
+
+/***************************************************************************/
+/* FastFwdEnd: switch a processor to detailed simulation.                  */
+/***************************************************************************/
+
+void FastFwdEnd(ProcState *proc)
+{
+  if (proc->fastfwd == FASTFWD_OFF)
+    return;
+
+  if (proc->fastfwd == FASTFWD_FUNC)
+    FastFwdSync(proc);
+
+  proc->fastfwd = FASTFWD_OFF;
+
+  YS__logmsg(proc->proc_id / ARCH_cpus,
+	     "CPU %i: fast-forwarded %lld instructions (%lld handed over)\n",
+	     proc->proc_id % ARCH_cpus,
+	     proc->fastfwd_insts, proc->fastfwd_handovers);
+}
+
+
+
+/***************************************************************************/
+/* FastFwdStop: switch all processors of a node to detailed simulation.    */
+/* Called when the fast-forward count is reached or when the application   */
+/* marks the start of its region of interest (RSIM_ON or clear-stat trap); */
+/* fast-forwarding does not resume afterwards.                             */
+/***************************************************************************/
+
+void FastFwdStop(int node)
+{
+  int n;
+
+  if (SimpointActive())
+    return;
+
+  fastfwd_instruction = 0;
+
+  for (n = node * ARCH_cpus; n < (node + 1) * ARCH_cpus; n++)
+    if (AllProcs[n])
+      FastFwdEnd(AllProcs[n]);
+}
+
+
+
+/***************************************************************************/
+/* FastFwdResume: return a processor to functional execution after a       */
+/* detailed simulation period. Decode stops and functional execution       */
+/* starts once the pipeline has drained, as after a handed-over            */
+/* instruction.                                                            */
+/***************************************************************************/
+
+void FastFwdResume(ProcState *proc)
+{
+  if (proc->fastfwd != FASTFWD_OFF)
+    return;
+
+  proc->fastfwd        = FASTFWD_HANDOVER;
+  proc->fastfwd_detail = 0;
+}
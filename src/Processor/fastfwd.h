@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+/***************************************************************************/
+/* Functional fast-forwarding: processors execute instructions directly on */
+/* the architectural register file at FASTFWD_RATE instructions per cycle, */
+/* optionally warming the caches, until the fast-forward instruction count */
+/* is reached. Instructions that trap, serialize or access I/O space are   */
+/* handed over to the detailed pipeline, which executes them and drains    */
+/* before functional execution resumes.                                    */
+/***************************************************************************/
+
+#ifndef __RSIM_FASTFWD_H__
+#define __RSIM_FASTFWD_H__
+
+
+#define FASTFWD_OFF       0    /* detailed simulation                      */
+#define FASTFWD_FUNC      1    /* functional execution                     */
+#define FASTFWD_HANDOVER  2    /* instruction handed over to the pipeline  */
+
+
+extern long long fastfwd_instruction;  /* end of fast-forward period (-f)   */
+extern int       FASTFWD_RATE;         /* instructions per cycle            */
+extern int       FASTFWD_WARM;         /* warm caches while fast-forwarding */
+
+
+struct ProcState;
+
+int  FastFwdCycle   (ProcState *);
+void FastFwdEnd     (ProcState *);
+void FastFwdStop    (int);
+int  FastFwdDrained (ProcState *);
+void FastFwdSync    (ProcState *);
+void FastFwdResume  (ProcState *);
+
+
+#endif
@@ -79,6 +79,7 @@ extern "C"
 {
 #include "sim_main/simsys.h"
 #include "sim_main/util.h"
+#include "sim_main/checkpoint.h"
 }
 
 #include "Processor/simio.h"
@@ -348,3 +349,33 @@ int FD_remove(int fd)
 
 
 
+
+
+
+/*=========================================================================*/
+/* Save and restore the filedescriptor map. Only the map is checkpointed,  */
+/* the host files themselves must still exist when the checkpoint is       */
+/* restored.                                                               */
+/*=========================================================================*/
+
+void FD_ckpt_save(CKPT *ckpt)
+{
+  Ckpt_section(ckpt, CKPT_TAG('F', 'D', 'S', ' '));
+  Ckpt_write_int(ckpt, fd_max);
+  Ckpt_write_int(ckpt, fd_free);
+  Ckpt_write(ckpt, FDs, fd_max * sizeof(rsim_filedesc_t));
+}
+
+
+
+void FD_ckpt_restore(CKPT *ckpt)
+{
+  Ckpt_expect(ckpt, CKPT_TAG('F', 'D', 'S', ' '));
+  fd_max  = Ckpt_read_int(ckpt);
+  fd_free = Ckpt_read_int(ckpt);
+
+  FDs = (rsim_filedesc_t*)realloc(FDs, fd_max * sizeof(rsim_filedesc_t));
+  if (FDs == NULL)
+    YS__errmsg(ckpt->nodeid, "Realloc failed in %s:%i", __FILE__, __LINE__);
+  Ckpt_read(ckpt, FDs, fd_max * sizeof(rsim_filedesc_t));
+}
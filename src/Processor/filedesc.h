@@ -86,6 +86,10 @@ int       FD_fchdir (int fd);
 long long FD_lseek  (int fd, long long offset, int whence);
 int       FD_remove (int fd);
 
+struct CKPT;
+void      FD_ckpt_save    (struct CKPT *ckpt);
+void      FD_ckpt_restore (struct CKPT *ckpt);
+
 
 #define FD_INCR 256
 
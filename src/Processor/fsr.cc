@@ -84,7 +84,7 @@ extern "C"
 #include "Processor/procstate.hh"
 
 
-volatile int fpfailed = 0;
+__thread volatile int fpfailed = 0;   // per thread, see cputhreads.cc
 
 
 /*---------------------------------------------------------------------------*/
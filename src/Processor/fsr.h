@@ -154,7 +154,7 @@ inline void take_fp_exception(ProcState *proc, instance *inst)
 /* in case of an exception.                                                  */
 /*---------------------------------------------------------------------------*/
 
-extern volatile int fpfailed;
+extern __thread volatile int fpfailed;
 
 
 void get_fsr(ProcState*, instance *);
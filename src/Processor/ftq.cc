@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C"
+{
+#include "sim_main/simsys.h"
+}
+
+#include "Processor/procstate.h"
+#include "Processor/ftq.h"
+
+
+int FTQ_SIZE     = 0;
+int FETCH_BLOCKS = 2;
+int FTB_SIZE     = 512;
+int FTQ_PREFETCH = 1;
+
+
+
+/*************************************************************************/
+/* FetchTargetQueue: circular queue of fetch blocks plus the next-block  */
+/* predictor that fills it                                               */
+/*************************************************************************/
+
+FetchTargetQueue::FetchTargetQueue(int size):
+  ftb(FTB_SIZE, FTB_ASSOC)
+{
+  if (size < 1)
+    size = 1;
+
+  this->size = size;
+  blocks     = new FetchBlock[size];
+  head       = 0;
+  items      = 0;
+  last_pc    = FTQ_NOPC;
+  predict_pc = FTQ_NOPC;                 // idle until decode redirects it
+  tlb_vpage  = FTQ_NOPC;
+}
+
+
+/*
+ * Append up to FTQ_PREDICTS blocks. A block stops at the end of the line,
+ * after 'rate' instructions or at the first instruction with an FTB entry,
+ * in which case the next block starts at the recorded target.
+ */
+void FetchTargetQueue::Predict(int linesz, int rate)
+{
+  FetchBlock *blk;
+  unsigned    target;
+  int         n, i, count;
+
+  if (predict_pc == FTQ_NOPC)
+    return;
+
+  for (n = 0; (n < FTQ_PREDICTS) && (items < size); n++)
+    {
+      count = (linesz - (predict_pc % linesz)) / SIZE_OF_SPARC_INSTRUCTION;
+      if (count > rate)
+	count = rate;
+
+      target = BP_NOTARGET;
+      for (i = 0; i < count; i++)
+	{
+	  target = ftb.Predict(predict_pc + i * SIZE_OF_SPARC_INSTRUCTION, 0);
+	  if (target != BP_NOTARGET)
+	    {
+	      count = i + 1;
+	      break;
+	    }
+	}
+
+      blk = &blocks[(head + items) % size];
+      blk->pc       = predict_pc;
+      blk->count    = count;
+      blk->state    = FTQ_PREDICTED;
+      blk->prefetch = FTQ_PF_NONE;
+      items++;
+
+      if (target != BP_NOTARGET)
+	predict_pc = target;
+      else
+	predict_pc += count * SIZE_OF_SPARC_INSTRUCTION;
+    }
+}
+
+
+
+void FetchTargetQueue::Pop()
+{
+  head = (head + 1) % size;
+  items--;
+}
+
+
+
+/*
+ * Oldest block starting at 'pc' that is in the given state
+ */
+FetchBlock *FetchTargetQueue::Find(unsigned pc, ftq_state state)
+{
+  FetchBlock *blk;
+  int n;
+
+  for (n = 0; n < items; n++)
+    {
+      blk = Block(n);
+      if ((blk->pc == pc) && (blk->state == state))
+	return(blk);
+    }
+
+  return(NULL);
+}
+
+
+
+/*
+ * Drop all blocks and stop predicting until the next Redirect. Replies to
+ * outstanding requests no longer find their block and are discarded.
+ */
+void FetchTargetQueue::Flush()
+{
+  head       = 0;
+  items      = 0;
+  last_pc    = FTQ_NOPC;
+  predict_pc = FTQ_NOPC;
+  tlb_vpage  = FTQ_NOPC;
+}
+
+
+void FetchTargetQueue::Redirect(unsigned pc)
+{
+  Flush();
+  predict_pc = pc;
+}
+
+
+
+/*
+ * Decode continues at 'pc' after the last decoded instruction, but the
+ * FTQ delivered something else: either it predicted a transfer that did
+ * not happen, or it missed one. Returns 0 if nothing was decoded since
+ * the last flush, i.e. decode itself was redirected.
+ */
+int FetchTargetQueue::Train(unsigned pc)
+{
+  if (last_pc == FTQ_NOPC)
+    return(0);
+
+  if (pc == last_pc + SIZE_OF_SPARC_INSTRUCTION)
+    ftb.Invalidate(last_pc);
+  else
+    ftb.Update(last_pc, 0, pc);
+
+  return(1);
+}
+
+
+
+/*
+ * Remember the last I-TLB translation of the fetch stage; prefetches to
+ * blocks on the same page use it instead of accessing the I-TLB.
+ */
+void FetchTargetQueue::Translated(unsigned vaddr, unsigned paddr,
+				  int attributes)
+{
+  tlb_vpage      = vaddr & ~(PAGE_SIZE - 1);
+  tlb_ppage      = paddr & ~(PAGE_SIZE - 1);
+  tlb_attributes = attributes;
+}
+
+
+int FetchTargetQueue::Translate(unsigned vaddr, unsigned *paddr,
+				int *attributes)
+{
+  if ((tlb_vpage == FTQ_NOPC) || ((vaddr & ~(PAGE_SIZE - 1)) != tlb_vpage))
+    return(0);
+
+  *paddr      = tlb_ppage | (vaddr & (PAGE_SIZE - 1));
+  *attributes = tlb_attributes;
+  return(1);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#ifndef __RSIM_FTQ_H__
+#define __RSIM_FTQ_H__
+
+/*
+ * Decoupled instruction fetch. A next-block predictor runs ahead of the
+ * I-cache and appends fetch blocks to the fetch target queue (FTQ); the
+ * fetch stage sends up to 'fetchblocks' I-cache requests per cycle from
+ * the oldest blocks, and blocks further back in the queue are prefetched
+ * into the L1 I-cache. A block ends at the end of a cache line, after
+ * 'fetchrate' instructions, or at a predicted taken control transfer.
+ *
+ * Taken transfers are kept in a fetch target buffer (FTB), keyed by the
+ * last instruction before the transfer (the delay slot, or the branch
+ * itself if the delay slot is annulled). Decode stays authoritative: when
+ * it continues at a different PC than the FTQ delivered, the FTB learns
+ * the transition and the FTQ restarts at the decode PC.
+ */
+
+#include "Processor/bpred.h"
+
+extern int FTQ_SIZE;                      /* fetch blocks, 0 = coupled     */
+extern int FETCH_BLOCKS;                  /* I-cache requests per cycle    */
+extern int FTB_SIZE;                      /* fetch target buffer entries   */
+extern int FTQ_PREFETCH;                  /* prefetch queued blocks        */
+
+#define FTB_ASSOC      4
+#define FTQ_PREDICTS   2                  /* blocks predicted per cycle    */
+#define FTQ_NOPC       ((unsigned) -1)
+
+
+enum ftq_state
+{
+  FTQ_PREDICTED,                          /* waiting for the I-cache       */
+  FTQ_ISSUED                              /* I-cache request outstanding   */
+};
+
+enum ftq_prefetch
+{
+  FTQ_PF_NONE,
+  FTQ_PF_DONE                             /* issued or not needed          */
+};
+
+
+struct FetchBlock
+{
+  unsigned     pc;                        /* first instruction             */
+  int          count;                     /* number of instructions        */
+  ftq_state    state;
+  ftq_prefetch prefetch;
+  unsigned     phys_pc;                   /* translation used for issue    */
+  int          attributes;
+};
+
+
+class FetchTargetQueue
+{
+private:
+  FetchBlock         *blocks;
+  int                 size;
+  int                 head;
+  int                 items;
+
+  BranchTargetBuffer  ftb;
+  unsigned            predict_pc;         /* start of next block           */
+  unsigned            last_pc;            /* last decoded PC, for training */
+
+  unsigned            tlb_vpage;          /* last I-TLB translation, reused */
+  unsigned            tlb_ppage;          /* for prefetches on that page    */
+  int                 tlb_attributes;
+
+public:
+  FetchTargetQueue(int size);
+
+  int         NumItems()      { return(items); }
+  int         Full()          { return(items == size); }
+  FetchBlock *Block(int n)    { return(&blocks[(head + n) % size]); }
+  unsigned    NextPC()        { return(items ? blocks[head].pc : predict_pc); }
+
+  void        Predict   (int linesz, int rate);
+  void        Pop       ();
+  FetchBlock *Find      (unsigned pc, ftq_state state);
+
+  void        Flush     ();
+  void        Redirect  (unsigned pc);
+  void        Decoded   (unsigned pc)    { last_pc = pc; }
+  int         Train     (unsigned pc);
+
+  void        Translated(unsigned vaddr, unsigned paddr, int attributes);
+  int         Translate (unsigned vaddr, unsigned *paddr, int *attributes);
+};
+
+#endif
@@ -109,8 +109,8 @@ extern "C"
 #define fccUO 3 /* unordered */
 
 
-/* need additional indirection to get gcc to respect the volatile attribute */
-volatile int *fpstatus = &fpfailed;
+/* IEEE exception code of this thread, set by the FP signal handler */
+#define fpstatus (&fpfailed)
 
 
 
@@ -159,7 +159,7 @@ void fnCALL(instance *inst, ProcState *)
 }
 
 
-void fnJMPL(instance *inst, ProcState *)
+void fnJMPL(instance *inst, ProcState *proc)
 {
   int tmp;
   inst->rdvali = inst->pc;
@@ -169,6 +169,9 @@ void fnJMPL(instance *inst, ProcState *)
     tmp = inst->rs1vali + inst->rs2vali;
   inst->newpc = tmp;
 
+  if (inst->code.uncond_branch == 1 && proc->TargetPred)  /* not a return */
+    proc->TargetPred->Update(inst->pc, inst->bp_hist, tmp);
+
   inst->mispredicted = (tmp != inst->branch_pred);
 }
 
@@ -363,7 +366,7 @@ void fnBPcc(instance *inst, ProcState *proc)
     inst->newpc = inst->pc + (2 * SIZE_OF_SPARC_INSTRUCTION);
 
   if (inst->code.aux1 != Nb) /* don't mark it for bn */
-    proc->BPBComplete(inst->pc, taken, inst->code.taken);
+    proc->BPBComplete(inst->pc, taken, inst->code.taken, inst->bp_hist);
 
   inst->mispredicted = (inst->taken != taken);
 }
@@ -413,7 +416,7 @@ void fnBPr(instance *inst, ProcState *proc)
   else
     inst->newpc = inst->pc + (2 * SIZE_OF_SPARC_INSTRUCTION);
 
-  proc->BPBComplete(inst->pc, taken, inst->code.taken);
+  proc->BPBComplete(inst->pc, taken, inst->code.taken, inst->bp_hist);
   
   inst->mispredicted = (inst->taken != taken);
 }
@@ -503,7 +506,7 @@ void fnFBPfcc(instance *inst, ProcState *proc)
     inst->newpc = inst->pc + (2 * SIZE_OF_SPARC_INSTRUCTION);
 
   if (inst->code.aux1 != Nf) /* don't mark it for bn */
-    proc->BPBComplete(inst->pc, taken, inst->code.taken);
+    proc->BPBComplete(inst->pc, taken, inst->code.taken, inst->bp_hist);
   
   inst->mispredicted = (inst->taken != taken);
 }
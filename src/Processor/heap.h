@@ -269,6 +269,12 @@ public:
     return obj[0];
   }
 
+  /* return the tag stored with the head instance */
+  inline long long PeekHeadTag() const
+  {
+    return tags[0];
+  }
+
   /* 
    * The following three member functions are defined below. 
    *   void resize(int);
@@ -402,4 +408,247 @@ public:
   }
 };
 
+
+
+/**************************************************************************/
+/******************* InstWheel class definition ***************************/
+/**************************************************************************/
+/* Timing wheel with the same interface and ordering as the InstHeap.    */
+/* Events are kept in one list per cycle, sorted by tag; a bitmap of     */
+/* non-empty slots finds the earliest cycle with a single bit scan, so   */
+/* insert and remove do not depend on the number of pending events.      */
+/* The wheel covers WHEELSLOTS consecutive cycles starting at 'base';    */
+/* events outside that window (long latencies, or a far earlier event    */
+/* while the wheel is occupied) go to an ordinary InstHeap.              */
+/**************************************************************************/
+
+#define WHEELSLOTS	64             /* one bit per slot in 'busy'      */
+#define WHEELNIL	-1
+
+
+class InstWheel
+{
+  typedef instance *instptr;
+
+private:
+  instptr            *obj;             /* event storage, linked by index  */
+  long long          *tags;
+  long long          *ord;
+  int                *next;
+  int                 size;
+  int                 freelist;
+
+  int                 slot[WHEELSLOTS];  /* per-cycle lists, by tag       */
+  int                 last[WHEELSLOTS];  /* tail of each list             */
+  unsigned long long  busy;            /* bit n: slot n non-empty         */
+  long long           base;            /* no event before this cycle      */
+  int                 used;            /* events in the wheel             */
+  InstHeap            overflow;        /* events outside the window       */
+
+
+  static inline int LowBit(unsigned long long b)
+  {
+#ifdef __GNUC__
+    return __builtin_ctzll(b);
+#else
+    int n = 0;
+    while (!(b & 1)) { b >>= 1; n++; }
+    return n;
+#endif
+  }
+
+  static inline int HighBit(unsigned long long b)
+  {
+#ifdef __GNUC__
+    return 63 - __builtin_clzll(b);
+#else
+    int n = 0;
+    while (b >>= 1) n++;
+    return n;
+#endif
+  }
+
+  /* slot bitmap rotated so that bit 0 corresponds to 'base' */
+  inline unsigned long long Window() const
+  {
+    int off = (int)(base & (WHEELSLOTS - 1));
+
+    if (off == 0)
+      return busy;
+    return (busy >> off) | (busy << (WHEELSLOTS - off));
+  }
+
+  inline void resize(int sz)
+  {
+    instance **obj2  = new instptr[sz];
+    long long *tags2 = new long long[sz];
+    long long *ord2  = new long long[sz];
+    int       *next2 = new int[sz];
+    int        n;
+
+    memcpy(obj2,  obj,  size * sizeof(instptr));
+    memcpy(tags2, tags, size * sizeof(long long));
+    memcpy(ord2,  ord,  size * sizeof(long long));
+    memcpy(next2, next, size * sizeof(int));
+
+    for (n = size; n < sz - 1; n++)
+      next2[n] = n + 1;
+    next2[sz - 1] = freelist;
+    freelist = size;
+
+    delete []obj; delete []tags; delete []ord; delete []next;
+
+    size = sz;
+    obj  = obj2;
+    tags = tags2;
+    ord  = ord2;
+    next = next2;
+  }
+
+
+public:
+  InstWheel(): size(MINHEAPSZ), busy(0), base(0), used(0)
+  {
+    int n;
+
+    obj  = new instptr[size];
+    tags = new long long[size];
+    ord  = new long long[size];
+    next = new int[size];
+
+    for (n = 0; n < size - 1; n++)
+      next[n] = n + 1;
+    next[size - 1] = WHEELNIL;
+    freelist = 0;
+
+    for (n = 0; n < WHEELSLOTS; n++)
+      slot[n] = WHEELNIL;
+  }
+
+
+  ~InstWheel()
+  {
+    delete[] obj;
+    delete[] tags;
+    delete[] ord;
+    delete[] next;
+  }
+
+
+  inline int num() const
+  {
+    return used + overflow.num();
+  }
+
+  /* does the overflow heap hold the earliest event? */
+  inline int OverflowFirst() const
+  {
+    if (overflow.num() == 0)
+      return 0;
+    if (used == 0)
+      return 1;
+
+    int       e  = slot[(base + LowBit(Window())) & (WHEELSLOTS - 1)];
+    long long ts = overflow.PeekMin();
+
+    return (ts < ord[e]) ||
+           ((ts == ord[e]) && (overflow.PeekHeadTag() < tags[e]));
+  }
+
+  /* return min timestamp */
+  inline long long PeekMin() const
+  {
+    if (OverflowFirst())
+      return overflow.PeekMin();
+    return base + LowBit(Window());
+  }
+
+  /* return the head instance */
+  inline instance *PeekHeadInst() const
+  {
+    if (OverflowFirst())
+      return overflow.PeekHeadInst();
+    return obj[slot[(base + LowBit(Window())) & (WHEELSLOTS - 1)]];
+  }
+
+
+  inline int insert(long long ts, instance * o, long long tag)
+  {
+    int n, e, *link;
+
+    if (used == 0)
+      base = ts;
+    else if (ts < base)
+      {
+	// move the window back if the latest event still fits
+	if (base + HighBit(Window()) - ts >= WHEELSLOTS)
+	  return overflow.insert(ts, o, tag);
+	base = ts;
+      }
+    else if (ts - base >= WHEELSLOTS)
+      return overflow.insert(ts, o, tag);
+
+    if (freelist == WHEELNIL)
+      resize(2 * size);
+
+    e = freelist;
+    freelist = next[e];
+
+    obj[e]  = o;
+    tags[e] = tag;
+    ord[e]  = ts;
+
+    // events mostly arrive in tag order, try the tail of the list first
+    n = (int)(ts & (WHEELSLOTS - 1));
+    if ((slot[n] == WHEELNIL) || (tags[last[n]] <= tag))
+      link = (slot[n] == WHEELNIL) ? &slot[n] : &next[last[n]];
+    else
+      {
+	link = &slot[n];
+	while (tags[*link] <= tag)
+	  link = &next[*link];
+      }
+
+    next[e] = *link;
+    *link   = e;
+    if (next[e] == WHEELNIL)
+      last[n] = e;
+
+    busy |= 1ULL << n;
+    used++;
+    return 1;
+  }
+
+
+  inline long long GetMin(instance * &min, long long &tag)
+  {
+    long long ts;
+    int       n, e;
+
+    if (num() == 0)
+      return -1;
+
+    if (OverflowFirst())
+      return overflow.GetMin(min, tag);
+
+    ts = base + LowBit(Window());
+    n  = (int)(ts & (WHEELSLOTS - 1));
+    e  = slot[n];
+
+    min = obj[e];
+    tag = tags[e];
+
+    slot[n]  = next[e];
+    next[e]  = freelist;
+    freelist = e;
+
+    if (slot[n] == WHEELNIL)
+      busy &= ~(1ULL << n);
+
+    base = ts;                         // nothing earlier is left
+    used--;
+    return ts;
+  }
+};
+
 #endif
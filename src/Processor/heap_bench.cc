@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+/*
+ * heap_bench.cc
+ *
+ * Standalone microbenchmark for the completion event queues in heap.h:
+ * the binary InstHeap and the InstWheel timing wheel that replaced it for
+ * Running, DoneHeap and MemDoneHeap. Only heap.h is needed; the instance
+ * structure is stubbed since the queues store pointers to it.
+ *
+ * Each run uses the 'hold' model: the queue is filled with <pending>
+ * events, then the earliest event is repeatedly removed and rescheduled
+ * at its time plus a latency of 1 to 20 cycles, or 100 to 300 cycles
+ * for one event in 32 (these take the wheel's overflow path). Both
+ * queues see the same sequence of operations, so they must return the
+ * same events in the same order; any difference is reported as an error.
+ *
+ * Build with 'make bench', usage: heap_bench [pending] [steps]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "sim_main/util.h"
+
+struct instance
+{
+  int dummy;
+};
+
+#include "Processor/heap.h"
+
+
+#define MAX_RECORD   (1 << 16)
+
+static instance   insts[16];
+static long long  times[MAX_RECORD];
+static long long  tags[MAX_RECORD];
+
+
+
+static double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+
+static long long latency(void)
+{
+  if (rand() % 32 == 0)
+    return 100 + rand() % 201;
+  return 1 + rand() % 20;
+}
+
+
+
+/*
+ * Run the hold model on one queue type. The first MAX_RECORD events
+ * removed are recorded, or compared against the recording if 'check' is
+ * set; returns the time per step in nanoseconds.
+ */
+template <class Q> static double run(int pending, int steps, int check,
+				     int &errors)
+{
+  Q          q;
+  instance  *inst;
+  long long  cycle = 0, tag = 0, t, lasttime = -1;
+  double     t0;
+  int        n;
+
+  srand(1);
+  for (n = 0; n < pending; n++)
+    q.insert(latency(), &insts[n % 16], tag++);
+
+  t0 = now();
+  for (n = 0; n < steps; n++)
+    {
+      cycle = q.GetMin(inst, t);
+      if (cycle < lasttime)
+	errors++;
+      lasttime = cycle;
+
+      if (n < MAX_RECORD)
+	{
+	  if (!check)
+	    {
+	      times[n] = cycle;
+	      tags[n]  = t;
+	    }
+	  else if ((times[n] != cycle) || (tags[n] != t))
+	    errors++;
+	}
+
+      q.insert(cycle + latency(), inst, tag++);
+    }
+
+  return (now() - t0) * 1.0e9 / steps;
+}
+
+
+
+int main(int argc, char **argv)
+{
+  static int sizes[] = { 16, 64, 256, 1024, 4096 };
+  int        pending = 0, steps = 2000000, errors = 0, s;
+  double     heap, wheel;
+
+  if (argc > 1)
+    pending = atoi(argv[1]);
+  if (argc > 2)
+    steps = atoi(argv[2]);
+
+  printf("%8s %10s %10s %10s %8s\n",
+	 "pending", "steps", "heap ns", "wheel ns", "errors");
+
+  for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+    {
+      int size = (pending > 0) ? pending : sizes[s], e = 0;
+
+      if ((pending > 0) && (s > 0))
+	break;
+
+      heap  = run<InstHeap>(size, steps, 0, e);
+      wheel = run<InstWheel>(size, steps, 1, e);
+      printf("%8d %10d %10.1f %10.1f %8d\n", size, steps, heap, wheel, e);
+      errors += e;
+    }
+
+  if (errors)
+    printf("FAILED: %d ordering errors\n", errors);
+
+  return errors != 0;
+}
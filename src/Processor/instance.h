@@ -225,6 +225,9 @@ struct instance
   unsigned  finish_addr;     /* the "end address" of the memory instruction*/
 
   long long vsbfwd;	     /* forwards from virtual store buffer         */
+
+  instance *lsq_next;        /* next op on load/store queue address chain  */
+  int       lsq_bucket;      /* address chain of op, LSQ_NONE if none      */
   
 
   
@@ -263,6 +266,7 @@ struct instance
   char      taken;             /* the return value of StartCtlXfer         */
 
   unsigned  branch_pred;       /* pc predicted, filled in at decode        */
+  unsigned long long bp_hist;  /* global branch history at prediction      */
 
   
   /************************** dependence records ***************************/
@@ -0,0 +1,535 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#ifndef __RSIM_LSQ_H__
+#define __RSIM_LSQ_H__
+
+#include <string.h>
+#include <limits.h>
+
+#include "Processor/memq.h"
+#include "Processor/instance.h"
+
+
+/*
+ * Load and store queues with an address index. The queues themselves are
+ * still the tag-ordered MemQs that the rest of the processor walks, but
+ * operations whose address has been generated are also kept on per-line
+ * hash chains, sorted by tag. Loads and stores only need to look at the
+ * chains of the lines they touch, instead of scanning the entire opposite
+ * queue for overlaps. An empty chain rejects a lookup without touching any
+ * instance. Operations crossing a line boundary go on a separate 'wide'
+ * chain that every lookup merges in. Tags of stores without an address are
+ * kept in an ordered list so that the oldest unresolved store can be found
+ * without a scan. Loads in limbo are kept on their own chain, since a newly
+ * disambiguated store has to look at them regardless of their address.
+ *
+ * An operation whose address is replaced by the physical address
+ * (ReplaceAddr) is moved to the chain of the new address.
+ */
+
+#define LSQ_LINE_SHIFT   5                 /* 32 byte index granularity    */
+#define LSQ_BUCKETS      256               /* number of hash chains        */
+#define LSQ_WIDE         LSQ_BUCKETS       /* chain for line-crossing ops  */
+#define LSQ_LIMBO        (LSQ_BUCKETS + 1) /* chain for loads in limbo     */
+#define LSQ_CHAINS       (LSQ_BUCKETS + 2)
+#define LSQ_NONE         -1                /* not on any chain             */
+#define LSQ_UNKNOWN      -2                /* queued load without address  */
+
+
+/*************************************************************************/
+/* LSQCursor: iterates over the indexed operations with a tag in a given */
+/*          : range that may overlap with a given memory operation, in   */
+/*          : tag order                                                  */
+/*************************************************************************/
+
+struct LSQCursor
+{
+  instance  *chain[4];
+  long long  low;
+  long long  limit;
+
+  inline instance *Next()
+  {
+    int n, best = -1;
+
+    for (n = 0; n < 4; n++)
+      {
+	while (chain[n] != NULL && chain[n]->tag < low)
+	  chain[n] = chain[n]->lsq_next;
+
+	if (chain[n] != NULL && chain[n]->tag < limit &&
+	    (best < 0 || chain[n]->tag < chain[best]->tag))
+	  best = n;
+      }
+
+    if (best < 0)
+      return(NULL);
+
+    instance *op = chain[best];
+    chain[best] = op->lsq_next;
+    return(op);
+  }
+};
+
+
+
+/*************************************************************************/
+/* LSQIndex: per-line chains of one queue                                */
+/*************************************************************************/
+
+class LSQIndex
+{
+private:
+  instance *chains[LSQ_CHAINS];
+
+public:
+  LSQIndex()
+  {
+    for (int n = 0; n < LSQ_CHAINS; n++)
+      chains[n] = NULL;
+  }
+
+  static inline int LineBucket(unsigned addr)
+  {
+    return((addr >> LSQ_LINE_SHIFT) & (LSQ_BUCKETS - 1));
+  }
+
+  static inline int Bucket(instance *inst)
+  {
+    if ((inst->addr >> LSQ_LINE_SHIFT) ==
+	(inst->finish_addr >> LSQ_LINE_SHIFT))
+      return(LineBucket(inst->addr));
+    return(LSQ_WIDE);
+  }
+
+  inline void Link  (instance *inst, int bucket);
+  inline int  Unlink(instance *inst);
+  inline void Swap  (instance *inst, instance *inst2);
+  inline int  Rekey (instance *inst, unsigned addr);
+
+  inline void Cursor(instance *op, LSQCursor &cursor, int limbo)
+  {
+    int b1 = LineBucket(op->addr);
+    int b2 = LineBucket(op->finish_addr);
+
+    cursor.chain[0] = chains[b1];
+    cursor.chain[1] = (b2 != b1) ? chains[b2] : NULL;
+    cursor.chain[2] = chains[LSQ_WIDE];
+    cursor.chain[3] = limbo ? chains[LSQ_LIMBO] : NULL;
+  }
+};
+
+
+
+/*************************************************************************/
+/***************** StoreQ class definition *******************************/
+/*************************************************************************/
+
+class StoreQ : public MemQ<instance *>
+{
+private:
+  LSQIndex         index;
+  MemQ<long long>  unresolved;             /* tags of stores w/o address */
+
+  inline void Forget(instance *inst);
+
+public:
+  StoreQ(): MemQ<instance *>()
+  { }
+
+  inline void Insert    (instance *inst);
+  inline int  Remove    (instance *inst);
+  inline void RemoveTail();
+  inline int  Replace   (instance *inst, instance *inst2);
+  inline void Resolve   (instance *inst);  /* address has been generated  */
+
+  inline void Rekey(instance *inst, unsigned addr)
+  {
+    index.Rekey(inst, addr);
+  }
+
+  inline void Older(instance *op, LSQCursor &cursor)
+  {
+    index.Cursor(op, cursor, 0);
+    cursor.low   = LLONG_MIN;
+    cursor.limit = op->tag;
+  }
+
+  inline int MinUnresolved(long long &tag)
+  {
+    return(unresolved.GetMin(tag));
+  }
+
+  inline int CountUnresolved(long long low, long long high)
+  {
+    MemQLink<long long> *index = NULL;
+    int count = 0;
+
+    while ((index = unresolved.GetNext(index)) != NULL && index->d < high)
+      if (index->d > low)
+	count++;
+
+    return(count);
+  }
+};
+
+
+
+/*************************************************************************/
+/***************** LoadQ class definition ********************************/
+/*************************************************************************/
+
+class LoadQ : public MemQ<instance *>
+{
+private:
+  LSQIndex index;
+
+public:
+  LoadQ(): MemQ<instance *>()
+  { }
+
+  inline void Insert    (instance *inst);
+  inline int  Remove    (instance *inst);
+  inline void RemoveTail();
+  inline void Resolve   (instance *inst);  /* address has been generated  */
+  inline void Update    (instance *inst);  /* limbo count has changed     */
+
+  inline void Rekey(instance *inst, unsigned addr)
+  {
+    index.Rekey(inst, addr);
+  }
+
+  inline void Younger(instance *op, LSQCursor &cursor)
+  {
+    index.Cursor(op, cursor, 1);
+    cursor.low   = op->tag;
+    cursor.limit = LLONG_MAX;
+  }
+};
+
+
+
+/*************************************************************************/
+/***************** LSQIndex class implementation *************************/
+/*************************************************************************/
+
+inline void LSQIndex::Link(instance *inst, int bucket)
+{
+  instance **prev = &chains[bucket];
+
+  while (*prev != NULL && (*prev)->tag < inst->tag)
+    prev = &(*prev)->lsq_next;
+
+  inst->lsq_bucket = bucket;
+  inst->lsq_next = *prev;
+  *prev = inst;
+}
+
+
+inline int LSQIndex::Unlink(instance *inst)
+{
+  instance **prev = &chains[inst->lsq_bucket];
+
+  while (*prev != NULL && *prev != inst)
+    prev = &(*prev)->lsq_next;
+
+  inst->lsq_bucket = LSQ_NONE;
+  if (*prev == NULL)
+    return(0);
+
+  *prev = inst->lsq_next;
+  inst->lsq_next = NULL;
+  return(1);
+}
+
+
+/*
+ * Put "inst2" in the place of "inst" on its chain. The replacement is a
+ * copy of the original instance, so it already carries the chain link and
+ * bucket.
+ */
+inline void LSQIndex::Swap(instance *inst, instance *inst2)
+{
+  instance **prev = &chains[inst->lsq_bucket];
+
+  while (*prev != NULL && *prev != inst)
+    prev = &(*prev)->lsq_next;
+
+  if (*prev != NULL)
+    *prev = inst2;
+}
+
+
+/*
+ * Change the address of "inst" and move it to the chain of the new
+ * address. Loads in limbo stay on the limbo chain. Returns 0 if the
+ * operation was not on a chain, including stale copies of queued stores.
+ */
+inline int LSQIndex::Rekey(instance *inst, unsigned addr)
+{
+  int bucket = inst->lsq_bucket;
+
+  inst->finish_addr += addr - inst->addr;
+  inst->addr = addr;
+
+  if (bucket < 0 || !Unlink(inst))
+    {
+      inst->lsq_bucket = bucket;
+      return(0);
+    }
+
+  Link(inst, (bucket == LSQ_LIMBO) ? LSQ_LIMBO : Bucket(inst));
+  return(1);
+}
+
+
+
+/*************************************************************************/
+/***************** StoreQ class implementation ***************************/
+/*************************************************************************/
+
+inline void StoreQ::Forget(instance *inst)
+{
+  if (inst->lsq_bucket != LSQ_NONE)
+    index.Unlink(inst);
+  else
+    unresolved.Remove(inst->tag);
+}
+
+
+inline void StoreQ::Insert(instance *inst)
+{
+  inst->lsq_next   = NULL;
+  inst->lsq_bucket = LSQ_NONE;
+  unresolved.Insert(inst->tag);
+  MemQ<instance *>::Insert(inst);
+}
+
+
+inline int StoreQ::Remove(instance *inst)
+{
+  if (!MemQ<instance *>::Remove(inst))
+    return(0);
+
+  Forget(inst);
+  return(1);
+}
+
+
+inline void StoreQ::RemoveTail()
+{
+  instance *inst;
+
+  if (!GetTail(inst))
+    return;
+
+  Forget(inst);
+  MemQ<instance *>::RemoveTail();
+}
+
+
+inline int StoreQ::Replace(instance *inst, instance *inst2)
+{
+  if (!MemQ<instance *>::Replace(inst, inst2))
+    return(0);
+
+  if (inst->lsq_bucket != LSQ_NONE)
+    index.Swap(inst, inst2);
+
+  return(1);
+}
+
+
+inline void StoreQ::Resolve(instance *inst)
+{
+  if (inst->lsq_bucket != LSQ_NONE)
+    {
+      if (!index.Unlink(inst))           /* stale copy of a queued store */
+	return;
+    }
+  else if (!unresolved.Remove(inst->tag))
+    return;                              /* not in the store queue       */
+
+  index.Link(inst, LSQIndex::Bucket(inst));
+}
+
+
+
+/*************************************************************************/
+/***************** LoadQ class implementation ****************************/
+/*************************************************************************/
+
+inline void LoadQ::Insert(instance *inst)
+{
+  inst->lsq_next   = NULL;
+  inst->lsq_bucket = LSQ_UNKNOWN;
+  MemQ<instance *>::Insert(inst);
+}
+
+
+inline int LoadQ::Remove(instance *inst)
+{
+  if (!MemQ<instance *>::Remove(inst))
+    return(0);
+
+  if (inst->lsq_bucket >= 0)
+    index.Unlink(inst);
+  inst->lsq_bucket = LSQ_NONE;
+  return(1);
+}
+
+
+inline void LoadQ::RemoveTail()
+{
+  instance *inst;
+
+  if (!GetTail(inst))
+    return;
+
+  if (inst->lsq_bucket >= 0)
+    index.Unlink(inst);
+  inst->lsq_bucket = LSQ_NONE;
+  MemQ<instance *>::RemoveTail();
+}
+
+
+inline void LoadQ::Resolve(instance *inst)
+{
+  if (inst->lsq_bucket == LSQ_NONE)
+    return;                              /* not in the load queue        */
+
+  if (inst->lsq_bucket >= 0)
+    index.Unlink(inst);
+
+  index.Link(inst, inst->limbo ? LSQ_LIMBO : LSQIndex::Bucket(inst));
+}
+
+
+inline void LoadQ::Update(instance *inst)
+{
+  if (inst->lsq_bucket < 0 ||
+      (inst->lsq_bucket == LSQ_LIMBO) == (inst->limbo != 0))
+    return;
+
+  index.Unlink(inst);
+  index.Link(inst, inst->limbo ? LSQ_LIMBO : LSQIndex::Bucket(inst));
+}
+
+
+
+/*************************************************************************/
+/* StoreWaitTable: PC-indexed memory dependence predictor. A load that   */
+/*               : was caught bypassing a conflicting store sets its wait*/
+/*               : bit and will from then on wait for all older store    */
+/*               : addresses. Bits are cleared periodically so that      */
+/*               : stale predictions do not serialize loads forever.     */
+/*************************************************************************/
+
+extern int STORE_WAIT_SIZE;              /* entries, 0 disables predictor  */
+extern int STORE_WAIT_CLEAR;             /* cycles between table clears    */
+
+class StoreWaitTable
+{
+private:
+  unsigned char *bits;
+  unsigned       mask;
+  long long      next_clear;
+
+public:
+  StoreWaitTable(): bits(NULL), mask(0), next_clear(0)
+  { }
+
+  inline void Setup()
+  {
+    int size = 1;
+
+    if (STORE_WAIT_SIZE <= 0)
+      return;
+
+    while (size * 2 <= STORE_WAIT_SIZE)
+      size *= 2;
+
+    bits = new unsigned char[size];
+    memset(bits, 0, size);
+    mask = size - 1;
+    next_clear = STORE_WAIT_CLEAR;
+  }
+
+  inline int Wait(unsigned pc, long long cycle)
+  {
+    if (bits == NULL)
+      return(0);
+
+    if (STORE_WAIT_CLEAR > 0 && cycle >= next_clear)
+      {
+	memset(bits, 0, mask + 1);
+	next_clear = cycle + STORE_WAIT_CLEAR;
+      }
+
+    return(bits[(pc >> 2) & mask]);
+  }
+
+  inline int Train(unsigned pc)
+  {
+    if (bits == NULL)
+      return(0);
+
+    bits[(pc >> 2) & mask] = 1;
+    return(1);
+  }
+};
+
+
+#endif
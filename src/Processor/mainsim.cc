@@ -78,7 +78,7 @@ extern "C"
 #include "Caches/cache.h"
 #include "Caches/ubuf.h"
 #include "Bus/bus.h"
-
+#include "sim_main/checkpoint.h"
 }
 
 
@@ -90,7 +90,13 @@ extern "C"
 #include "Processor/simio.h"
 #include "Processor/exec.h"
 #include "Processor/branchpred.h"
+#include "Processor/ftq.h"
+#include "Processor/smt.h"
 #include "Processor/fastnews.h"
+#include "Processor/fastfwd.h"
+#include "Processor/checkpoint.h"
+#include "Processor/simpoint.h"
+#include "Processor/cputhreads.h"
 #include "Processor/procstate.hh"
 #include "Processor/tagcvt.hh"
 #include "Processor/memunit.hh"
@@ -133,6 +139,7 @@ FILE *corefile;
 char *mailto   = NULL;
 char *subject  = NULL;
 const char *configfile = "rsim_params";
+char *cache_trace_file = NULL;   /* trace-driven functional cache mode */
 
 
 int  statfile[MAX_NODES];
@@ -152,6 +159,8 @@ long long stop_instruction  = 0;     // when to record stats. and abort sim.
 
 int  StartStopInit();
 int  WatchDogInit();
+static int RSIM_Idle();
+static void RSIM_EVENT_PARALLEL();
 void GetRusage(int);
 void PrintHelpInformation(char *);
 
@@ -199,7 +208,7 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 	 ((c1 = getopt(argc,
 		       argv,
 		       "D:F:S:X"
-		       "de:hm:nr:s:t:z:")) != -1))
+		       "b:c:de:f:hl:m:np:r:s:t:w:z:")) != -1))
     {
       c = c1;
       switch (c)
@@ -220,10 +229,31 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 	  mailto = optarg;
 	  break;
 
+	case 'b': // write basic-block vectors
+	  bbv_file = optarg;
+	  break;
+
+	case 'c': // functional cache simulation of a reference trace
+	  cache_trace_file = optarg;
+	  break;
+
         case 'd': // debug/dump bus trace and/or waveform
 	  BUS_TRACE_ENABLE = 1;
           break;
 
+	case 'f': // fast-forward functionally
+	  unit = ' ';
+	  sscanf(optarg, "%lld%c", &fastfwd_instruction, &unit);
+	  if ((unit == 'm') || (unit == 'M'))
+	    fastfwd_instruction *= 1000000ll;
+	  if ((unit == 'b') || (unit == 'B'))
+	    fastfwd_instruction *= 1000000000ll;
+	  break;
+
+	case 'l': // restore checkpoint
+	  ckpt_restore_file = optarg;
+	  break;
+
 	case 'm':
 	  mp = atoi(optarg);
 	  if (mp == 0)
@@ -232,6 +262,10 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 	      mp = 1;
 	    }
 	  break;
+
+	case 'p': // sampled simulation of simulation points
+	  simpoint_file = optarg;
+	  break;
 	  
 	case 'n':
 	  errno = 0;
@@ -262,6 +296,10 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 	  DEBUG_TIME = atoi(optarg);
 	  break;
 
+	case 'w': // write checkpoint at end of fast-forwarding
+	  ckpt_write_file = optarg;
+	  break;
+
 	case 'F': // executable to interpret
 	  done = 1;
 	  break;
@@ -296,6 +334,8 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 
   if (i < argc - optind + 1)
     sim_exec = sim_args + i;
+  else if (cache_trace_file)         // no executable needed to run a trace
+    strcpy(execname, cache_trace_file);
   else
     {
       PrintHelpInformation(argv[0]);
@@ -303,21 +343,27 @@ extern "C" void UserMain(int argc, char **argv, char **env)
     }
 
 
-  if ((*sim_exec)[0] == '/')
-    strcpy(execname, *sim_exec);
-  else
+  if (sim_exec)
     {
-      startdir = getcwd(NULL, MAXPATHLEN);
-      sprintf(execname, "%s/%s", startdir, *sim_exec);
-      free(startdir);
-    }
+      if ((*sim_exec)[0] == '/')
+	strcpy(execname, *sim_exec);
+      else
+	{
+	  startdir = getcwd(NULL, MAXPATHLEN);
+	  sprintf(execname, "%s/%s", startdir, *sim_exec);
+	  free(startdir);
+	}
 
-  *sim_exec = execname;
+      *sim_exec = execname;
+    }
 
   if (!subject)
     {
       subject = strrchr(execname, '/');
-      subject++;
+      if (subject)
+	subject++;
+      else
+	subject = execname;
     }
 
 
@@ -463,6 +509,11 @@ extern "C" void UserMain(int argc, char **argv, char **env)
   if (EXCEPT_FLUSHES_PER_CYCLE == -1)
     EXCEPT_FLUSHES_PER_CYCLE = GRADUATES_PER_CYCLE;
 
+  SMTCheckConfig();
+
+  if (FASTFWD_RATE < 1)
+    FASTFWD_RATE = 1;
+
 
   
   //-------------------------------------------------------------------------
@@ -605,6 +656,14 @@ extern "C" void UserMain(int argc, char **argv, char **env)
       YS__statmsg(k, "RSIM:\t Active list:      %3d\n", MAX_ACTIVE_INSTS);
       YS__statmsg(k, "\t Speculations:     %3d\n", MAX_SPEC);
       YS__statmsg(k, "\t Fetch rate:       %3d\n", FETCHES_PER_CYCLE);
+      if (FTQ_SIZE > 0)
+	YS__statmsg(k, "\t FTQ:              %3d blocks, %d per cycle\n",
+		    FTQ_SIZE, FETCH_BLOCKS);
+      if (SMT_THREADS > 1)
+	YS__statmsg(k, "\t SMT contexts:     %3d per core, %d fetching (%s), "
+		    "%d%% cap\n", SMT_THREADS, SMT_FETCH,
+		    SMT_POLICY == SMT_ICOUNT ? "ICOUNT" : "round-robin",
+		    SMT_CAP);
       YS__statmsg(k, "\t Decode rate:      %3d\n", DECODES_PER_CYCLE);
       YS__statmsg(k, "\t Graduation rate:  %3d\n", GRADUATES_PER_CYCLE);
       if (STALL_ON_FULL)
@@ -632,6 +691,16 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 
   SystemInit();
 
+  // trace-driven mode runs only the functional cache model
+  if (cache_trace_file)
+    {
+      Cache_trace_run(cache_trace_file);
+      return;
+    }
+
+  // sampled simulation starts processors in fast-forward mode
+  SimpointInit();
+
   AllProcs = RSIM_CALLOC(ProcState*, ARCH_numnodes * ARCH_cpus);
   if (!AllProcs)
     YS__errmsg(0, "Malloc failed in %s:%i", __FILE__, __LINE__);
@@ -660,6 +729,13 @@ extern "C" void UserMain(int argc, char **argv, char **env)
     }
 
 
+  if (ckpt_restore_file)
+    for (k = ARCH_firstnode; k < ARCH_firstnode + ARCH_mynodes; k++)
+      CheckpointRestore(k);
+
+  CpuThreadsInit();
+
+
   //-------------------------------------------------------------------------
   // start simulation driver
 
@@ -732,6 +808,124 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 
 
 
+/*=========================================================================*/
+/* Cache pipeline stages of one processor; the output stages run before    */
+/* the processor, the input stages after it.                               */
+/*=========================================================================*/
+
+static inline void RSIM_CacheOut(int i)
+{
+  /*
+   * Handle requests in the pipelines of the L1 cache, L1 write buffer,
+   * and L2 cache.
+   */
+  if (L1ICaches[i]->num_in_pipes)
+    L1ICacheOutSim(i);
+
+  if (L1DCaches[i]->num_in_pipes)
+    L1DCacheOutSim(i);
+
+  if (WBuffers[i]->num_in_pipes || WBuffers[i]->inqueue.size)
+    L1DCacheWBufferSim(i);
+
+
+  if (UBuffers[i]->num_entries)
+    UBuffer_out_sim(i);
+
+  if (L2Caches[i]->num_in_pipes)
+    L2CacheOutSim(i);
+}
+
+
+
+static inline void RSIM_CacheIn(int i)
+{
+  /*
+   * Handle requests coming into L1 cache and L2 cache
+   */
+  if (!(L1ICaches[i]->inq_empty))
+    L1ICacheInSim(i);
+
+  if (!(L1DCaches[i]->inq_empty))
+    L1DCacheInSim(i);
+
+  if (!(L2Caches[i]->inq_empty))
+    L2CacheInSim(i);
+}
+
+
+
+static inline void RSIM_IssueMem(ProcState *proc)
+{
+#ifdef STORE_ORDERING
+  if (proc->MemQueue.NumItems() && proc->UnitsFree[uMEM])
+    IssueMem(proc);
+#else
+  if ((proc->LoadQueue.NumItems() ||
+       proc->StoreQueue.NumItems()) &&
+      proc->UnitsFree[uMEM])
+    IssueMem(proc);
+#endif	      
+}
+
+
+
+static inline void RSIM_ProcStats(ProcState *proc)
+{
+#ifndef NOSTAT
+  StatrecUpdate(proc->SpecStats,
+		proc->branchq.NumItems(),
+		1);
+
+  for (int ctrfu = 0; ctrfu < numUTYPES; ctrfu++)
+    StatrecUpdate(proc->FUUsage[ctrfu],
+		  proc->MaxUnits[ctrfu]-proc->UnitsFree[ctrfu],
+		  1);
+
+#ifndef STORE_ORDERING
+  StatrecUpdate(proc->VSB, proc->StoresToMem, 1);
+  StatrecUpdate(proc->LoadQueueSize,
+		proc->LoadQueue.NumItems(), 1);
+#else
+  StatrecUpdate(proc->MemQueueSize,
+		proc->MemQueue.NumItems(), 1);
+#endif
+  StatrecUpdate(proc->FetchQueueStats,
+		proc->fetch_queue->NumItems(), 1);
+  if (proc->ftq)
+    StatrecUpdate(proc->FTQStats, proc->ftq->NumItems(), 1);
+  StatrecUpdate(proc->ActiveListStats,
+		proc->active_list.NumElements(), 1);
+#endif
+}
+
+
+
+/*=========================================================================*/
+/* Schedule the main processor loop for next cycle. If all processors are  */
+/* halted and all caches are idle, nothing can happen before the next      */
+/* event in the event list, so skip ahead to the first cycle at or after   */
+/* that event.                                                             */
+/*=========================================================================*/
+
+static void RSIM_Reschedule()
+{
+  if (RSIM_Idle())
+    {
+      double next = YS__EventListHeadval();
+      double skip = 1.0;
+
+      if (next > YS__Simtime + 1.0)
+	skip = ceil(next - YS__Simtime - 0.000001);
+
+      schedule_event(YS__ActEvnt, YS__Simtime + skip);
+    }
+  else
+    schedule_event(YS__ActEvnt, YS__Simtime + 1.0);
+}
+
+
+
 /*=========================================================================*/
 /*                                                                         */
 /* The main process event; gets called every cycle performs the main       */
@@ -742,39 +936,37 @@ extern "C" void UserMain(int argc, char **argv, char **env)
 
 extern "C" void RSIM_EVENT()
 {
-  int i;
+  int i, k, n;
+
+  if (SMT_THREADS > 1)
+    SMTSelectFetch();
+
+  if (PARALLEL_CPUS)
+    {
+      RSIM_EVENT_PARALLEL();
+      return;
+    }
   
   /*
-   * Loop through each processor and advance simulation by a cycle
+   * Loop through each processor and advance simulation by a cycle.
+   * The contexts of an SMT core run between the output and input stages
+   * of the core's caches, in an order that rotates every cycle.
    */
-  for (i = ARCH_cpus * ARCH_firstnode;
-       i < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
-       i++)
+  for (k = ARCH_cpus * ARCH_firstnode;
+       k < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       k++)
     {
-      /*
-       * Handle requests in the pipelines of the L1 cache, L1 write buffer,
-       * and L2 cache.
-       */
-      if (L1ICaches[i]->num_in_pipes)
-	L1ICacheOutSim(i);
-
-      if (L1DCaches[i]->num_in_pipes)
-	L1DCacheOutSim(i);
-
-      if (WBuffers[i]->num_in_pipes || WBuffers[i]->inqueue.size)
-	L1DCacheWBufferSim(i);
-
+      if (k == SMT_CORE(k))
+	for (n = k; n < k + SMT_THREADS; n++)
+	  RSIM_CacheOut(n);
 
-      if (UBuffers[i]->num_entries)
-	UBuffer_out_sim(i);
-
-      if (L2Caches[i]->num_in_pipes)
-	L2CacheOutSim(i);
+      i = SMT_THREADS > 1 ? SMTContext(k) : k;
 
       //---------------------------------------------------------------------
 
       ProcState *proc = AllProcs[i];
-      if ((proc) && (!proc->halt))
+      if ((proc) && (!proc->halt) &&
+	  !((proc->fastfwd) && (FastFwdCycle(proc))))
 	{
 	  proc->curr_cycle = (long long) YS__Simtime;
 #ifdef COREFILE
@@ -821,64 +1013,193 @@ extern "C" void RSIM_EVENT()
 		{
 		  //	      if (proc->ReadyQueue_count > 0)
 		  IssueQueues(proc);       /* Issue to queues */
-
-#ifdef STORE_ORDERING
-		  if (proc->MemQueue.NumItems() && proc->UnitsFree[uMEM])
-		    IssueMem(proc);
-#else
-		  if ((proc->LoadQueue.NumItems() ||
-		       proc->StoreQueue.NumItems()) &&
-		      proc->UnitsFree[uMEM])
-		    IssueMem(proc);
-#endif	      
+		  RSIM_IssueMem(proc);
 		  proc->DELAY = 1;
 		}
 
-#ifndef NOSTAT
-	      StatrecUpdate(proc->SpecStats,
-			    proc->branchq.NumItems(),
-			    1);
+	      RSIM_ProcStats(proc);
+	    }
+	}
 
-	      for (int ctrfu = 0; ctrfu < numUTYPES; ctrfu++)
-		StatrecUpdate(proc->FUUsage[ctrfu],
-			      proc->MaxUnits[ctrfu]-proc->UnitsFree[ctrfu],
-			      1);
+      if (k == SMT_CORE(k) + SMT_THREADS - 1)
+	for (n = SMT_CORE(k); n <= k; n++)
+	  RSIM_CacheIn(n);
+    }
 
-#ifndef STORE_ORDERING
-	      StatrecUpdate(proc->VSB, proc->StoresToMem, 1);
-	      StatrecUpdate(proc->LoadQueueSize,
-			    proc->LoadQueue.NumItems(), 1);
-#else
-	      StatrecUpdate(proc->MemQueueSize,
-			    proc->MemQueue.NumItems(), 1);
-#endif
-	      StatrecUpdate(proc->FetchQueueStats,
-				 proc->fetch_queue->NumItems(), 1);
-	      StatrecUpdate(proc->ActiveListStats,
-			    proc->active_list.NumElements(), 1);
-#endif
+  RSIM_Reschedule();
+}
+
+
+
+/*=========================================================================*/
+/* Processor-local part of a cycle, run in parallel for all processors:    */
+/* completion, graduation, decode, fetch and issue to the functional      */
+/* units. Stops at an exception, which is handled afterwards.             */
+/*=========================================================================*/
+
+static void RSIM_ProcStage(ProcState *proc)
+{
+  CompleteQueues(proc);
+
+  if (proc->in_exception == NULL && !proc->exit)
+    maindecode(proc);
+
+  if ((proc->deferred_exception == NULL) && (proc->DELAY <= 0))
+    IssueQueues(proc);
+}
+
+
+
+/*=========================================================================*/
+/* Main processor loop with parallel processor stages (parallel_cpus > 0). */
+/* Every cycle consists of three phases:                                   */
+/*  1. serially: cache output stages, fast-forwarding, pending exceptions */
+/*     and memory completion                                               */
+/*  2. in parallel: RSIM_ProcStage                                         */
+/*  3. serially, per processor: exceptions raised in phase 2, the whole    */
+/*     fetch stage, memory issue, cache input stages                       */
+/* Fetch follows IssueQueues instead of preceding it; the two do not share */
+/* state. Every processor therefore sees its own caches exactly as in the */
+/* serial loop. The only reordering is that the cache output stages of    */
+/* processor i+1 run before phase 3 of processor i rather than after it.  */
+/* They can interact only through the bus arbiter, which collects requests */
+/* per cycle regardless of order, and the event list, where events that  */
+/* processor i and the output stages of i+1 schedule for the same time    */
+/* may be processed in the other order. Results are the same for any      */
+/* number of threads.                                                      */
+/*=========================================================================*/
+
+static void RSIM_EVENT_PARALLEL()
+{
+  static ProcState **ready = NULL;
+  ProcState         *proc;
+  instance          *inst;
+  int                i, n, count = 0;
+
+  if (ready == NULL)
+    {
+      ready = RSIM_CALLOC(ProcState*, ARCH_mynodes * ARCH_cpus);
+      if (!ready)
+	YS__errmsg(ARCH_firstnode, "Malloc failed in %s:%i",
+		   __FILE__, __LINE__);
+    }
+
+  for (i = ARCH_cpus * ARCH_firstnode;
+       i < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       i++)
+    {
+      RSIM_CacheOut(i);
+
+      proc = AllProcs[i];
+      if ((proc) && (!proc->halt) &&
+	  !((proc->fastfwd) && (FastFwdCycle(proc))))
+	{
+	  proc->curr_cycle = (long long) YS__Simtime;
+	  proc->DELAY--;
+	  if (proc->DELAY <= 0 && !proc->exit)
+	    {
+	      if (proc->in_exception != NULL)
+		{
+		  proc->ComputeAvail();
+		  PreExceptionHandler(proc->in_exception, proc);
+		}
+
+	      CompleteMemQueue(proc);
+	      ready[count++] = proc;
 	    }
 	}
+    }
 
-      
-       /*
-       * Handle requests coming into L1 cache and L2 cache
-       */
-      if (!(L1ICaches[i]->inq_empty))
-	L1ICacheInSim(i);
+  CpuThreadsRun(ready, count, RSIM_ProcStage);
 
-      if (!(L1DCaches[i]->inq_empty))
-	L1DCacheInSim(i);
+  for (i = ARCH_cpus * ARCH_firstnode, n = 0;
+       i < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       i++)
+    {
+      proc = AllProcs[i];
+      if ((n < count) && (ready[n] == proc))
+	{
+	  n++;
 
-      if (!(L2Caches[i]->inq_empty))
-	L2CacheInSim(i);
+	  if (proc->deferred_exception)
+	    {
+	      inst = proc->deferred_exception;
+	      proc->deferred_exception = NULL;
+	      PreExceptionHandler(inst, proc);
+
+	      if (simulate_ilp)
+		proc->active_list.mark_memops_ready(proc->curr_cycle, proc);
+
+	      maindecode_finish(proc, proc->deferred_sync);
+
+	      if (proc->DELAY <= 0)
+		IssueQueues(proc);
+	    }
+
+	  if (proc->fetch_deferred)
+	    {
+	      proc->fetch_deferred = 0;
+	      fetch_cycle(proc);
+	    }
+
+	  if (proc->exit)
+	    {
+	      aliveprocs--;
+
+	      DoExit();
+
+	      if (aliveprocs == 0)
+		{
+		  EXIT = 1;
+		  return;
+		}
+	    }
+
+	  if (proc->DELAY <= 0)
+	    {
+	      RSIM_IssueMem(proc);
+	      proc->DELAY = 1;
+	    }
+
+	  RSIM_ProcStats(proc);
+	}
+
+      RSIM_CacheIn(i);
     }
 
-  
-  //-------------------------------------------------------------------------
-  // Schedule the main processorloop for next cycle
+  RSIM_Reschedule();
+}
+
+
+
+/*=========================================================================*/
+/* Returns true if none of the local processors or caches has any work to  */
+/* do, i.e. all processors are halted (waiting for an interrupt) and all   */
+/* cache pipelines, input queues and buffers are empty. In that case the   */
+/* processor loop does not change any state until some other event (an     */
+/* interrupt or a bus transaction) occurs.                                 */
+/*=========================================================================*/
 
-  schedule_event(YS__ActEvnt, YS__Simtime + 1.0);
+static int RSIM_Idle()
+{
+  int i;
+
+  for (i = ARCH_cpus * ARCH_firstnode;
+       i < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       i++)
+    {
+      if ((AllProcs[i]) && (!AllProcs[i]->halt))
+	return 0;
+
+      if (L1ICaches[i]->num_in_pipes  || !L1ICaches[i]->inq_empty ||
+	  L1DCaches[i]->num_in_pipes  || !L1DCaches[i]->inq_empty ||
+	  L2Caches[i]->num_in_pipes   || !L2Caches[i]->inq_empty  ||
+	  WBuffers[i]->num_in_pipes   || WBuffers[i]->inqueue.size ||
+	  UBuffers[i]->num_entries)
+	return 0;
+    }
+
+  return 1;
 }
 
 
@@ -953,7 +1274,10 @@ int WatchDogInit()
 /***********************************************************************/
 /* Handle start/stop event: scheduled at the earliest time graduation  */
 /* count may reach desired start or stop count. Find maximum           */
-/* graduation count among all processors. If start/reset count is      */
+/* graduation count among all processors. If fast-forward count is     */
+/* given, check if reached and then switch all processors to detailed  */
+/* simulation and reset statistics; start and stop counts are relative */
+/* to the end of fast-forwarding. If start/reset count is              */
 /* given, check if reached and then reset all statistics, otherwise    */
 /* reschedule for next earliest time. If stop count is given, check    */
 /* if reached, then dump statistics and interrupt all processors,      */
@@ -978,8 +1302,49 @@ extern "C" void StartStopHandle()
       max_inst = AllProcs[n]->graduates;
 
 
+  // still fast-forwarding
+  if (fastfwd_instruction != 0)
+    {
+      // fast-forward instruction reached: switch to detailed simulation
+      if (max_inst >= fastfwd_instruction)
+	{
+	  // write checkpoint once quiescent instead of simulating in detail
+	  if (ckpt_write_file)
+	    {
+	      CheckpointStart();
+	      return;
+	    }
+
+	  for (n = ARCH_firstnode;
+	       n < ARCH_firstnode + ARCH_mynodes;
+	       n++)
+	    YS__logmsg(n,
+		       "Fast-forward instruction %lld reached - start detailed simulation\n",
+		       fastfwd_instruction);
+
+	  for (n = ARCH_firstnode;
+	       n < ARCH_firstnode + ARCH_mynodes;
+	       n++)
+	    {
+	      FastFwdStop(n);
+	      StatClear(n);
+	    }
+
+          max_inst = 0;
+	}
+      // fast-forward instruction not reached: reschedule
+      else
+	{
+          del = (fastfwd_instruction - max_inst) / FASTFWD_RATE;
+          if (del <= 0)
+            del = 1;
+	  schedule_event(ev, YS__Simtime + del);
+	}
+    }
+
+
   // still waiting to reset statistics
-  if (reset_instruction != 0)
+  if ((fastfwd_instruction == 0) && (reset_instruction != 0))
     {
       // reset instruction reached: reset statistics
       if (max_inst >= reset_instruction)
@@ -1015,7 +1380,8 @@ extern "C" void StartStopHandle()
 
   
   // waiting to reach stop instruction
-  if ((reset_instruction == 0) && (stop_instruction != 0))
+  if ((fastfwd_instruction == 0) && (reset_instruction == 0) &&
+      (stop_instruction != 0))
     {
       if (max_inst >= stop_instruction)
 	{
@@ -1055,8 +1421,8 @@ extern "C" void StartStopHandle()
 
 
 /***********************************************************************/
-/* Initialize 'start/stop' feature. If start and/or stop instruction   */
-/* is specified, create event and schedule accordingly.                */
+/* Initialize 'start/stop' feature. If fast-forward, start and/or stop */
+/* instruction is specified, create event and schedule accordingly.    */
 /* Schedule time is estimated by assuming maximum graduation rate per  */
 /* cycle and remaining instructions to go. When scheduled, handler     */
 /* checks actual graduation count and reschedules if needed.           */
@@ -1066,8 +1432,16 @@ int StartStopInit()
 {
   EVENT *ev;
   
-  // skip if neither start nor stop is specified
-  if ((reset_instruction == 0) && (stop_instruction == 0))
+  // a checkpoint is written at the end of fast-forwarding
+  if ((ckpt_write_file) && (fastfwd_instruction == 0))
+    {
+      fprintf(stderr, "Writing a checkpoint (-w) requires a fast-forward count (-f)\n");
+      exit(1);
+    }
+
+  // skip if neither fast-forward, start nor stop is specified
+  if ((fastfwd_instruction == 0) &&
+      (reset_instruction == 0) && (stop_instruction == 0))
     return(0);
 
   // check that stop is past start, unless stop is not specified
@@ -1085,7 +1459,11 @@ int StartStopInit()
 		StartStopHandle, NODELETE, 0);
 
   EventSetArg(ev, ev, sizeof(ev));
-  if (reset_instruction > 0)
+  if (fastfwd_instruction > 0)
+    {
+      schedule_event(ev, fastfwd_instruction / FASTFWD_RATE);
+    }
+  else if (reset_instruction > 0)
     {
       schedule_event(ev, reset_instruction / GRADUATES_PER_CYCLE);
     }
@@ -1172,14 +1550,21 @@ void PrintHelpInformation(char *progname)
 	   progname);
 
   puts("simulator options are:");
+  puts("\t-b file    - write basic-block vectors of fast-forwarded intervals to file");
+  puts("\t-c file    - functional cache simulation of the reference trace in file");
+  puts("\t             (no application is run)");
   puts("\t-d         - turn on bus trace");
   puts("\t-e eaddr   - Send an email notification to the specified");
   puts("\t             address upon completion of this simulation");
+  puts("\t-f icount  - fast-forward functionally until icount instructions are executed");
+  puts("\t-l file    - restore checkpoint from file before starting simulation");
   puts("\t-m cpus    - parallel simulation on up to M processors");
   puts("\t-n         - lower simulator priority (nice)");
+  puts("\t-p prefix  - simulate the simulation points in prefix.simpoints/prefix.weights");
   puts("\t-r icount  - reset statistics when icount instructions are graduated");
   puts("\t-s icount  - write statistics and abort simulation when icount instructions are graduated");
   puts("\t-t time    - print debugging output after time T");
+  puts("\t-w file    - write checkpoint to file at end of fast-forwarding and exit");
   puts("\t-z file    - Configuration file (default: rsim_params)");
   puts("\t-D dir     - Directory for output file");
   puts("\t-S subj    - Subject to use in output filenames");
@@ -65,6 +65,7 @@ extern "C"
 #include "Processor/procstate.h"
 #include "Processor/mainsim.h"
 #include "Processor/branchpred.h"
+#include "Processor/ftq.h"
 #include "Processor/simio.h"
 #include "Processor/fastnews.h"
 #include "Processor/tagcvt.hh"
@@ -95,7 +96,7 @@ int IssuePrefetch(ProcState *proc, unsigned addr, int level, int excl,
 #endif
 
 
-  DCache_recv_addr(proc->proc_id, NULL, inst_tag, addr,
+  DCache_recv_addr(proc->proc_id, NULL, inst_tag, 0, addr,
 		   excl ? WRITE : READ, 4, 0, level);
 
   return 0;
@@ -288,6 +289,62 @@ extern "C" void PerformData(REQ * req)
 
 
 
+/*****************************************************************************/
+/* PerformFetchBlock: I-cache reply for a fetch target queue block. Only the */
+/* oldest block may deliver; a younger block that completes first (its line  */
+/* hit while an older one missed) is simply fetched again. Replies for       */
+/* flushed blocks find no match and are dropped.                             */
+/*****************************************************************************/
+
+static void PerformFetchBlock(ProcState *proc, REQ *req)
+{
+  int         count, max_count;
+  unsigned    pc;
+  fetch_queue_entry fqe;
+  instr      *instruction;
+  FetchBlock *blk;
+
+  blk = proc->ftq->Find(req->vaddr, FTQ_ISSUED);
+  if (blk == NULL)
+    return;
+
+  if ((blk != proc->ftq->Block(0)) ||
+      (proc->pstate != req->d.proc_instruction.pstate))
+    {
+      blk->state = FTQ_PREDICTED;
+      return;
+    }
+
+  instruction = (instr*)req->d.proc_instruction.instructions;
+  max_count = min(blk->count,
+		  proc->fetch_queue_size - proc->fetch_queue->NumItems());
+
+  count = 0;
+  pc    = req->vaddr;
+  while (count < max_count)
+    {
+      fqe.inst           = NewInstance(instruction, proc);
+      fqe.exception_code = OK;
+      fqe.pc             = pc;
+      proc->fetch_queue->Enqueue(fqe);
+
+      count ++;
+      instruction ++;
+      pc += SIZE_OF_SPARC_INSTRUCTION;
+    }
+
+  if (count == blk->count)
+    proc->ftq->Pop();
+  else
+    {
+      blk->pc     = pc;                // fetch the rest once there is room
+      blk->count -= count;
+      blk->state  = FTQ_PREDICTED;
+    }
+}
+
+
+
 /*****************************************************************************/
 /*****************************************************************************/
 
@@ -301,6 +358,12 @@ extern "C" void PerformIFetch(REQ * req)
   instr     *instruction;
 
 
+  if (proc->ftq)
+    {
+      PerformFetchBlock(proc, req);
+      return;
+    }
+
   if (proc->pstate != req->d.proc_instruction.pstate)
     {
       proc->fetch_done = 1;
@@ -461,9 +524,19 @@ extern "C" void AckWriteToWBUF(instance *inst, int proc_id)
 
 /*****************************************************************************/
 
-extern "C" void ReplaceAddr(instance *inst, unsigned addr)
+extern "C" void ReplaceAddr(int proc_id, instance *inst, unsigned addr)
 {
+#ifndef STORE_ORDERING
+  ProcState *proc = AllProcs[proc_id];
+
+  if (IsStore(inst))
+    proc->StoreQueue.Rekey(inst, addr);
+  else
+    proc->LoadQueue.Rekey(inst, addr);
+#else
+  inst->finish_addr += addr - inst->addr;
   inst->addr = addr;
+#endif
 }
 
 
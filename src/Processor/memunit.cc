@@ -92,6 +92,9 @@ static void IssueOpMessage (ProcState *proc, instance *memop);
 
 int INSTANT_ADDRESS_GENERATE = 0;
 
+int STORE_WAIT_SIZE  = 0;      /* store-wait predictor entries, 0 = off   */
+int STORE_WAIT_CLEAR = 16384;  /* cycles between clearing of wait bits    */
+
 
 /*
  * Overlap: returns 1 if there is overlap between addresse
@@ -161,7 +164,7 @@ int IssueMem(ProcState * proc)
 
 	  if (memop->mem_ready && ctr == 1)
 	    {
-	      if (L1Q_FULL[proc->proc_id]) 
+	      if (L1Q_FULL[proc->core_id]) 
 		break;
 	      else
 		{
@@ -181,7 +184,7 @@ int IssueMem(ProcState * proc)
 	  if (memop->code.instruction == iPREFETCH)
 	    {
 	      /* software prefetch */
-	      if (L1Q_FULL[proc->proc_id])
+	      if (L1Q_FULL[proc->core_id])
 		break;
 	      else
 		{
@@ -198,7 +201,7 @@ int IssueMem(ProcState * proc)
 	    {
 	      if (ctr == 1)
 		{
-		  if (L1Q_FULL[proc->proc_id])
+		  if (L1Q_FULL[proc->core_id])
 		    break;
 		  else
 		    {
@@ -282,7 +285,7 @@ int IssueMem(ProcState * proc)
  
 	      if (canissue && memop->memprogress > -3)
 		{
-		  if (L1Q_FULL[proc->proc_id])
+		  if (L1Q_FULL[proc->core_id])
 		    {
 		      memop->memprogress = 0;
 		      canissue = 0;
@@ -752,27 +755,71 @@ int CompleteMemOp(instance * inst, ProcState * proc)
             {
               proc->limbos++;
               inst->limbo++;  // Set the limbo bit on to remember to check for this
+#ifndef STORE_ORDERING
+              proc->LoadQueue.Update(inst);
+#endif
             }
 
           // if so, this is all taken care of before Issue
           if (spec_stores != SPEC_STALL)
             {
-              MemQLink<instance *> *stindex = NULL;
-
 #ifndef STORE_ORDERING
-              while ((stindex = proc->StoreQueue.GetNext(stindex)) != NULL)
+              // only stores on the chains of the lines this load touches
+              // can conflict; stores older than the one we got a forward
+              // from (if any) can be ignored
+              LSQCursor older;
+              long long fwdtag = -inst->memprogress - 3;
+              long long conftag = inst->tag;
+
+              proc->StoreQueue.Older(inst, older);
+              while ((sts = older.Next()) != NULL)
+                {
+                  if (sts->tag <= fwdtag)
+                    continue;
+
+                  if (overlap(sts, inst) &&
+		      (inst->issuetime < sts->issuetime))
+                    {
+                      proc->redos++;
+                      redo = 1;
+                      conftag = sts->tag;
+                      break;
+                    }
+                }
+
+              if (spec_stores == SPEC_EXCEPT)
+                {
+                  // gamble on every ambiguous store up to the conflict
+                  int ambig = proc->StoreQueue.CountUnresolved(fwdtag, conftag);
+
+                  if (ambig)
+                    {
+		      if (inst->limbo == 0)
+			proc->limbos++;
+		      inst->limbo += ambig;
+		      proc->LoadQueue.Update(inst);
+
+#ifdef COREFILE
+                      if (proc->curr_cycle > DEBUG_TIME)
+                        fprintf(corefile,
+                                "P%d,%lld Gambling to avoid %d limbos\n",
+                                proc->proc_id,
+                                inst->tag,
+                                ambig);
+#endif
+                    }
+                }
 #else
+              MemQLink<instance *> *stindex = NULL;
+
 	      while ((stindex = proc->MemQueue.GetNext(stindex)) != NULL)
-#endif
                 {
                   sts = stindex->d;
                   if (sts->tag > inst->tag)
                     break;
 
-#ifdef STORE_ORDERING
                   if (!IsStore(sts))
                     continue;
-#endif
 
                   // if we got a forward, then we can ignore the other cases here
                   if (inst->memprogress <= -sts->tag-3)
@@ -804,6 +851,7 @@ int CompleteMemOp(instance * inst, ProcState * proc)
                       break;
                     }
 		}
+#endif
 	    }
           
 	  if (redo)
@@ -812,6 +860,9 @@ int CompleteMemOp(instance * inst, ProcState * proc)
 	      inst->vsbfwd = 0;
 	      inst->issuetime = LLONG_MAX;
 	      inst->limbo--;
+#ifndef STORE_ORDERING
+	      proc->LoadQueue.Update(inst);
+#endif
 	      return 0;
 	    }
  
@@ -1177,6 +1228,22 @@ void FlushMems(long long tag, ProcState * proc)
 
 
 
+/*************************************************************************/
+/* TrainStoreWait : A load was found to have bypassed a conflicting      */
+/*                : store; make it wait for older store addresses next   */
+/*                : time                                                 */
+/*************************************************************************/
+
+static inline void TrainStoreWait(instance *ld, ProcState *proc)
+{
+#ifndef STORE_ORDERING
+  if (proc->StoreWait.Train(ld->pc))
+    proc->stwait_trains++;
+#endif
+}
+
+
+
 /*************************************************************************/
 /* Disambiguate : Called when the address is newly generated for an      */
 /*              : instruction. Checks if newly disambiguated stores      */
@@ -1189,31 +1256,40 @@ void Disambiguate(instance * inst, ProcState * proc)
   inst->time_addr_ready = YS__Simtime;
 
   if (!IsStore(inst))
-    return;
+    {
+#ifndef STORE_ORDERING
+      proc->LoadQueue.Resolve(inst);
+#endif
+      return;
+    }
 
   if (!simulate_ilp)
     inst->mem_ready = 1;
 
   instance *conf;
-  MemQLink<instance *> *ldindex = NULL;      
   long long lowambig = LLONG_MAX;
 
 
   proc->ambig_st_tags.Remove(inst->tag);
   proc->ambig_st_tags.GetMin(lowambig);
 
-  proc->LoadQueue.GetMin(conf);
-  
-
 #ifndef STORE_ORDERING
-  while ((ldindex = proc->LoadQueue.GetNext(ldindex)) != NULL)
+  // only younger loads on the chains of the lines this store touches and
+  // loads in limbo can be affected
+  LSQCursor younger;
+
+  proc->StoreQueue.Resolve(inst);
+  proc->LoadQueue.Younger(inst, younger);
+
+  while ((conf = younger.Next()) != NULL)
 #else
+  MemQLink<instance *> *ldindex = NULL;      
+
   while ((ldindex = proc->MemQueue.GetNext(ldindex)) != NULL)
 #endif
     {
-      conf = ldindex->d;
-
 #ifdef STORE_ORDERING
+      conf = ldindex->d;
       if (IsStore(conf))
 	continue;
 #endif
@@ -1225,6 +1301,10 @@ void Disambiguate(instance * inst, ProcState * proc)
 	      if (overlap(conf, inst))
 		{
 		  conf->limbo--;
+		  TrainStoreWait(conf, proc);
+#ifndef STORE_ORDERING
+		  proc->LoadQueue.Update(conf);
+#endif
 
 		  if (spec_stores == SPEC_EXCEPT)
 		    {
@@ -1246,12 +1326,11 @@ void Disambiguate(instance * inst, ProcState * proc)
 		      // mark this as being "done" so that way it
 		      // actually graduates
  
-		      MemQLink<instance *> *confindex = ldindex;
-
 #ifndef STORE_ORDERING
-		      ldindex = proc->LoadQueue.GetPrev(ldindex);
-		      proc->LoadQueue.Remove(confindex);
+		      proc->LoadQueue.Remove(conf);
 #else
+		      MemQLink<instance *> *confindex = ldindex;
+
 		      ldindex = proc->MemQueue.GetPrev(ldindex);
 		      proc->MemQueue.Remove(confindex);
 #endif
@@ -1284,13 +1363,14 @@ void Disambiguate(instance * inst, ProcState * proc)
 		{
 		  proc->unlimbos++;
 		  conf->limbo--;
+#ifndef STORE_ORDERING
+		  proc->LoadQueue.Update(conf);
+#endif
 		  
 		  conf->memprogress = 1;
 		  if (!conf->limbo)
 		    {
-#ifndef STORE_ORDERING
-		      ldindex = proc->LoadQueue.GetPrev(ldindex);
-#else
+#ifdef STORE_ORDERING
 		      ldindex = proc->MemQueue.GetPrev(ldindex);
 #endif
 		      proc->DoneHeap.insert(proc->curr_cycle, conf, conf->tag);
@@ -1308,7 +1388,6 @@ void Disambiguate(instance * inst, ProcState * proc)
 		      conf->memprogress = 1;
 		      conf->in_memunit = 0;
 #ifndef STORE_ORDERING
-		      ldindex = proc->LoadQueue.GetPrev(ldindex);
 		      proc->LoadQueue.Remove(conf);
 #else
 		      ldindex = proc->MemQueue.GetPrev(ldindex);
@@ -1323,6 +1402,7 @@ void Disambiguate(instance * inst, ProcState * proc)
 		   overlap(conf, inst))
 	    {
 	      proc->kills++;
+	      TrainStoreWait(conf, proc);
 	      if (spec_stores == SPEC_EXCEPT)
 		{
 		  if (conf->exception_code == OK ||
@@ -1360,7 +1440,7 @@ void Disambiguate(instance * inst, ProcState * proc)
  
 int IssueBarrier(ProcState *proc)
 {
-  if (!L1DQ_FULL[proc->proc_id])
+  if (!L1DQ_FULL[proc->core_id])
     {
       DCache_recv_barrier(proc->proc_id);
       return 1;
@@ -1401,7 +1481,7 @@ int IssueMem(ProcState * proc)
       if ((!(mb.LL || mb.LS) || proc->minload > mb.tag) &&
           (!(mb.SL || mb.SS) || proc->minstore > mb.tag) &&
           (!mb.MEMISSUE || (proc->minstore>mb.tag && proc->minload>mb.tag)) &&
-	  (!mb.MEMISSUE || UBuffers[proc->proc_id]->num_entries == 0) &&
+	  (!mb.MEMISSUE || UBuffers[proc->core_id]->num_entries == 0) &&
 	  !mb.SYNC)
 	{
 #ifdef COREFILE
@@ -1534,11 +1614,11 @@ void IssueStores(ProcState * proc)
   /* first do loads, then stores */
   instance *memop;
   int confstore = 0;
-  MemQLink<instance *> *stindex = NULL, *stindex2 = NULL;
+  MemQLink<instance *> *stindex = NULL;
 
   /* NOTE: DON'T ISSUE ANY STORES SPECULATIVELY */
 
-  while ((proc->UnitsFree[uMEM]) &&
+  while ((proc->UnitsFree[uMEM]) && !SMTUnitsBusy(proc, uMEM) &&
 	 ((stindex = proc->StoreQueue.GetNext(stindex)) != NULL))
     {
       memop = stindex->d;
@@ -1577,14 +1657,11 @@ void IssueStores(ProcState * proc)
 
       int canissue = 1;
       instance *conf;
+      LSQCursor older;
 
-      stindex2 = NULL;
-      while ((stindex2 = proc->StoreQueue.GetNext(stindex2)) != NULL)
+      proc->StoreQueue.Older(memop, older);
+      while ((conf = older.Next()) != NULL)
 	{
-	  conf = stindex2->d;
-	  if (conf->tag >= memop->tag)
-	    break;
-
 	  // block this one if there is a previous unissued one with
 	  // overlapping address....
 
@@ -1617,7 +1694,7 @@ void IssueStores(ProcState * proc)
       // So, now we need to check for hardware constraints
  
       // check for structural hazards on input ports of cache
-      if (L1DQ_FULL[proc->proc_id])
+      if (L1DQ_FULL[proc->core_id])
         {
           canissue = 0;
           memop->memprogress = 0;
@@ -1647,9 +1724,9 @@ void IssueStores(ProcState * proc)
 void IssueLoads(ProcState * proc)
 {
   instance *memop;
-  MemQLink<instance *> *stindex = NULL, *ldindex = NULL;
+  MemQLink<instance *> *ldindex = NULL;
 
-  while ((proc->UnitsFree[uMEM]) &&
+  while ((proc->UnitsFree[uMEM]) && !SMTUnitsBusy(proc, uMEM) &&
 	 ((ldindex = proc->LoadQueue.GetNext(ldindex)) != NULL))
     {
       memop = ldindex->d;
@@ -1702,14 +1779,15 @@ void IssueLoads(ProcState * proc)
 	  unsigned instaddr = memop->addr;
 	  instance *conf;
 	  unsigned confaddr;
-	  stindex = NULL;
+	  long long lowstore;
+	  LSQCursor older;
 
 
 	  //-----------------------------------------------------------------
 	  // prefetches
 	  if (memop->code.instruction == iPREFETCH)
 	    {
-	      if (L1DQ_FULL[proc->proc_id])      /* ports are taken */
+	      if (L1DQ_FULL[proc->core_id])      /* ports are taken */
 		break;
                 // no further accesses will be allowed till ports free up 
 	      else
@@ -1723,28 +1801,36 @@ void IssueLoads(ProcState * proc)
 	    }
 
 	  //-----------------------------------------------------------------
-	  // check for earlier (non-issued) stores
-	  while ((stindex = proc->StoreQueue.GetNext(stindex)) != NULL)
+	  // check for earlier stores with unknown address
+	  if (proc->StoreQueue.MinUnresolved(lowstore) &&
+	      lowstore < memop->tag)
 	    {
-	      conf = stindex->d;
-
-	      if (conf->tag > memop->tag)
-		break;
+	      specing = 1;
 
-	      if (!conf->addr_ready)
+	      if (spec_stores == SPEC_STALL)
 		{
-		  specing = 1;
+		  // now's the time to give up, if so
+		  memop->memprogress = 0;
+		  memop->vsbfwd = 0;
+		  return;
+		}
 
-		  if (spec_stores == SPEC_STALL)
-		    {
-                      // now's the time to give up, if so
-		      memop->memprogress = 0;
-		      memop->vsbfwd = 0;
-		      return;
-		    }
+	      if (proc->StoreWait.Wait(memop->pc, proc->curr_cycle))
+		{
+		  // predicted to conflict with one of them, so wait for
+		  // the store addresses instead of speculating
+		  memop->memprogress = 0;
+		  memop->vsbfwd = 0;
+		  proc->stwaits++;
 		  continue;
 		}
+	    }
 
+	  //-----------------------------------------------------------------
+	  // check for earlier (non-issued) stores
+	  proc->StoreQueue.Older(memop, older);
+	  while ((conf = older.Next()) != NULL)
+	    {
 	      confaddr = conf->addr;
 	      if (overlap(conf, memop))
 		{
@@ -1905,7 +1991,7 @@ void IssueLoads(ProcState * proc)
 		}
 	      
               // Check if L1 ports are busy before issuing
-              if (L1DQ_FULL[proc->proc_id])
+              if (L1DQ_FULL[proc->core_id])
                 {
                   canissue = 0;
                   memop->vsbfwd = 0;
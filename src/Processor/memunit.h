@@ -126,7 +126,8 @@ extern "C"
   void      UpdateFlushCond       (struct _req_ *req, int val);
   void      CompleteFlushCond     (struct _req_ *req, int val);
   
-  void      ReplaceAddr           (struct instance *inst, unsigned addr);
+  void      ReplaceAddr           (int proc_id, struct instance *inst,
+				   unsigned addr);
   void      ExternalInterrupt     (int, int);
   void      ProcessorHalt         (int, int);
   
@@ -62,6 +62,8 @@ extern "C"
 #include "Caches/ubuf.h"
 }
 
+#include "Processor/smt.h"
+
 
 inline int IsLoad(instance *inst)
 {
@@ -94,7 +96,7 @@ inline int StartUpMemRef(ProcState *proc, instance *inst)
 {
   inst->global_perform = 0;    // clear this bit!!
 
-  DCache_recv_addr(proc->proc_id, inst, inst->tag, inst->addr,
+  DCache_recv_addr(proc->proc_id, inst, inst->tag, inst->pc, inst->addr,
 		   mem_acctype[inst->code.instruction],
 		   mem_length[inst->code.instruction],
 		   inst->addr_attributes,
@@ -274,7 +276,7 @@ inline void GenerateAddress(instance * inst, ProcState * proc)
     Disambiguate(inst, proc);
   else
     {
-      if (proc->UnitsFree[uADDR] == 0)
+      if ((proc->UnitsFree[uADDR] == 0) || SMTUnitsBusy(proc, uADDR))
 	{
 	  inst->stallqs++;
 	  proc->UnitQ[uADDR].AddElt(inst, proc);
@@ -292,7 +294,7 @@ inline void StartPrefetch(ProcState * proc)
      as being an indication of whether prefetching is on or not. */
 
   for (int pref = 0; pref < proc->prefs && proc->UnitsFree[uMEM] &&
-	 !L1DQ_FULL[proc->proc_id]; pref++)
+	 !SMTUnitsBusy(proc, uMEM) && !L1DQ_FULL[proc->core_id]; pref++)
     {
       instance *prefop = proc->prefrdy[pref];
       int macc  = mem_acctype[prefop->code.instruction];
@@ -60,8 +60,12 @@
 #include <errno.h>
 #include <signal.h>
 #include <sys/wait.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
+#include <sys/mman.h>
+
+#ifdef linux
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
 
 #ifndef linux
 #include <sys/siginfo.h>
@@ -79,12 +83,17 @@ extern "C"
 #include "Processor/simio.h"
 #include "Processor/multiprocessor.h"
 
+int              MP_LOOKAHEAD    = 0;      // cycles between barriers
+int              MP_LATENCY      = 0;      // min. inter-node message latency
+
 int              total_processes = 1;
 int              my_process_id   = 0;
 
-int              barrier_id      = -1;
+size_t           barrier_size    = 0;
 lrsim_barrier_t *barrier_ptr     = NULL;
 EVENT           *barrier_event;
+int              barrier_leaf;             // tree node of this process
+int              barrier_cpus;             // live processors of this process
 
 int              procgrp = -1;
 
@@ -127,6 +136,37 @@ extern "C" void sigchldhandler(int sig, siginfo_t *si)
 
 
 
+/***************************************************************************/
+/* MPLookahead: a process may run ahead of the others by at most the       */
+/* lookahead, so a message from another node must never arrive earlier    */
+/* than that. The lookahead defaults to the minimum inter-node message    */
+/* latency, larger values are rejected. Nodes that do not communicate     */
+/* (mp_latency 0) are only kept within MP_MAX_SKEW cycles of each other.  */
+/***************************************************************************/
+
+static void MPLookahead()
+{
+  if ((MP_LOOKAHEAD < 0) || (MP_LATENCY < 0))
+    {
+      fprintf(stderr, "Illegal mp_lookahead %i or mp_latency %i\n",
+	      MP_LOOKAHEAD, MP_LATENCY);
+      exit(1);
+    }
+
+  if (MP_LOOKAHEAD == 0)
+    MP_LOOKAHEAD = MP_LATENCY > 0 ? MP_LATENCY : MP_MAX_SKEW;
+
+  if ((MP_LATENCY > 0) && (MP_LOOKAHEAD > MP_LATENCY))
+    {
+      fprintf(stderr,
+	      "mp_lookahead %i exceeds the minimum inter-node latency %i\n",
+	      MP_LOOKAHEAD, MP_LATENCY);
+      exit(1);
+    }
+}
+
+
+
 void DoMP(int mp)
 {
   int               rc;
@@ -161,36 +201,57 @@ void DoMP(int mp)
 
 
   /*-------------------------------------------------------------------------*/
-  /* create shared memory region for barrier if needed                       */
+  /* create shared memory region for barrier if needed; the tree has no     */
+  /* more nodes than processes                                              */
 
   if (total_processes > 1)
     {
-      barrier_id = shmget(IPC_PRIVATE,
-			  sizeof(lrsim_barrier_t) +
-			  sizeof(unsigned) * ARCH_numnodes,
-                          IPC_CREAT | SHM_R | SHM_W);
-      if (barrier_id < 0)
-        fprintf(stderr,
-		"Error: ShmGet failed at %s:%i: %s\n",
-		__FILE__, __LINE__, YS__strerror(errno)), exit(1);
+      int n, level, width, first, next;
 
-      barrier_ptr = (lrsim_barrier_t*)shmat(barrier_id, NULL, 00400 | 00200);
-      if (barrier_ptr < (lrsim_barrier_t*)NULL)
+      MPLookahead();
+
+      barrier_size = sizeof(lrsim_barrier_t) +
+	sizeof(lrsim_barrier_node_t) * total_processes;
+      barrier_ptr = (lrsim_barrier_t*)mmap(NULL, barrier_size,
+					   PROT_READ | PROT_WRITE,
+					   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+      if (barrier_ptr == (lrsim_barrier_t*)MAP_FAILED)
         fprintf(stderr,
-		"Error: ShmAt failed at %s:%i: %s\n",
+		"Error: Mmap failed at %s:%i: %s\n",
 		__FILE__, __LINE__, YS__strerror(errno)), exit(1);
 
-      barrier_ptr->lock      = 0;
-      barrier_ptr->count     = 0;
-      barrier_ptr->bcast     = 0;
-      barrier_ptr->num_procs = ARCH_cpus;
+      barrier_ptr->bcast      = 0;
+      barrier_ptr->num_procs  = total_processes;
       barrier_ptr->procs_lock = 0;
 
-      for (int n = 0; n < ARCH_numnodes; n++)
-	barrier_ptr->wakeup[n] = 0;
+      // build the tree level by level, starting at the leaves
+      first = 0;
+      width = total_processes;
+      do
+	{
+	  next = first + (width + MP_BARRIER_FANOUT - 1) / MP_BARRIER_FANOUT;
+	  for (n = first; n < next; n++)
+	    {
+	      barrier_ptr->node[n].lock     = 0;
+	      barrier_ptr->node[n].count    = 0;
+	      barrier_ptr->node[n].parent   = -1;
+	      barrier_ptr->node[n].expected = MP_BARRIER_FANOUT;
+	    }
+	  barrier_ptr->node[next - 1].expected =
+	    width - (next - first - 1) * MP_BARRIER_FANOUT;
+
+	  if (first > 0)
+	    for (level = 0; level < width; level++)
+	      barrier_ptr->node[first - width + level].parent =
+		first + level / MP_BARRIER_FANOUT;
+
+	  width = next - first;
+	  first = next;
+	}
+      while (width > 1);
 
       barrier_event = NewEvent("RSIM Barrier", DoBarrier, NODELETE, 0);
-      schedule_event(barrier_event, YS__Simtime + BARRIER_INTERVAL);
+      schedule_event(barrier_event, YS__Simtime + MP_LOOKAHEAD);
     }
 
   
@@ -217,6 +278,9 @@ void DoMP(int mp)
   if (my_process_id == 0)
     ARCH_mynodes = ARCH_numnodes - (total_processes - 1) * ARCH_mynodes;
 
+  barrier_leaf = my_process_id / MP_BARRIER_FANOUT;
+  barrier_cpus = ARCH_mynodes * ARCH_cpus;
+
   if (total_processes > 1)
     {
       atexit(CleanupMP);
@@ -230,14 +294,96 @@ void DoMP(int mp)
 
 
 
+/***************************************************************************/
+/* BarrierArrive: count an arrival at a tree node. The last arrival at a  */
+/* node continues to its parent; at the root it starts the next episode   */
+/* and wakes up all waiting processes.                                     */
+/***************************************************************************/
+
+static void BarrierArrive(int t)
+{
+  lrsim_barrier_node_t *node = &barrier_ptr->node[t];
+
+  get_lock(&node->lock);
+
+  if (++node->count < node->expected)
+    {
+      clr_lock(&node->lock);
+      return;
+    }
+
+  node->count = 0;
+
+  if (node->parent >= 0)
+    {
+      clr_lock(&node->lock);
+      BarrierArrive(node->parent);
+      return;
+    }
+
+  barrier_ptr->bcast++;
+  clr_lock(&node->lock);
+
+#ifdef linux
+  syscall(SYS_futex, &barrier_ptr->bcast, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+
+
+/***************************************************************************/
+/* BarrierLeave: remove a process or an empty subtree from a tree node.   */
+/* If all remaining members have already arrived, the episode completes   */
+/* on their behalf.                                                        */
+/***************************************************************************/
+
+static void BarrierLeave(int t)
+{
+  lrsim_barrier_node_t *node = &barrier_ptr->node[t];
+
+  get_lock(&node->lock);
+
+  node->expected--;
+
+  if (node->expected == 0)
+    {
+      clr_lock(&node->lock);
+      if (node->parent >= 0)
+	BarrierLeave(node->parent);
+      return;
+    }
+
+  if (node->count < node->expected)
+    {
+      clr_lock(&node->lock);
+      return;
+    }
+
+  node->count--;                      // BarrierArrive counts it again
+  clr_lock(&node->lock);
+  BarrierArrive(t);
+}
+
+
+
+/***************************************************************************/
+/* DoExit: called for every processor that exits. When the last processor */
+/* of this process is done, it no longer participates in the barrier.     */
+/***************************************************************************/
+
 void DoExit()
 {
   if (total_processes == 1)
     return;
-  
+
+  if (--barrier_cpus != 0)
+    return;
+
   get_lock(&barrier_ptr->procs_lock);
   barrier_ptr->num_procs--;
   clr_lock(&barrier_ptr->procs_lock);
+
+  BarrierLeave(barrier_leaf);
 }
 
 
@@ -246,17 +392,12 @@ extern "C" void CleanupMP()
 {
   int n;
 
-  if (barrier_ptr != NULL)
-    shmdt((char*)barrier_ptr);
-
   if (my_process_id == 0)
-    {
-      for (n = 1; n < total_processes; n++)
-	wait(NULL);
+    for (n = 1; n < total_processes; n++)
+      wait(NULL);
 
-      if (barrier_id >= 0)
-	shmctl(barrier_id, IPC_RMID, NULL);
-    }
+  if (barrier_ptr != NULL)
+    munmap((char*)barrier_ptr, barrier_size);
 }
 
 
@@ -273,43 +414,28 @@ extern "C" void _yield();
 
 extern "C" void DoBarrier()
 {
-  int old, i;
+  unsigned int old;
+  int          i;
 
-  get_lock(&barrier_ptr->lock);
+  old = barrier_ptr->bcast;
 
-  barrier_ptr->count++;
+  BarrierArrive(barrier_leaf);
 
-  if (barrier_ptr->count < total_processes)
+  while (barrier_ptr->bcast == old)
     {
-      old = barrier_ptr->bcast;
-      clr_lock(&barrier_ptr->lock);
+      for (i = 0; i < MP_BARRIER_SPIN; i++)
+	if (barrier_ptr->bcast != old)
+	  break;
 
-      while (barrier_ptr->bcast == old)
-	{
-	  for (i = 0; i < 100000; i++)
-	    if (barrier_ptr->bcast != old)
-	      break;
-
-	  if (barrier_ptr->bcast == old)
-	    _yield();
-	}
-    }
-  else
-    {
-      barrier_ptr->count = 0;
-      barrier_ptr->bcast++;
-
-      clr_lock(&barrier_ptr->lock);
+      if (barrier_ptr->bcast == old)
+#ifdef linux
+	syscall(SYS_futex, &barrier_ptr->bcast, FUTEX_WAIT, old,
+		NULL, NULL, 0);
+#else
+	_yield();
+#endif
     }
 
-  if (barrier_ptr->num_procs)
-    schedule_event(barrier_event, YS__Simtime + BARRIER_INTERVAL);
-
-  for (i = ARCH_firstnode; i < ARCH_firstnode + ARCH_mynodes; i++)
-    if (barrier_ptr->wakeup[i])
-      {
-	barrier_ptr->wakeup[i] = 0;
-
-      }
+  if (barrier_ptr->num_procs > 1)
+    schedule_event(barrier_event, YS__Simtime + MP_LOOKAHEAD);
 }
-
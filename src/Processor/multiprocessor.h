@@ -56,19 +56,42 @@
 #define __RSIM_MULTIPROCESSOR_H__
 
 
-#define BARRIER_INTERVAL 30
+/*
+ * Nodes are simulated by a group of processes, each owning a contiguous
+ * range of nodes with its own event list. Every MP_LOOKAHEAD cycles the
+ * processes meet at a combining-tree barrier in shared memory: each
+ * process arrives at its leaf, the last arrival at a tree node continues
+ * to its parent and the last arrival at the root releases all processes
+ * by incrementing the episode count. Waiting processes spin briefly and
+ * then sleep on the episode count (futex on Linux). The lookahead is the
+ * minimum inter-node message latency (mp_latency) unless a smaller value
+ * is configured. A process leaves the barrier for good when all of its
+ * processors have exited.
+ */
+
+#define MP_BARRIER_FANOUT  4        /* processes/subtrees per tree node     */
+#define MP_BARRIER_SPIN    1000     /* polls before sleeping                */
+#define MP_MAX_SKEW        1000     /* lookahead of independent nodes       */
 
 typedef struct
 {
   volatile unsigned int lock;
-  volatile unsigned int count;
-  volatile unsigned int bcast;
-  volatile unsigned int num_procs;
+  volatile unsigned int count;      /* arrivals in current episode          */
+  volatile unsigned int expected;   /* live processes/subtrees              */
+  int                   parent;     /* parent tree node, -1 for root        */
+} lrsim_barrier_node_t;
+
+typedef struct
+{
+  volatile unsigned int bcast;      /* barrier episode                      */
+  volatile unsigned int num_procs;  /* live simulation processes            */
   volatile unsigned int procs_lock;
-  volatile unsigned int wakeup[1];
+  lrsim_barrier_node_t  node[1];    /* leaves first, root last              */
 } lrsim_barrier_t;
 
 
+extern int MP_LOOKAHEAD;
+extern int MP_LATENCY;
 extern int my_process_id;
 extern int total_processes;
 extern lrsim_barrier_t *barrier_ptr;
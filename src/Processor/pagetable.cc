@@ -58,7 +58,12 @@
 /***************************************************************************/
 
 #include <string.h>
+#include <stdlib.h>
 #include <malloc.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 extern "C"
 {
@@ -71,132 +76,87 @@ extern "C"
 #include "Processor/pagetable.h"
 #include "Processor/endian_swap.h"
 
+#include "../lamix/mm/mm.h"
+
 
 page_table **PageTables;
 
+int          MEM_MMAP = 0;         // back memory with one mapping per node
+static char **MemRegions = NULL;   // per-node mapping of [0, IO_SEGMENT_LOW)
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
 
 
 /*=========================================================================*/
-/* Constructor: initialize array of anchor elements.                       */
+/* Constructor: no second-level tables yet.                                */
 /*=========================================================================*/
 
 page_table::page_table()
 {
-  for (int n = 0; n < PAGETABLE_SIZE; n++)
-    {
-      data[n].phys_addr = 0;
-      data[n].sim_addr  = NULL;
-      data[n].next      = NULL;
-    }
+  for (int n = 0; n < PAGETABLE_DIR_SIZE; n++)
+    dir[n] = NULL;
+
+  generation = 0;
 }
 
 
 
 /*=========================================================================*/
-/* Destructor: free all elements.                                          */
+/* Destructor: free all second-level tables.                               */
 /*=========================================================================*/
 
 page_table::~page_table()
 {
-  struct page_table_entry *pte, *npte;
-
-  for (int n = 0; n < PAGETABLE_SIZE; n++)
-    {
-      pte = data[n].next;
-      while (pte)
-	{
-	  npte = pte->next;
-	  delete pte;
-	  pte = npte;
-	}
-    }
+  for (int n = 0; n < PAGETABLE_DIR_SIZE; n++)
+    if (dir[n])
+      free(dir[n]);
 }
 
 
 
 
 /*=========================================================================*/
-/* Insert: insert an entry into the hash table. Hash physical page number  */
-/* to find anchor element, scan linked list of elements until either an    */
-/* unused element (sim_addr == NULL) or the end of the list is found (in   */
-/* which case a new element is allocated and appended) and fill in the     */
-/* found empty element.                                                    */
+/* Insert: enter the host page for a physical page, allocating the second- */
+/* level table if needed. An existing mapping is replaced.                 */
 /*=========================================================================*/
 
 void page_table::insert(unsigned phys_addr, char *sim_addr)
 {
-  unsigned index;
-  page_table_entry *pte;
-
-  index = (phys_addr / PAGE_SIZE) & PAGETABLE_HASH;
-  pte = &data[index];
+  char ***tab = &dir[phys_addr >> PAGETABLE_DIR_SHIFT];
 
-  while (pte->sim_addr != NULL)
+  if (*tab == NULL)
     {
-      if (pte->next == NULL)
-	pte->next = new page_table_entry();
-
-      pte = pte->next;
+      *tab = (char**)calloc(PAGETABLE_TAB_SIZE, sizeof(char*));
+      if (*tab == NULL)
+	YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
     }
 
-  pte->phys_addr = phys_addr / PAGE_SIZE;
-  pte->sim_addr  = sim_addr;
+  if ((*tab)[(phys_addr / PAGE_SIZE) & PAGETABLE_TAB_MASK] != NULL)
+    generation++;
+
+  (*tab)[(phys_addr / PAGE_SIZE) & PAGETABLE_TAB_MASK] = sim_addr;
 }
 
 
 
 
 /*=========================================================================*/
-/* Remove: hash physical page number to find anchor element. If anchor is  */
-/* to be removed, copy next element into anchor and remove next element    */
-/* from list, or just clear anchor element if no next element is found.    */
-/* If anchor is not the desired element, scan list until element is found, */
-/* keep track of previous element and simply remove desired element.       */
+/* Remove: clear the mapping of a physical page and invalidate cached     */
+/* translations. Second-level tables are kept.                             */
 /*=========================================================================*/
 
 void page_table::remove(unsigned phys_addr)
 {
-  unsigned          index;
-  page_table_entry *pte, *opte;
-
-  index = (phys_addr / PAGE_SIZE) & PAGETABLE_HASH;
-  pte = &data[index];
-
-  if (pte->phys_addr == phys_addr / PAGE_SIZE)  // anchor needs to be removed
-    {
-      if (pte->next != NULL)                      // has next element
-	{
-	  pte->phys_addr = pte->next->phys_addr;  // copy element
-	  pte->sim_addr  = pte->next->sim_addr;
-	  opte = pte->next;                       // save pointer to it
-	  pte->next      = pte->next->next;       // remove from linked list
-	  delete opte;                            // delete it
-	}
-      else                                        // anchor has no next elem.
-	{
-	  pte->phys_addr = 0;                     // clear it
-	  pte->sim_addr  = NULL;
-	  pte->next      = NULL;
-	}
+  char **tab = dir[phys_addr >> PAGETABLE_DIR_SHIFT];
 
-      return;
-    }
-  
+  if (tab == NULL)
+    return;
 
-  opte = pte;                                     // anchor is not desired elm.
-  pte = pte->next;
-  while (pte)                                     // look for match
-    {
-      if (pte->phys_addr == phys_addr / PAGE_SIZE)
-	{
-	  opte->next = pte->next;                 // remove element from list
-	  delete pte;                             // delete it
-	  return;
-	}
-
-      opte = pte;
-      pte = pte->next;
-    }
+  tab[(phys_addr / PAGE_SIZE) & PAGETABLE_TAB_MASK] = NULL;
+  generation++;
 }
 
 
@@ -216,6 +176,12 @@ extern "C" void PageTable_init(void)
  
   if (!PageTables)
     YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  // every node reserves the whole range below the I/O segment, which does
+  // not fit into the address space of a 32-bit host
+  if ((MEM_MMAP) && (sizeof(char*) < 8))
+    YS__errmsg(0, "mem_mmap reserves %u MB of address space per node and requires a 64-bit host; set mem_mmap to 0",
+	       (unsigned)IO_SEGMENT_LOW >> 20);
    
   for (i = 0; i < ARCH_numnodes; i++)
     PageTables[i] = new page_table();
@@ -223,6 +189,162 @@ extern "C" void PageTable_init(void)
 
 
 
+/*=========================================================================*/
+/* Memory regions: with mem_mmap set, the physical memory of a node below  */
+/* the I/O segment is one anonymous mapping that reserves no swap space;   */
+/* pages are backed by host memory only once they are written. A region   */
+/* can also be backed by a memory image file (written with a checkpoint),  */
+/* mapped private copy-on-write, so that concurrent simulations started   */
+/* from the same image share all pages they do not modify.                */
+/*=========================================================================*/
+
+static char *PageTable_region(int node_id)
+{
+  char *region;
+
+  if (MemRegions == NULL)
+    {
+      MemRegions = (char**)calloc(ARCH_numnodes, sizeof(char*));
+      if (MemRegions == NULL)
+	YS__errmsg(node_id, "Malloc failed at %s:%i", __FILE__, __LINE__);
+    }
+
+  if (MemRegions[node_id] == NULL)
+    {
+      region = (char*)mmap(NULL, IO_SEGMENT_LOW, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+			   -1, 0);
+      if (region == (char*)MAP_FAILED)
+	YS__errmsg(node_id, "Mapping simulated memory failed: %s",
+		   YS__strerror(errno));
+
+      MemRegions[node_id] = region;
+    }
+
+  return MemRegions[node_id];
+}
+
+
+
+static int PageTable_in_region(int node_id, char *sim_mem)
+{
+  return (MemRegions != NULL) && (MemRegions[node_id] != NULL) &&
+    (sim_mem >= MemRegions[node_id]) &&
+    (sim_mem < MemRegions[node_id] + IO_SEGMENT_LOW);
+}
+
+
+
+/*=========================================================================*/
+/* Allocate a zeroed host page for a physical page; it is not entered     */
+/* into the page table. Pages of a memory region are zero until they are  */
+/* written; PageTable_remove_free keeps it that way for freed pages.      */
+/*=========================================================================*/
+
+extern "C" char *PageTable_alloc(int node_id, unsigned addr)
+{
+  char *sim_mem;
+
+  addr &= ~(PAGE_SIZE - 1);
+
+  if ((MEM_MMAP) && (addr < IO_SEGMENT_LOW))
+    return PageTable_region(node_id) + addr;
+
+  sim_mem = (char*)malloc(PAGE_SIZE);
+  if (sim_mem == NULL)
+    YS__errmsg(node_id, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  memset(sim_mem, 0, PAGE_SIZE);
+  return sim_mem;
+}
+
+
+
+/*=========================================================================*/
+/* Map a memory image file over the region of a node, private copy-on-    */
+/* write, and point the listed physical pages to it.                       */
+/*=========================================================================*/
+
+extern "C" void PageTable_map_image(int node_id, const char *name,
+				    unsigned *pages, int count)
+{
+  char *region = PageTable_region(node_id);
+  int   fd, n;
+
+  fd = open(name, O_RDONLY);
+  if (fd < 0)
+    YS__errmsg(node_id, "Open memory image %s failed: %s",
+	       name, YS__strerror(errno));
+
+  if (mmap(region, IO_SEGMENT_LOW, PROT_READ | PROT_WRITE,
+	   MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE, fd, 0) == MAP_FAILED)
+    YS__errmsg(node_id, "Mapping memory image %s failed: %s",
+	       name, YS__strerror(errno));
+
+  close(fd);
+
+  for (n = 0; n < count; n++)
+    {
+      if (PageTables[node_id]->lookup(pages[n]) != region + pages[n])
+	PageTables[node_id]->insert(pages[n], region + pages[n]);
+    }
+}
+
+
+
+/*=========================================================================*/
+/* Write the memory of a node below the I/O segment to a sparse memory     */
+/* image file; pages that are all zero are left as holes. Fills in the     */
+/* list of existing pages and returns their number.                        */
+/*=========================================================================*/
+
+extern "C" int PageTable_write_image(int node_id, const char *name,
+				     unsigned **pages)
+{
+  static const char zero[PAGE_SIZE] = { 0 };
+  unsigned addr;
+  char    *sim_mem;
+  int      fd, count = 0, max = 0;
+
+  fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    YS__errmsg(node_id, "Open memory image %s failed: %s",
+	       name, YS__strerror(errno));
+
+  if (ftruncate(fd, IO_SEGMENT_LOW) < 0)
+    YS__errmsg(node_id, "Truncate memory image %s failed: %s",
+	       name, YS__strerror(errno));
+
+  *pages = NULL;
+  for (addr = 0; addr < IO_SEGMENT_LOW; addr += PAGE_SIZE)
+    {
+      sim_mem = PageTables[node_id]->lookup(addr);
+      if (sim_mem == NULL)
+	continue;
+
+      if (count == max)
+	{
+	  max = max ? 2 * max : 1024;
+	  *pages = (unsigned*)realloc(*pages, max * sizeof(unsigned));
+	  if (*pages == NULL)
+	    YS__errmsg(node_id, "Malloc failed at %s:%i", __FILE__, __LINE__);
+	}
+      (*pages)[count++] = addr;
+
+      if (memcmp(sim_mem, zero, PAGE_SIZE) == 0)
+	continue;
+
+      if (pwrite(fd, sim_mem, PAGE_SIZE, addr) != PAGE_SIZE)
+	YS__errmsg(node_id, "Writing memory image %s failed: %s",
+		   name, YS__strerror(errno));
+    }
+
+  close(fd);
+  return count;
+}
+
+
+
 /*=========================================================================*/
 /* Insert a mapping for 1 page (4K) into the page table for this node, in  */
 /* addition allocate physical (host) memory.                               */
@@ -235,7 +357,7 @@ extern "C" void PageTable_insert_alloc(int node_id, unsigned addr)
   sim_mem = PageTables[node_id]->lookup(addr);
   if (!sim_mem)
     {
-      sim_mem = (char*)malloc(PAGE_SIZE);
+      sim_mem = PageTable_alloc(node_id, addr);
       PageTables[node_id]->insert(addr, sim_mem);
     }
 }
@@ -283,8 +405,20 @@ extern "C" void PageTable_remove(int node_id, unsigned addr)
 
 extern "C" void PageTable_remove_free(int node_id, unsigned addr)
 {
-  char *sim_mem = PageTables[node_id]->lookup(addr);
-  if (sim_mem)
+  char *sim_mem = PageTables[node_id]->lookup(addr & ~(PAGE_SIZE - 1));
+
+  // replace a region page by fresh anonymous memory: this releases the
+  // host page, and unlike MADV_DONTNEED it does not bring back the
+  // contents of a memory image mapped underneath
+  if (PageTable_in_region(node_id, sim_mem))
+    {
+      if ((PAGE_SIZE % getpagesize() != 0) ||
+	  (mmap(sim_mem, PAGE_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE,
+		-1, 0) == MAP_FAILED))
+	memset(sim_mem, 0, PAGE_SIZE);
+    }
+  else if (sim_mem)
     free(sim_mem);
 
   PageTables[node_id]->remove(addr);
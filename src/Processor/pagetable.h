@@ -66,15 +66,21 @@
 #define __RSIM_PAGETABLE_H__
 
 
+extern int MEM_MMAP;                   /* one memory mapping per node       */
+
+
 /* regular C declarations, e.g. for I/O devices ---------------------------*/
 #ifndef __cplusplus
 
 void            PageTable_init         (void);
+char           *PageTable_alloc        (int, unsigned);
 void            PageTable_insert_alloc (int, unsigned);
 void            PageTable_insert       (int, unsigned, char*);
 char           *PageTable_lookup       (int, unsigned);
 void            PageTable_remove       (int, unsigned);
 void            PageTable_remove_free  (int, unsigned);
+void            PageTable_map_image    (int, const char*, unsigned*, int);
+int             PageTable_write_image  (int, const char*, unsigned**);
 
 unsigned int    read_int               (int, unsigned);
 unsigned char   read_char              (int, unsigned);
@@ -96,11 +102,14 @@ void            write_bit              (int, unsigned, int, int);
 extern "C"
 {
   void  PageTable_init         (void);
+  char *PageTable_alloc        (int, unsigned);
   void  PageTable_insert_alloc (int, unsigned);
   void  PageTable_insert       (int, unsigned, char*);
   char *PageTable_lookup       (int, unsigned);
   void  PageTable_remove       (int, unsigned);
   void  PageTable_remove_free  (int, unsigned);
+  void  PageTable_map_image    (int, const char*, unsigned*, int);
+  int   PageTable_write_image  (int, const char*, unsigned**);
 
   unsigned int    read_int     (int, unsigned);
   unsigned char   read_char    (int, unsigned);
@@ -118,32 +127,30 @@ extern "C"
 
 
 
-struct page_table_entry
-{
-  unsigned                 phys_addr;
-  char                    *sim_addr;
-  struct page_table_entry *next;
-
-  page_table_entry()
-  {
-    phys_addr = 0;
-    sim_addr  = NULL;
-    next      = NULL;
-  }
-};
-
-
+/*
+ * Two-level radix table over the 32-bit physical address space: the top
+ * PAGETABLE_DIR_BITS of the address select a second-level table, which
+ * maps the remaining page number bits to the host page. Second-level
+ * tables are allocated when the first page in their range is inserted.
+ * The generation count changes whenever a mapping is removed, so that
+ * cached translations (see GetMap) can be revalidated cheaply.
+ */
 
-#define PAGETABLE_SIZE 0x10000
-#define PAGETABLE_HASH (PAGETABLE_SIZE-1)
+#define PAGETABLE_DIR_BITS  10
+#define PAGETABLE_DIR_SIZE  (1 << PAGETABLE_DIR_BITS)
+#define PAGETABLE_DIR_SHIFT (32 - PAGETABLE_DIR_BITS)
+#define PAGETABLE_TAB_SIZE  ((unsigned)(0x100000000ull / PAGE_SIZE) / PAGETABLE_DIR_SIZE)
+#define PAGETABLE_TAB_MASK  (PAGETABLE_TAB_SIZE - 1)
 
 
 class page_table
 {
 private:
-  struct page_table_entry data[PAGETABLE_SIZE];
+  char **dir[PAGETABLE_DIR_SIZE];
 
 public:
+  unsigned generation;
+
   page_table();
   ~page_table();
   void insert(unsigned phys_addr, char *sim_addr);
@@ -151,21 +158,17 @@ public:
   
   inline char *lookup(unsigned phys_addr)
   {
-    unsigned          index;
-    page_table_entry *pte;
+    char **tab, *page;
 
-    index = (phys_addr / PAGE_SIZE) & PAGETABLE_HASH;
-    pte = &data[index];
+    tab = dir[phys_addr >> PAGETABLE_DIR_SHIFT];
+    if (tab == NULL)
+      return(NULL);
 
-    while (pte)
-      {
-	if (pte->phys_addr == phys_addr / PAGE_SIZE)
-	  return (char*)(pte->sim_addr + (phys_addr & (PAGE_SIZE-1)));
-	
-	pte = pte->next;
-      }
+    page = tab[(phys_addr / PAGE_SIZE) & PAGETABLE_TAB_MASK];
+    if (page == NULL)
+      return(NULL);
 
-    return(NULL);
+    return(page + (phys_addr & (PAGE_SIZE-1)));
   }
 };
 
@@ -56,6 +56,7 @@
 #define _PROCESSOR_PREDECODE_H_
 
 extern int SIZEOF_INSTR;
+extern int PREDECODE_PAGES;
 
 #ifdef __cplusplus
 void PredecodeTableSetup();
@@ -61,10 +61,13 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 extern "C"
 {
 #include "sim_main/util.h"
+#include "Caches/system.h"
 }
 
 #include "Processor/sync_asis.h"
@@ -1438,31 +1441,131 @@ int start_decode(instr *in, unsigned undec)
 
 
 
+/***************************************************************************/
+/* Predecode cache: decoded instructions of recently used physical pages,  */
+/* per node. The table is direct-mapped by page number and each entry     */
+/* keeps the raw instruction word next to its decoded form. A cached       */
+/* instruction is used only if the word in memory is unchanged, so stores  */
+/* to text pages, DMA and self-modifying code need no invalidation.       */
+/***************************************************************************/
+
+int PREDECODE_PAGES = 256;           // predecode cache entries per node
+
+#define PREDECODE_INSTRS  (PAGE_SIZE / SIZE_OF_SPARC_INSTRUCTION)
+
+struct predecode_page
+{
+  unsigned  page;                    // physical page number
+  unsigned  raw[PREDECODE_INSTRS];   // instruction words ...
+  char      valid[PREDECODE_INSTRS]; // ... that have been decoded
+  instr     code[PREDECODE_INSTRS];
+};
+
+static predecode_page ***PredecodeCache = NULL;
+
+
+
+static predecode_page *PredecodeLookup(unsigned pc, int nodeid)
+{
+  predecode_page  *pp;
+  predecode_page **entry;
+  unsigned         page = pc / PAGE_SIZE;
+
+  if (PredecodeCache == NULL)
+    {
+      PredecodeCache = RSIM_CALLOC(predecode_page**, ARCH_numnodes);
+      if (PredecodeCache == NULL)
+	YS__errmsg(nodeid, "Malloc failed in %s:%i", __FILE__, __LINE__);
+    }
+
+  if (PredecodeCache[nodeid] == NULL)
+    {
+      PredecodeCache[nodeid] = RSIM_CALLOC(predecode_page*, PREDECODE_PAGES);
+      if (PredecodeCache[nodeid] == NULL)
+	YS__errmsg(nodeid, "Malloc failed in %s:%i", __FILE__, __LINE__);
+    }
+
+  entry = &PredecodeCache[nodeid][page % PREDECODE_PAGES];
+  pp    = *entry;
+
+  if (pp == NULL)
+    {
+      pp = *entry = (predecode_page*)malloc(sizeof(predecode_page));
+      if (pp == NULL)
+	YS__errmsg(nodeid, "Malloc failed in %s:%i", __FILE__, __LINE__);
+      pp->page = page + 1;
+    }
+
+  if (pp->page != page)
+    {
+      pp->page = page;
+      memset(pp->valid, 0, sizeof(pp->valid));
+    }
+
+  return pp;
+}
+
+
+
 extern "C" int PredecodeBlock(unsigned pc, int nodeid, char *daddr, int num)
 {
-  int      n, rc;
-  unsigned instruction, *paddr;
-  instr   *in;
+  int             n, idx;
+  unsigned        instruction, *paddr;
+  instr          *in;
+  predecode_page *pp;
 
   paddr = (unsigned*)PageTables[nodeid]->lookup(pc);
   if (!paddr)
     return(0);
-  
-  in = (instr*)daddr;
-  memset(in, 0, sizeof(instr) * num);
 
-  for (n = 0; n < num; n++)
+  in  = (instr*)daddr;
+  idx = (pc & (PAGE_SIZE - 1)) / SIZE_OF_SPARC_INSTRUCTION;
+
+  if ((PREDECODE_PAGES <= 0) || (idx + num > PREDECODE_INSTRS))
     {
-      instruction = endian_swap(*paddr);
-      if (!(*(starters[Extract(instruction, 31, 30)]))(in, instruction))
+      memset(in, 0, sizeof(instr) * num);
+
+      for (n = 0; n < num; n++)
 	{
-	  YS__warnmsg(nodeid, "Predecode failed\n");
-	  return(0);
+	  instruction = endian_swap(*paddr);
+	  if (!(*(starters[Extract(instruction, 31, 30)]))(in, instruction))
+	    {
+	      YS__warnmsg(nodeid, "Predecode failed\n");
+	      return(0);
+	    }
+
+	  paddr++;
+	  in++;
+	}
+
+      return(1);
+    }
+
+  pp = PredecodeLookup(pc, nodeid);
+
+  for (n = 0; n < num; n++, idx++)
+    {
+      if ((!pp->valid[idx]) || (pp->raw[idx] != *paddr))
+	{
+	  pp->valid[idx] = 0;
+	  memset(&pp->code[idx], 0, sizeof(instr));
+
+	  instruction = endian_swap(*paddr);
+	  if (!(*(starters[Extract(instruction, 31, 30)]))(&pp->code[idx],
+							  instruction))
+	    {
+	      YS__warnmsg(nodeid, "Predecode failed\n");
+	      return(0);
+	    }
+
+	  pp->raw[idx]   = *paddr;
+	  pp->valid[idx] = 1;
 	}
 
       paddr++;
-      in++;
     }
 
+  memcpy(in, &pp->code[idx - num], sizeof(instr) * num);
+
   return(1);
 }
@@ -64,6 +64,9 @@ extern "C"
 #include "Processor/procstate.h"
 #include "Processor/mainsim.h"
 #include "Processor/branchpred.h"
+#include "Processor/bpred.h"
+#include "Processor/ftq.h"
+#include "Processor/smt.h"
 #include "Processor/simio.h"
 #include "Processor/fastnews.h"
 #include "Processor/tagcvt.hh"
@@ -71,6 +74,7 @@ extern "C"
 #include "Processor/procstate.hh"
 #include "Processor/memunit.h"
 #include "Processor/exec.h"
+#include "Processor/fastfwd.h"
 #include "Processor/branchpred.hh"
 #include "Processor/pagetable.h"
 
@@ -141,6 +145,10 @@ ProcState::ProcState(int proc):
   proc_id = proc;
   aliveprocs++;
   halt = 0;
+  fastfwd = fastfwd_instruction ? FASTFWD_FUNC : FASTFWD_OFF;
+  fastfwd_detail = 0;
+  fetch_deferred = 0;
+  deferred_exception = NULL;
   
 #ifdef COREFILE
   char proc_file_name[80];
@@ -150,20 +158,24 @@ ProcState::ProcState(int proc):
   corefile = NULL;
 #endif
 
-  l1i_argptr = L1ICaches[proc_id];
-  l1d_argptr = L1DCaches[proc_id];
-  l2_argptr  = L2Caches[proc_id];
-  wb_argptr  = WBuffers[proc_id];
+  core_id    = SMT_CORE(proc_id);
+  l1i_argptr = L1ICaches[core_id];
+  l1d_argptr = L1DCaches[core_id];
+  l2_argptr  = L2Caches[core_id];
+  wb_argptr  = WBuffers[core_id];
 
   fetch_rate      = FETCHES_PER_CYCLE;
   decode_rate     = DECODES_PER_CYCLE;
   graduate_rate   = GRADUATES_PER_CYCLE;
-  max_active_list = MAX_ACTIVE_NUMBER;
+  max_active_list = SMTActiveList();
+  smt_fetch       = 1;
 
   exit = 0;                  /* don't exit yet */
   interrupt_pending = 0;     /* no interrupt   */
 
   PageTable = PageTables[proc_id / ARCH_cpus];
+  map_page  = ~0U;
+  map_addr  = NULL;
 
   
   // Initialize privileged state --------------------------------------------
@@ -272,7 +284,13 @@ ProcState::ProcState(int proc):
 	}
     }
 
-  if (ITLB_SIZE == 0)
+  if (proc_id != core_id)
+    {
+      // SMT contexts use the entries of the core's TLBs
+      itlb = new TLB(AllProcs[core_id]->itlb, this);
+      dtlb = new TLB(AllProcs[core_id]->dtlb, this);
+    }
+  else if (ITLB_SIZE == 0)
     {
       if (DTLB_SIZE == 0)
 	YS__errmsg(proc_id / ARCH_cpus,
@@ -280,7 +298,7 @@ ProcState::ProcState(int proc):
 
       dtlb = new TLB(this, DTLB_TYPE, DTLB_SIZE, DTLB_ASSOCIATIVITY,
 		     DTLB_TAGGED);
-      itlb = new TLB(dtlb);
+      itlb = new TLB(dtlb, this);
     }
   else
     {
@@ -288,7 +306,7 @@ ProcState::ProcState(int proc):
 		     ITLB_TAGGED);
 
       if (DTLB_SIZE == 0)
-	dtlb = new TLB(itlb);
+	dtlb = new TLB(itlb, this);
       else
 	dtlb = new TLB(this, DTLB_TYPE, DTLB_SIZE, DTLB_ASSOCIATIVITY,
 		       DTLB_TAGGED);
@@ -372,9 +390,9 @@ ProcState::ProcState(int proc):
       active_instr[i] = 0;
     }
 
-  max_active_instr[uALU] = MAX_ALU_OPS;
-  max_active_instr[uFP]  = MAX_FPU_OPS;
-  max_active_instr[uMEM] = MAX_MEM_OPS;
+  max_active_instr[uALU] = SMTCap(MAX_ALU_OPS);
+  max_active_instr[uFP]  = SMTCap(MAX_FPU_OPS);
+  max_active_instr[uMEM] = SMTCap(MAX_MEM_OPS);
 
   ldissues = 0;
 
@@ -390,6 +408,10 @@ ProcState::ProcState(int proc):
   fetch_queue = new Queue<fetch_queue_entry>;
   inst_save = NULL;
 
+  ftq = NULL;                            // decoupled front end
+  if (FTQ_SIZE > 0)
+    ftq = new FetchTargetQueue(FTQ_SIZE);
+
   in_exception = NULL;
 
   // Prediction
@@ -408,6 +430,7 @@ ProcState::ProcState(int proc):
     }
 
 #ifndef STORE_ORDERING
+  StoreWait.Setup();                     // setup memory dependence predictor
   StoresToMem = 0;
   SStag = LStag = SLtag = LLtag = MEMISSUEtag = -1;
 #endif
@@ -426,6 +449,15 @@ ProcState::ProcState(int proc):
   ras_bad_predicts  = 0;
   ras_underflows    = 0;
   ras_overflows     = 0;
+  jmp_good_predicts = 0;
+  jmp_bad_predicts  = 0;
+  jmp_unpredicted   = 0;
+  fastfwd_insts     = 0;
+  fastfwd_handovers = 0;
+  fetch_bubbles     = 0;
+  smt_fetch_cycles  = 0;
+  ftq_redirects     = 0;
+  ftq_multifetch    = 0;
 
   ldspecs = 0;
   last_counted = 0;
@@ -450,6 +482,8 @@ ProcState::ProcState(int proc):
   unlimbos = 0;
   redos = 0;
   kills = 0;
+  stwaits = 0;
+  stwait_trains = 0;
   vsbfwds = 0;
   fwds = 0;
   partial_overlaps = 0;
@@ -507,6 +541,13 @@ ProcState::ProcState(int proc):
 			       POINT, MEANS, HIST, min(8, fetch_queue_size), 0,
 			       fetch_queue_size);
 
+  // size of fetch target queue
+  FTQStats = NULL;
+  if (ftq)
+    FTQStats = NewStatrec(proc_id / ARCH_cpus,
+			  "Fetch target queue size",
+			  POINT, MEANS, HIST, min(8, FTQ_SIZE), 0, FTQ_SIZE);
+
   // size of active list
   ActiveListStats = NewStatrec(proc_id / ARCH_cpus,
 			       "Active list size", POINT, MEANS,
@@ -892,6 +933,20 @@ void ProcState::report_stats(int nid)
   int i;
 #ifndef NOSTAT
   StatrecReport(nid, FetchQueueStats);
+  if (FTQStats)
+    StatrecReport(nid, FTQStats);
+  YS__statmsg(nid, "Fetch bubbles: %lld cycles (%.2f%%)\n",
+	      fetch_bubbles,
+	      100.0 * (double)fetch_bubbles / (double)(curr_cycle - start_time));
+  if (ftq)
+    YS__statmsg(nid, "FTQ redirects: %lld; multi-block fetch cycles: %lld\n",
+		ftq_redirects, ftq_multifetch);
+  if (SMT_THREADS > 1)
+    YS__statmsg(nid, "SMT fetch cycles: %lld (%.2f%%)\n",
+		smt_fetch_cycles,
+		100.0 * (double)smt_fetch_cycles /
+		(double)(curr_cycle - start_time));
+  YS__statmsg(nid, "\n");
   StatrecReport(nid, ActiveListStats);
 
   StatrecReport(nid, SpecStats);
@@ -913,6 +968,13 @@ void ProcState::report_stats(int nid)
     YS__statmsg(nid, "Two bit agree predictor; %i entries\n\n", BPB_SIZE);
   if (BPB_TYPE == STATIC)
     YS__statmsg(nid, "Static predictor\n");
+  if (BPB_TYPE == GSHARE)
+    YS__statmsg(nid, "gshare predictor; %i entries\n\n", BPB_SIZE);
+  if (BPB_TYPE == TOURNAMENT)
+    YS__statmsg(nid, "Tournament predictor; %i entries\n\n", BPB_SIZE);
+  if (BPB_TYPE == TAGE)
+    YS__statmsg(nid, "TAGE predictor; %i entries, %i tagged tables\n\n",
+		BPB_SIZE, TAGE_TABLES);
 
   YS__statmsg(nid, "%lld good predictions;  %lld bad predictions\n",
 	 bpb_good_predicts, bpb_bad_predicts);
@@ -936,6 +998,30 @@ void ProcState::report_stats(int nid)
     }
   else
     YS__statmsg(nid, "No RAS\n");
+
+
+  YS__statmsg(nid,
+	      "\n------------------------------------------------------------------------\n");
+  YS__statmsg(nid, "Indirect Jump Statistics\n\n");
+
+  if (BTB_TYPE == BTBASSOC && BTB_SIZE > 0)
+    YS__statmsg(nid, "BTB; %i entries, %i-way\n", BTB_SIZE, BTB_ASSOC);
+  else if (BTB_TYPE == BTBITTAGE && BTB_SIZE > 0)
+    YS__statmsg(nid, "ITTAGE; %i entries per table, %i-way base BTB\n",
+		BTB_SIZE, BTB_ASSOC);
+  else
+    YS__statmsg(nid, "No target predictor\n");
+
+  YS__statmsg(nid, "%lld good predictions;  %lld bad predictions;  "
+	      "%lld unpredicted\n",
+	      jmp_good_predicts, jmp_bad_predicts, jmp_unpredicted);
+
+  if (BranchProf)
+    {
+      YS__statmsg(nid,
+		  "\n------------------------------------------------------------------------\n");
+      BranchProf->Report(nid, BP_PROFILE);
+    }
   
   
   YS__statmsg(nid,
@@ -945,6 +1031,9 @@ void ProcState::report_stats(int nid)
 	      "Loads issued: %lld, speced: %lld, limbos: %lld, unlimbos: %lld, "
 	      "redos: %lld, kills: %lld\n", ldissues, ldspecs, limbos,
 	      unlimbos, redos, kills);
+  YS__statmsg(nid,
+	      "Store-wait stalls: %lld, trained: %lld\n",
+	      stwaits, stwait_trains);
   YS__statmsg(nid,
 	      "Memory unit fwds: %lld, Virtual store buffer fwds: %lld "
 	      "Partial overlaps: %lld\n", fwds, vsbfwds, partial_overlaps);
@@ -1135,6 +1224,11 @@ void ProcState::report_phase_fast(int pid)
 	      "STAT Return prediction rate: %.4f\n",
 	      double(ras_good_predicts) / double(ras_good_predicts + ras_bad_predicts));
 
+  YS__statmsg(nid,
+	      "STAT Indirect prediction rate: %.4f\n",
+	      double(jmp_good_predicts) /
+	      double(jmp_good_predicts + jmp_bad_predicts + jmp_unpredicted));
+
 #ifndef NOSTAT
   YS__statmsg(nid,
 	      "STAT Reads Mean (ACT): %.3f Stddev: %.3f\n",
@@ -1241,6 +1335,11 @@ void ProcState::reset_stats()
   bpb_good_predicts = bpb_bad_predicts = 0;
   ras_good_predicts = ras_bad_predicts = 0;
   ras_underflows = ras_overflows = 0;
+  jmp_good_predicts = jmp_bad_predicts = jmp_unpredicted = 0;
+  fetch_bubbles = ftq_redirects = ftq_multifetch = 0;
+  smt_fetch_cycles = 0;
+  if (BranchProf)
+    BranchProf->Reset();
 
 #ifndef NOSTAT
   StatrecReset(BadPredFlushes);
@@ -1260,6 +1359,7 @@ void ProcState::reset_stats()
 
   ldissues = ldspecs = limbos = unlimbos = redos = 0;
   kills = vsbfwds = fwds = partial_overlaps = 0;
+  stwaits = stwait_trains = 0;
   avail_fetch_slots = 0;
   stats_phase = -1;
 
@@ -1279,6 +1379,8 @@ void ProcState::reset_stats()
 
   StatrecReset(ActiveListStats);
   StatrecReset(FetchQueueStats);
+  if (FTQStats)
+    StatrecReset(FTQStats);
 
   // size of active list
   StatrecReset(readacc);
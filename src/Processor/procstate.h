@@ -78,6 +78,7 @@
 #include "Processor/hash.h"
 #include "Processor/allocator.h"
 #include "Processor/memq.h"
+#include "Processor/lsq.h"
 #include "Processor/fetch_queue.h"
 #include "Processor/queue.h"
 #include "Processor/stallq.h"
@@ -99,6 +100,10 @@ extern "C"
 
 struct MapTable;
 struct BranchQElement;
+class  DirPredictor;
+class  TargetPredictor;
+class  BranchProfile;
+class  FetchTargetQueue;
 
 extern int  DEBUG_TIME;  /* time to enable debugging on */
 
@@ -248,6 +253,7 @@ struct ProcState
   /****************** Configuraton parameter ********************/
 
   int         proc_id;             /* processor id                         */
+  int         core_id;             /* SMT core, owns the shared caches     */
   int         fetch_rate;          /* instruction fetches per cycle        */
   int         decode_rate;         /* decode rate of proc                  */
   int         graduate_rate;       /* graduate rate of proc                */
@@ -262,11 +268,16 @@ struct ProcState
   long long   curr_cycle;          /* current simulated cycle              */
 
   page_table *PageTable;
+  unsigned    map_page;            /* last translation of GetMap:          */
+  char       *map_addr;            /* physical page and host page          */
+  unsigned    map_generation;
 
 
   /******** instruction fetching, decoding, and graduation *******/
 
   int         halt;                /* halt processor until next interrupt  */
+  int         fastfwd;             /* functional fast-forward state        */
+  int         fastfwd_detail;      /* # of instr. the pipeline may decode  */
   
   unsigned    pc;                  /* the current pc                       */
   unsigned    npc;                 /* the next pc to fetch from            */
@@ -313,6 +324,11 @@ struct ProcState
   int                       fetch_done;
   instance                 *inst_save;  
 
+  int                       fetch_deferred;   /* fetch after parallel stage */
+
+  FetchTargetQueue         *ftq;              /* decoupled fetch, or NULL */
+  int                       smt_fetch;        /* SMT: may fetch this cycle */
+
   
   int            DELAY;            /* Is the processor stalling            */
   long long      stall_the_rest;   /* flag indicating processor stall      */
@@ -337,9 +353,9 @@ struct ProcState
   /******** instruction issue, execution, and completion *******/
    
   Heap<UTYPE> FreeingUnits;        /* units get freed                      */
-  InstHeap    Running;             /* when instructions complete           */
-  InstHeap    DoneHeap;            /* instructions that are done           */
-  InstHeap    MemDoneHeap;         /* memory instructions that are done    */
+  InstWheel   Running;             /* when instructions complete           */
+  InstWheel   DoneHeap;            /* instructions that are done           */
+  InstWheel   MemDoneHeap;         /* memory instructions that are done    */
   MiniStallQ  UnitQ[numUTYPES];    /* instructions stalled at each unit    */
 
   MiniStallQ  dist_stallq_int[NO_OF_LOG_INT_REGS + MAX_MAX_ACTIVE_NUMBER];
@@ -347,6 +363,8 @@ struct ProcState
 
   instance *in_exception;          /* instance causing exception           */
   long long time_pre_exception;    /* time before exception                */
+  instance *deferred_exception;    /* exception after parallel stage       */
+  int       deferred_sync;         /* sync flag at start of that cycle     */
 
   
   /********************* Prediction **************************/
@@ -357,6 +375,10 @@ struct ProcState
 
   int      *BranchPred;                  /* 1st bit of 2-bit BHT           */
   int      *PrevPred;                    /* 2nd bit of 2-bit BHT           */
+  DirPredictor    *DirPred;              /* gshare/tournament/TAGE         */
+  TargetPredictor *TargetPred;           /* indirect jump target predictor */
+  BranchProfile   *BranchProf;           /* per-PC misprediction profile   */
+  unsigned long long bp_history;         /* speculative global history     */
   unsigned *ReturnAddressStack;          /* return address predictor       */
   int       rasptr;                      /* return address stack pointer   */
   int       rascnt;                      /* return address stack counter   */
@@ -392,8 +414,9 @@ struct ProcState
   TLB *dtlb;
 
 #ifndef STORE_ORDERING
-  MemQ<instance *> LoadQueue;            /* load queue                     */
-  MemQ<instance *> StoreQueue;           /* store queue                    */
+  LoadQ            LoadQueue;            /* address-indexed load queue     */
+  StoreQ           StoreQueue;           /* address-indexed store queue    */
+  StoreWaitTable   StoreWait;            /* memory dependence predictor    */
   int StoresToMem;                       /* keep track of outstanding sts  */
   MemQ<long long>  st_tags;              /* list of store tags             */
   MemQ<long long>  rmw_tags;             /* list of rmw tags               */
@@ -442,11 +465,21 @@ struct ProcState
   long long ras_bad_predicts;            /* number of bad returns          */
   long long ras_overflows;               /* number of RAS overflows        */
   long long ras_underflows;              /* number of RAS underflows       */
+  long long jmp_good_predicts;           /* correct indirect jump targets  */
+  long long jmp_bad_predicts;            /* wrong indirect jump targets    */
+  long long jmp_unpredicted;             /* indirect jumps w/o prediction  */
+  long long fastfwd_insts;               /* functionally executed instrs.  */
+  long long fastfwd_handovers;           /* instrs. handed over to pipeline*/
+  long long fetch_bubbles;               /* decode cycles w/o instructions */
+  long long ftq_redirects;               /* FTQ path differed from decode  */
+  long long ftq_multifetch;              /* cycles w/ more than one block  */
+  long long smt_fetch_cycles;            /* cycles this context fetched    */
 
   STATREC *BadPredFlushes;               /* impact of mispredictions       */
   STATREC *ExceptFlushed;                /* impact of exceptions           */
   STATREC *SpecStats;                    /* time at each spec level        */
-  STATREC *FetchQueueStats;              /* size of active list            */
+  STATREC *FetchQueueStats;              /* size of fetch queue            */
+  STATREC *FTQStats;                     /* size of fetch target queue     */
   STATREC *ActiveListStats;              /* size of active list            */
   STATREC *FUUsage[numUTYPES];           /* utilization of functional units*/
 
@@ -482,6 +515,8 @@ struct ProcState
 
   /* classification of loads */
   long long ldissues, ldspecs, limbos, unlimbos, redos, kills;
+  /* memory dependence prediction */
+  long long stwaits, stwait_trains;
   /* forwarding stats */
   long long vsbfwds, fwds, partial_overlaps;
   /* availability, efficiency and utility (BennetFlynn1995 TR)  */
@@ -508,7 +543,8 @@ struct ProcState
   inline int      BPBPredict(unsigned bpc, int statpred);
   // returns predicted pc
   
-  inline void     BPBComplete(unsigned bpc, int taken, int statpred);  
+  inline void     BPBComplete(unsigned bpc, int taken, int statpred,
+			      unsigned long long hist);
 
   inline void     RASSetup   ();               // set up RAS predictor
   inline void     RASInsert  (unsigned newpc); // insert on a CALL
@@ -162,8 +162,20 @@ inline char* GetMap(instance *inst, ProcState *proc)
 {
   char *pa;
 
+  // last translation, valid until a mapping is removed
+  if ((inst->addr / PAGE_SIZE == proc->map_page) &&
+      (proc->map_generation == proc->PageTable->generation))
+    return proc->map_addr + (inst->addr & (PAGE_SIZE-1));
+
   pa = proc->PageTable->lookup(inst->addr);
 
+  if (pa)
+    {
+      proc->map_page       = inst->addr / PAGE_SIZE;
+      proc->map_addr       = pa - (inst->addr & (PAGE_SIZE-1));
+      proc->map_generation = proc->PageTable->generation;
+    }
+
   return pa;
 }
 
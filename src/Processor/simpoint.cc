@@ -0,0 +1,688 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+extern "C"
+{
+#include "sim_main/simsys.h"
+#include "sim_main/util.h"
+#include "sim_main/evlst.h"
+#include "sim_main/stat.h"
+#include "Caches/system.h"
+#include "Caches/req.h"
+#include "Caches/cache.h"
+}
+
+#include "Processor/procstate.h"
+#include "Processor/memunit.h"
+#include "Processor/exec.h"
+#include "Processor/mainsim.h"
+#include "Processor/fastfwd.h"
+#include "Processor/simpoint.h"
+#include "Processor/fastnews.h"
+#include "Processor/procstate.hh"
+#include "Processor/tagcvt.hh"
+#include "Processor/memunit.hh"
+#include "Processor/stallq.hh"
+#include "Processor/active.hh"
+
+#include "../../lamix/machine/intr.h"
+
+
+char *bbv_file          = NULL;         // write basic-block vectors (-b)
+char *simpoint_file     = NULL;         // simulate simulation points (-p)
+int   SIMPOINT_INTERVAL = 10000000;     // instructions per interval
+int   SIMPOINT_WARMUP   = 100000;       // detailed warm-up before a point
+
+extern long long reset_instruction;
+extern long long stop_instruction;
+
+
+
+/***************************************************************************/
+/* Basic-block vector profile of one processor. Basic blocks end with a    */
+/* control-transfer instruction and are identified by its PC; block IDs    */
+/* are assigned in order of first execution, starting at 1. An open-       */
+/* addressed table maps PCs to IDs, the per-interval counts are indexed by */
+/* ID and only the blocks executed during the interval are written out.    */
+/* Instructions of a block that is still open at the end of an interval    */
+/* are carried into the next interval.                                     */
+/***************************************************************************/
+
+struct bbv_profile
+{
+  FILE      *fp;
+  unsigned  *pcs;                       // hash table: block PC ...
+  int       *ids;                       // ... and block ID (0 = empty)
+  int        size;                      // table size, power of 2
+  int        blocks;                    // number of blocks seen
+  long long *counts;                    // instructions per block ID
+  int       *touched;                   // IDs executed in this interval
+  int        ntouched;
+  long long  insts;                     // instructions in current block
+  int        lastid;                    // last completed block
+  long long  position;                  // instructions profiled so far
+  long long  interval_end;              // graduation count ending interval
+};
+
+static struct bbv_profile *profiles;
+
+
+
+static void SimpointProfileGrow(struct bbv_profile *bbv)
+{
+  unsigned *pcs = bbv->pcs;
+  int      *ids = bbv->ids;
+  int       size = bbv->size;
+  int       n, h;
+
+  bbv->size    = size ? size * 2 : 4096;
+  bbv->pcs     = (unsigned*)calloc(bbv->size, sizeof(unsigned));
+  bbv->ids     = (int*)calloc(bbv->size, sizeof(int));
+  bbv->counts  = (long long*)realloc(bbv->counts,
+				     bbv->size * sizeof(long long));
+  bbv->touched = (int*)realloc(bbv->touched, bbv->size * sizeof(int));
+  if (!bbv->pcs || !bbv->ids || !bbv->counts || !bbv->touched)
+    YS__errmsg(0, "Malloc failed in %s:%i", __FILE__, __LINE__);
+
+  memset(bbv->counts + size, 0, (bbv->size - size) * sizeof(long long));
+
+  for (n = 0; n < size; n++)
+    if (ids[n])
+      {
+	h = (pcs[n] / SIZE_OF_SPARC_INSTRUCTION) & (bbv->size - 1);
+	while (bbv->ids[h])
+	  h = (h + 1) & (bbv->size - 1);
+	bbv->pcs[h] = pcs[n];
+	bbv->ids[h] = ids[n];
+      }
+
+  free(pcs);
+  free(ids);
+}
+
+
+
+/***************************************************************************/
+/* Write the vector of the interval that ends at position and start the    */
+/* next one. An interval without any completed block (it was spent in     */
+/* detailed simulation of a handed-over instruction) is charged to the    */
+/* last completed block, so that line N of the file always describes      */
+/* interval N as the SimPoint tool expects.                                */
+/***************************************************************************/
+
+static void SimpointVector(struct bbv_profile *bbv)
+{
+  int id, n;
+
+  fprintf(bbv->fp, "T");
+  if ((bbv->ntouched == 0) && (bbv->lastid != 0))
+    {
+      fprintf(bbv->fp, ":%i:%lld ", bbv->lastid, bbv->insts);
+      bbv->insts = 0;
+    }
+
+  for (n = 0; n < bbv->ntouched; n++)
+    {
+      id = bbv->touched[n];
+      fprintf(bbv->fp, ":%i:%lld ", id, bbv->counts[id]);
+      bbv->counts[id] = 0;
+    }
+  fprintf(bbv->fp, "\n");
+
+  bbv->ntouched      = 0;
+  bbv->interval_end += SIMPOINT_INTERVAL;
+}
+
+
+
+/***************************************************************************/
+/* SimpointProfile: called by the functional fast-forward engine for every */
+/* executed instruction; "ctl" is set for control-transfer instructions,  */
+/* the same instructions that decode_branch_instruction handles. Writes a  */
+/* vector line "T:id:count :id:count ..." at the end of every interval.   */
+/* Instructions graduated by the pipeline after a handover are added to   */
+/* the current block, and one vector is written for every interval        */
+/* boundary they cross.                                                    */
+/***************************************************************************/
+
+void SimpointProfile(ProcState *proc, unsigned pc, int ctl)
+{
+  struct bbv_profile *bbv = &profiles[proc->proc_id];
+  long long gap = proc->graduation_count - bbv->position;
+  int h, id;
+
+  while ((gap > 0) && (bbv->position + gap >= bbv->interval_end))
+    {
+      bbv->insts    += bbv->interval_end - bbv->position;
+      gap           -= bbv->interval_end - bbv->position;
+      bbv->position  = bbv->interval_end;
+      SimpointVector(bbv);
+    }
+
+  bbv->insts    += gap + 1;
+  bbv->position  = proc->graduation_count + 1;
+
+  if (ctl)
+    {
+      if (2 * (bbv->blocks + 1) > bbv->size)
+	SimpointProfileGrow(bbv);
+
+      h = (pc / SIZE_OF_SPARC_INSTRUCTION) & (bbv->size - 1);
+      while ((bbv->ids[h]) && (bbv->pcs[h] != pc))
+	h = (h + 1) & (bbv->size - 1);
+
+      if (bbv->ids[h] == 0)
+	{
+	  bbv->pcs[h] = pc;
+	  bbv->ids[h] = ++bbv->blocks;
+	}
+
+      id = bbv->ids[h];
+      if (bbv->counts[id] == 0)
+	bbv->touched[bbv->ntouched++] = id;
+      bbv->counts[id] += bbv->insts;
+      bbv->insts  = 0;
+      bbv->lastid = id;
+    }
+
+  if (bbv->position >= bbv->interval_end)
+    SimpointVector(bbv);
+}
+
+
+
+static void SimpointProfileInit()
+{
+  char name[PATH_MAX];
+  int  n;
+
+  profiles = RSIM_CALLOC(struct bbv_profile, ARCH_numnodes * ARCH_cpus);
+  if (profiles == NULL)
+    YS__errmsg(0, "Malloc failed in %s:%i", __FILE__, __LINE__);
+
+  for (n = ARCH_cpus * ARCH_firstnode;
+       n < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       n++)
+    {
+      if (ARCH_numnodes * ARCH_cpus == 1)
+	strcpy(name, bbv_file);
+      else
+	sprintf(name, "%s.%i", bbv_file, n);
+
+      profiles[n].fp = fopen(name, "w");
+      if (profiles[n].fp == NULL)
+	YS__errmsg(n / ARCH_cpus, "Open BBV file %s failed: %s",
+		   name, YS__strerror(errno));
+
+      profiles[n].interval_end = SIMPOINT_INTERVAL;
+      SimpointProfileGrow(&profiles[n]);
+
+      YS__logmsg(n / ARCH_cpus,
+		 "CPU %i: writing basic-block vectors (%i instr. intervals) to %s\n",
+		 n % ARCH_cpus, SIMPOINT_INTERVAL, name);
+    }
+}
+
+
+
+/***************************************************************************/
+/* Simulation points, sorted by interval. The interval index and cluster   */
+/* are read from <prefix>.simpoints, the weight of each cluster from       */
+/* <prefix>.weights, as written by SimPoint.                               */
+/***************************************************************************/
+
+struct simpoint
+{
+  long long interval;
+  int       cluster;
+  double    weight;
+};
+
+static struct simpoint *points;
+static int              num_points;
+static int              cur_point;
+
+enum { SIMPOINT_FASTFWD, SIMPOINT_WARM, SIMPOINT_MEASURE };
+static int              phase;
+
+static double           start_time;
+static long long       *start_count;
+
+static STATREC        **stat_cpi;       // cycles per 1000 instructions
+static STATREC        **stat_l1i;       // misses per 1000 instructions
+static STATREC        **stat_l1d;
+static STATREC        **stat_l2;
+
+
+
+static int SimpointCompare(const void *a, const void *b)
+{
+  long long d = ((struct simpoint*)a)->interval -
+    ((struct simpoint*)b)->interval;
+
+  return d < 0 ? -1 : d > 0;
+}
+
+
+
+static void SimpointRead()
+{
+  char       name[PATH_MAX];
+  FILE      *fp;
+  long long  interval;
+  double     weight;
+  int        cluster, n, max = 0;
+
+  sprintf(name, "%s.simpoints", simpoint_file);
+  if ((fp = fopen(name, "r")) == NULL)
+    YS__errmsg(0, "Open simulation points %s failed: %s",
+	       name, YS__strerror(errno));
+
+  while (fscanf(fp, "%lld %i", &interval, &cluster) == 2)
+    {
+      if (num_points == max)
+	{
+	  max = max ? 2 * max : 32;
+	  points = (struct simpoint*)realloc(points,
+					     max * sizeof(struct simpoint));
+	  if (points == NULL)
+	    YS__errmsg(0, "Malloc failed in %s:%i", __FILE__, __LINE__);
+	}
+
+      points[num_points].interval = interval;
+      points[num_points].cluster  = cluster;
+      points[num_points].weight   = -1.0;
+      num_points++;
+    }
+  fclose(fp);
+
+  sprintf(name, "%s.weights", simpoint_file);
+  if ((fp = fopen(name, "r")) == NULL)
+    YS__errmsg(0, "Open simulation point weights %s failed: %s",
+	       name, YS__strerror(errno));
+
+  while (fscanf(fp, "%lf %i", &weight, &cluster) == 2)
+    for (n = 0; n < num_points; n++)
+      if (points[n].cluster == cluster)
+	points[n].weight = weight;
+  fclose(fp);
+
+  if (num_points == 0)
+    YS__errmsg(0, "No simulation points in %s.simpoints", simpoint_file);
+
+  for (n = 0; n < num_points; n++)
+    if (points[n].weight < 0.0)
+      YS__errmsg(0, "No weight for simulation point cluster %i in %s",
+		 points[n].cluster, name);
+
+  qsort(points, num_points, sizeof(struct simpoint), SimpointCompare);
+}
+
+
+
+/***************************************************************************/
+/* Interval position: highest graduation count of all local processors,   */
+/* including instructions executed while fast-forwarding.                 */
+/***************************************************************************/
+
+static long long SimpointPosition()
+{
+  long long pos = 0;
+  int       n;
+
+  for (n = ARCH_cpus * ARCH_firstnode;
+       n < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       n++)
+    if (AllProcs[n]->graduation_count > pos)
+      pos = AllProcs[n]->graduation_count;
+
+  return pos;
+}
+
+
+
+static void SimpointDetail(int detail)
+{
+  int n;
+
+  for (n = ARCH_cpus * ARCH_firstnode;
+       n < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       n++)
+    if (detail)
+      FastFwdEnd(AllProcs[n]);
+    else
+      FastFwdResume(AllProcs[n]);
+}
+
+
+
+static long long SimpointMisses(long long *misses)
+{
+  long long sum = 0;
+  int       n;
+
+  for (n = 0; n < UNCACHED; n++)
+    sum += misses[n];
+
+  return sum;
+}
+
+
+
+/***************************************************************************/
+/* SimpointRecord: end of a simulation point. Write the statistics of the  */
+/* point and add its CPI and miss rates to the weighted summary.          */
+/***************************************************************************/
+
+static void SimpointRecord(struct simpoint *p)
+{
+  CacheStat *cs;
+  long long  insts, core_insts, weight;
+  double     cycles = YS__Simtime - start_time;
+  int        n, k;
+
+  weight = (long long)(p->weight * 1000000.0 + 0.5);
+
+  for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+    {
+      YS__statmsg(n,
+		  "\n\n\nSIMULATION POINT %i: interval %lld, weight %.6f, %.0f cycles\n",
+		  cur_point, p->interval, p->weight, cycles);
+      StatReport(n);
+    }
+
+  for (n = ARCH_cpus * ARCH_firstnode;
+       n < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       n++)
+    {
+      insts = AllProcs[n]->graduation_count - start_count[n];
+      if (insts == 0)
+	continue;
+
+      // the contexts of an SMT core share its caches and miss counts
+      core_insts = 0;
+      for (k = SMT_CORE(n); k < SMT_CORE(n) + SMT_THREADS; k++)
+	core_insts += AllProcs[k]->graduation_count - start_count[k];
+
+      cs = L1ICaches[SMT_CORE(n)]->pstats;
+      StatrecUpdate(stat_cpi[n], (int)(1000.0 * cycles / insts), weight);
+      StatrecUpdate(stat_l1i[n],
+		    (int)(1000 * SimpointMisses(cs->ifetch.l1imisses) /
+			  core_insts),
+		    weight);
+      StatrecUpdate(stat_l1d[n],
+		    (int)(1000 * (SimpointMisses(cs->read.l1dmisses) +
+				  SimpointMisses(cs->write.l1dmisses) +
+				  SimpointMisses(cs->rmw.l1dmisses)) / core_insts),
+		    weight);
+      StatrecUpdate(stat_l2[n],
+		    (int)(1000 * (SimpointMisses(cs->ifetch.l2misses) +
+				  SimpointMisses(cs->read.l2misses) +
+				  SimpointMisses(cs->write.l2misses) +
+				  SimpointMisses(cs->rmw.l2misses)) / core_insts),
+		    weight);
+    }
+}
+
+
+
+static void SimpointReport()
+{
+  int node, n;
+
+  for (node = ARCH_firstnode; node < ARCH_firstnode + ARCH_mynodes; node++)
+    {
+      YS__statmsg(node,
+		  "\n\n\n\n========================================================================\n\n\n\n");
+      YS__statmsg(node,
+		  "WEIGHTED SIMULATION POINT STATISTICS (%i points, %i instr. intervals)\n",
+		  num_points, SIMPOINT_INTERVAL);
+
+      for (n = node * ARCH_cpus; n < (node + 1) * ARCH_cpus; n++)
+	{
+	  YS__statmsg(node, "\nProcessor %i:\n", n % ARCH_cpus);
+	  StatrecReport(node, stat_cpi[n]);
+	  StatrecReport(node, stat_l1i[n]);
+	  StatrecReport(node, stat_l1d[n]);
+	  StatrecReport(node, stat_l2[n]);
+	}
+    }
+}
+
+
+
+/***************************************************************************/
+/* SimpointHandle: drives sampled simulation. Fast-forward to the warm-up  */
+/* period of the next point, simulate in detail until the point starts,   */
+/* clear statistics and simulate the point. After the last point, report  */
+/* the weighted statistics and shut the simulated system down like the    */
+/* stop instruction count (-s) does.                                       */
+/***************************************************************************/
+
+extern "C" void SimpointHandle()
+{
+  EVENT           *ev = (EVENT*)EventGetArg(NULL);
+  struct simpoint *p  = &points[cur_point];
+  long long        pos, start, del;
+  int              n;
+
+  if (EXIT)
+    return;
+
+  pos   = SimpointPosition();
+  start = p->interval * SIMPOINT_INTERVAL;
+
+  if (phase == SIMPOINT_FASTFWD)
+    {
+      if (pos < start - SIMPOINT_WARMUP)
+	{
+	  del = (start - SIMPOINT_WARMUP - pos) / FASTFWD_RATE;
+	  schedule_event(ev, YS__Simtime + (del > 0 ? del : 1));
+	  return;
+	}
+
+      SimpointDetail(1);
+      phase = SIMPOINT_WARM;
+    }
+
+  if (phase == SIMPOINT_WARM)
+    {
+      if (pos < start)
+	{
+	  del = (start - pos) / GRADUATES_PER_CYCLE;
+	  schedule_event(ev, YS__Simtime + (del > 0 ? del : 1));
+	  return;
+	}
+
+      for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+	StatClear(n);
+      for (n = ARCH_cpus * ARCH_firstnode;
+	   n < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+	   n++)
+	start_count[n] = AllProcs[n]->graduation_count;
+      start_time = YS__Simtime;
+
+      phase = SIMPOINT_MEASURE;
+    }
+
+  if (pos < start + SIMPOINT_INTERVAL)
+    {
+      del = (start + SIMPOINT_INTERVAL - pos) / GRADUATES_PER_CYCLE;
+      schedule_event(ev, YS__Simtime + (del > 0 ? del : 1));
+      return;
+    }
+
+  SimpointRecord(p);
+
+  if (++cur_point == num_points)
+    {
+      SimpointReport();
+      for (n = ARCH_cpus * ARCH_firstnode;
+	   n < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+	   n += ARCH_cpus)
+	ExternalInterrupt(n, IPL_PFAIL);
+      return;
+    }
+
+  // next point starts within the warm-up period: stay in detailed mode
+  if (points[cur_point].interval * SIMPOINT_INTERVAL - SIMPOINT_WARMUP > pos)
+    {
+      SimpointDetail(0);
+      phase = SIMPOINT_FASTFWD;
+    }
+  else
+    phase = SIMPOINT_WARM;
+
+  schedule_event(ev, YS__Simtime + 1);
+}
+
+
+
+static void SimpointSampleInit()
+{
+  EVENT *ev;
+  int    n;
+
+  SimpointRead();
+
+  start_count = RSIM_CALLOC(long long, ARCH_numnodes * ARCH_cpus);
+  stat_cpi    = RSIM_CALLOC(STATREC*, ARCH_numnodes * ARCH_cpus);
+  stat_l1i    = RSIM_CALLOC(STATREC*, ARCH_numnodes * ARCH_cpus);
+  stat_l1d    = RSIM_CALLOC(STATREC*, ARCH_numnodes * ARCH_cpus);
+  stat_l2     = RSIM_CALLOC(STATREC*, ARCH_numnodes * ARCH_cpus);
+  if (!start_count || !stat_cpi || !stat_l1i || !stat_l1d || !stat_l2)
+    YS__errmsg(0, "Malloc failed in %s:%i", __FILE__, __LINE__);
+
+  for (n = ARCH_cpus * ARCH_firstnode;
+       n < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       n++)
+    {
+      stat_cpi[n] = NewStatrec(n / ARCH_cpus, "Cycles per 1000 instr.",
+			       POINT, MEANS, NOHIST, 0, 0, 0);
+      stat_l1i[n] = NewStatrec(n / ARCH_cpus, "L1I misses per 1000 instr.",
+			       POINT, MEANS, NOHIST, 0, 0, 0);
+      stat_l1d[n] = NewStatrec(n / ARCH_cpus, "L1D misses per 1000 instr.",
+			       POINT, MEANS, NOHIST, 0, 0, 0);
+      stat_l2[n]  = NewStatrec(n / ARCH_cpus, "L2 misses per 1000 instr.",
+			       POINT, MEANS, NOHIST, 0, 0, 0);
+    }
+
+  for (n = ARCH_firstnode; n < ARCH_firstnode + ARCH_mynodes; n++)
+    YS__logmsg(n, "Simulating %i simulation points from %s (%i instr. intervals, %i warm-up)\n",
+	       num_points, simpoint_file, SIMPOINT_INTERVAL, SIMPOINT_WARMUP);
+
+  phase     = SIMPOINT_FASTFWD;
+  cur_point = 0;
+
+  ev = NewEvent("Simulation points", SimpointHandle, NODELETE, 0);
+  EventSetArg(ev, ev, sizeof(ev));
+  schedule_event(ev, YS__Simtime + 1);
+}
+
+
+
+/***************************************************************************/
+/* SimpointInit: called after the command line and configuration file have */
+/* been read. Both modes start all processors in functional fast-forward   */
+/* mode and disable the other start/stop controls.                         */
+/***************************************************************************/
+
+void SimpointInit()
+{
+  if ((bbv_file == NULL) && (simpoint_file == NULL))
+    return;
+
+  if ((bbv_file != NULL) && (simpoint_file != NULL))
+    {
+      fprintf(stderr, "Profiling (-b) and sampled simulation (-p) are exclusive\n");
+      exit(1);
+    }
+
+  if (fastfwd_instruction || reset_instruction || stop_instruction)
+    {
+      fprintf(stderr, "Sampled simulation (-b, -p) can not be combined with -f, -r or -s\n");
+      exit(1);
+    }
+
+  if (SIMPOINT_INTERVAL <= 0)
+    {
+      fprintf(stderr, "Illegal simpoint_interval %i\n", SIMPOINT_INTERVAL);
+      exit(1);
+    }
+
+  fastfwd_instruction = LLONG_MAX;
+
+  if (bbv_file)
+    SimpointProfileInit();
+  else
+    SimpointSampleInit();
+}
+
+
+
+/***************************************************************************/
+/* SimpointActive: sampled simulation controls fast-forwarding and the     */
+/* statistics; application requests to do so are ignored.                  */
+/***************************************************************************/
+
+int SimpointActive()
+{
+  return (bbv_file != NULL) || (simpoint_file != NULL);
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+extern "C"
+{
+#include "sim_main/simsys.h"
+#include "sim_main/util.h"
+#include "Caches/system.h"
+}
+
+#include "Processor/procstate.h"
+#include "Processor/mainsim.h"
+#include "Processor/branchpred.h"
+#include "Processor/exec.h"
+#include "Processor/memunit.h"
+#include "Processor/instance.h"
+#include "Processor/tlb.h"
+#include "Processor/cputhreads.h"
+#include "Processor/smt.h"
+#include "Processor/fastnews.h"
+#include "Processor/procstate.hh"
+#include "Processor/tagcvt.hh"
+#include "Processor/memunit.hh"
+#include "Processor/active.hh"
+#include "Processor/stallq.hh"
+
+
+int       SMT_FETCH   = 1;              // contexts fetching per cycle
+smtpolicy SMT_POLICY  = SMT_ICOUNT;     // fetch selection policy
+int       SMT_CAP     = 100;            // per-context share of a core, in %
+
+
+
+/***************************************************************************/
+/* SMTCap: most of a core resource one context may hold, at least one.     */
+/* Without SMT the context is the core and gets all of it.                 */
+/***************************************************************************/
+
+int SMTCap(int total)
+{
+  int cap;
+
+  if (SMT_THREADS == 1)
+    return(total);
+
+  cap = total * SMT_CAP / 100;
+  return(cap > 0 ? cap : 1);
+}
+
+
+
+/***************************************************************************/
+/* SMTActiveList: instruction window of a context. The active list fills  */
+/* in pairs, so an SMT context's cap is kept even; without SMT the window  */
+/* is activelist as configured.                                            */
+/***************************************************************************/
+
+int SMTActiveList(void)
+{
+  if (SMT_THREADS == 1)
+    return(MAX_ACTIVE_NUMBER);
+
+  return(SMTCap(MAX_ACTIVE_INSTS) * 2);
+}
+
+
+
+/***************************************************************************/
+/* SMTContext: the contexts of a core compete for its shared resources in  */
+/* the order they are simulated. Rotate that order every cycle so no       */
+/* context gets first pick permanently. Maps the k-th slot of the loop     */
+/* over all CPUs to the context simulated in it.                           */
+/***************************************************************************/
+
+int SMTContext(int k)
+{
+  int core = SMT_CORE(k);
+
+  return(core + (int)((k - core + (long long)YS__Simtime) % SMT_THREADS));
+}
+
+
+
+/***************************************************************************/
+/* SMTCheckConfig: a node must consist of whole SMT cores. Contexts of a   */
+/* core update each other's resource counts and share caches, so they are  */
+/* simulated serially, and must tell their TLB entries apart.              */
+/***************************************************************************/
+
+void SMTCheckConfig(void)
+{
+  if (SMT_THREADS < 1)
+    SMT_THREADS = 1;
+
+  if (ARCH_cpus % SMT_THREADS != 0)
+    {
+      fprintf(stderr, "numcpus (%i) is not a multiple of smtthreads (%i)\n",
+	      ARCH_cpus, SMT_THREADS);
+      exit(1);
+    }
+
+  if (SMT_FETCH < 1)
+    SMT_FETCH = 1;
+  if (SMT_FETCH > SMT_THREADS)
+    SMT_FETCH = SMT_THREADS;
+
+  if (SMT_CAP < 1)
+    SMT_CAP = 1;
+  if (SMT_CAP > 100)
+    SMT_CAP = 100;
+
+  if (SMT_THREADS == 1)
+    return;
+
+  if (PARALLEL_CPUS)
+    {
+      YS__warnmsg(0, "parallel_cpus is not supported with SMT, ignored");
+      PARALLEL_CPUS = 0;
+    }
+
+  if (!ITLB_TAGGED || !DTLB_TAGGED)
+    {
+      YS__warnmsg(0, "SMT contexts share the TLBs, using tagged entries");
+      ITLB_TAGGED = DTLB_TAGGED = 1;
+    }
+}
+
+
+
+/***************************************************************************/
+/* SMTSelectFetch: called at the beginning of a cycle, before any context  */
+/* has advanced. Picks the contexts of each core that may fetch this cycle. */
+/* Contexts that could not fetch anyway (halted, in an exception handler,  */
+/* synchronizing or fast-forwarding) do not compete. Ties are broken by a  */
+/* priority that rotates every cycle.                                      */
+/***************************************************************************/
+
+void SMTSelectFetch(void)
+{
+  ProcState *proc, *best;
+  int        core, n, k, start, count, best_count;
+
+  start = (int)((long long)YS__Simtime % SMT_THREADS);
+
+  for (core = ARCH_cpus * ARCH_firstnode;
+       core < ARCH_cpus * (ARCH_firstnode + ARCH_mynodes);
+       core += SMT_THREADS)
+    {
+      for (n = 0; n < SMT_THREADS; n++)
+	if (AllProcs[core + n])
+	  AllProcs[core + n]->smt_fetch = 0;
+
+      for (k = 0; k < SMT_FETCH; k++)
+	{
+	  best = NULL;
+	  best_count = 0;
+
+	  for (n = 0; n < SMT_THREADS; n++)
+	    {
+	      proc = AllProcs[core + (start + n) % SMT_THREADS];
+	      if ((proc == NULL) || (proc->smt_fetch) || (proc->halt) ||
+		  (proc->exit) || (proc->in_exception) || (proc->sync) ||
+		  (proc->fastfwd))
+		continue;
+
+	      count = 0;
+	      if (SMT_POLICY == SMT_ICOUNT)
+		count = proc->fetch_queue->NumItems() +
+		  proc->active_list.NumElements();
+
+	      if ((best == NULL) || (count < best_count))
+		{
+		  best       = proc;
+		  best_count = count;
+		}
+	    }
+
+	  if (best == NULL)
+	    break;
+
+	  best->smt_fetch = 1;
+	  best->smt_fetch_cycles++;
+	}
+    }
+}
+
+
+
+/***************************************************************************/
+/* Core-wide resource checks. A context's own limits (MaxUnits,            */
+/* max_active_instr, max_active_list) are its cap; these add up the use of */
+/* all contexts of the core against the configured totals.                 */
+/***************************************************************************/
+
+int SMTCoreUnitsBusy(ProcState *proc, int unit)
+{
+  ProcState *ctx;
+  int        n, total, busy = 0;
+
+  switch (unit)
+    {
+    case uALU:  total = ALU_UNITS;  break;
+    case uFP:   total = FPU_UNITS;  break;
+    case uADDR: total = ADDR_UNITS; break;
+    default:    total = MEM_UNITS;  break;
+    }
+
+  for (n = 0; n < SMT_THREADS; n++)
+    if ((ctx = AllProcs[proc->core_id + n]) != NULL)
+      busy += ctx->MaxUnits[unit] - ctx->UnitsFree[unit];
+
+  return(busy >= total);
+}
+
+
+
+int SMTCoreQueueFull(ProcState *proc, int unit)
+{
+  ProcState *ctx;
+  int        n, total, queued = 0;
+
+  switch (unit)
+    {
+    case uALU: total = MAX_ALU_OPS; break;
+    case uFP:  total = MAX_FPU_OPS; break;
+    default:   total = MAX_MEM_OPS; break;
+    }
+
+  for (n = 0; n < SMT_THREADS; n++)
+    if ((ctx = AllProcs[proc->core_id + n]) != NULL)
+      queued += ctx->active_instr[unit];
+
+  return(queued >= total);
+}
+
+
+
+int SMTCoreWindowFull(ProcState *proc)
+{
+  ProcState *ctx;
+  int        n, entries = 0;
+
+  for (n = 0; n < SMT_THREADS; n++)
+    if ((ctx = AllProcs[proc->core_id + n]) != NULL)
+      entries += ctx->active_list.NumEntries();
+
+  return(entries >= MAX_ACTIVE_INSTS * 2);
+}
+
+
+
+/***************************************************************************/
+/* SMTWakeUnit: a context freed a functional unit but has nothing waiting  */
+/* for it. Hand it to the next sibling with an instruction stalled for     */
+/* that unit type and room under its cap; otherwise a sibling that waits   */
+/* only because the core was busy would never be woken up.                */
+/***************************************************************************/
+
+void SMTWakeUnit(ProcState *proc, int unit)
+{
+  ProcState *ctx;
+  instance  *inst;
+  int        n, core = proc->core_id;
+
+  for (n = 1; n < SMT_THREADS; n++)
+    {
+      ctx = AllProcs[core + (proc->proc_id - core + n) % SMT_THREADS];
+      if ((ctx == NULL) || (ctx->UnitsFree[unit] == 0))
+	continue;
+
+      inst = ctx->UnitQ[unit].GetNext(ctx);
+      if (inst != NULL)
+	{
+	  inst->stallqs--;
+	  issue(inst, ctx);
+	  return;
+	}
+    }
+}
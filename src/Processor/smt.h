@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+/***************************************************************************/
+/* Simultaneous multithreading. With smtthreads > 1, consecutive CPUs of a */
+/* node form SMT cores of smtthreads hardware contexts each. A context is  */
+/* still a ProcState with its own architectural state, rename tables and   */
+/* active list, and the OS sees it as a separate CPU. Every cycle only     */
+/* smtfetch contexts of a core fetch, selected by the ICOUNT policy        */
+/* (fewest instructions in the fetch queue and active list) or             */
+/* round-robin. The contexts share the L1 caches, write buffer, uncached   */
+/* buffer and L2 cache of the core's first context (SMT_CORE), and the     */
+/* entries of its TLBs. The functional units, issue queues and instruction */
+/* window of the core are shared dynamically: a context may use whatever   */
+/* its siblings leave free, up to smtcap percent of each. The per-context  */
+/* limits in ProcState (MaxUnits, max_active_instr, max_active_list) hold  */
+/* that cap; the SMTUnitsBusy, SMTQueueFull and SMTWindowFull checks add   */
+/* the core totals and are always false without SMT.                       */
+/***************************************************************************/
+
+#ifndef __RSIM_SMT_H__
+#define __RSIM_SMT_H__
+
+extern "C"
+{
+#include "Caches/system.h"
+}
+
+
+enum smtpolicy
+{
+  SMT_ICOUNT,                          /* fewest instructions in flight     */
+  SMT_ROUNDROBIN                       /* rotate among ready contexts       */
+};
+
+/* SMT_THREADS (contexts per core) is declared in Caches/system.h */
+extern int       SMT_FETCH;            /* contexts fetching per cycle       */
+extern smtpolicy SMT_POLICY;           /* fetch selection policy            */
+extern int       SMT_CAP;              /* per-context share of a core, in % */
+
+
+class ProcState;
+
+int  SMTCap         (int);
+int  SMTActiveList  (void);
+int  SMTContext     (int);
+void SMTCheckConfig (void);
+void SMTSelectFetch (void);
+void SMTWakeUnit    (ProcState *, int);
+
+int  SMTCoreUnitsBusy (ProcState *, int);
+int  SMTCoreQueueFull (ProcState *, int);
+int  SMTCoreWindowFull(ProcState *);
+
+
+/* all units of this type are busy in the core */
+inline int SMTUnitsBusy(ProcState *proc, int unit)
+{
+  return((SMT_THREADS > 1) && SMTCoreUnitsBusy(proc, unit));
+}
+
+/* the core's issue queue for this unit type is full */
+inline int SMTQueueFull(ProcState *proc, int unit)
+{
+  return((SMT_THREADS > 1) && SMTCoreQueueFull(proc, unit));
+}
+
+/* the core's instruction window is full */
+inline int SMTWindowFull(ProcState *proc)
+{
+  return((SMT_THREADS > 1) && SMTCoreWindowFull(proc));
+}
+
+
+#endif
@@ -61,6 +61,7 @@
 extern "C"
 {
 #include "sim_main/simsys.h"
+#include "sim_main/checkpoint.h"
 }
 
 #include "Processor/procstate.h"
@@ -135,10 +136,11 @@ TLB::TLB (ProcState *p, enum tlb_type tp, int sz, int assoc, int tgd)
 
 
 //=============================================================================
-// Alternate constructor: clone existing TLB and share array of entries
+// Alternate constructor: clone existing TLB and share array of entries,
+// hardware fills are performed on behalf of processor p
 //=============================================================================
 
-TLB::TLB (TLB *tlb)
+TLB::TLB (TLB *tlb, ProcState *p)
 {
   int n;
 
@@ -148,7 +150,7 @@ TLB::TLB (TLB *tlb)
   tagged         = tlb->tagged;
   
   entries        = tlb->entries;
-  proc           = tlb->proc;
+  proc           = p;
 
   index = 0;
 }
@@ -246,6 +248,49 @@ void TLB::WriteEntry(int entry, unsigned int tag, unsigned int context,
 
 
 
+//=============================================================================
+// Save or restore all TLB entries to/from a checkpoint. The TLB geometry is
+// written first; if it does not match on restore the entries are skipped
+// and the TLB starts out cold.
+//=============================================================================
+
+void TLB::CkptSave(CKPT *ckpt)
+{
+  Ckpt_section(ckpt, CKPT_TAG('T', 'L', 'B', ' '));
+  Ckpt_write_int(ckpt, type);
+  Ckpt_write_int(ckpt, size);
+  Ckpt_write_int(ckpt, associativity);
+  Ckpt_write_int(ckpt, index);
+  Ckpt_write(ckpt, entries, size * sizeof(struct tlb_entry));
+}
+
+
+
+void TLB::CkptRestore(CKPT *ckpt)
+{
+  int tp, sz, assoc, idx;
+
+  Ckpt_expect(ckpt, CKPT_TAG('T', 'L', 'B', ' '));
+  tp    = Ckpt_read_int(ckpt);
+  sz    = Ckpt_read_int(ckpt);
+  assoc = Ckpt_read_int(ckpt);
+  idx   = Ckpt_read_int(ckpt);
+
+  if ((tp != type) || (sz != size) || (assoc != associativity))
+    {
+      YS__warnmsg(proc->proc_id / ARCH_cpus,
+		  "TLB configuration differs from checkpoint %s - not restored",
+		  ckpt->name);
+      Ckpt_skip(ckpt, sz * sizeof(struct tlb_entry));
+      return;
+    }
+
+  index = idx;
+  Ckpt_read(ckpt, entries, size * sizeof(struct tlb_entry));
+}
+
+
+
 //=============================================================================
 // Return oldest (or invalid) entry in a set specified by tag
 //=============================================================================
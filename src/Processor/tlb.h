@@ -60,6 +60,7 @@ extern "C"
 {
 #endif
 #include "Caches/req.h"
+#include "sim_main/checkpoint.h"
 #include "../lamix/mm/mm.h"
 #ifdef __cplusplus
 }
@@ -144,7 +145,7 @@ class TLB
 {
 public:
   TLB  (ProcState*, enum tlb_type, int, int, int);
-  TLB  (TLB*);
+  TLB  (TLB*, ProcState*);
   ~TLB ();
 
   void            ProbeEntry   (unsigned int, int*);
@@ -158,6 +159,9 @@ public:
   void            Fill         (unsigned int, int, unsigned int, long long);
   void            Perform_Fill (REQ*);
 
+  void            CkptSave     (CKPT*);
+  void            CkptRestore  (CKPT*);
+
 
 
 private:
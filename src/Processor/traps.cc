@@ -111,6 +111,9 @@ extern "C"
 #include "Processor/branchpred.h"
 #include "Processor/fastnews.h"
 #include "Processor/filedesc.h"
+#include "Processor/fastfwd.h"
+#include "Processor/simpoint.h"
+#include "Processor/smt.h"
 #include "Processor/tagcvt.hh"
 #include "Processor/procstate.hh"
 #include "Processor/active.hh"
@@ -283,16 +286,19 @@ int SimTrapHandle(instance *inst, ProcState *proc)
       
       //---------------------------------------------------------------------
     case SIM_TRAP_RSIM_ON:               // RSIM ON
+      FastFwdStop(proc->proc_id / ARCH_cpus);
       proc->decode_rate = DECODES_PER_CYCLE;
       proc->graduate_rate = GRADUATES_PER_CYCLE;
-      proc->max_active_list = MAX_ACTIVE_NUMBER;
+      proc->max_active_list = SMTActiveList();
       break;
  
       
       //=====================================================================
 
     case SIM_TRAP_CLEAR_STAT:            // clear stats
-      StatClear(proc->proc_id / ARCH_cpus);
+      FastFwdStop(proc->proc_id / ARCH_cpus);
+      if (!SimpointActive())
+	StatClear(proc->proc_id / ARCH_cpus);
       break;
  
       
@@ -360,12 +366,7 @@ int SimTrapHandle(instance *inst, ProcState *proc)
 		       "%.0f: Installing Mapping: %08X\n",
 		       YS__Simtime, addr);
 #endif
-          phys_mem = (char*)malloc(PAGE_SIZE);
-	  if (phys_mem == NULL)
-	    YS__errmsg(proc->proc_id / ARCH_cpus,
-		       "SimAllocPage: Malloc failed: %s\n",
-		       YS__strerror(errno));
-	  memset(phys_mem, 0, PAGE_SIZE);
+          phys_mem = PageTable_alloc(proc->proc_id / ARCH_cpus, addr);
 	  proc->PageTable->insert(addr, phys_mem);
         }
 #ifdef TRACE
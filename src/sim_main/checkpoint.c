@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+/*****************************************************************************/
+/* Checkpoint file access routines. Modules save their state through these   */
+/* routines in a fixed order, each module starting with a section tag that   */
+/* is verified when the checkpoint is restored. Integers are stored in host */
+/* byte order; the header records it so that files from a host with a       */
+/* different byte order are rejected rather than misinterpreted.             */
+/*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "sim_main/simsys.h"
+#include "sim_main/util.h"
+#include "sim_main/checkpoint.h"
+#include "Caches/system.h"
+
+
+char *ckpt_write_file   = NULL;
+char *ckpt_restore_file = NULL;
+
+
+
+/*===========================================================================*/
+/* Open the checkpoint file for a node. Multi-node systems use one file per */
+/* node, named like the per-node log files. When writing, create the file   */
+/* and write the header; when reading, verify the header against the        */
+/* current system configuration.                                             */
+/*===========================================================================*/
+
+CKPT *Ckpt_open(const char *name, int node, int write)
+{
+  CKPT *ckpt;
+  int   hdr[6];
+
+  ckpt = RSIM_CALLOC(CKPT, 1);
+  if (ckpt == NULL)
+    YS__errmsg(node, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  if (ARCH_numnodes == 1)
+    strcpy(ckpt->name, name);
+  else if (ARCH_numnodes <= 10)
+    sprintf(ckpt->name, "%s%i", name, node);
+  else
+    sprintf(ckpt->name, "%s%02i", name, node);
+
+  ckpt->nodeid = node;
+  ckpt->write  = write;
+
+  ckpt->fp = fopen(ckpt->name, write ? "wb" : "rb");
+  if (ckpt->fp == NULL)
+    YS__errmsg(node, "Open checkpoint file %s failed: %s",
+	       ckpt->name, YS__strerror(errno));
+
+  if (write)
+    {
+      hdr[0] = CKPT_MAGIC;
+      hdr[1] = CKPT_VERSION;
+      hdr[2] = CKPT_BYTEORDER;
+      hdr[3] = node;
+      hdr[4] = ARCH_numnodes;
+      hdr[5] = ARCH_cpus;
+      ckpt->simtime = YS__Simtime;
+
+      Ckpt_write(ckpt, hdr, sizeof(hdr));
+      Ckpt_write(ckpt, &ckpt->simtime, sizeof(ckpt->simtime));
+      return(ckpt);
+    }
+
+  Ckpt_read(ckpt, hdr, sizeof(hdr));
+  Ckpt_read(ckpt, &ckpt->simtime, sizeof(ckpt->simtime));
+
+  if ((hdr[0] != CKPT_MAGIC) || (hdr[2] != CKPT_BYTEORDER))
+    YS__errmsg(node, "%s is not a checkpoint file for this host", ckpt->name);
+
+  if (hdr[1] != CKPT_VERSION)
+    YS__errmsg(node, "Checkpoint %s has version %i, expected %i",
+	       ckpt->name, hdr[1], CKPT_VERSION);
+
+  if ((hdr[3] != node) || (hdr[4] != ARCH_numnodes) || (hdr[5] != ARCH_cpus))
+    YS__errmsg(node,
+	       "Checkpoint %s is for node %i of %i with %i CPUs per node",
+	       ckpt->name, hdr[3], hdr[4], hdr[5]);
+
+  return(ckpt);
+}
+
+
+
+void Ckpt_close(CKPT *ckpt)
+{
+  if (ckpt->write)
+    Ckpt_section(ckpt, CKPT_TAG('E', 'N', 'D', ' '));
+  else
+    Ckpt_expect(ckpt, CKPT_TAG('E', 'N', 'D', ' '));
+
+  if (fclose(ckpt->fp) != 0)
+    YS__errmsg(ckpt->nodeid, "Close checkpoint file %s failed: %s",
+	       ckpt->name, YS__strerror(errno));
+
+  free(ckpt);
+}
+
+
+
+
+/*===========================================================================*/
+/* Raw data transfer; a short read or write is fatal.                        */
+/*===========================================================================*/
+
+void Ckpt_write(CKPT *ckpt, const void *buf, int length)
+{
+  if ((length > 0) && (fwrite(buf, length, 1, ckpt->fp) != 1))
+    YS__errmsg(ckpt->nodeid, "Write to checkpoint file %s failed: %s",
+	       ckpt->name, YS__strerror(errno));
+}
+
+
+void Ckpt_read(CKPT *ckpt, void *buf, int length)
+{
+  if ((length > 0) && (fread(buf, length, 1, ckpt->fp) != 1))
+    YS__errmsg(ckpt->nodeid, "Checkpoint file %s is truncated", ckpt->name);
+}
+
+
+void Ckpt_write_int(CKPT *ckpt, int val)
+{
+  Ckpt_write(ckpt, &val, sizeof(val));
+}
+
+
+int Ckpt_read_int(CKPT *ckpt)
+{
+  int val;
+
+  Ckpt_read(ckpt, &val, sizeof(val));
+  return(val);
+}
+
+
+void Ckpt_skip(CKPT *ckpt, int length)
+{
+  if ((length > 0) && (fseek(ckpt->fp, length, SEEK_CUR) != 0))
+    YS__errmsg(ckpt->nodeid, "Checkpoint file %s is truncated", ckpt->name);
+}
+
+
+
+
+/*===========================================================================*/
+/* Section tags: catch modules that save and restore a different amount of  */
+/* state, which would otherwise silently corrupt everything that follows.   */
+/*===========================================================================*/
+
+void Ckpt_section(CKPT *ckpt, unsigned tag)
+{
+  Ckpt_write(ckpt, &tag, sizeof(tag));
+}
+
+
+void Ckpt_expect(CKPT *ckpt, unsigned tag)
+{
+  unsigned t;
+
+  Ckpt_read(ckpt, &t, sizeof(t));
+  if (t != tag)
+    YS__errmsg(ckpt->nodeid,
+	       "Checkpoint %s: found section '%c%c%c%c', expected '%c%c%c%c'",
+	       ckpt->name,
+	       (t >> 24) & 0xFF, (t >> 16) & 0xFF, (t >> 8) & 0xFF, t & 0xFF,
+	       (tag >> 24) & 0xFF, (tag >> 16) & 0xFF, (tag >> 8) & 0xFF,
+	       tag & 0xFF);
+}
+
+
+
+
+/*===========================================================================*/
+/* Compressed buffers: a sequence of records, each consisting of a count of */
+/* zero bytes and a count of literal bytes followed by the literals. Most   */
+/* simulated memory pages are largely zero, so this alone shrinks typical   */
+/* checkpoints considerably without depending on a compression library.    */
+/* A NULL buffer on restore skips the data.                                  */
+/*===========================================================================*/
+
+#define CKPT_MIN_ZERO_RUN 8
+
+void Ckpt_write_page(CKPT *ckpt, const char *buf, int length)
+{
+  unsigned short cnt[2];
+  int            pos, start, run;
+
+  Ckpt_write_int(ckpt, length);
+
+  pos = 0;
+  while (pos < length)
+    {
+      start = pos;
+      while ((pos < length) && (buf[pos] == 0) && (pos - start < 0xFFFF))
+	pos++;
+      cnt[0] = pos - start;
+
+      /* literals extend until the next sufficiently long run of zeros     */
+      start = pos;
+      while ((pos < length) && (pos - start < 0xFFFF))
+	{
+	  for (run = 0;
+	       (run < CKPT_MIN_ZERO_RUN) && (pos + run < length) &&
+		 (buf[pos + run] == 0);
+	       run++)
+	    ;
+	  if ((run == CKPT_MIN_ZERO_RUN) || (pos + run == length))
+	    break;
+	  pos += run + 1;
+	}
+      if (pos - start > 0xFFFF)
+	pos = start + 0xFFFF;
+      cnt[1] = pos - start;
+
+      Ckpt_write(ckpt, cnt, sizeof(cnt));
+      Ckpt_write(ckpt, buf + start, cnt[1]);
+    }
+}
+
+
+
+void Ckpt_read_page(CKPT *ckpt, char *buf, int length)
+{
+  unsigned short cnt[2];
+  int            pos, len;
+
+  len = Ckpt_read_int(ckpt);
+  if (len != length)
+    YS__errmsg(ckpt->nodeid,
+	       "Checkpoint %s: buffer size %i does not match %i",
+	       ckpt->name, len, length);
+
+  pos = 0;
+  while (pos < length)
+    {
+      Ckpt_read(ckpt, cnt, sizeof(cnt));
+      if (pos + cnt[0] + cnt[1] > length)
+	YS__errmsg(ckpt->nodeid, "Checkpoint %s is corrupted", ckpt->name);
+
+      if (buf)
+	{
+	  memset(buf + pos, 0, cnt[0]);
+	  Ckpt_read(ckpt, buf + pos + cnt[0], cnt[1]);
+	}
+      else
+	Ckpt_skip(ckpt, cnt[1]);
+
+      pos += cnt[0] + cnt[1];
+    }
+}
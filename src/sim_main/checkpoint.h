@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+
+/*****************************************************************************/
+/* Checkpoint file access. A checkpoint is a per-node binary file that holds */
+/* the architectural and warm microarchitectural state of one node. It       */
+/* starts with a versioned header, followed by tagged sections written and   */
+/* read in a fixed order by the individual simulator modules. Page-sized    */
+/* buffers are compressed by encoding runs of zero bytes.                    */
+/*****************************************************************************/
+
+#ifndef __RSIM_CHECKPOINT_H__
+#define __RSIM_CHECKPOINT_H__
+
+#include <stdio.h>
+#include <limits.h>
+
+
+#define CKPT_MAGIC      0x52534350          /* 'RSCP'                        */
+#define CKPT_VERSION    3
+#define CKPT_BYTEORDER  0x01020304          /* detects foreign host files    */
+
+#define CKPT_TAG(a, b, c, d) \
+  ((unsigned)(a) << 24 | (unsigned)(b) << 16 | (unsigned)(c) << 8 | (unsigned)(d))
+
+
+typedef struct CKPT
+{
+  FILE   *fp;
+  int     nodeid;
+  int     write;
+  char    name[PATH_MAX];
+  double  simtime;                          /* time at which it was written  */
+} CKPT;
+
+
+extern char *ckpt_write_file;               /* -w: write at end of fast-fwd. */
+extern char *ckpt_restore_file;             /* -l: restore at startup        */
+
+
+CKPT   *Ckpt_open       (const char *name, int node, int write);
+void    Ckpt_close      (CKPT *ckpt);
+
+void    Ckpt_write      (CKPT *ckpt, const void *buf, int length);
+void    Ckpt_read       (CKPT *ckpt, void *buf, int length);
+void    Ckpt_write_int  (CKPT *ckpt, int val);
+int     Ckpt_read_int   (CKPT *ckpt);
+void    Ckpt_skip       (CKPT *ckpt, int length);
+
+void    Ckpt_section    (CKPT *ckpt, unsigned tag);
+void    Ckpt_expect     (CKPT *ckpt, unsigned tag);
+
+void    Ckpt_write_page (CKPT *ckpt, const char *buf, int length);
+void    Ckpt_read_page  (CKPT *ckpt, char *buf, int length);
+
+#endif
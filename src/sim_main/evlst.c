@@ -60,6 +60,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "sim_main/simsys.h"
 #include "sim_main/tr.evlst.h"
@@ -70,8 +71,8 @@
 /*****************************************************************************/
 /* EVENT LIST Operations: There are two implementations of the eventlist:    */
 /* a calendar queue and a simple linear list.  The choice of which list      */
-/* to use is determined by a command line argument or by the operation       */
-/* EventListSelect().  The implementaton of the calendar queue algorithm     */
+/* to use is determined by the 'eventlist' configuration parameter or by     */
+/* the operation EventListSelect().  The implementaton of the calendar queue algorithm     */
 /* follows the description in "Calendar Queues: A Fast O(1) Priority         */
 /* Queue Implementation for the Simulation Event Set Problem," by Randy      */
 /* Brown, Comm. ACM, Oct. 1988, pp. 1220-1227.                               */
@@ -79,17 +80,51 @@
 
 STATREC *lengthstat = 0;           /* For collecting queue length statistics */
 
+int EventListType = EVLST_CALENDAR;    /* event list implementation in use  */
 
 
 /* 
  * Variables used when the event List is implemented as a
- * simple linear list 
+ * simple linear list. 'head' always points to the earliest event, also
+ * for the calendar queue, so that YS__EventListHeadval() remains a macro.
  */
 EVENT *head;                  /* Pointer to the first element of the queue   */
 EVENT *tail;                  /* Pointer to the last element of the queue    */
 int   size;                   /* Number of elements in the queue             */
 
 
+/*
+ * Variables used when the event list is implemented as a calendar queue.
+ * Each bucket is a list sorted by time; events with identical time always
+ * fall into the same bucket and are kept in insertion order. Instead of
+ * accumulating bucket boundaries in floating point, times are mapped to
+ * 'virtual buckets' (time / width), the physical bucket is the virtual
+ * bucket modulo the number of buckets.
+ */
+#define CQ_MIN_BUCKETS   16          /* never shrink below this             */
+#define CQ_SAMPLE        25          /* events sampled to estimate width    */
+
+int        cqsize;            /* Number of buckets (power of 2)              */
+double     lastprio;          /* Time of the last event removed from list    */
+
+static EVENT   **cq_bucket = NULL; /* first (earliest) event in bucket       */
+static EVENT   **cq_last   = NULL; /* last event in bucket, for fast append  */
+static int       cq_mask;          /* cqsize - 1                             */
+static double    cq_width;         /* time interval covered by one bucket    */
+static double    cq_invwidth;      /* 1 / cq_width                           */
+static long long cq_curvb;         /* virtual bucket of the earliest event   */
+
+#define CQ_VBUCKET(t)    ((long long)((t) * cq_invwidth))
+
+static void   CQ_Init    (int, double);
+static void   CQ_Insert  (EVENT *);
+static void   CQ_Remove  (EVENT *);
+static EVENT *CQ_FindMin (void);
+static void   CQ_Resize  (int);
+static EVENT *EventListSort(EVENT *, int);
+
+
+
 /* 
  * Creates & returns pointer to an event 
  */
@@ -131,10 +166,68 @@ EVENT *NewEvent(const char *ename, func bodyname, int dflag, int etype)
  */
 void YS__EventListInit(void)
 {
-  TRACE_EVLST_init2;
-  head = 0;
-  tail = 0;
-  size = 0;
+  head     = 0;
+  tail     = 0;
+  size     = 0;
+  lastprio = 0.0;
+
+  if (EventListType == EVLST_CALENDAR)
+    {
+      TRACE_EVLST_init1;
+      CQ_Init(CQ_MIN_BUCKETS, 1.0);
+    }
+  else
+    {
+      TRACE_EVLST_init2;
+    }
+}
+
+
+
+/*
+ * Switches the event list implementation. Pending events are moved
+ * to the new list in time order, preserving the order of events
+ * scheduled for the same time.
+ */
+void EventListSelect(int type)
+{
+  EVENT *list, *ev;
+  int    n;
+
+  if (type == EventListType)
+    return;
+
+  if ((type != EVLST_LIST) && (type != EVLST_CALENDAR))
+    YS__errmsg(0, "Unknown event list type %d", type);
+
+  /* collect all pending events into a single sorted list */
+  if (EventListType == EVLST_CALENDAR)
+    {
+      list = NULL;
+      for (n = cqsize - 1; n >= 0; n--)
+	if (cq_bucket[n])
+	  {
+	    cq_last[n]->next = (QE*)list;
+	    list = cq_bucket[n];
+	  }
+      list = EventListSort(list, size);
+
+      free(cq_bucket);
+      free(cq_last);
+      cq_bucket = cq_last = NULL;
+    }
+  else
+    list = head;
+
+  EventListType = type;
+  YS__EventListInit();
+
+  while (list)
+    {
+      ev   = list;
+      list = (EVENT*)list->next;
+      YS__EventListInsert(ev);
+    }
 }
 
 
@@ -175,7 +268,20 @@ void YS__EventListInsert(EVENT *vptr)
   TRACE_EVLST_insert;
 
   size++;
-  if (head == 0)
+
+  if (EventListType == EVLST_CALENDAR)
+    {
+      CQ_Insert(vptr);
+      if ((head == 0) || (vptr->time < head->time))
+	{
+	  head     = vptr;
+	  cq_curvb = CQ_VBUCKET(vptr->time);
+	}
+
+      if (size > 2 * cqsize)
+	CQ_Resize(2 * cqsize);
+    }
+  else if (head == 0)
     {       /* The queue is empty */
       head = vptr;
       tail = vptr;
@@ -231,9 +337,18 @@ void YS__EventListRemove(EVENT *vptr)
 {
   EVENT *e, *p;
 
+  if (EventListType == EVLST_CALENDAR)
+    {
+      CQ_Remove(vptr);
+      return;
+    }
+
+  size--;
   if (head == vptr)
     {
       head = (EVENT*)vptr->next;
+      if (head == 0)
+	tail = 0;
     }
   else
     {
@@ -259,16 +374,40 @@ void YS__EventListRemove(EVENT *vptr)
 EVENT *YS__EventListGetHead(void)
 {
   EVENT *retptr;
+  int    b;
 
   if (head != 0)
     {     /* Queue not empty */
       size--;                          /* One fewer element in the queue */
       retptr = head;                   /* Get the head element */
-      head = (EVENT *) (retptr->next);
+
+      if (EventListType == EVLST_CALENDAR)
+	{
+	  /* the earliest event is always first in its bucket */
+	  b = (int)(cq_curvb & cq_mask);
+	  cq_bucket[b] = (EVENT*)retptr->next;
+	  if (cq_bucket[b] == 0)
+	    cq_last[b] = 0;
+
+	  lastprio = retptr->time;
+
+	  if ((size < cqsize / 2) && (cqsize > CQ_MIN_BUCKETS))
+	    {
+	      head = 0;
+	      CQ_Resize(cqsize / 2);
+	    }
+	  else
+	    head = size ? CQ_FindMin() : 0;
+	}
+      else
+	{
+	  head = (EVENT *) (retptr->next);
+	  if (head == 0)
+	    tail = 0;               /* Queue now empty */
+	}
+
       retptr->next = 0;         /* Clear next pointer of removed element */
       retptr->scheduled = UNSCHEDULED;
-      if (head == 0)
-	tail = 0;               /* Queue now empty */
 
 #ifdef DEBUG_EVENT 
       if (lengthstat)           /* Queue length statistics collectd */
@@ -290,6 +429,269 @@ EVENT *YS__EventListGetHead(void)
 
 
 
+/*****************************************************************************/
+/* Calendar queue internals                                                  */
+/*****************************************************************************/
+
+/*
+ * Allocate an empty calendar with the given number of buckets (a power
+ * of 2) and bucket width.
+ */
+static void CQ_Init(int nbuckets, double width)
+{
+  free(cq_bucket);
+  free(cq_last);
+
+  cq_bucket = (EVENT**)calloc(nbuckets, sizeof(EVENT*));
+  cq_last   = (EVENT**)calloc(nbuckets, sizeof(EVENT*));
+  if ((cq_bucket == NULL) || (cq_last == NULL))
+    YS__errmsg(0, "Malloc failed at %s:%i", __FILE__, __LINE__);
+
+  cqsize      = nbuckets;
+  cq_mask     = nbuckets - 1;
+  cq_width    = width;
+  cq_invwidth = 1.0 / width;
+  cq_curvb    = CQ_VBUCKET(lastprio);
+}
+
+
+
+/*
+ * Insert an event into its bucket. Events are appended behind all
+ * events with the same or an earlier time.
+ */
+static void CQ_Insert(EVENT *vptr)
+{
+  int    b = (int)(CQ_VBUCKET(vptr->time) & cq_mask);
+  EVENT *tp1;
+
+  if (cq_bucket[b] == 0)
+    {
+      vptr->next   = 0;
+      cq_bucket[b] = vptr;
+      cq_last[b]   = vptr;
+    }
+  else if (vptr->time >= cq_last[b]->time)
+    {
+      vptr->next       = 0;
+      cq_last[b]->next = (QE*)vptr;
+      cq_last[b]       = vptr;
+    }
+  else if (vptr->time < cq_bucket[b]->time)
+    {
+      vptr->next   = (QE*)cq_bucket[b];
+      cq_bucket[b] = vptr;
+    }
+  else
+    {
+      tp1 = cq_bucket[b];
+      while (vptr->time >= ((EVENT*)tp1->next)->time)
+	tp1 = (EVENT*)tp1->next;
+
+      vptr->next = tp1->next;
+      tp1->next  = (QE*)vptr;
+    }
+}
+
+
+
+/*
+ * Unlink an arbitrary event from its bucket (deschedule). Does nothing
+ * if the event is not in the list.
+ */
+static void CQ_Remove(EVENT *vptr)
+{
+  int    b = (int)(CQ_VBUCKET(vptr->time) & cq_mask);
+  EVENT *e, *p;
+
+  for (p = 0, e = cq_bucket[b]; e && (e != vptr); p = e, e = (EVENT*)e->next)
+    ;
+
+  if (e == 0)
+    return;
+
+  if (p)
+    p->next = e->next;
+  else
+    cq_bucket[b] = (EVENT*)e->next;
+
+  if (cq_last[b] == e)
+    cq_last[b] = p;
+
+  e->next = 0;
+  size--;
+
+  if (head == vptr)
+    head = size ? CQ_FindMin() : 0;
+}
+
+
+
+/*
+ * Find the earliest event, starting the search at the current virtual
+ * bucket. Scan at most one 'year' of buckets, then fall back to a direct
+ * search over all buckets. All pending events are at or after cq_curvb.
+ */
+static EVENT *CQ_FindMin(void)
+{
+  long long vb;
+  EVENT    *e, *min;
+  int       n;
+
+  for (n = 0, vb = cq_curvb; n < cqsize; n++, vb++)
+    {
+      e = cq_bucket[vb & cq_mask];
+      if (e && (CQ_VBUCKET(e->time) <= vb))
+	{
+	  cq_curvb = vb;
+	  return e;
+	}
+    }
+
+  min = 0;
+  for (n = 0; n < cqsize; n++)
+    if (cq_bucket[n] && ((min == 0) || (cq_bucket[n]->time < min->time)))
+      min = cq_bucket[n];
+
+  if (min)
+    cq_curvb = CQ_VBUCKET(min->time);
+
+  return min;
+}
+
+
+
+/*
+ * Change the number of buckets and re-estimate the bucket width from the
+ * average separation of the earliest events (ignoring outliers), as
+ * described by Brown. All events are merged into one list in time order
+ * first, so that rebuilding the calendar keeps the FIFO order of events
+ * with identical times.
+ */
+static void CQ_Resize(int nbuckets)
+{
+  EVENT  *list, *ev;
+  double  sep, avg, width;
+  int     n, cnt, b;
+
+  list = NULL;
+  for (n = cqsize - 1; n >= 0; n--)
+    if (cq_bucket[n])
+      {
+	cq_last[n]->next = (QE*)list;
+	list = cq_bucket[n];
+      }
+  list = EventListSort(list, size);
+
+  /* average separation of the first few distinct event times */
+  avg = 0.0;
+  cnt = 0;
+  for (n = 0, ev = list; (n < CQ_SAMPLE) && ev && ev->next;
+       n++, ev = (EVENT*)ev->next)
+    {
+      sep = ((EVENT*)ev->next)->time - ev->time;
+      if (sep > 0.0)
+	{
+	  avg += sep;
+	  cnt++;
+	}
+    }
+
+  width = cq_width;
+  if (cnt > 0)
+    {
+      avg /= cnt;
+
+      sep = 0.0;
+      cnt = 0;
+      for (n = 0, ev = list; (n < CQ_SAMPLE) && ev && ev->next;
+	   n++, ev = (EVENT*)ev->next)
+	{
+	  double s = ((EVENT*)ev->next)->time - ev->time;
+	  if ((s > 0.0) && (s <= 2.0 * avg))
+	    {
+	      sep += s;
+	      cnt++;
+	    }
+	}
+
+      if (cnt > 0)
+	width = 3.0 * sep / cnt;
+    }
+
+  CQ_Init(nbuckets, width);
+
+  /* list is sorted - every event goes to the tail of its bucket */
+  head = list;
+  if (head)
+    cq_curvb = CQ_VBUCKET(head->time);
+
+  while (list)
+    {
+      ev   = list;
+      list = (EVENT*)list->next;
+
+      b = (int)(CQ_VBUCKET(ev->time) & cq_mask);
+      ev->next = 0;
+      if (cq_bucket[b])
+	cq_last[b]->next = (QE*)ev;
+      else
+	cq_bucket[b] = ev;
+      cq_last[b] = ev;
+    }
+}
+
+
+
+/*
+ * Stable merge sort of a list of n events by time. Concatenated calendar
+ * buckets are sorted runs, and events with identical times are never split
+ * across buckets, hence a stable sort restores the exact event list order.
+ */
+static EVENT *EventListSort(EVENT *list, int n)
+{
+  EVENT *a, *b, *p, **tp;
+  int    half, k;
+
+  if ((list == NULL) || (n <= 1))
+    {
+      if (list)
+	list->next = 0;
+      return list;
+    }
+
+  half = n / 2;
+  for (k = 1, p = list; k < half; k++)
+    p = (EVENT*)p->next;
+  b = (EVENT*)p->next;
+  p->next = 0;
+
+  a = EventListSort(list, half);
+  b = EventListSort(b, n - half);
+
+  tp = &list;
+  while (a && b)
+    {
+      if (b->time < a->time)
+	{
+	  *tp = b;
+	  b = (EVENT*)b->next;
+	}
+      else
+	{
+	  *tp = a;
+	  a = (EVENT*)a->next;
+	}
+      tp = (EVENT**)&(*tp)->next;
+    }
+  *tp = a ? a : b;
+
+  return list;
+}
+
+
+
+
 /* 
  * Schedules an activity in the future 
  */
@@ -453,8 +855,24 @@ double YS__EventListHeadval(void)
 void Evlst_dump(int nid)
 {
   EVENT *ev;
+  int    n;
+
   YS__logmsg(nid, "\n====== EVENT LIST ======\n");
 
+  if (EventListType == EVLST_CALENDAR)
+    {
+      YS__logmsg(nid, "Calendar queue: %d buckets, width %lf, %d events\n",
+		 cqsize, cq_width, size);
+      for (n = 0; n < cqsize; n++)
+	for (ev = cq_bucket[n]; ev != NULL; ev = (EVENT*)ev->next)
+	  {
+	    YS__logmsg(nid, "Event %i: %s (bucket %d)\n", ev->id, ev->name, n);
+	    YS__logmsg(nid, "  enterque(%lf), time(%lf), status(%d), scheduled(%d)\n",
+		       ev->enterque, ev->time, ev->status, ev->scheduled);
+	  }
+      return;
+    }
+
   for (ev = head; ev != NULL; ev = (EVENT*)ev->next)
     {
       YS__logmsg(nid, "Event %i: %s\n", ev->id, ev->name);
@@ -463,4 +881,3 @@ void Evlst_dump(int nid)
     }
        
 }
-
@@ -175,12 +175,24 @@ extern double  lastprio;
 
 
 
+/*****************************************************************************/
+/* Event list implementations                                                */
+/*****************************************************************************/
+
+#define EVLST_LIST          0        /* sorted linear list, O(n) insert      */
+#define EVLST_CALENDAR      1        /* calendar queue, O(1) insert/remove   */
+
+extern int     EventListType;        /* implementation currently in use      */
+
+
+
 /*****************************************************************************/
 /* Event list operations                                                     */
 /*****************************************************************************/
 
 EVENT  *NewEvent             (const char *, void (*)(), int, int);
 void    YS__EventListInit    (void);         /* Initializes the event list   */
+void    EventListSelect      (int);          /* Switches implementation      */
 void    YS__EventListInsert  (EVENT *);
 void    YS__EventListRemove  (EVENT *);
 EVENT  *YS__EventListGetHead (void);
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2002 The Board of Trustees of the University of Illinois and
+ *                    William Marsh Rice University
+ * Copyright (c) 2002 The University of Utah
+ * Copyright (c) 2002 The University of Notre Dame du Lac
+ *
+ * All rights reserved.
+ *
+ * Based on RSIM 1.0, developed by:
+ *   Professor Sarita Adve's RSIM research group
+ *   University of Illinois at Urbana-Champaign and
+     William Marsh Rice University
+ *   http://www.cs.uiuc.edu/rsim and http://www.ece.rice.edu/~rsim/dist.html
+ * ML-RSIM/URSIM extensions by:
+ *   The Impulse Research Group, University of Utah
+ *   http://www.cs.utah.edu/impulse
+ *   Lambert Schaelicke, University of Utah and University of Notre Dame du Lac
+ *   http://www.cse.nd.edu/~lambert
+ *   Mike Parker, University of Utah
+ *   http://www.cs.utah.edu/~map
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal with the Software without restriction, including without
+ * limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to
+ * whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimers. 
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimers in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the names of Professor Sarita Adve's RSIM research group,
+ *    the University of Illinois at Urbana-Champaign, William Marsh Rice
+ *    University, nor the names of its contributors may be used to endorse
+ *    or promote products derived from this Software without specific prior
+ *    written permission. 
+ * 4. Neither the names of the ML-RSIM project, the URSIM project, the
+ *    Impulse research group, the University of Utah, the University of
+ *    Notre Dame du Lac, nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission. 
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS WITH THE SOFTWARE. 
+ */
+
+/*
+ * evlst_bench.c
+ *
+ * Standalone microbenchmark for the event list implementations in
+ * evlst.c. Links only against evlst.c and provides stubs for the few
+ * simulator globals the event list references.
+ *
+ * Each run uses the classic 'hold' model: the list is filled with
+ * <pending> events, then the earliest event is repeatedly removed and
+ * rescheduled at its time plus a random increment (hold time, reported
+ * per step). Then steps/16 random pending events are descheduled and
+ * reinserted (remove time, reported per remove plus insert). Two
+ * increment distributions are measured:
+ *
+ *   same-time  most increments are 0, so many events share a timestamp
+ *   spread     uniformly distributed real-valued increments
+ *
+ * Every event removed from the head is checked for time order, and
+ * events with equal times must leave in the order they were inserted.
+ *
+ * Build with 'make bench', usage: evlst_bench [pending] [steps]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <sys/time.h>
+#include "sim_main/simsys.h"
+
+
+/* stubs for simulator globals referenced by evlst.c */
+int     TraceIDs     = 0;
+int     YS__idctr    = 0;
+EVENT  *YS__ActEvnt  = NULL;
+double  YS__Simtime  = 0.0;
+POOL    YS__EventPool;
+
+void YS__RdyListAppend(EVENT *vptr)
+{
+}
+
+void YS__errmsg(int node, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+void YS__logmsg(int node, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+}
+
+
+
+#define WL_SAMETIME   0
+#define WL_SPREAD     1
+
+static const char *wl_names[]   = { "same-time", "spread" };
+static const char *list_names[] = { "list", "calendar" };
+
+static int seqno;
+
+
+
+static double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+
+static double increment(int workload)
+{
+  if (workload == WL_SAMETIME)
+    return (rand() % 8 == 0) ? (double)(rand() % 4 + 1) : 0.0;
+  else
+    return (double)rand() / RAND_MAX * 100.0;
+}
+
+
+static void schedule(EVENT *ev, double time)
+{
+  ev->time      = time;
+  ev->ival1     = seqno++;
+  ev->scheduled = SCHEDULED;
+  YS__EventListInsert(ev);
+}
+
+
+
+/*
+ * Run one benchmark configuration; returns the number of ordering
+ * violations found.
+ */
+static int run(int type, int workload, int pending, int steps)
+{
+  EVENT  *events, *ev;
+  double  t0, t_hold = 0.0, t_remove = 0.0, lasttime;
+  int     n, lastseq, errors = 0, removes = steps / 16 + 1;
+
+  events = (EVENT*)calloc(pending, sizeof(EVENT));
+  if (events == NULL)
+    YS__errmsg(0, "Malloc failed for %d events", pending);
+
+  srand(1);
+  seqno = 0;
+  EventListType = type;
+  YS__EventListInit();
+
+  for (n = 0; n < pending; n++)
+    schedule(&events[n], increment(workload));
+
+  lasttime = -1.0;
+  lastseq  = -1;
+
+  t0 = now();
+  for (n = 0; n < steps; n++)
+    {
+      ev = YS__EventListGetHead();
+      if ((ev->time < lasttime) ||
+	  ((ev->time == lasttime) && (ev->ival1 < lastseq)))
+	errors++;
+      lasttime = ev->time;
+      lastseq  = ev->ival1;
+
+      schedule(ev, ev->time + increment(workload));
+    }
+  t_hold = now() - t0;
+
+  /* deschedule random events and reinsert them after the current time */
+  t0 = now();
+  for (n = 0; n < removes; n++)
+    {
+      ev = &events[rand() % pending];
+      YS__EventListRemove(ev);
+      schedule(ev, lasttime + increment(workload));
+    }
+  t_remove = now() - t0;
+
+  /* drain the list, checking order and FIFO tie-breaking */
+  for (n = 0; n < pending; n++)
+    {
+      ev = YS__EventListGetHead();
+      if ((ev == NULL) ||
+	  (ev->time < lasttime) ||
+	  ((ev->time == lasttime) && (ev->ival1 < lastseq)))
+	{
+	  errors++;
+	  if (ev == NULL)
+	    break;
+	}
+      lasttime = ev->time;
+      lastseq  = ev->ival1;
+    }
+
+  if (YS__EventListGetHead() != NULL)
+    errors++;
+
+  printf("%-9s %-10s %8d %10d %10.1f %10.1f %8d\n",
+	 list_names[type], wl_names[workload], pending, steps,
+	 t_hold * 1.0e9 / steps, t_remove * 1.0e9 / removes, errors);
+
+  if (type == EVLST_CALENDAR)
+    EventListSelect(EVLST_LIST);
+  free(events);
+  return errors;
+}
+
+
+
+int main(int argc, char **argv)
+{
+  int pending = 0, steps = 100000, errors = 0;
+  int sizes[] = { 16, 256, 4096 };
+  int s, type, workload;
+
+  if (argc > 1)
+    pending = atoi(argv[1]);
+  if (argc > 2)
+    steps = atoi(argv[2]);
+
+  printf("%-9s %-10s %8s %10s %10s %10s %8s\n",
+	 "list", "workload", "pending", "steps",
+	 "hold ns", "remove ns", "errors");
+
+  for (s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++)
+    {
+      if ((pending > 0) && (s > 0))
+	break;
+
+      for (workload = WL_SAMETIME; workload <= WL_SPREAD; workload++)
+	for (type = EVLST_LIST; type <= EVLST_CALENDAR; type++)
+	  errors += run(type, workload, pending > 0 ? pending : sizes[s],
+			steps);
+    }
+
+  if (errors)
+    printf("FAILED: %d ordering errors\n", errors);
+
+  return errors != 0;
+}